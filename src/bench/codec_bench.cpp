@@ -0,0 +1,533 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "core/codec/isa.hpp"
+#include "core/codec/byterun1.hpp"
+#include "core/codec/ilbm.hpp"
+#include "core/codec/anim.hpp"
+#include "core/codec/audio.hpp"
+#include "core/codec/records.hpp"
+#include "core/ea/id.hpp"
+#include "core/fd_io.hpp"
+#include "bench/corpus.hpp"
+
+#if defined(IFF_CODEC_X86)
+#include <x86intrin.h>
+#endif
+
+#if !defined(IFF_SAMPLES_DIR)
+#define IFF_SAMPLES_DIR "samples"
+#endif
+
+#if !defined(IFF_CODEC_GOLDEN)
+#define IFF_CODEC_GOLDEN "codec_golden.txt"
+#endif
+
+// Every decoder kernel runs in each variant the CPU supports against
+// payloads taken from the sample corpus. The output of every variant
+// is hashed and compared with the golden hashes committed next to this
+// file, so a faster kernel can never be a wrong one.
+
+using iff::codec::isa_t;
+using iff::codec::bmhd_t;
+using iff::codec::anhd_t;
+using iff::codec::comm_t;
+using iff::bench::chunk_t;
+using namespace iff::ea::literals;
+
+// ===============================================================
+// Benchmark cases. Inputs are prepared once, run () only executes
+// the kernel.
+// ===============================================================
+struct case_t
+{
+  std::string kernel;
+  std::string sample;
+  bmhd_t      bmhd;
+  bool        pbm;
+  unsigned    sample_bytes;
+  std::vector <uint8_t> input;
+  std::vector <std::vector <uint8_t> > deltas;
+  std::vector <unsigned> interleave;
+  size_t      out_size;
+};
+// ---------------------------------------------------------------
+static bool run_case (const case_t& c, isa_t isa, std::vector <uint8_t>& out)
+{
+  out.resize (c.out_size);
+  if (c.kernel == "byterun1")
+    {
+      return iff::codec::decode_body (c.bmhd, c.pbm, &c.input [0], c.input.size (), &out [0], isa);
+    }
+  if (c.kernel == "pack")
+    {
+      // the BODY packed again, one thread so only the kernel is timed
+      bmhd_t h = c.bmhd;
+      h.compression = bmhd_t::eCMP_BYTERUN1;
+      out.clear ();
+      return iff::codec::encode_body (h, c.pbm, &c.input [0], out, 1, isa);
+    }
+  if (c.kernel == "planar")
+    {
+      return iff::codec::frame_to_chunky (c.bmhd, &c.input [0], &out [0], isa);
+    }
+  if (c.kernel == "anim5")
+    {
+      // both display buffers start as the first frame, the output is
+      // the pair of buffers after the last delta
+      const size_t frame = c.input.size ();
+      memcpy (&out [0], &c.input [0], frame);
+      memcpy (&out [frame], &c.input [0], frame);
+      for (size_t k = 0; k < c.deltas.size (); k++)
+	{
+	  const size_t target = c.interleave [k] == 1 ? 0 : (k + 1) & 1;
+	  const std::vector <uint8_t>& d = c.deltas [k];
+	  if (!iff::codec::anim5_decode (c.bmhd, &d [0], d.size (), &out [target * frame]))
+	    {
+	      return false;
+	    }
+	}
+      return true;
+    }
+  if (c.kernel == "audio")
+    {
+      return iff::codec::swap_samples (&c.input [0], &out [0], c.out_size / c.sample_bytes,
+				       c.sample_bytes, isa);
+    }
+  return false;
+}
+// ---------------------------------------------------------------
+// Decodes the BODY found in the sample. Failures drop the sample
+// from the image kernels rather than fail the run.
+static bool image_cases (const std::string& name, const std::vector <uint8_t>& data,
+			 const std::vector <chunk_t>& chunks, std::vector <case_t>& cases)
+{
+  const chunk_t* bmhd = 0;
+  const chunk_t* body = 0;
+  for (size_t i = 0; i < chunks.size () && !body; i++)
+    {
+      switch (chunks [i].id)
+	{
+	case "BMHD"_id:
+	  bmhd = &chunks [i];
+	  break;
+	case "BODY"_id:
+	  body = bmhd ? &chunks [i] : 0;
+	  break;
+	}
+    }
+  if (!body)
+    {
+      return false;
+    }
+  case_t c;
+  c.sample       = name;
+  c.pbm          = body->form == "PBM "_id;
+  c.sample_bytes = 0;
+  if (!iff::codec::parse_bmhd (&data [bmhd->offset], bmhd->size, c.bmhd))
+    {
+      return false;
+    }
+  c.kernel   = "byterun1";
+  c.input.assign (data.begin () + body->offset, data.begin () + body->offset + body->size);
+  c.out_size = iff::codec::body_row_bytes (c.bmhd, c.pbm) * c.bmhd.height;
+  std::vector <uint8_t> frame;
+  if (!run_case (c, iff::codec::eSCALAR, frame))
+    {
+      return false;
+    }
+  cases.push_back (c);
+
+  case_t k = c;
+  k.kernel   = "pack";
+  k.input    = frame;
+  k.out_size = frame.size ();
+  cases.push_back (k);
+
+  if (c.pbm)
+    {
+      return true;
+    }
+  case_t p = c;
+  p.kernel   = "planar";
+  p.input    = frame;
+  p.out_size = (size_t)c.bmhd.width * c.bmhd.height * iff::codec::chunky_pixel_bytes (c.bmhd);
+  cases.push_back (p);
+
+  // op 5 deltas, paired with the ANHD of their frame
+  case_t a = c;
+  a.kernel = "anim5";
+  a.input  = frame;
+  const chunk_t* anhd = 0;
+  for (size_t i = 0; i < chunks.size (); i++)
+    {
+      if (chunks [i].id == "ANHD"_id)
+	{
+	  anhd = &chunks [i];
+	}
+      else if (chunks [i].id == "DLTA"_id && anhd)
+	{
+	  anhd_t h;
+	  if (!iff::codec::parse_anhd (&data [anhd->offset], anhd->size, h) ||
+	      h.operation != anhd_t::eOP_BYTE_VERTICAL)
+	    {
+	      return true;
+	    }
+	  const uint8_t* p = &data [chunks [i].offset];
+	  a.deltas.push_back (std::vector <uint8_t> (p, p + chunks [i].size));
+	  a.interleave.push_back (h.interleave);
+	  anhd = 0;
+	}
+    }
+  if (!a.deltas.empty ())
+    {
+      a.out_size = 2 * frame.size ();
+      cases.push_back (a);
+    }
+  return true;
+}
+// ---------------------------------------------------------------
+// AIFF/AIFC sample data: SSND minus its offset and block size fields
+static bool audio_cases (const std::string& name, const std::vector <uint8_t>& data,
+			 const std::vector <chunk_t>& chunks, std::vector <case_t>& cases)
+{
+  const chunk_t* comm = 0;
+  const chunk_t* ssnd = 0;
+  for (size_t i = 0; i < chunks.size (); i++)
+    {
+      switch (chunks [i].id)
+	{
+	case "COMM"_id:
+	  comm = &chunks [i];
+	  break;
+	case "SSND"_id:
+	  ssnd = &chunks [i];
+	  break;
+	}
+    }
+  if (!comm || !ssnd || ssnd->size < 8)
+    {
+      return false;
+    }
+  comm_t h;
+  if (!iff::codec::comm_schema_t::decode (&data [comm->offset], comm->size, h))
+    {
+      return false;
+    }
+  const unsigned bits  = (unsigned)h.sample_bits;
+  const size_t   start = ssnd->offset + 8 + iff::be32 (&data [ssnd->offset]);
+  const size_t   end   = ssnd->offset + ssnd->size;
+  case_t c;
+  c.kernel       = "audio";
+  c.sample       = name;
+  c.pbm          = false;
+  c.sample_bytes = (bits + 7) / 8;
+  if (start >= end || c.sample_bytes == 0)
+    {
+      return false;
+    }
+  c.input.assign (data.begin () + start, data.begin () + end);
+  c.out_size = c.input.size () - c.input.size () % c.sample_bytes;
+  cases.push_back (c);
+  return true;
+}
+// ---------------------------------------------------------------
+static void load_cases (const std::string& path, std::vector <case_t>& cases)
+{
+  std::vector <uint8_t> data;
+  if (!iff::bench::load_file (path, data) || data.empty ())
+    {
+      return;
+    }
+  // a damaged tail still leaves the chunks before it to measure
+  std::vector <chunk_t> chunks;
+  iff::bench::list_chunks (&data [0], data.size (), chunks);
+  const std::string name = iff::bench::base_name (path);
+  if (!image_cases (name, data, chunks, cases))
+    {
+      audio_cases (name, data, chunks, cases);
+    }
+}
+// ===============================================================
+// Golden hashes: one "kernel sample bytes fnv1a64" line per case
+// ===============================================================
+static uint64_t fnv1a (const std::vector <uint8_t>& v)
+{
+  uint64_t h = 0xCBF29CE484222325ULL;
+  for (size_t i = 0; i < v.size (); i++)
+    {
+      h ^= v [i];
+      h *= 0x100000001B3ULL;
+    }
+  return h;
+}
+// ---------------------------------------------------------------
+struct golden_t
+{
+  uint64_t bytes;
+  uint64_t hash;
+};
+
+typedef std::map <std::string, golden_t> golden_map_t;
+// ---------------------------------------------------------------
+static bool load_golden (const char* path, golden_map_t& golden)
+{
+  std::ifstream ifs (path);
+  if (!ifs)
+    {
+      return false;
+    }
+  std::string line;
+  while (std::getline (ifs, line))
+    {
+      if (line.empty () || line [0] == '#')
+	{
+	  continue;
+	}
+      char kernel [64];
+      char sample [256];
+      unsigned long long bytes;
+      unsigned long long hash;
+      if (sscanf (line.c_str (), "%63s %255s %llu %llx", kernel, sample, &bytes, &hash) == 4)
+	{
+	  golden_t g;
+	  g.bytes = bytes;
+	  g.hash  = hash;
+	  golden [std::string (kernel) + " " + sample] = g;
+	}
+    }
+  return true;
+}
+// ---------------------------------------------------------------
+static bool save_golden (const char* path, const golden_map_t& golden)
+{
+  std::ofstream ofs (path);
+  if (!ofs)
+    {
+      return false;
+    }
+  ofs << "# kernel sample output_bytes fnv1a64 -- written by iff_codec_bench -u\n";
+  for (golden_map_t::const_iterator i = golden.begin (); i != golden.end (); ++i)
+    {
+      char line [512];
+      snprintf (line, sizeof (line), "%s %llu %016llx\n", i->first.c_str (),
+		(unsigned long long)i->second.bytes, (unsigned long long)i->second.hash);
+      ofs << line;
+    }
+  return ofs.good ();
+}
+// ===============================================================
+// Timing: TSC cycles where available, nanoseconds elsewhere
+// ===============================================================
+static uint64_t ticks ()
+{
+#if defined(IFF_CODEC_X86)
+  return __rdtsc ();
+#else
+  return (uint64_t)std::chrono::duration_cast <std::chrono::nanoseconds>
+    (std::chrono::steady_clock::now ().time_since_epoch ()).count ();
+#endif
+}
+// ---------------------------------------------------------------
+static const char* ticks_unit ()
+{
+#if defined(IFF_CODEC_X86)
+  return "cyc/B";
+#else
+  return "ns/B";
+#endif
+}
+// ---------------------------------------------------------------
+// kernels without vector variants only run as scalar
+static bool has_variants (const std::string& kernel)
+{
+  return kernel != "anim5";
+}
+// ===============================================================
+static void usage (const char* prog)
+{
+  std::cerr << "USAGE " << prog << " [-n iterations] [-k kernel] [-g golden_file] [-u] [file|dir ...]" << std::endl
+	    << "  kernels: byterun1 pack planar anim5 audio" << std::endl
+	    << "  -u rewrites the golden file from the scalar output" << std::endl
+	    << "  default corpus: " << IFF_SAMPLES_DIR << std::endl
+	    << "  default golden: " << IFF_CODEC_GOLDEN << std::endl;
+}
+// ---------------------------------------------------------------
+int main (int argc, char* argv [])
+{
+  unsigned    iterations  = 20;
+  const char* only_kernel = 0;
+  const char* golden_file = IFF_CODEC_GOLDEN;
+  bool        update      = false;
+  std::vector <std::string> inputs;
+
+  for (int i = 1; i < argc; i++)
+    {
+      const std::string a = argv [i];
+      if ((a == "-n" || a == "-k" || a == "-g") && i + 1 < argc)
+	{
+	  const char* v = argv [++i];
+	  if (a == "-n")
+	    {
+	      iterations = (unsigned)atoi (v);
+	    }
+	  else if (a == "-k")
+	    {
+	      only_kernel = v;
+	    }
+	  else
+	    {
+	      golden_file = v;
+	    }
+	}
+      else if (a == "-u")
+	{
+	  update = true;
+	}
+      else if (a == "-h" || a == "--help" || (a.size () > 1 && a [0] == '-'))
+	{
+	  usage (argv [0]);
+	  return 1;
+	}
+      else
+	{
+	  inputs.push_back (a);
+	}
+    }
+  if (iterations == 0)
+    {
+      iterations = 1;
+    }
+  if (inputs.empty ())
+    {
+      inputs.push_back (IFF_SAMPLES_DIR);
+    }
+
+  std::vector <std::string> files;
+  for (size_t i = 0; i < inputs.size (); i++)
+    {
+      iff::bench::collect (inputs [i], files);
+    }
+  std::vector <case_t> cases;
+  for (size_t i = 0; i < files.size (); i++)
+    {
+      load_cases (files [i], cases);
+    }
+  if (cases.empty ())
+    {
+      std::cerr << "no decodable samples" << std::endl;
+      return 1;
+    }
+
+  golden_map_t golden;
+  if (!load_golden (golden_file, golden) && !update)
+    {
+      std::cerr << "cant read golden file " << golden_file << std::endl;
+      return 1;
+    }
+
+  char line [512];
+  snprintf (line, sizeof (line), "%-9s %-24s %-7s %10s %10s %8s  %s\n",
+	    "kernel", "sample", "isa", "bytes", ticks_unit (), "MB/s", "result");
+  std::cout << line;
+
+  unsigned failures = 0;
+  std::vector <uint8_t> out;
+  for (size_t i = 0; i < cases.size (); i++)
+    {
+      const case_t& c = cases [i];
+      if (only_kernel && c.kernel != only_kernel)
+	{
+	  continue;
+	}
+      const std::string key = c.kernel + " " + c.sample;
+      for (int v = 0; v < iff::codec::ISA_COUNT; v++)
+	{
+	  const isa_t isa = (isa_t)v;
+	  if (!iff::codec::isa_supported (isa) || (isa != iff::codec::eSCALAR && !has_variants (c.kernel)))
+	    {
+	      continue;
+	    }
+	  // first run checks the output, the timed ones only decode
+	  bool ok = run_case (c, isa, out);
+	  const uint64_t hash = fnv1a (out);
+	  if (ok && update && isa == iff::codec::eSCALAR)
+	    {
+	      golden_t g;
+	      g.bytes = out.size ();
+	      g.hash  = hash;
+	      golden [key] = g;
+	    }
+	  const golden_map_t::const_iterator g = golden.find (key);
+	  const char* result = "ok";
+	  if (!ok)
+	    {
+	      result = "FAILED";
+	    }
+	  else if (g == golden.end ())
+	    {
+	      result = "NO GOLDEN";
+	      ok = false;
+	    }
+	  else if (g->second.bytes != out.size () || g->second.hash != hash)
+	    {
+	      result = "MISMATCH";
+	      ok = false;
+	    }
+
+	  double per_byte = 0;
+	  double mb_per_s = 0;
+	  if (ok)
+	    {
+	      const std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now ();
+	      const uint64_t c0 = ticks ();
+	      for (unsigned n = 0; n < iterations; n++)
+		{
+		  run_case (c, isa, out);
+		}
+	      const uint64_t c1 = ticks ();
+	      const std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now ();
+	      const double bytes   = (double)c.out_size * iterations;
+	      const double seconds = std::chrono::duration <double> (t1 - t0).count ();
+	      per_byte = (double)(c1 - c0) / bytes;
+	      mb_per_s = seconds > 0 ? bytes / (1024.0 * 1024.0) / seconds : 0;
+	    }
+	  else
+	    {
+	      failures++;
+	    }
+	  snprintf (line, sizeof (line), "%-9s %-24s %-7s %10llu %10.3f %8.1f  %s\n",
+		    c.kernel.c_str (), c.sample.c_str (), iff::codec::isa_name (isa),
+		    (unsigned long long)c.out_size, per_byte, mb_per_s, result);
+	  std::cout << line;
+	}
+    }
+
+  if (update)
+    {
+      if (failures)
+	{
+	  std::cerr << "not updating " << golden_file << ": " << failures << " failures" << std::endl;
+	  return 1;
+	}
+      if (!save_golden (golden_file, golden))
+	{
+	  std::cerr << "cant write " << golden_file << std::endl;
+	  return 1;
+	}
+      std::cout << "wrote " << golden_file << std::endl;
+    }
+  if (failures)
+    {
+      std::cerr << failures << " kernel runs diverged from the golden output" << std::endl;
+      return 1;
+    }
+  return 0;
+}
@@ -0,0 +1,137 @@
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include "bench/corpus.hpp"
+#include "core/generic_iff_reader.hpp"
+#include "core/ea/ea_io.hpp"
+
+namespace
+{
+  class chunk_lister_c : public generic_iff_reader_c <iff::ea::io_c>
+  {
+  public:
+    explicit chunk_lister_c (std::vector <iff::bench::chunk_t>& chunks)
+      : m_chunks (chunks)
+    {
+    }
+  private:
+    virtual void _on_chunk_enter (const id_t& id, std::streamsize size, std::streamsize pos)
+    {
+      iff::bench::chunk_t c;
+      c.form   = m_forms.empty () ? 0 : m_forms.back ();
+      c.id     = id.value ();
+      c.offset = (size_t)pos;
+      c.size   = (size_t)size;
+      m_chunks.push_back (c);
+    }
+    virtual void _on_chunk_exit  (const id_t&, std::streamsize, std::streamsize)
+    {
+    }
+    virtual void _on_group_enter (const id_t&, const id_t& tag, std::streamsize, std::streamsize)
+    {
+      m_forms.push_back (tag.value ());
+    }
+    virtual void _on_group_exit  (const id_t&, const id_t&, std::streamsize, std::streamsize)
+    {
+      m_forms.pop_back ();
+    }
+  private:
+    std::vector <iff::bench::chunk_t>& m_chunks;
+    std::vector <iff_id_t> m_forms;
+  };
+}
+
+namespace iff
+{
+  namespace bench
+  {
+    bool file_size (const std::string& path, uint64_t& sz, bool& is_dir)
+    {
+      struct stat st;
+      if (stat (path.c_str (), &st) != 0)
+	{
+	  return false;
+	}
+      is_dir = S_ISDIR (st.st_mode);
+      sz     = (uint64_t)st.st_size;
+      return true;
+    }
+    // ---------------------------------------------------------------
+    void collect (const std::string& path, std::vector <std::string>& files)
+    {
+      uint64_t sz;
+      bool     is_dir;
+      if (!file_size (path, sz, is_dir))
+	{
+	  std::cerr << "cant stat " << path << std::endl;
+	  return;
+	}
+      if (!is_dir)
+	{
+	  files.push_back (path);
+	  return;
+	}
+      DIR* d = opendir (path.c_str ());
+      if (!d)
+	{
+	  return;
+	}
+      std::vector <std::string> found;
+      while (struct dirent* e = readdir (d))
+	{
+	  if (e->d_name [0] == '.')
+	    {
+	      continue;
+	    }
+	  const std::string child = path + "/" + e->d_name;
+	  if (file_size (child, sz, is_dir) && !is_dir)
+	    {
+	      found.push_back (child);
+	    }
+	}
+      closedir (d);
+      std::sort (found.begin (), found.end ());
+      files.insert (files.end (), found.begin (), found.end ());
+    }
+    // ---------------------------------------------------------------
+    bool load_file (const std::string& path, std::vector <uint8_t>& data)
+    {
+      std::ifstream ifs (path.c_str (), std::ios::in | std::ios::binary);
+      if (!ifs)
+	{
+	  return false;
+	}
+      ifs.seekg (0, std::ios::end);
+      const std::streamoff size = ifs.tellg ();
+      ifs.seekg (0, std::ios::beg);
+      if (size < 0)
+	{
+	  return false;
+	}
+      data.resize ((size_t)size);
+      if (size && !ifs.read ((char*)&data [0], size))
+	{
+	  return false;
+	}
+      return true;
+    }
+    // ---------------------------------------------------------------
+    std::string base_name (const std::string& path)
+    {
+      const std::string::size_type slash = path.rfind ('/');
+      return slash == std::string::npos ? path : path.substr (slash + 1);
+    }
+    // ---------------------------------------------------------------
+    bool list_chunks (const uint8_t* data, size_t size, std::vector <chunk_t>& chunks)
+    {
+      chunks.clear ();
+      chunk_lister_c r (chunks);
+      return r.open (data, (std::streamsize)size) == chunk_lister_c::eOK &&
+	r.read () == chunk_lister_c::eOK;
+    }
+  } // ns bench
+} // ns iff
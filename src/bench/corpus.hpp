@@ -0,0 +1,33 @@
+#ifndef __IFF_BENCH_CORPUS_HPP__
+#define __IFF_BENCH_CORPUS_HPP__
+
+#include <string>
+#include <vector>
+#include "core/iff_types.hpp"
+
+namespace iff
+{
+  namespace bench
+  {
+    bool file_size (const std::string& path, uint64_t& sz, bool& is_dir);
+    // appends path, or the regular files of directory path in name order
+    void collect   (const std::string& path, std::vector <std::string>& files);
+    bool load_file (const std::string& path, std::vector <uint8_t>& data);
+    // last path component
+    std::string base_name (const std::string& path);
+
+    // a chunk payload of a file in memory and the FORM it belongs to
+    struct chunk_t
+    {
+      iff_id_t form;
+      iff_id_t id;
+      size_t   offset;
+      size_t   size;
+    };
+    // every chunk in file order; false when the file does not parse
+    // to the end, chunks then holds the ones found before the error
+    bool list_chunks (const uint8_t* data, size_t size, std::vector <chunk_t>& chunks);
+  } // ns bench
+} // ns iff
+
+#endif
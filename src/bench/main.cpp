@@ -0,0 +1,389 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "core/generic_iff_reader.hpp"
+#include "core/generic_parser.hpp"
+#include "core/ea/ea_io.hpp"
+#include "core/trace.hpp"
+#include "bench/probe.hpp"
+#include "bench/corpus.hpp"
+
+#if !defined(IFF_SAMPLES_DIR)
+#define IFF_SAMPLES_DIR "samples"
+#endif
+
+// ===============================================================
+// Reader paths. Every path parses a file and reports the number
+// of callbacks it dispatched.
+// ===============================================================
+class raw_reader_c : public generic_iff_reader_c <iff::ea::io_c>
+{
+public:
+  raw_reader_c ()
+    : m_events (0)
+  {
+  }
+  uint64_t events () const
+  {
+    return m_events;
+  }
+private:
+  virtual void _on_chunk_enter (const id_t&, std::streamsize, std::streamsize)
+  {
+    m_events++;
+  }
+  virtual void _on_chunk_exit  (const id_t&, std::streamsize, std::streamsize)
+  {
+    m_events++;
+  }
+  virtual void _on_group_enter (const id_t&, const id_t&, std::streamsize, std::streamsize)
+  {
+    m_events++;
+  }
+  virtual void _on_group_exit  (const id_t&, const id_t&, std::streamsize, std::streamsize)
+  {
+    m_events++;
+  }
+private:
+  uint64_t m_events;
+};
+// ---------------------------------------------------------------
+class string_parser_c : public iff::generic_parser_c <iff::ea::io_c>
+{
+public:
+  string_parser_c ()
+    : m_events (0)
+  {
+  }
+  uint64_t events () const
+  {
+    return m_events;
+  }
+private:
+  virtual void _on_chunk_enter (const std::string&, std::streamsize, std::streamsize)
+  {
+    m_events++;
+  }
+  virtual void _on_chunk_exit  (const std::string&, std::streamsize, std::streamsize)
+  {
+    m_events++;
+  }
+  virtual void _on_group_enter (const std::string&, const std::string&,
+				std::streamsize, std::streamsize)
+  {
+    m_events++;
+  }
+  virtual void _on_group_exit  (const std::string&, const std::string&,
+				std::streamsize, std::streamsize)
+  {
+    m_events++;
+  }
+private:
+  uint64_t m_events;
+};
+// ---------------------------------------------------------------
+template <class READER>
+static bool run_once (const char* path, uint64_t& events)
+{
+  READER r;
+  if (r.open (path) != READER::eOK)
+    {
+      return false;
+    }
+  if (r.read () != READER::eOK)
+    {
+      return false;
+    }
+  events = r.events ();
+  return true;
+}
+// ---------------------------------------------------------------
+struct bench_path_t
+{
+  const char* name;
+  bool (*run) (const char* path, uint64_t& events);
+};
+
+static const bench_path_t s_paths [] =
+  {
+    {"reader", &run_once <raw_reader_c>},
+    {"parser", &run_once <string_parser_c>}
+  };
+
+static const size_t s_paths_count = sizeof (s_paths) / sizeof (s_paths [0]);
+// ===============================================================
+struct result_t
+{
+  std::string file;
+  std::string path;
+  bool        ok;
+  uint64_t    file_size;
+  unsigned    iterations;
+  double      seconds;
+  uint64_t    events;
+  uint64_t    allocs;
+  uint64_t    alloc_bytes;
+  uint64_t    seeks;
+};
+// ---------------------------------------------------------------
+static void run_bench (const std::string& file, uint64_t file_size,
+		       const bench_path_t& p, unsigned iterations, result_t& res)
+{
+  res.file       = file;
+  res.path       = p.name;
+  res.file_size  = file_size;
+  res.iterations = iterations;
+  res.seconds    = 0;
+  res.events     = 0;
+  res.allocs     = 0;
+  res.alloc_bytes = 0;
+  res.seeks      = 0;
+
+  uint64_t ev = 0;
+  // warm up the page cache and reject files this path cannot parse
+  res.ok = p.run (file.c_str (), ev);
+  if (!res.ok)
+    {
+      return;
+    }
+
+  iff::bench::counters_t before;
+  iff::bench::counters_t after;
+  iff::bench::snapshot (before);
+  const std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now ();
+  for (unsigned i = 0; i < iterations; i++)
+    {
+      if (!p.run (file.c_str (), ev))
+	{
+	  res.ok = false;
+	  return;
+	}
+      res.events += ev;
+    }
+  const std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now ();
+  iff::bench::snapshot (after);
+
+  res.seconds     = std::chrono::duration <double> (t1 - t0).count ();
+  res.allocs      = after.allocs - before.allocs;
+  res.alloc_bytes = after.alloc_bytes - before.alloc_bytes;
+  res.seeks       = after.seeks - before.seeks;
+}
+// ===============================================================
+static double per_sec (double v, double seconds)
+{
+  return seconds > 0 ? v / seconds : 0;
+}
+// ---------------------------------------------------------------
+static void print_text (std::ostream& os, const std::vector <result_t>& results)
+{
+  char line [512];
+  snprintf (line, sizeof (line), "%-36s %-8s %10s %14s %12s %12s\n",
+	    "file", "path", "MB/s", "events/s", "allocs/iter", "seeks/iter");
+  os << line;
+  for (size_t i = 0; i < results.size (); i++)
+    {
+      const result_t& r = results [i];
+      const std::string name = iff::bench::base_name (r.file);
+      if (!r.ok)
+	{
+	  snprintf (line, sizeof (line), "%-36s %-8s %10s\n",
+		    name.c_str (), r.path.c_str (), "skipped");
+	  os << line;
+	  continue;
+	}
+      const double mb = (double)r.file_size * r.iterations / (1024.0 * 1024.0);
+      snprintf (line, sizeof (line), "%-36s %-8s %10.1f %14.0f %12.1f %12.1f\n",
+		name.c_str (), r.path.c_str (),
+		per_sec (mb, r.seconds),
+		per_sec ((double)r.events, r.seconds),
+		(double)r.allocs / r.iterations,
+		(double)r.seeks / r.iterations);
+      os << line;
+    }
+}
+// ---------------------------------------------------------------
+static std::string json_string (const std::string& s)
+{
+  std::string out = "\"";
+  for (size_t i = 0; i < s.size (); i++)
+    {
+      const unsigned char c = (unsigned char)s [i];
+      if (c == '"' || c == '\\')
+	{
+	  out += '\\';
+	  out += (char)c;
+	}
+      else if (c < 0x20)
+	{
+	  char esc [8];
+	  snprintf (esc, sizeof (esc), "\\u%04x", c);
+	  out += esc;
+	}
+      else
+	{
+	  out += (char)c;
+	}
+    }
+  out += '"';
+  return out;
+}
+// ---------------------------------------------------------------
+static void print_json (std::ostream& os, const std::vector <result_t>& results,
+			unsigned iterations)
+{
+  os << "{\n  \"benchmark\": \"iff_bench\",\n"
+     << "  \"iterations\": " << iterations << ",\n"
+     << "  \"seeks_counted\": " << (iff::bench::has_seek_counter () ? "true" : "false") << ",\n"
+     << "  \"results\": [";
+  for (size_t i = 0; i < results.size (); i++)
+    {
+      const result_t& r = results [i];
+      char nums [512];
+      snprintf (nums, sizeof (nums),
+		"\"file_size\": %llu, \"iterations\": %u, \"seconds\": %.9f, "
+		"\"events\": %llu, \"allocs\": %llu, \"alloc_bytes\": %llu, \"seeks\": %llu, "
+		"\"mb_per_s\": %.3f, \"events_per_s\": %.1f",
+		(unsigned long long)r.file_size, r.iterations, r.seconds,
+		(unsigned long long)r.events, (unsigned long long)r.allocs,
+		(unsigned long long)r.alloc_bytes, (unsigned long long)r.seeks,
+		per_sec ((double)r.file_size * r.iterations / (1024.0 * 1024.0), r.seconds),
+		per_sec ((double)r.events, r.seconds));
+      os << (i ? ",\n" : "\n")
+	 << "    {\"file\": " << json_string (r.file)
+	 << ", \"path\": " << json_string (r.path)
+	 << ", \"ok\": " << (r.ok ? "true" : "false")
+	 << ", " << nums << "}";
+    }
+  os << "\n  ]\n}\n";
+}
+// ===============================================================
+static void usage (const char* prog)
+{
+  std::cerr << "USAGE " << prog << " [-n iterations] [-p path] [-j json_file|-] [-t trace_file] [file|dir ...]" << std::endl
+	    << "  paths:";
+  for (size_t i = 0; i < s_paths_count; i++)
+    {
+      std::cerr << " " << s_paths [i].name;
+    }
+  std::cerr << std::endl
+	    << "  default corpus: " << IFF_SAMPLES_DIR << std::endl;
+}
+// ---------------------------------------------------------------
+int main (int argc, char* argv [])
+{
+  unsigned    iterations = 20;
+  const char* only_path  = 0;
+  const char* json_file  = 0;
+  const char* trace_file = 0;
+  std::vector <std::string> inputs;
+
+  for (int i = 1; i < argc; i++)
+    {
+      const std::string a = argv [i];
+      if ((a == "-n" || a == "-p" || a == "-j" || a == "-t") && i + 1 < argc)
+	{
+	  const char* v = argv [++i];
+	  if (a == "-n")
+	    {
+	      iterations = (unsigned)atoi (v);
+	    }
+	  else if (a == "-p")
+	    {
+	      only_path = v;
+	    }
+	  else if (a == "-t")
+	    {
+	      trace_file = v;
+	    }
+	  else
+	    {
+	      json_file = v;
+	    }
+	}
+      else if (a == "-h" || a == "--help" || (a.size () > 1 && a [0] == '-'))
+	{
+	  usage (argv [0]);
+	  return 1;
+	}
+      else
+	{
+	  inputs.push_back (a);
+	}
+    }
+  if (iterations == 0)
+    {
+      iterations = 1;
+    }
+  if (inputs.empty ())
+    {
+      inputs.push_back (IFF_SAMPLES_DIR);
+    }
+
+  std::vector <std::string> files;
+  for (size_t i = 0; i < inputs.size (); i++)
+    {
+      iff::bench::collect (inputs [i], files);
+    }
+  if (files.empty ())
+    {
+      std::cerr << "nothing to benchmark" << std::endl;
+      return 1;
+    }
+
+  // tracing is switched on after the corpus scan, it records every
+  // benchmarked parse and therefore slows the run down
+  iff::trace::enable (trace_file != 0);
+
+  std::vector <result_t> results;
+  for (size_t f = 0; f < files.size (); f++)
+    {
+      uint64_t sz;
+      bool     is_dir;
+      if (!iff::bench::file_size (files [f], sz, is_dir))
+	{
+	  continue;
+	}
+      for (size_t p = 0; p < s_paths_count; p++)
+	{
+	  if (only_path && strcmp (only_path, s_paths [p].name) != 0)
+	    {
+	      continue;
+	    }
+	  result_t r;
+	  run_bench (files [f], sz, s_paths [p], iterations, r);
+	  results.push_back (r);
+	}
+    }
+
+  iff::trace::enable (false);
+  if (trace_file && !iff::trace::dump (trace_file))
+    {
+      std::cerr << "cant write " << trace_file << std::endl;
+      return 1;
+    }
+
+  const bool json_to_stdout = json_file && strcmp (json_file, "-") == 0;
+  print_text (json_to_stdout ? std::cerr : std::cout, results);
+  if (json_to_stdout)
+    {
+      print_json (std::cout, results, iterations);
+    }
+  else if (json_file)
+    {
+      std::ofstream ofs (json_file);
+      if (!ofs.good ())
+	{
+	  std::cerr << "cant write " << json_file << std::endl;
+	  return 1;
+	}
+      print_json (ofs, results, iterations);
+    }
+  return 0;
+}
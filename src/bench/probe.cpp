@@ -0,0 +1,133 @@
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE 1
+#endif
+
+#include <new>
+#include <cstdlib>
+#include <atomic>
+
+#if defined(__linux__)
+#include <dlfcn.h>
+#include <unistd.h>
+#include <sys/types.h>
+#endif
+
+#include "bench/probe.hpp"
+
+// glibc lets malloc be replaced and exports the real one as
+// __libc_malloc; the sanitizers replace it themselves
+#if defined(__GLIBC__) && !defined(__SANITIZE_ADDRESS__) && !defined(__SANITIZE_THREAD__)
+#define IFF_PROBE_MALLOC 1
+#endif
+
+static std::atomic <uint64_t> s_allocs      (0);
+static std::atomic <uint64_t> s_alloc_bytes (0);
+static std::atomic <uint64_t> s_seeks       (0);
+
+static void count_alloc (std::size_t sz)
+{
+  s_allocs.fetch_add (1, std::memory_order_relaxed);
+  s_alloc_bytes.fetch_add (sz, std::memory_order_relaxed);
+}
+
+#if defined(IFF_PROBE_MALLOC)
+extern "C" void* __libc_malloc  (size_t sz);
+extern "C" void* __libc_calloc  (size_t n, size_t sz);
+extern "C" void* __libc_realloc (void* p, size_t sz);
+
+// -----------------------------------------------------------------------
+// allocations of the C library (fopen, strdup, ...) count as well
+extern "C" void* malloc (size_t sz)
+{
+  count_alloc (sz);
+  return __libc_malloc (sz);
+}
+// -----------------------------------------------------------------------
+extern "C" void* calloc (size_t n, size_t sz)
+{
+  count_alloc (n * sz);
+  return __libc_calloc (n, sz);
+}
+// -----------------------------------------------------------------------
+extern "C" void* realloc (void* p, size_t sz)
+{
+  count_alloc (sz);
+  return __libc_realloc (p, sz);
+}
+#endif
+
+// -----------------------------------------------------------------------
+static void* counted_alloc (std::size_t sz)
+{
+#if !defined(IFF_PROBE_MALLOC)
+  // otherwise malloc () counts it
+  count_alloc (sz);
+#endif
+  void* p = std::malloc (sz ? sz : 1);
+  if (!p)
+    {
+      throw std::bad_alloc ();
+    }
+  return p;
+}
+// -----------------------------------------------------------------------
+void* operator new (std::size_t sz)
+{
+  return counted_alloc (sz);
+}
+// -----------------------------------------------------------------------
+void* operator new [] (std::size_t sz)
+{
+  return counted_alloc (sz);
+}
+// -----------------------------------------------------------------------
+void operator delete (void* p) noexcept
+{
+  std::free (p);
+}
+// -----------------------------------------------------------------------
+void operator delete [] (void* p) noexcept
+{
+  std::free (p);
+}
+
+#if defined(__linux__)
+// -----------------------------------------------------------------------
+extern "C" off_t lseek (int fd, off_t offset, int whence)
+{
+  typedef off_t (*fn_t) (int, off_t, int);
+  static fn_t next = (fn_t)dlsym (RTLD_NEXT, "lseek");
+  s_seeks.fetch_add (1, std::memory_order_relaxed);
+  return next (fd, offset, whence);
+}
+// -----------------------------------------------------------------------
+extern "C" off64_t lseek64 (int fd, off64_t offset, int whence)
+{
+  typedef off64_t (*fn_t) (int, off64_t, int);
+  static fn_t next = (fn_t)dlsym (RTLD_NEXT, "lseek64");
+  s_seeks.fetch_add (1, std::memory_order_relaxed);
+  return next (fd, offset, whence);
+}
+#endif
+
+namespace iff
+{
+  namespace bench
+  {
+    void snapshot (counters_t& c)
+    {
+      c.allocs      = s_allocs.load (std::memory_order_relaxed);
+      c.alloc_bytes = s_alloc_bytes.load (std::memory_order_relaxed);
+      c.seeks       = s_seeks.load (std::memory_order_relaxed);
+    }
+    // -----------------------------------------------------------------
+    bool has_seek_counter ()
+    {
+#if defined(__linux__)
+      return true;
+#else
+      return false;
+#endif
+    }
+  } // ns bench
+} // ns iff
@@ -0,0 +1,28 @@
+#ifndef __IFF_BENCH_PROBE_HPP__
+#define __IFF_BENCH_PROBE_HPP__
+
+#include "core/iff_types.hpp"
+
+namespace iff
+{
+  namespace bench
+  {
+    // Process wide counters maintained by the probe library.
+    // Linking iff_probe replaces the global operator new/delete and,
+    // on Linux, interposes lseek so that every kernel seek issued by
+    // the standard library is counted. With glibc malloc, calloc and
+    // realloc are interposed too, so allocations made inside the C
+    // library count as well.
+    struct counters_t
+    {
+      uint64_t allocs;
+      uint64_t alloc_bytes;
+      uint64_t seeks;
+    };
+
+    void snapshot (counters_t& c);
+    bool has_seek_counter ();
+  } // ns bench
+} // ns iff
+
+#endif
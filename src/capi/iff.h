@@ -0,0 +1,96 @@
+#ifndef __IFF_CAPI_IFF_H__
+#define __IFF_CAPI_IFF_H__
+
+/*
+ * C interface of libiff, built as the shared library iff_c.
+ *
+ * One call parses a whole file into a caller supplied array of flat,
+ * fixed size event records, one per chunk and one per group in file
+ * order, so a foreign function interface is crossed once per file
+ * instead of once per chunk. The records carry what a binary index
+ * record does (see core/index.hpp).
+ *
+ * The ABI is stable: iff_event_t only grows by using its reserved
+ * field, and IFF_C_API_VERSION changes whenever it does.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32)
+#  if defined(IFF_C_BUILD)
+#    define IFF_C_API __declspec(dllexport)
+#  else
+#    define IFF_C_API __declspec(dllimport)
+#  endif
+#elif defined(__GNUC__)
+#  define IFF_C_API __attribute__ ((visibility ("default")))
+#else
+#  define IFF_C_API
+#endif
+
+#define IFF_C_API_VERSION 1
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum
+  {
+    IFF_OK          = 0,
+    IFF_NOT_IFF     = 1,
+    IFF_IO_ERROR    = 2,
+    IFF_TOO_DEEP    = 3,
+    IFF_CORRUPT     = 4,
+    IFF_NO_MEMORY   = 5,
+    /* the file parsed but had more events than the array holds */
+    IFF_TRUNCATED   = 6,
+    IFF_BAD_ARGUMENT = 7
+  } iff_status_t;
+
+typedef enum
+  {
+    IFF_EVENT_GROUP = 1,
+    IFF_EVENT_CHUNK = 2
+  } iff_event_kind_t;
+
+/* 32 bytes, naturally aligned, no padding */
+typedef struct
+{
+  uint32_t id;        /* four character code, big endian value: 'FORM' is 0x464F524D */
+  uint32_t tag;       /* group type (ILBM, ...), the id for chunks */
+  uint64_t offset;    /* of the data, for groups of the tag */
+  uint64_t size;      /* as stored in the header */
+  uint16_t depth;     /* 0 for top level objects */
+  uint8_t  kind;      /* iff_event_kind_t */
+  uint8_t  reserved0;
+  uint32_t reserved1;
+} iff_event_t;
+
+/*
+ * Parses the file at path. Up to capacity events are stored in events
+ * (which may be NULL when capacity is 0); *count receives the number
+ * of events of the whole file even when that is more than capacity,
+ * in which case IFF_TRUNCATED is returned and the call can be repeated
+ * with a larger array. On other errors *count holds the events found
+ * before the error.
+ */
+IFF_C_API iff_status_t iff_parse_file (const char* path,
+				       iff_event_t* events, size_t capacity,
+				       size_t* count);
+
+/* the same for a file already in memory */
+IFF_C_API iff_status_t iff_parse_memory (const void* data, size_t size,
+					 iff_event_t* events, size_t capacity,
+					 size_t* count);
+
+IFF_C_API const char*  iff_status_string (iff_status_t status);
+
+/* IFF_C_API_VERSION of the library loaded at run time */
+IFF_C_API unsigned     iff_api_version   (void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,162 @@
+#include "capi/iff.h"
+#include "core/generic_iff_reader.hpp"
+#include "core/ea/ea_io.hpp"
+
+static_assert (sizeof (iff_event_t) == 32, "iff_event_t is part of the ABI");
+
+namespace
+{
+  // fills the caller's array, and only counts once it is full
+  class event_reader_c : public generic_iff_reader_c <iff::ea::io_c>
+  {
+  public:
+    event_reader_c (iff_event_t* events, size_t capacity)
+      : count     (0),
+	m_events   (events),
+	m_capacity (capacity),
+	m_depth    (0)
+    {
+    }
+    size_t count;
+  private:
+    void _emit (uint8_t kind, const id_t& id, const id_t& tag,
+		std::streamsize size, std::streamsize file_pos)
+    {
+      if (count < m_capacity)
+	{
+	  iff_event_t& e = m_events [count];
+	  e.id        = id.value ();
+	  e.tag       = tag.value ();
+	  e.offset    = (uint64_t)file_pos;
+	  e.size      = (uint64_t)size;
+	  e.depth     = m_depth;
+	  e.kind      = kind;
+	  e.reserved0 = 0;
+	  e.reserved1 = 0;
+	}
+      count++;
+    }
+    virtual void _on_chunk_enter (const id_t& id, std::streamsize size, std::streamsize pos)
+    {
+      _emit (IFF_EVENT_CHUNK, id, id, size, pos);
+    }
+    virtual void _on_chunk_exit  (const id_t&, std::streamsize, std::streamsize)
+    {
+    }
+    virtual void _on_group_enter (const id_t& id, const id_t& tag, std::streamsize size, std::streamsize pos)
+    {
+      _emit (IFF_EVENT_GROUP, id, tag, size, pos);
+      m_depth++;
+    }
+    virtual void _on_group_exit  (const id_t&, const id_t&, std::streamsize, std::streamsize)
+    {
+      m_depth--;
+    }
+  private:
+    iff_event_t* m_events;
+    size_t       m_capacity;
+    uint16_t     m_depth;
+  };
+}
+// ---------------------------------------------------------------
+static iff_status_t to_status (event_reader_c::status_t rc)
+{
+  switch (rc)
+    {
+    case event_reader_c::eOK:
+      return IFF_OK;
+    case event_reader_c::eNOT_IFF:
+      return IFF_NOT_IFF;
+    case event_reader_c::eTOO_DEEP:
+      return IFF_TOO_DEEP;
+    case event_reader_c::eCORRUPT:
+      return IFF_CORRUPT;
+    case event_reader_c::eNO_MEMORY:
+      return IFF_NO_MEMORY;
+    default:
+      return IFF_IO_ERROR;
+    }
+}
+// ---------------------------------------------------------------
+// no exception may cross the C boundary
+static iff_status_t parse (const char* path, const void* data, size_t size,
+			   iff_event_t* events, size_t capacity, size_t* count)
+{
+  if (!count || (!events && capacity) || (!path && !data && size))
+    {
+      return IFF_BAD_ARGUMENT;
+    }
+  *count = 0;
+  try
+    {
+      event_reader_c r (events, capacity);
+      event_reader_c::status_t rc = path ? r.open (path) : r.open (data, (std::streamsize)size);
+      if (rc == event_reader_c::eOK)
+	{
+	  rc = r.read ();
+	}
+      *count = r.count;
+      if (rc != event_reader_c::eOK)
+	{
+	  return to_status (rc);
+	}
+      return r.count > capacity ? IFF_TRUNCATED : IFF_OK;
+    }
+  catch (const std::bad_alloc&)
+    {
+      return IFF_NO_MEMORY;
+    }
+  catch (...)
+    {
+      return IFF_IO_ERROR;
+    }
+}
+// ---------------------------------------------------------------
+iff_status_t iff_parse_file (const char* path, iff_event_t* events, size_t capacity,
+			     size_t* count)
+{
+  if (!path)
+    {
+      return IFF_BAD_ARGUMENT;
+    }
+  return parse (path, 0, 0, events, capacity, count);
+}
+// ---------------------------------------------------------------
+iff_status_t iff_parse_memory (const void* data, size_t size,
+			       iff_event_t* events, size_t capacity, size_t* count)
+{
+  if (!data)
+    {
+      return IFF_BAD_ARGUMENT;
+    }
+  return parse (0, data, size, events, capacity, count);
+}
+// ---------------------------------------------------------------
+const char* iff_status_string (iff_status_t status)
+{
+  switch (status)
+    {
+    case IFF_OK:
+      return "ok";
+    case IFF_NOT_IFF:
+      return "not an IFF file";
+    case IFF_IO_ERROR:
+      return "io error";
+    case IFF_TOO_DEEP:
+      return "nested too deep";
+    case IFF_CORRUPT:
+      return "corrupt";
+    case IFF_NO_MEMORY:
+      return "out of memory";
+    case IFF_TRUNCATED:
+      return "more events than the array holds";
+    case IFF_BAD_ARGUMENT:
+      return "bad argument";
+    }
+  return "unknown status";
+}
+// ---------------------------------------------------------------
+unsigned iff_api_version (void)
+{
+  return IFF_C_API_VERSION;
+}
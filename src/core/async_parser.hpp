@@ -0,0 +1,321 @@
+#ifndef __IFF_CORE_ASYNC_PARSER_HPP__
+#define __IFF_CORE_ASYNC_PARSER_HPP__
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "core/generic_iff_reader.hpp"
+#include "core/index.hpp"
+
+namespace iff
+{
+  // Parses a file on a thread of its own. The caller polls progress
+  // (consumed () out of file_size ()), takes the structure found so
+  // far as index records, in file order, and may cancel at any time;
+  // the parse stops before its next chunk or group. A GUI or service
+  // can so show a huge file as it is parsed instead of blocking on
+  // read ().
+  //
+  //   async_parser_c <ea::io_c> p;
+  //   p.start (path);
+  //   while (!p.wait_for (std::chrono::milliseconds (100)))
+  //     {
+  //       p.take (records);  // and p.consumed () for a progress bar
+  //     }
+  //   p.take (records);
+  template <class IO_POLICY>
+  class async_parser_c
+  {
+  public:
+    typedef typename generic_iff_reader_c <IO_POLICY>::status_t status_t;
+  public:
+    // Records are handed over batch at a time, and at the end. A batch
+    // also goes out early once the walk has moved a 64th of the file
+    // past the last one, a chunk at least that big included, or after
+    // 100 ms, so few large chunks show up as they are reached.
+    explicit async_parser_c (size_t batch = 256);
+    // cancels and joins
+    ~async_parser_c ();
+
+    // Opens path on the calling thread, then parses it on a new one.
+    // Whatever ran before is cancelled and its records dropped. On
+    // failure nothing runs and status () tells why.
+    status_t start (const char* path);
+    // thread safe, see generic_iff_reader_c::cancel ()
+    void     cancel ();
+    // Waits until the parse is done or records are there to take; true
+    // once done. wait () waits for the end and joins.
+    bool     wait_for (std::chrono::milliseconds timeout);
+    status_t wait ();
+
+    bool     done      () const;
+    // eOK while running
+    status_t status    () const;
+    uint64_t file_size () const;
+    uint64_t consumed  () const;
+    // appends the records parsed since the last call, returns how many
+    size_t   take (std::vector <index_record_t>& out);
+  private:
+    typedef typename generic_iff_reader_c <IO_POLICY>::id_t id_t;
+
+    class collector_c : public generic_iff_reader_c <IO_POLICY>
+    {
+    public:
+      explicit collector_c (async_parser_c& owner);
+
+      uint16_t depth;
+      std::vector <index_record_t> pending;
+      // the pending records go out once the walk reaches this far or
+      // at this time, whichever comes first
+      std::streamsize                       flush_pos;
+      std::chrono::steady_clock::time_point flush_time;
+    private:
+      virtual void _on_chunk_enter (const id_t& id, std::streamsize chunk_size, std::streamsize file_pos);
+      virtual void _on_chunk_exit  (const id_t& id, std::streamsize chunk_size, std::streamsize file_pos);
+      virtual void _on_group_enter (const id_t& id, const id_t& tag,
+				    std::streamsize group_size, std::streamsize file_pos);
+      virtual void _on_group_exit  (const id_t& id, const id_t& tag,
+				    std::streamsize group_size, std::streamsize file_pos);
+
+      void _emit (uint8_t kind, const id_t& id, const id_t& tag,
+		  std::streamsize size, std::streamsize file_pos);
+    private:
+      async_parser_c& m_owner;
+    };
+    friend class collector_c;
+
+    async_parser_c (const async_parser_c&);
+    async_parser_c& operator = (const async_parser_c&);
+
+    void _run ();
+    void _flush ();
+    void _schedule (std::streamsize from);
+    void _join ();
+  private:
+    const size_t                  m_batch;
+    collector_c                   m_reader;
+    std::thread                   m_thread;
+    mutable std::mutex            m_mutex;
+    std::condition_variable       m_changed;
+    std::vector <index_record_t>  m_records;
+    bool                          m_done;
+    status_t                      m_status;
+  };
+} // ns iff
+
+// ===================================================
+// Implementation
+// ===================================================
+
+namespace iff
+{
+  template <class IO_POLICY>
+  async_parser_c <IO_POLICY>::collector_c::collector_c (async_parser_c& owner)
+    : depth     (0),
+      flush_pos (0),
+      m_owner   (owner)
+  {
+  }
+  // -------------------------------------------------
+  template <class IO_POLICY>
+  void async_parser_c <IO_POLICY>::collector_c::_emit (uint8_t kind, const id_t& id, const id_t& tag,
+						       std::streamsize size, std::streamsize file_pos)
+  {
+    index_record_t r;
+    r.kind   = kind;
+    r.depth  = depth;
+    r.id     = id.value ();
+    r.tag    = tag.value ();
+    r.size   = (uint64_t)size;
+    r.offset = (uint64_t)file_pos;
+    pending.push_back (r);
+    // a chunk is walked past in one step, a group entered
+    const std::streamsize reach = kind == index_record_t::eCHUNK ? file_pos + size : file_pos;
+    if (pending.size () >= m_owner.m_batch || reach >= flush_pos ||
+	std::chrono::steady_clock::now () >= flush_time)
+      {
+	m_owner._flush ();
+	m_owner._schedule (reach);
+      }
+  }
+  // -------------------------------------------------
+  template <class IO_POLICY>
+  void async_parser_c <IO_POLICY>::collector_c::_on_chunk_enter (const id_t& id, std::streamsize chunk_size,
+								 std::streamsize file_pos)
+  {
+    _emit (index_record_t::eCHUNK, id, id, chunk_size, file_pos);
+  }
+  // -------------------------------------------------
+  template <class IO_POLICY>
+  void async_parser_c <IO_POLICY>::collector_c::_on_chunk_exit (const id_t&, std::streamsize,
+								std::streamsize)
+  {
+  }
+  // -------------------------------------------------
+  template <class IO_POLICY>
+  void async_parser_c <IO_POLICY>::collector_c::_on_group_enter (const id_t& id, const id_t& tag,
+								 std::streamsize group_size,
+								 std::streamsize file_pos)
+  {
+    _emit (index_record_t::eGROUP, id, tag, group_size, file_pos);
+    depth++;
+  }
+  // -------------------------------------------------
+  template <class IO_POLICY>
+  void async_parser_c <IO_POLICY>::collector_c::_on_group_exit (const id_t&, const id_t&,
+								std::streamsize, std::streamsize)
+  {
+    depth--;
+  }
+  // =================================================
+  template <class IO_POLICY>
+  async_parser_c <IO_POLICY>::async_parser_c (size_t batch)
+    : m_batch  (batch ? batch : 1),
+      m_reader (*this),
+      m_done   (true),
+      m_status (generic_iff_reader_c <IO_POLICY>::eOK)
+  {
+  }
+  // -------------------------------------------------
+  template <class IO_POLICY>
+  async_parser_c <IO_POLICY>::~async_parser_c ()
+  {
+    _join ();
+  }
+  // -------------------------------------------------
+  template <class IO_POLICY>
+  void async_parser_c <IO_POLICY>::_join ()
+  {
+    if (m_thread.joinable ())
+      {
+	m_reader.cancel ();
+	m_thread.join ();
+      }
+  }
+  // -------------------------------------------------
+  template <class IO_POLICY>
+  typename async_parser_c <IO_POLICY>::status_t
+  async_parser_c <IO_POLICY>::start (const char* path)
+  {
+    _join ();
+    m_reader.pending.clear ();
+    m_reader.depth = 0;
+    const status_t rc = m_reader.open (path);
+    _schedule (0);
+    std::lock_guard <std::mutex> lock (m_mutex);
+    m_records.clear ();
+    m_status = rc;
+    m_done   = rc != generic_iff_reader_c <IO_POLICY>::eOK;
+    if (!m_done)
+      {
+	m_thread = std::thread (&async_parser_c::_run, this);
+      }
+    return rc;
+  }
+  // -------------------------------------------------
+  template <class IO_POLICY>
+  void async_parser_c <IO_POLICY>::_run ()
+  {
+    const status_t rc = m_reader.read ();
+    _flush ();
+    {
+      std::lock_guard <std::mutex> lock (m_mutex);
+      m_status = rc;
+      m_done   = true;
+    }
+    m_changed.notify_all ();
+  }
+  // -------------------------------------------------
+  // on the parsing thread
+  template <class IO_POLICY>
+  void async_parser_c <IO_POLICY>::_flush ()
+  {
+    if (m_reader.pending.empty ())
+      {
+	return;
+      }
+    {
+      std::lock_guard <std::mutex> lock (m_mutex);
+      m_records.insert (m_records.end (), m_reader.pending.begin (), m_reader.pending.end ());
+    }
+    m_reader.pending.clear ();
+    m_changed.notify_all ();
+  }
+  // -------------------------------------------------
+  // on the parsing thread, or before it starts
+  template <class IO_POLICY>
+  void async_parser_c <IO_POLICY>::_schedule (std::streamsize from)
+  {
+    const std::streamsize step = m_reader.file_size () / 64;
+    m_reader.flush_pos  = from + (step > 0 ? step : 1);
+    m_reader.flush_time = std::chrono::steady_clock::now () + std::chrono::milliseconds (100);
+  }
+  // -------------------------------------------------
+  template <class IO_POLICY>
+  void async_parser_c <IO_POLICY>::cancel ()
+  {
+    m_reader.cancel ();
+  }
+  // -------------------------------------------------
+  template <class IO_POLICY>
+  bool async_parser_c <IO_POLICY>::wait_for (std::chrono::milliseconds timeout)
+  {
+    std::unique_lock <std::mutex> lock (m_mutex);
+    m_changed.wait_for (lock, timeout, [this] () { return m_done || !m_records.empty (); });
+    return m_done;
+  }
+  // -------------------------------------------------
+  template <class IO_POLICY>
+  typename async_parser_c <IO_POLICY>::status_t
+  async_parser_c <IO_POLICY>::wait ()
+  {
+    if (m_thread.joinable ())
+      {
+	m_thread.join ();
+      }
+    return status ();
+  }
+  // -------------------------------------------------
+  template <class IO_POLICY>
+  bool async_parser_c <IO_POLICY>::done () const
+  {
+    std::lock_guard <std::mutex> lock (m_mutex);
+    return m_done;
+  }
+  // -------------------------------------------------
+  template <class IO_POLICY>
+  typename async_parser_c <IO_POLICY>::status_t
+  async_parser_c <IO_POLICY>::status () const
+  {
+    std::lock_guard <std::mutex> lock (m_mutex);
+    return m_status;
+  }
+  // -------------------------------------------------
+  // set by open () before the thread starts, read only afterwards
+  template <class IO_POLICY>
+  uint64_t async_parser_c <IO_POLICY>::file_size () const
+  {
+    return (uint64_t)m_reader.file_size ();
+  }
+  // -------------------------------------------------
+  template <class IO_POLICY>
+  uint64_t async_parser_c <IO_POLICY>::consumed () const
+  {
+    return (uint64_t)m_reader.consumed ();
+  }
+  // -------------------------------------------------
+  template <class IO_POLICY>
+  size_t async_parser_c <IO_POLICY>::take (std::vector <index_record_t>& out)
+  {
+    std::lock_guard <std::mutex> lock (m_mutex);
+    const size_t n = m_records.size ();
+    out.insert (out.end (), m_records.begin (), m_records.end ());
+    m_records.clear ();
+    return n;
+  }
+} // ns iff
+
+#endif
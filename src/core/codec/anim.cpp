@@ -0,0 +1,313 @@
+#include "core/codec/anim.hpp"
+#include "core/codec/records.hpp"
+#include "core/codec/parallel.hpp"
+#include "core/trace.hpp"
+#include "core/fd_io.hpp"
+
+namespace iff
+{
+  namespace codec
+  {
+    bool parse_anhd (const uint8_t* data, size_t size, anhd_t& h)
+    {
+      return anhd_schema_t::decode (data, size, h);
+    }
+    // ---------------------------------------------------------------
+    static bool decode_plane (const uint8_t* p, const uint8_t* end, uint8_t* plane,
+			      size_t columns, size_t stride, size_t height)
+    {
+      for (size_t col = 0; col < columns; col++)
+	{
+	  if (p >= end)
+	    {
+	      return false;
+	    }
+	  unsigned ops = *p++;
+	  uint8_t* dst = plane + col;
+	  size_t   row = 0;
+	  while (ops--)
+	    {
+	      if (p >= end)
+		{
+		  return false;
+		}
+	      const unsigned op = *p++;
+	      if (op == 0)
+		{
+		  // same: count, value
+		  if (end - p < 2)
+		    {
+		      return false;
+		    }
+		  const unsigned count = p [0];
+		  const uint8_t  value = p [1];
+		  p += 2;
+		  if (row + count > height)
+		    {
+		      return false;
+		    }
+		  for (unsigned i = 0; i < count; i++, dst += stride)
+		    {
+		      *dst = value;
+		    }
+		  row += count;
+		}
+	      else if (op & 0x80)
+		{
+		  // uniq: count literal bytes
+		  const unsigned count = op & 0x7F;
+		  if ((size_t)(end - p) < count || row + count > height)
+		    {
+		      return false;
+		    }
+		  for (unsigned i = 0; i < count; i++, dst += stride)
+		    {
+		      *dst = *p++;
+		    }
+		  row += count;
+		}
+	      else
+		{
+		  // skip
+		  if (row + op > height)
+		    {
+		      return false;
+		    }
+		  dst += op * stride;
+		  row += op;
+		}
+	    }
+	}
+      return true;
+    }
+    // ---------------------------------------------------------------
+    bool anim5_decode (const bmhd_t& h, const uint8_t* dlta, size_t size, uint8_t* frame)
+    {
+      trace::scope_c span ("decode", "anim5");
+      // 8 plane pointers followed by 8 unused ones
+      if (size < 64)
+	{
+	  return false;
+	}
+      const size_t columns = plane_row_bytes (h);
+      const size_t stride  = body_row_bytes (h, false);
+      const unsigned planes = h.nplanes < 8 ? h.nplanes : 8;
+      for (unsigned i = 0; i < planes; i++)
+	{
+	  const uint32_t offset = be32 (dlta + 4 * i);
+	  if (offset == 0)
+	    {
+	      continue;
+	    }
+	  if (offset >= size ||
+	      !decode_plane (dlta + offset, dlta + size, frame + i * columns,
+			     columns, stride, h.height))
+	    {
+	      return false;
+	    }
+	}
+      return true;
+    }
+    // ---------------------------------------------------------------
+    // Encoder
+    // ---------------------------------------------------------------
+    static const size_t MAX_OPS   = 255;
+    static const size_t MAX_SKIP  = 127;
+    static const size_t MAX_UNIQ  = 127;
+    static const size_t MAX_SAME  = 255;
+    // shortest run a same op is worth breaking a uniq op for
+    static const size_t MIN_SAME  = 4;
+
+    // rows from row on that frame leaves as they are in ref
+    static size_t unchanged (const uint8_t* ref, const uint8_t* cur, size_t stride,
+			     size_t row, size_t height)
+    {
+      size_t n = 0;
+      while (row + n < height && ref [(row + n) * stride] == cur [(row + n) * stride])
+	{
+	  n++;
+	}
+      return n;
+    }
+    // ---------------------------------------------------------------
+    // rows from row on holding the same value, at most max
+    static size_t run (const uint8_t* cur, size_t stride, size_t row, size_t height, size_t max)
+    {
+      const uint8_t v = cur [row * stride];
+      size_t n = 1;
+      while (n < max && row + n < height && cur [(row + n) * stride] == v)
+	{
+	  n++;
+	}
+      return n;
+    }
+    // ---------------------------------------------------------------
+    static size_t emit_skips (size_t rows, std::vector <uint8_t>& out)
+    {
+      size_t ops = 0;
+      for (; rows; ops++)
+	{
+	  const size_t k = rows < MAX_SKIP ? rows : MAX_SKIP;
+	  out.push_back ((uint8_t)k);
+	  rows -= k;
+	}
+      return ops;
+    }
+    // ---------------------------------------------------------------
+    static void emit_uniq (const uint8_t* cur, size_t stride, size_t row, size_t count,
+			   std::vector <uint8_t>& out)
+    {
+      out.push_back ((uint8_t)(0x80 | count));
+      for (size_t i = 0; i < count; i++)
+	{
+	  out.push_back (cur [(row + i) * stride]);
+	}
+    }
+    // ---------------------------------------------------------------
+    // Appends one column: its op count, then the ops. The greedy pass
+    // skips unchanged rows, stores runs as same ops and the rest as
+    // uniq ops, letting a lone unchanged row ride along in a uniq op
+    // since skipping it costs more. Columns that need more than 255
+    // ops that way fall back to one skip run and uniq ops over the
+    // changed span. Returns false if even that does not fit.
+    static bool encode_column (const uint8_t* ref, const uint8_t* cur, size_t stride,
+			       size_t height, std::vector <uint8_t>& out)
+    {
+      const size_t start = out.size ();
+      out.push_back (0);
+      size_t ops = 0;
+      size_t row = 0;
+      size_t first = height;
+      size_t last  = 0;
+      for (;;)
+	{
+	  const size_t skip = unchanged (ref, cur, stride, row, height);
+	  if (row + skip == height)
+	    {
+	      break;
+	    }
+	  ops += emit_skips (skip, out);
+	  row += skip;
+	  if (first == height)
+	    {
+	      first = row;
+	    }
+
+	  const size_t same = run (cur, stride, row, height, MAX_SAME);
+	  if (same >= MIN_SAME)
+	    {
+	      out.push_back (0);
+	      out.push_back ((uint8_t)same);
+	      out.push_back (cur [row * stride]);
+	      ops++;
+	      row += same;
+	      last = row;
+	      continue;
+	    }
+	  const size_t begin = row;
+	  while (row < height && row - begin < MAX_UNIQ)
+	    {
+	      if (row > begin)
+		{
+		  const size_t u = unchanged (ref, cur, stride, row, height);
+		  if (u >= 2 || row + u == height ||
+		      run (cur, stride, row, height, MIN_SAME) >= MIN_SAME)
+		    {
+		      break;
+		    }
+		}
+	      row++;
+	    }
+	  emit_uniq (cur, stride, begin, row - begin, out);
+	  ops++;
+	  last = row;
+	}
+      if (ops <= MAX_OPS)
+	{
+	  out [start] = (uint8_t)ops;
+	  return true;
+	}
+
+      out.resize (start + 1);
+      ops = emit_skips (first, out);
+      for (size_t r = first; r < last; r += MAX_UNIQ, ops++)
+	{
+	  emit_uniq (cur, stride, r, last - r < MAX_UNIQ ? last - r : MAX_UNIQ, out);
+	}
+      out [start] = (uint8_t)ops;
+      return ops <= MAX_OPS;
+    }
+    // ---------------------------------------------------------------
+    bool anim5_encode (const bmhd_t& h, const uint8_t* ref, const uint8_t* frame,
+		       std::vector <uint8_t>& dlta, unsigned threads)
+    {
+      trace::scope_c span ("encode", "anim5");
+      dlta.assign (64, 0);
+      if (h.nplanes > 8)
+	{
+	  return false;
+	}
+      const size_t columns = plane_row_bytes (h);
+      const size_t stride  = body_row_bytes (h, false);
+      const unsigned planes = h.nplanes;
+      if (columns == 0 || h.height == 0)
+	{
+	  return true;
+	}
+
+      // one item is a block of columns of one plane, small enough
+      // that every thread gets a few of them
+      size_t block = columns;
+      if (threads != 1)
+	{
+	  const size_t lanes = (threads ? threads : std::thread::hardware_concurrency ()) * 4;
+	  const size_t per_plane = (lanes + planes - 1) / planes;
+	  block = (columns + per_plane - 1) / per_plane;
+	}
+      const size_t blocks = (columns + block - 1) / block;
+      std::vector <std::vector <uint8_t> > parts (planes * blocks);
+      std::atomic <bool> ok (true);
+      parallel_for (parts.size (), threads, [&] (size_t i)
+	{
+	  const size_t plane = i / blocks;
+	  const size_t col   = (i % blocks) * block;
+	  const size_t end   = col + block < columns ? col + block : columns;
+	  const size_t off   = plane * columns;
+	  std::vector <uint8_t>& out = parts [i];
+	  for (size_t c = col; c < end; c++)
+	    {
+	      if (!encode_column (ref + off + c, frame + off + c, stride, h.height, out))
+		{
+		  ok = false;
+		}
+	    }
+	});
+      if (!ok)
+	{
+	  return false;
+	}
+
+      for (unsigned p = 0; p < planes; p++)
+	{
+	  // a plane whose every column is a bare zero op count is left out
+	  size_t size = 0;
+	  for (size_t b = 0; b < blocks; b++)
+	    {
+	      size += parts [p * blocks + b].size ();
+	    }
+	  if (size == columns)
+	    {
+	      continue;
+	    }
+	  const uint32_t offset = (uint32_t)dlta.size ();
+	  put_be32 (&dlta [4 * p], offset);
+	  for (size_t b = 0; b < blocks; b++)
+	    {
+	      const std::vector <uint8_t>& part = parts [p * blocks + b];
+	      dlta.insert (dlta.end (), part.begin (), part.end ());
+	    }
+	}
+      return true;
+    }
+  } // ns codec
+} // ns iff
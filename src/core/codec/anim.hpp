@@ -0,0 +1,64 @@
+#ifndef __IFF_CODEC_ANIM_HPP__
+#define __IFF_CODEC_ANIM_HPP__
+
+#include <cstddef>
+#include <vector>
+#include "core/codec/ilbm.hpp"
+
+namespace iff
+{
+  namespace codec
+  {
+    // ANIM frame header
+    struct anhd_t
+    {
+      enum
+	{
+	  eOP_BODY           = 0,
+	  eOP_XOR            = 1,
+	  eOP_LONG_DELTA     = 2,
+	  eOP_SHORT_DELTA    = 3,
+	  eOP_GENERAL_DELTA  = 4,
+	  eOP_BYTE_VERTICAL  = 5,
+	  eOP_STEREO         = 6,
+	  eOP_VERTICAL_7     = 7,
+	  eOP_VERTICAL_8     = 8,
+	  eOP_ASCII_J        = 74
+	};
+
+      uint8_t  operation;
+      uint8_t  mask;
+      uint16_t width;
+      uint16_t height;
+      int16_t  x;
+      int16_t  y;
+      uint32_t abs_time;
+      uint32_t rel_time;
+      uint8_t  interleave;
+      uint32_t bits;
+    };
+
+    static const size_t ANHD_MIN_SIZE = 24;
+
+    bool parse_anhd (const uint8_t* data, size_t size, anhd_t& h);
+
+    // Applies an op 5 (byte vertical delta) DLTA to a frame in the
+    // layout decode_body produces. Every plane is a list of columns,
+    // each column walks down the rows, so the kernel is scalar only.
+    // Returns false if the delta runs outside the frame.
+    bool anim5_decode (const bmhd_t& h, const uint8_t* dlta, size_t size, uint8_t* frame);
+
+    // The inverse: fills dlta with the op 5 delta that turns ref into
+    // frame, both in the layout decode_body produces. The columns of
+    // every plane are independent, so blocks of them are encoded on up
+    // to threads threads (0 = one per core) and the output does not
+    // depend on the thread count. The mask plane is not part of op 5
+    // and is left alone. Returns false for more than 8 planes or a
+    // column that needs more than 255 ops (only images taller than
+    // about 32000 rows).
+    bool anim5_encode (const bmhd_t& h, const uint8_t* ref, const uint8_t* frame,
+		       std::vector <uint8_t>& dlta, unsigned threads = 1);
+  } // ns codec
+} // ns iff
+
+#endif
@@ -0,0 +1,345 @@
+#include <string.h>
+#include <unistd.h>
+
+#include "core/codec/anim_decoder.hpp"
+#include "core/ea/container.hpp"
+#include "core/fd_io.hpp"
+
+using namespace iff::ea::literals;
+
+namespace iff
+{
+  namespace codec
+  {
+    // a small chunk's payload, BMHD, CMAP or ANHD
+    static bool read_payload (int fd, const ea::container_child_t& c,
+			      std::vector <uint8_t>& data)
+    {
+      data.resize ((size_t)(c.size - 8));
+      return data.empty () || read_at (fd, c.offset + 8, &data [0], data.size ());
+    }
+    // ---------------------------------------------------------------
+    anim_decoder_c::anim_decoder_c ()
+      : m_fd       (-1),
+	m_pbm      (false),
+	m_complete (true)
+    {
+      memset (&m_bmhd, 0, sizeof (m_bmhd));
+    }
+    // ---------------------------------------------------------------
+    anim_decoder_c::~anim_decoder_c ()
+    {
+      if (m_fd >= 0)
+	{
+	  ::close (m_fd);
+	}
+    }
+    // ---------------------------------------------------------------
+    // The chunks of one FORM ILBM: BMHD, CMAP and BODY for the first
+    // frame, ANHD and DLTA for the others.
+    anim_decoder_c::status_t anim_decoder_c::_frame (uint64_t offset, uint64_t size, bool first)
+    {
+      std::vector <ea::container_child_t> items;
+      uint64_t pos = offset + 12;
+      if (!ea::list_range (m_fd, pos, offset + size, items))
+	{
+	  return eCORRUPT;
+	}
+      frame_t f;
+      memset (&f, 0, sizeof (f));
+      bool has_bmhd = false;
+      bool has_data = false;
+      bool has_anhd = false;
+      std::vector <uint8_t> data;
+      for (size_t i = 0; i < items.size (); i++)
+	{
+	  const ea::container_child_t& c = items [i];
+	  switch (c.id)
+	    {
+	    case "BMHD"_id:
+	      if (!first)
+		{
+		  break;
+		}
+	      if (!read_payload (m_fd, c, data))
+		{
+		  return eIO_ERROR;
+		}
+	      has_bmhd = parse_bmhd (data.empty () ? 0 : &data [0], data.size (), m_bmhd);
+	      if (!has_bmhd)
+		{
+		  return eCORRUPT;
+		}
+	      break;
+	    case "CMAP"_id:
+	      if (!first)
+		{
+		  break;
+		}
+	      if (!read_payload (m_fd, c, data))
+		{
+		  return eIO_ERROR;
+		}
+	      m_palette.resize (data.size () / 3);
+	      for (size_t e = 0; e < m_palette.size (); e++)
+		{
+		  m_palette [e].r = data [3 * e];
+		  m_palette [e].g = data [3 * e + 1];
+		  m_palette [e].b = data [3 * e + 2];
+		}
+	      break;
+	    case "ANHD"_id:
+	      if (!read_payload (m_fd, c, data))
+		{
+		  return eIO_ERROR;
+		}
+	      has_anhd = parse_anhd (data.empty () ? 0 : &data [0], data.size (), f.anhd);
+	      break;
+	    case "BODY"_id:
+	    case "DLTA"_id:
+	      if ((c.id == "BODY"_id) != first || has_data)
+		{
+		  break;
+		}
+	      f.offset = c.offset + 8;
+	      f.size   = c.size - 8;
+	      has_data = true;
+	      break;
+	    }
+	}
+      if (first)
+	{
+	  if (!has_bmhd || !has_data)
+	    {
+	      return eNOT_IMAGE;
+	    }
+	  m_frames.push_back (f);
+	  return eOK;
+	}
+      if (has_data && has_anhd && f.anhd.operation == anhd_t::eOP_BYTE_VERTICAL &&
+	  m_bmhd.nplanes <= 8 && !m_pbm)
+	{
+	  m_frames.push_back (f);
+	}
+      else
+	{
+	  m_complete = false;
+	}
+      return eOK;
+    }
+    // ---------------------------------------------------------------
+    anim_decoder_c::status_t anim_decoder_c::open (int fd, uint64_t offset, uint64_t size)
+    {
+      if (m_fd >= 0)
+	{
+	  ::close (m_fd);
+	}
+      m_fd       = fd >= 0 ? dup (fd) : -1;
+      m_pbm      = false;
+      m_complete = true;
+      m_palette.clear ();
+      m_frames.clear ();
+      memset (&m_bmhd, 0, sizeof (m_bmhd));
+
+      std::vector <ea::container_child_t> form;
+      uint64_t pos = offset;
+      if (m_fd < 0 || !ea::list_range (m_fd, pos, offset + size, form, 1))
+	{
+	  return eIO_ERROR;
+	}
+      if (form.size () != 1 || form [0].id != "FORM"_id)
+	{
+	  return eNOT_IMAGE;
+	}
+      const ea::container_child_t& f = form [0];
+      status_t rc = eOK;
+      switch (f.tag)
+	{
+	case "ILBM"_id:
+	case "PBM "_id:
+	  m_pbm = f.tag == "PBM "_id;
+	  rc = _frame (f.offset, f.size, true);
+	  break;
+	case "ANIM"_id:
+	  {
+	    std::vector <ea::container_child_t> items;
+	    pos = f.offset + 12;
+	    if (!ea::list_range (m_fd, pos, f.offset + f.size, items))
+	      {
+		return eCORRUPT;
+	      }
+	    // a frame left out breaks the delta chain of every later
+	    // one, the frames stop there
+	    for (size_t i = 0; i < items.size () && rc == eOK && m_complete; i++)
+	      {
+		const ea::container_child_t& c = items [i];
+		if (c.id != "FORM"_id || (c.tag != "ILBM"_id && c.tag != "PBM "_id))
+		  {
+		    continue;
+		  }
+		if (m_frames.empty ())
+		  {
+		    m_pbm = c.tag == "PBM "_id;
+		  }
+		rc = _frame (c.offset, c.size, m_frames.empty ());
+	      }
+	    if (rc == eOK && m_frames.empty ())
+	      {
+		rc = eNOT_IMAGE;
+	      }
+	  }
+	  break;
+	default:
+	  return eNOT_IMAGE;
+	}
+      if (rc == eOK && (m_bmhd.compression > bmhd_t::eCMP_BYTERUN1 ||
+			(m_pbm && m_bmhd.nplanes != 8) ||
+			m_bmhd.nplanes == 0 || chunky_pixel_bytes (m_bmhd) == 2 ||
+			chunky_pixel_bytes (m_bmhd) > 4 ||
+			frame_size () == 0))
+	{
+	  rc = eUNSUPPORTED;
+	}
+      if (rc != eOK)
+	{
+	  m_frames.clear ();
+	}
+      return rc;
+    }
+    // ---------------------------------------------------------------
+    const bmhd_t& anim_decoder_c::bmhd () const
+    {
+      return m_bmhd;
+    }
+    // ---------------------------------------------------------------
+    bool anim_decoder_c::pbm () const
+    {
+      return m_pbm;
+    }
+    // ---------------------------------------------------------------
+    const std::vector <cmap_entry_t>& anim_decoder_c::palette () const
+    {
+      return m_palette;
+    }
+    // ---------------------------------------------------------------
+    size_t anim_decoder_c::frames () const
+    {
+      return m_frames.size ();
+    }
+    // ---------------------------------------------------------------
+    bool anim_decoder_c::complete () const
+    {
+      return m_complete;
+    }
+    // ---------------------------------------------------------------
+    size_t anim_decoder_c::frame_size () const
+    {
+      return body_row_bytes (m_bmhd, m_pbm) * m_bmhd.height;
+    }
+    // ---------------------------------------------------------------
+    // Interleave 0 means 2: the delta goes into the buffer shown two
+    // frames back. Both buffers start out as frame 0.
+    size_t anim_decoder_c::base (size_t k) const
+    {
+      if (k == 0 || k >= m_frames.size ())
+	{
+	  return k;
+	}
+      const size_t il = m_frames [k].anhd.interleave ? m_frames [k].anhd.interleave : 2;
+      return k >= il ? k - il : 0;
+    }
+    // ---------------------------------------------------------------
+    uint32_t anim_decoder_c::rel_time (size_t k) const
+    {
+      return k < m_frames.size () ? m_frames [k].anhd.rel_time : 0;
+    }
+    // ---------------------------------------------------------------
+    bool anim_decoder_c::decode (size_t k, const uint8_t* base_frame, uint8_t* out) const
+    {
+      if (k >= m_frames.size ())
+	{
+	  return false;
+	}
+      const frame_t& f = m_frames [k];
+      std::vector <uint8_t> data ((size_t)f.size);
+      if (!data.empty () && !read_at (m_fd, f.offset, &data [0], data.size ()))
+	{
+	  return false;
+	}
+      const uint8_t* p = data.empty () ? 0 : &data [0];
+      if (k == 0)
+	{
+	  return decode_body (m_bmhd, m_pbm, p, data.size (), out);
+	}
+      if (out != base_frame)
+	{
+	  memcpy (out, base_frame, frame_size ());
+	}
+      return anim5_decode (m_bmhd, p, data.size (), out);
+    }
+    // ---------------------------------------------------------------
+    bool anim_decoder_c::to_argb (const uint8_t* frame, uint32_t* pixels) const
+    {
+      const size_t w = m_bmhd.width;
+      const size_t h = m_bmhd.height;
+      const size_t pixel_bytes = m_pbm ? 1 : chunky_pixel_bytes (m_bmhd);
+      std::vector <uint8_t> chunky;
+      const uint8_t* src    = frame;
+      size_t         stride = body_row_bytes (m_bmhd, true);
+      if (!m_pbm)
+	{
+	  chunky.resize (w * h * pixel_bytes);
+	  if (!chunky.empty () && !frame_to_chunky (m_bmhd, frame, &chunky [0]))
+	    {
+	      return false;
+	    }
+	  src    = chunky.empty () ? 0 : &chunky [0];
+	  stride = w * pixel_bytes;
+	}
+      for (size_t y = 0; y < h; y++)
+	{
+	  const uint8_t* s = src + y * stride;
+	  uint32_t*      d = pixels + y * w;
+	  for (size_t x = 0; x < w; x++)
+	    {
+	      if (pixel_bytes >= 3)
+		{
+		  const uint8_t* c = s + x * pixel_bytes;
+		  d [x] = 0xff000000u | ((uint32_t)c [0] << 16) | ((uint32_t)c [1] << 8) | c [2];
+		}
+	      else if (s [x] < m_palette.size ())
+		{
+		  const cmap_entry_t& c = m_palette [s [x]];
+		  d [x] = 0xff000000u | ((uint32_t)c.r << 16) | ((uint32_t)c.g << 8) | c.b;
+		}
+	      else
+		{
+		  // no colour for it, a grey ramp over the planes
+		  const uint32_t g = m_bmhd.nplanes >= 8 ? s [x] :
+		    (uint32_t)s [x] * 255 / ((1u << m_bmhd.nplanes) - 1);
+		  d [x] = 0xff000000u | (g << 16) | (g << 8) | g;
+		}
+	    }
+	}
+      return true;
+    }
+    // ---------------------------------------------------------------
+    const char* anim_decoder_c::status_name (status_t s)
+    {
+      switch (s)
+	{
+	case eOK:
+	  return "ok";
+	case eIO_ERROR:
+	  return "I/O error";
+	case eNOT_IMAGE:
+	  return "not an ILBM, PBM or ANIM picture";
+	case eUNSUPPORTED:
+	  return "unsupported bitmap format";
+	case eCORRUPT:
+	  return "corrupt file";
+	}
+      return "?";
+    }
+  } // ns codec
+} // ns iff
@@ -0,0 +1,88 @@
+#ifndef __IFF_CODEC_ANIM_DECODER_HPP__
+#define __IFF_CODEC_ANIM_DECODER_HPP__
+
+#include <vector>
+#include "core/codec/anim.hpp"
+#include "core/codec/records.hpp"
+
+namespace iff
+{
+  namespace codec
+  {
+    // Random access to the frames of a FORM ILBM / PBM (one frame) or
+    // a FORM ANIM of op 5 deltas in an open file. open () reads the
+    // headers and the small chunks only; BODY and DLTA payloads are
+    // read when a frame is decoded. Frame k > 0 is its delta applied
+    // to frame base (k), two frames back for the usual double buffered
+    // ANIM, so a player holding a few recent frames never goes back to
+    // the start. Decoding reads with pread and keeps no state, any
+    // number of threads may decode at once. The decoder reads through
+    // its own duplicate of the descriptor, so decodes still running
+    // are safe from the caller closing its own.
+    class anim_decoder_c
+    {
+    public:
+      enum status_t
+	{
+	  eOK,
+	  eIO_ERROR,
+	  // not a FORM ILBM, PBM or ANIM, or no BMHD / BODY
+	  eNOT_IMAGE,
+	  // a BODY compression or bitmap decode_body cannot handle, or
+	  // 9 to 16 planes, which have neither a CMAP nor RGB to show
+	  eUNSUPPORTED,
+	  eCORRUPT
+	};
+    public:
+      anim_decoder_c ();
+      ~anim_decoder_c ();
+
+      // offset and size of the FORM's header, size header included
+      status_t open (int fd, uint64_t offset, uint64_t size);
+
+      const bmhd_t& bmhd () const;
+      bool   pbm        () const;
+      const std::vector <cmap_entry_t>& palette () const;
+      // the frames before the first one that is not an op 5 delta
+      size_t frames     () const;
+      // false if frames were left out that way
+      bool   complete   () const;
+      // bytes of a frame in the layout decode_body produces
+      size_t frame_size () const;
+      // the frame k's delta applies to, k itself for frame 0
+      size_t base       (size_t k) const;
+      // jiffies (1/60 s) frame k is shown for, 0 if not stated
+      uint32_t rel_time (size_t k) const;
+
+      // Frame k into out, frame_size () bytes; base_frame is frame
+      // base (k), ignored for frame 0, and may be out itself.
+      bool decode (size_t k, const uint8_t* base_frame, uint8_t* out) const;
+      // width * height 0xAARRGGBB pixels of a decoded frame; up to 8
+      // planes go through the CMAP, 24 and 32 bits are RGB
+      bool to_argb (const uint8_t* frame, uint32_t* pixels) const;
+
+      static const char* status_name (status_t s);
+    private:
+      anim_decoder_c (const anim_decoder_c&);
+      anim_decoder_c& operator = (const anim_decoder_c&);
+
+      struct frame_t
+      {
+	// of the BODY or DLTA payload
+	uint64_t offset;
+	uint64_t size;
+	anhd_t   anhd;
+      };
+      status_t _frame (uint64_t offset, uint64_t size, bool first);
+    private:
+      int                        m_fd;
+      bmhd_t                     m_bmhd;
+      bool                       m_pbm;
+      bool                       m_complete;
+      std::vector <cmap_entry_t> m_palette;
+      std::vector <frame_t>      m_frames;
+    };
+  } // ns codec
+} // ns iff
+
+#endif
@@ -0,0 +1,176 @@
+#include <string.h>
+#include <thread>
+#include "core/codec/anim_writer.hpp"
+#include "core/codec/parallel.hpp"
+#include "core/codec/planar.hpp"
+#include "core/trace.hpp"
+
+using namespace iff::ea::literals;
+
+// the 16 reserved bytes of an ANHD are written as zeros
+static const size_t ANHD_SIZE = 40;
+
+namespace iff
+{
+  namespace codec
+  {
+    anim_writer_c::anim_writer_c (std::ostream& os, const bmhd_t& h, unsigned threads)
+      : m_writer   (os),
+	m_bmhd     (h),
+	m_threads  (threads ? threads : std::thread::hardware_concurrency ()),
+	m_rel_time (1),
+	m_queued   (0),
+	m_frames   (0),
+	m_finished (false),
+	m_good     (h.nplanes > 0 && h.nplanes <= 8 && h.width > 0 && h.height > 0)
+    {
+      if (m_threads == 0)
+	{
+	  m_threads = 1;
+	}
+      // enough frames per batch that every thread has a couple
+      m_batch = 2 * m_threads;
+      m_bmhd.compression = bmhd_t::eCMP_BYTERUN1;
+      m_good = m_good && m_writer.begin_group ("FORM"_id, "ANIM"_id);
+    }
+    // ---------------------------------------------------------------
+    anim_writer_c::~anim_writer_c ()
+    {
+    }
+    // ---------------------------------------------------------------
+    void anim_writer_c::set_palette (const cmap_entry_t* colors, size_t count)
+    {
+      m_palette.assign (colors, colors + count);
+    }
+    // ---------------------------------------------------------------
+    void anim_writer_c::set_rel_time (uint32_t jiffies)
+    {
+      m_rel_time = jiffies;
+    }
+    // ---------------------------------------------------------------
+    size_t anim_writer_c::frame_size () const
+    {
+      return body_row_bytes (m_bmhd, false) * m_bmhd.height;
+    }
+    // ---------------------------------------------------------------
+    size_t anim_writer_c::frames () const
+    {
+      return m_frames;
+    }
+    // ---------------------------------------------------------------
+    bool anim_writer_c::good () const
+    {
+      return m_good;
+    }
+    // ---------------------------------------------------------------
+    bool anim_writer_c::add_frame (const uint8_t* frame)
+    {
+      if (!m_good || m_finished)
+	{
+	  return false;
+	}
+      m_window.push_back (std::vector <uint8_t> (frame, frame + frame_size ()));
+      if (m_frames == 0)
+	{
+	  // both buffers of the player start out as frame 0
+	  m_window.push_back (m_window.back ());
+	  m_frames++;
+	  return m_good = _write_first ();
+	}
+      m_queued++;
+      m_frames++;
+      return m_queued < m_batch || _flush ();
+    }
+    // ---------------------------------------------------------------
+    bool anim_writer_c::add_chunky (const uint8_t* pixels)
+    {
+      std::vector <uint8_t> frame (frame_size ());
+      const size_t plane_bytes = plane_row_bytes (m_bmhd);
+      const size_t row_bytes   = body_row_bytes (m_bmhd, false);
+      for (size_t y = 0; y < m_bmhd.height; y++)
+	{
+	  chunky_to_planar (pixels + y * m_bmhd.width, m_bmhd.width, m_bmhd.nplanes,
+			    &frame [y * row_bytes], plane_bytes);
+	}
+      return add_frame (&frame [0]);
+    }
+    // ---------------------------------------------------------------
+    bool anim_writer_c::finish ()
+    {
+      if (m_finished)
+	{
+	  return m_good;
+	}
+      m_finished = true;
+      if (m_good && m_queued)
+	{
+	  _flush ();
+	}
+      return m_good = m_good && m_writer.end ();
+    }
+    // ---------------------------------------------------------------
+    bool anim_writer_c::_write_first ()
+    {
+      uint8_t bmhd [BMHD_SIZE];
+      bmhd_schema_t::encode (m_bmhd, bmhd);
+      if (!m_writer.begin_group ("FORM"_id, "ILBM"_id) ||
+	  !m_writer.chunk ("BMHD"_id, bmhd, sizeof (bmhd)))
+	{
+	  return false;
+	}
+      if (!m_palette.empty ())
+	{
+	  std::vector <uint8_t> cmap (m_palette.size () * cmap_schema_t::WIRE_SIZE);
+	  for (size_t i = 0; i < m_palette.size (); i++)
+	    {
+	      cmap_schema_t::encode (m_palette [i], &cmap [i * cmap_schema_t::WIRE_SIZE]);
+	    }
+	  if (!m_writer.chunk ("CMAP"_id, &cmap [0], cmap.size ()))
+	    {
+	      return false;
+	    }
+	}
+      return write_body (m_writer, m_bmhd, false, &m_window.back () [0], m_threads) &&
+	m_writer.end ();
+    }
+    // ---------------------------------------------------------------
+    bool anim_writer_c::_flush ()
+    {
+      trace::scope_c span ("encode", "anim");
+      const size_t n = m_queued;
+      std::vector <std::vector <uint8_t> > deltas (n);
+      std::vector <char> ok (n, 0);
+      // frames first, the columns of a frame get the threads left over
+      const unsigned inner = m_threads / n > 1 ? (unsigned)(m_threads / n) : 1;
+      parallel_for (n, m_threads, [&] (size_t i)
+	{
+	  ok [i] = anim5_encode (m_bmhd, &m_window [i][0], &m_window [i + 2][0],
+				 deltas [i], inner);
+	});
+
+      const size_t first = m_frames - n;
+      for (size_t i = 0; i < n && m_good; i++)
+	{
+	  anhd_t a;
+	  memset (&a, 0, sizeof (a));
+	  a.operation = anhd_t::eOP_BYTE_VERTICAL;
+	  a.width     = m_bmhd.width;
+	  a.height    = m_bmhd.height;
+	  a.abs_time  = (uint32_t)(first + i) * m_rel_time;
+	  a.rel_time  = m_rel_time;
+	  uint8_t anhd [ANHD_SIZE];
+	  memset (anhd, 0, sizeof (anhd));
+	  anhd_schema_t::encode (a, anhd);
+	  m_good = ok [i] &&
+	    m_writer.begin_group ("FORM"_id, "ILBM"_id) &&
+	    m_writer.chunk ("ANHD"_id, anhd, sizeof (anhd)) &&
+	    m_writer.chunk ("DLTA"_id, &deltas [i][0], deltas [i].size ()) &&
+	    m_writer.end ();
+	}
+      // keep the last two frames as the references of the next batch
+      m_window.erase (m_window.begin (), m_window.end () - 2);
+      m_queued = 0;
+      return m_good;
+    }
+  } // ns codec
+} // ns iff
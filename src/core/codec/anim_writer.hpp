@@ -0,0 +1,70 @@
+#ifndef __IFF_CODEC_ANIM_WRITER_HPP__
+#define __IFF_CODEC_ANIM_WRITER_HPP__
+
+#include <iostream>
+#include <vector>
+#include "core/codec/anim.hpp"
+#include "core/codec/records.hpp"
+#include "core/ea/writer.hpp"
+
+namespace iff
+{
+  namespace codec
+  {
+    // Writes a FORM ANIM of op 5 frames:
+    //
+    //   FORM ANIM
+    //     FORM ILBM  BMHD [CMAP] BODY          frame 0
+    //     FORM ILBM  ANHD DLTA                 frame 1, against frame 0
+    //     FORM ILBM  ANHD DLTA                 frame n, against frame n - 2
+    //
+    // which is what a player double buffering the frames expects
+    // (interleave 0). Frames are given in the layout decode_body
+    // produces or as one byte per pixel, and are queued until a batch
+    // is full; the deltas of a batch are computed in parallel, every
+    // frame's reference being either in the batch or one of the two
+    // frames before it, and written in order. The stream must be
+    // seekable, see ea::writer_c.
+    class anim_writer_c
+    {
+    public:
+      // h.nplanes is at most 8, the BODY is packed with ByteRun1.
+      // threads 0 means one per core.
+      anim_writer_c (std::ostream& os, const bmhd_t& h, unsigned threads = 0);
+      ~anim_writer_c ();
+
+      // before the first frame
+      void set_palette (const cmap_entry_t* colors, size_t count);
+      // display time of every delta frame, in jiffies
+      void set_rel_time (uint32_t jiffies);
+
+      bool add_frame  (const uint8_t* frame);
+      // width * height bytes, bit p of a pixel goes to plane p
+      bool add_chunky (const uint8_t* pixels);
+      // encodes what is queued and closes the FORM ANIM
+      bool finish ();
+
+      size_t frame_size () const;
+      size_t frames     () const;
+      bool   good       () const;
+    private:
+      bool _write_first ();
+      bool _flush       ();
+    private:
+      ea::writer_c  m_writer;
+      bmhd_t        m_bmhd;
+      unsigned      m_threads;
+      size_t        m_batch;
+      uint32_t      m_rel_time;
+      std::vector <cmap_entry_t> m_palette;
+      // the two frames before the queue, then the queue
+      std::vector <std::vector <uint8_t> > m_window;
+      size_t        m_queued;
+      size_t        m_frames;
+      bool          m_finished;
+      bool          m_good;
+    };
+  } // ns codec
+} // ns iff
+
+#endif
@@ -0,0 +1,126 @@
+#include <string.h>
+
+#include "core/codec/audio.hpp"
+
+#if defined(IFF_CODEC_X86)
+#include <immintrin.h>
+#endif
+
+namespace iff
+{
+  namespace codec
+  {
+    static void swap_scalar (const uint8_t* src, uint8_t* dst, size_t count, unsigned width)
+    {
+      uint8_t tmp [8];
+      for (size_t i = 0; i < count; i++, src += width, dst += width)
+	{
+	  for (unsigned k = 0; k < width; k++)
+	    {
+	      tmp [k] = src [width - 1 - k];
+	    }
+	  memcpy (dst, tmp, width);
+	}
+    }
+#if defined(IFF_CODEC_X86)
+    // ---------------------------------------------------------------
+    // SSE2 has no byte shuffle: swap the bytes of each 16 bit word with
+    // shifts, then the words with word shuffles.
+    __attribute__ ((target ("sse2")))
+    static inline __m128i swap_words_sse2 (__m128i v)
+    {
+      return _mm_or_si128 (_mm_slli_epi16 (v, 8), _mm_srli_epi16 (v, 8));
+    }
+    // ---------------------------------------------------------------
+    __attribute__ ((target ("sse2")))
+    static void swap_sse2 (const uint8_t* src, uint8_t* dst, size_t count, unsigned width)
+    {
+      const size_t bytes = count * width;
+      size_t i = 0;
+      for (; i + 16 <= bytes; i += 16)
+	{
+	  __m128i v = swap_words_sse2 (_mm_loadu_si128 ((const __m128i*)(src + i)));
+	  if (width == 4)
+	    {
+	      v = _mm_shufflelo_epi16 (v, _MM_SHUFFLE (2, 3, 0, 1));
+	      v = _mm_shufflehi_epi16 (v, _MM_SHUFFLE (2, 3, 0, 1));
+	    }
+	  else if (width == 8)
+	    {
+	      v = _mm_shufflelo_epi16 (v, _MM_SHUFFLE (0, 1, 2, 3));
+	      v = _mm_shufflehi_epi16 (v, _MM_SHUFFLE (0, 1, 2, 3));
+	    }
+	  _mm_storeu_si128 ((__m128i*)(dst + i), v);
+	}
+      swap_scalar (src + i, dst + i, (bytes - i) / width, width);
+    }
+    // ---------------------------------------------------------------
+    __attribute__ ((target ("avx2")))
+    static void swap_avx2 (const uint8_t* src, uint8_t* dst, size_t count, unsigned width)
+    {
+      __m256i mask;
+      if (width == 2)
+	{
+	  mask = _mm256_setr_epi8 (1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14,
+				   1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14);
+	}
+      else if (width == 4)
+	{
+	  mask = _mm256_setr_epi8 (3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+				   3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+	}
+      else
+	{
+	  mask = _mm256_setr_epi8 (7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8,
+				   7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8);
+	}
+      const size_t bytes = count * width;
+      size_t i = 0;
+      for (; i + 32 <= bytes; i += 32)
+	{
+	  const __m256i v = _mm256_loadu_si256 ((const __m256i*)(src + i));
+	  _mm256_storeu_si256 ((__m256i*)(dst + i), _mm256_shuffle_epi8 (v, mask));
+	}
+      swap_scalar (src + i, dst + i, (bytes - i) / width, width);
+    }
+#endif
+    // ---------------------------------------------------------------
+    bool swap_samples (const uint8_t* src, uint8_t* dst, size_t count,
+		       unsigned sample_bytes, isa_t isa)
+    {
+      switch (sample_bytes)
+	{
+	case 1:
+	  if (src != dst)
+	    {
+	      memmove (dst, src, count);
+	    }
+	  return true;
+	case 2:
+	case 4:
+	case 8:
+	  break;
+	case 3:
+	  // 24 bit samples straddle register lanes, scalar only
+	  swap_scalar (src, dst, count, sample_bytes);
+	  return true;
+	default:
+	  return false;
+	}
+      switch (isa_resolve (isa))
+	{
+#if defined(IFF_CODEC_X86)
+	case eAVX2:
+	  swap_avx2 (src, dst, count, sample_bytes);
+	  break;
+	case eSSE2:
+	  swap_sse2 (src, dst, count, sample_bytes);
+	  break;
+#endif
+	default:
+	  swap_scalar (src, dst, count, sample_bytes);
+	}
+      return true;
+    }
+  } // ns codec
+} // ns iff
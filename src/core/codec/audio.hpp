@@ -0,0 +1,20 @@
+#ifndef __IFF_CODEC_AUDIO_HPP__
+#define __IFF_CODEC_AUDIO_HPP__
+
+#include <cstddef>
+#include "core/codec/isa.hpp"
+
+namespace iff
+{
+  namespace codec
+  {
+    // Reverses the byte order of count samples of sample_bytes each
+    // (1, 2, 3, 4 or 8), converting big endian AIFF sample data to host
+    // order and back. src and dst may be the same buffer.
+    // Returns false for an unsupported sample width.
+    bool swap_samples (const uint8_t* src, uint8_t* dst, size_t count,
+		       unsigned sample_bytes, isa_t isa = eBEST);
+  } // ns codec
+} // ns iff
+
+#endif
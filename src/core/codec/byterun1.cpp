@@ -0,0 +1,389 @@
+#include <string.h>
+
+#include "core/codec/byterun1.hpp"
+#include "core/codec/parallel.hpp"
+
+#if defined(IFF_CODEC_X86)
+#include <immintrin.h>
+#endif
+
+namespace iff
+{
+  namespace codec
+  {
+    // The vector variants copy and fill whole registers. They may write
+    // past the end of a run, which is harmless while the register fits
+    // into dst: the bytes are overwritten by the next run. Runs too
+    // close to either end of a buffer take the byte loop.
+    static size_t decode_scalar (const uint8_t* src, size_t src_size,
+				 uint8_t* dst, size_t dst_size)
+    {
+      size_t i = 0;
+      size_t o = 0;
+      while (o < dst_size)
+	{
+	  if (i >= src_size)
+	    {
+	      return 0;
+	    }
+	  const int n = (int8_t)src [i++];
+	  if (n >= 0)
+	    {
+	      size_t count = (size_t)n + 1;
+	      if (i + count > src_size)
+		{
+		  return 0;
+		}
+	      const uint8_t* s = src + i;
+	      i += count;
+	      if (count > dst_size - o)
+		{
+		  count = dst_size - o;
+		}
+	      for (size_t k = 0; k < count; k++)
+		{
+		  dst [o++] = s [k];
+		}
+	    }
+	  else if (n != -128)
+	    {
+	      if (i >= src_size)
+		{
+		  return 0;
+		}
+	      const uint8_t v = src [i++];
+	      size_t count = (size_t)(1 - n);
+	      if (count > dst_size - o)
+		{
+		  count = dst_size - o;
+		}
+	      for (size_t k = 0; k < count; k++)
+		{
+		  dst [o++] = v;
+		}
+	    }
+	}
+      return i;
+    }
+#if defined(IFF_CODEC_X86)
+    // ---------------------------------------------------------------
+    // The same loop for every register width; a macro rather than a
+    // template because each expansion has to be compiled for its own
+    // target.
+#define IFF_BYTERUN1_VECTOR_LOOP(W, VEC, LOAD, STORE, SPLAT)		\
+    size_t i = 0;							\
+    size_t o = 0;							\
+    while (o < dst_size)						\
+      {									\
+	if (i >= src_size)						\
+	  {								\
+	    return 0;							\
+	  }								\
+	const int n = (int8_t)src [i++];				\
+	if (n >= 0)							\
+	  {								\
+	    const size_t count = (size_t)n + 1;				\
+	    if (i + count > src_size)					\
+	      {								\
+		return 0;						\
+	      }								\
+	    const size_t span = (count + W - 1) & ~(size_t)(W - 1);	\
+	    if (i + span <= src_size && o + span <= dst_size)		\
+	      {								\
+		for (size_t k = 0; k < span; k += W)			\
+		  {							\
+		    STORE ((VEC*)(dst + o + k), LOAD ((const VEC*)(src + i + k))); \
+		  }							\
+		i += count;						\
+		o += count;						\
+		continue;						\
+	      }								\
+	    const size_t tail = count < dst_size - o ? count : dst_size - o; \
+	    memcpy (dst + o, src + i, tail);				\
+	    i += count;							\
+	    o += tail;							\
+	  }								\
+	else if (n != -128)						\
+	  {								\
+	    if (i >= src_size)						\
+	      {								\
+		return 0;						\
+	      }								\
+	    const uint8_t v = src [i++];				\
+	    const size_t count = (size_t)(1 - n);			\
+	    const size_t span = (count + W - 1) & ~(size_t)(W - 1);	\
+	    if (o + span <= dst_size)					\
+	      {								\
+		const VEC r = SPLAT ((char)v);				\
+		for (size_t k = 0; k < span; k += W)			\
+		  {							\
+		    STORE ((VEC*)(dst + o + k), r);			\
+		  }							\
+		o += count;						\
+		continue;						\
+	      }								\
+	    const size_t tail = count < dst_size - o ? count : dst_size - o; \
+	    memset (dst + o, v, tail);					\
+	    o += tail;							\
+	  }								\
+      }									\
+    return i
+
+    __attribute__ ((target ("sse2")))
+    static size_t decode_sse2 (const uint8_t* src, size_t src_size,
+			       uint8_t* dst, size_t dst_size)
+    {
+      IFF_BYTERUN1_VECTOR_LOOP (16, __m128i, _mm_loadu_si128, _mm_storeu_si128, _mm_set1_epi8);
+    }
+    // ---------------------------------------------------------------
+    __attribute__ ((target ("avx2")))
+    static size_t decode_avx2 (const uint8_t* src, size_t src_size,
+			       uint8_t* dst, size_t dst_size)
+    {
+      IFF_BYTERUN1_VECTOR_LOOP (32, __m256i, _mm256_loadu_si256, _mm256_storeu_si256, _mm256_set1_epi8);
+    }
+
+#undef IFF_BYTERUN1_VECTOR_LOOP
+#endif
+    // ---------------------------------------------------------------
+    size_t byterun1_decode (const uint8_t* src, size_t src_size,
+			    uint8_t* dst, size_t dst_size, isa_t isa)
+    {
+      switch (isa_resolve (isa))
+	{
+#if defined(IFF_CODEC_X86)
+	case eAVX2:
+	  return decode_avx2 (src, src_size, dst, dst_size);
+	case eSSE2:
+	  return decode_sse2 (src, src_size, dst, dst_size);
+#endif
+	default:
+	  return decode_scalar (src, src_size, dst, dst_size);
+	}
+    }
+    // ---------------------------------------------------------------
+    // Encoder
+    // ---------------------------------------------------------------
+    static const size_t MAX_SPAN = 128;
+
+    size_t byterun1_bound (size_t size)
+    {
+      return size + (size + MAX_SPAN - 1) / MAX_SPAN;
+    }
+    // ---------------------------------------------------------------
+    // Bit i of same is set if src [i] == src [i - 1]. The vector
+    // variants cover what whole registers reach and leave the rest.
+    static void put_bits (uint64_t* same, size_t i, uint64_t m, unsigned n)
+    {
+      const unsigned shift = (unsigned)(i & 63);
+      same [i >> 6] |= m << shift;
+      if (shift + n > 64)
+	{
+	  same [(i >> 6) + 1] |= m >> (64 - shift);
+	}
+    }
+    // ---------------------------------------------------------------
+    static void same_scalar (const uint8_t* src, size_t size, uint64_t* same, size_t i)
+    {
+      for (; i < size; i++)
+	{
+	  if (src [i] == src [i - 1])
+	    {
+	      same [i >> 6] |= (uint64_t)1 << (i & 63);
+	    }
+	}
+    }
+#if defined(IFF_CODEC_X86)
+    // ---------------------------------------------------------------
+    __attribute__ ((target ("sse2")))
+    static void same_sse2 (const uint8_t* src, size_t size, uint64_t* same)
+    {
+      size_t i = 1;
+      for (; i + 16 <= size; i += 16)
+	{
+	  const __m128i a = _mm_loadu_si128 ((const __m128i*)(src + i));
+	  const __m128i b = _mm_loadu_si128 ((const __m128i*)(src + i - 1));
+	  put_bits (same, i, (uint32_t)_mm_movemask_epi8 (_mm_cmpeq_epi8 (a, b)), 16);
+	}
+      same_scalar (src, size, same, i);
+    }
+    // ---------------------------------------------------------------
+    __attribute__ ((target ("avx2")))
+    static void same_avx2 (const uint8_t* src, size_t size, uint64_t* same)
+    {
+      size_t i = 1;
+      for (; i + 32 <= size; i += 32)
+	{
+	  const __m256i a = _mm256_loadu_si256 ((const __m256i*)(src + i));
+	  const __m256i b = _mm256_loadu_si256 ((const __m256i*)(src + i - 1));
+	  put_bits (same, i, (uint32_t)_mm256_movemask_epi8 (_mm256_cmpeq_epi8 (a, b)), 32);
+	}
+      same_scalar (src, size, same, i);
+    }
+#endif
+    // ---------------------------------------------------------------
+    byterun1_packer_c::byterun1_packer_c (isa_t isa)
+      : m_isa (isa_resolve (isa))
+    {
+    }
+    // ---------------------------------------------------------------
+    // cost [i] is the fewest bytes that pack the first i bytes and
+    // step [i] the last op of such a packing: n > 0 literals or -n
+    // repeats. With c (j) = cost [j]
+    //
+    //   literal  cost [i] = min c (j) - j + i + 1,  i - 128 <= j < i
+    //   repeat   cost [i] = min c (j) + 2,          i - 128 <= j <= i - 2,
+    //                                               src [j..i) one run
+    //
+    // Both minima are over windows sliding with i, kept in monotonic
+    // queues (m_literal, m_repeat) of candidate positions, so every
+    // position is pushed and popped at most once per queue.
+    size_t byterun1_packer_c::pack (const uint8_t* src, size_t size, std::vector <uint8_t>& out)
+    {
+      if (size == 0)
+	{
+	  return 0;
+	}
+      m_same.assign ((size + 63) / 64 + 1, 0);
+      switch (m_isa)
+	{
+#if defined(IFF_CODEC_X86)
+	case eAVX2:
+	  same_avx2 (src, size, &m_same [0]);
+	  break;
+	case eSSE2:
+	  same_sse2 (src, size, &m_same [0]);
+	  break;
+#endif
+	default:
+	  same_scalar (src, size, &m_same [0], 1);
+	}
+
+      m_cost.resize (size + 1);
+      m_step.resize (size + 1);
+      m_literal.resize (size + 1);
+      m_repeat.resize (size + 1);
+      uint32_t* cost = &m_cost [0];
+      uint32_t* lq   = &m_literal [0];
+      uint32_t* rq   = &m_repeat [0];
+      size_t lh = 0, lt = 0;
+      size_t rh = 0, rt = 0;
+      cost [0] = 0;
+      for (size_t i = 1; i <= size; i++)
+	{
+	  const size_t j = i - 1;
+	  // literal candidates: j, keyed by cost [j] - j
+	  while (lt > lh && (int64_t)cost [lq [lt - 1]] - lq [lt - 1] >= (int64_t)cost [j] - (int64_t)j)
+	    {
+	      lt--;
+	    }
+	  lq [lt++] = (uint32_t)j;
+	  if (lq [lh] + MAX_SPAN < i)
+	    {
+	      lh++;
+	    }
+	  // repeat candidates: positions of the run holding src [i - 1]
+	  // that leave at least two of its bytes
+	  if (!((m_same [j >> 6] >> (j & 63)) & 1))
+	    {
+	      rh = rt = 0;
+	    }
+	  else
+	    {
+	      const size_t k = i - 2;
+	      while (rt > rh && cost [rq [rt - 1]] >= cost [k])
+		{
+		  rt--;
+		}
+	      rq [rt++] = (uint32_t)k;
+	      if (rq [rh] + MAX_SPAN < i)
+		{
+		  rh++;
+		}
+	    }
+
+	  const size_t l = lq [lh];
+	  cost [i]     = cost [l] + (uint32_t)(i - l) + 1;
+	  m_step [i]   = (int16_t)(i - l);
+	  if (rt > rh && cost [rq [rh]] + 2 <= cost [i])
+	    {
+	      cost [i]   = cost [rq [rh]] + 2;
+	      m_step [i] = (int16_t)-(int)(i - rq [rh]);
+	    }
+	}
+
+      // walk the ops back from the end, then write them forwards
+      m_ops.clear ();
+      for (size_t i = size; i > 0; )
+	{
+	  const int step = m_step [i];
+	  m_ops.push_back ((int16_t)step);
+	  i -= step > 0 ? step : -step;
+	}
+      const size_t start = out.size ();
+      out.resize (start + cost [size]);
+      uint8_t* o = &out [start];
+      size_t   i = 0;
+      for (size_t k = m_ops.size (); k-- > 0; )
+	{
+	  const int step = m_ops [k];
+	  if (step > 0)
+	    {
+	      *o++ = (uint8_t)(step - 1);
+	      memcpy (o, src + i, step);
+	      o += step;
+	      i += step;
+	    }
+	  else
+	    {
+	      *o++ = (uint8_t)(1 + step);
+	      *o++ = src [i];
+	      i -= step;
+	    }
+	}
+      return cost [size];
+    }
+    // ---------------------------------------------------------------
+    void byterun1_encode_rows (const uint8_t* src, size_t row_bytes, size_t rows,
+			       std::vector <uint8_t>& out, unsigned threads, isa_t isa)
+    {
+      thread_pool_c pool (threads);
+      byterun1_encode_rows (src, row_bytes, rows, out, pool, isa);
+    }
+    // ---------------------------------------------------------------
+    void byterun1_encode_rows (const uint8_t* src, size_t row_bytes, size_t rows,
+			       std::vector <uint8_t>& out, thread_pool_c& pool, isa_t isa)
+    {
+      // about 64K of input per item, whole rows
+      size_t block = row_bytes ? (64 * 1024) / row_bytes : rows;
+      if (block == 0)
+	{
+	  block = 1;
+	}
+      const size_t blocks = rows ? (rows + block - 1) / block : 0;
+      if (blocks <= 1 || pool.size () == 1)
+	{
+	  byterun1_packer_c packer (isa);
+	  for (size_t r = 0; r < rows; r++)
+	    {
+	      packer.pack (src + r * row_bytes, row_bytes, out);
+	    }
+	  return;
+	}
+      std::vector <std::vector <uint8_t> > parts (blocks);
+      pool.run (blocks, [&] (size_t b)
+	{
+	  byterun1_packer_c packer (isa);
+	  const size_t end = (b + 1) * block < rows ? (b + 1) * block : rows;
+	  for (size_t r = b * block; r < end; r++)
+	    {
+	      packer.pack (src + r * row_bytes, row_bytes, parts [b]);
+	    }
+	});
+      for (size_t b = 0; b < blocks; b++)
+	{
+	  out.insert (out.end (), parts [b].begin (), parts [b].end ());
+	}
+    }
+  } // ns codec
+} // ns iff
@@ -0,0 +1,62 @@
+#ifndef __IFF_CODEC_BYTERUN1_HPP__
+#define __IFF_CODEC_BYTERUN1_HPP__
+
+#include <cstddef>
+#include <vector>
+#include "core/codec/isa.hpp"
+
+namespace iff
+{
+  namespace codec
+  {
+    class thread_pool_c;
+
+    // ByteRun1 (PackBits) as used by ILBM and PBM bodies.
+    // Decodes until dst_size bytes are produced and returns the number
+    // of source bytes consumed, or 0 if the source ends first.
+    // A run that overshoots dst is clipped: some encoders pack across
+    // the end of the last row.
+    size_t byterun1_decode (const uint8_t* src, size_t src_size,
+			    uint8_t* dst, size_t dst_size, isa_t isa = eBEST);
+
+    // worst case packed size of size bytes
+    size_t byterun1_bound (size_t size);
+
+    // Packs rows with the fewest bytes ByteRun1 allows. The vector
+    // variants compare every byte with its predecessor a register at
+    // a time to find the runs; the packing itself is a shortest path
+    // over the row, O(n) with two sliding window minima (literals of
+    // up to 128 bytes, repeats of up to 128 bytes inside a run). The
+    // output is the same for every isa. The scratch buffers are kept
+    // between rows, so one packer per thread.
+    class byterun1_packer_c
+    {
+    public:
+      explicit byterun1_packer_c (isa_t isa = eBEST);
+
+      // appends the packed row to out, returns the bytes appended
+      size_t pack (const uint8_t* src, size_t size, std::vector <uint8_t>& out);
+    private:
+      isa_t                   m_isa;
+      std::vector <uint64_t>  m_same;
+      std::vector <uint32_t>  m_cost;
+      std::vector <int16_t>   m_step;
+      std::vector <uint32_t>  m_literal;
+      std::vector <uint32_t>  m_repeat;
+      std::vector <int16_t>   m_ops;
+    };
+
+    // Packs rows rows of row_bytes each, every row on its own as
+    // ILBM and PBM require. Blocks of rows go to up to threads threads
+    // (0 = one per core) and are appended to out in order.
+    void byterun1_encode_rows (const uint8_t* src, size_t row_bytes, size_t rows,
+			       std::vector <uint8_t>& out, unsigned threads = 1,
+			       isa_t isa = eBEST);
+    // the same on the threads of pool
+    void byterun1_encode_rows (const uint8_t* src, size_t row_bytes, size_t rows,
+			       std::vector <uint8_t>& out, thread_pool_c& pool,
+			       isa_t isa = eBEST);
+  } // ns codec
+} // ns iff
+
+#endif
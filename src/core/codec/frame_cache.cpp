@@ -0,0 +1,106 @@
+#include "core/codec/frame_cache.hpp"
+
+namespace iff
+{
+  namespace codec
+  {
+    frame_cache_c::frame_cache_c (size_t budget)
+      : m_budget    (budget),
+	m_bytes     (0),
+	m_hits      (0),
+	m_misses    (0),
+	m_evictions (0)
+    {
+    }
+    // ---------------------------------------------------------------
+    frame_ptr_t frame_cache_c::get (size_t k)
+    {
+      std::lock_guard <std::mutex> lock (m_mutex);
+      std::map <size_t, lru_t::iterator>::iterator i = m_index.find (k);
+      if (i == m_index.end ())
+	{
+	  m_misses++;
+	  return frame_ptr_t ();
+	}
+      m_hits++;
+      m_lru.splice (m_lru.begin (), m_lru, i->second);
+      return i->second->second;
+    }
+    // ---------------------------------------------------------------
+    bool frame_cache_c::contains (size_t k) const
+    {
+      std::lock_guard <std::mutex> lock (m_mutex);
+      return m_index.find (k) != m_index.end ();
+    }
+    // ---------------------------------------------------------------
+    void frame_cache_c::put (size_t k, const frame_ptr_t& frame)
+    {
+      if (!frame)
+	{
+	  return;
+	}
+      std::lock_guard <std::mutex> lock (m_mutex);
+      std::map <size_t, lru_t::iterator>::iterator i = m_index.find (k);
+      if (i != m_index.end ())
+	{
+	  m_bytes -= i->second->second->size ();
+	  m_lru.erase (i->second);
+	  m_index.erase (i);
+	}
+      m_lru.push_front (entry_t (k, frame));
+      m_index [k] = m_lru.begin ();
+      m_bytes += frame->size ();
+      while (m_bytes > m_budget && m_lru.size () > 1)
+	{
+	  const entry_t& last = m_lru.back ();
+	  m_bytes -= last.second->size ();
+	  m_index.erase (last.first);
+	  m_lru.pop_back ();
+	  m_evictions++;
+	}
+    }
+    // ---------------------------------------------------------------
+    void frame_cache_c::clear ()
+    {
+      std::lock_guard <std::mutex> lock (m_mutex);
+      m_lru.clear ();
+      m_index.clear ();
+      m_bytes = 0;
+    }
+    // ---------------------------------------------------------------
+    size_t frame_cache_c::budget () const
+    {
+      return m_budget;
+    }
+    // ---------------------------------------------------------------
+    size_t frame_cache_c::bytes () const
+    {
+      std::lock_guard <std::mutex> lock (m_mutex);
+      return m_bytes;
+    }
+    // ---------------------------------------------------------------
+    size_t frame_cache_c::count () const
+    {
+      std::lock_guard <std::mutex> lock (m_mutex);
+      return m_lru.size ();
+    }
+    // ---------------------------------------------------------------
+    uint64_t frame_cache_c::hits () const
+    {
+      std::lock_guard <std::mutex> lock (m_mutex);
+      return m_hits;
+    }
+    // ---------------------------------------------------------------
+    uint64_t frame_cache_c::misses () const
+    {
+      std::lock_guard <std::mutex> lock (m_mutex);
+      return m_misses;
+    }
+    // ---------------------------------------------------------------
+    uint64_t frame_cache_c::evictions () const
+    {
+      std::lock_guard <std::mutex> lock (m_mutex);
+      return m_evictions;
+    }
+  } // ns codec
+} // ns iff
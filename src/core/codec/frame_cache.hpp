@@ -0,0 +1,60 @@
+#ifndef __IFF_CODEC_FRAME_CACHE_HPP__
+#define __IFF_CODEC_FRAME_CACHE_HPP__
+
+#include <cstddef>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "core/iff_types.hpp"
+
+namespace iff
+{
+  namespace codec
+  {
+    typedef std::shared_ptr <const std::vector <uint8_t> > frame_ptr_t;
+
+    // Decoded frames by number, least recently used ones dropped once
+    // they take more than budget bytes. The frame put last is kept
+    // even if it alone is over budget. A frame handed out stays valid
+    // for its holder after it is dropped. All members lock.
+    class frame_cache_c
+    {
+    public:
+      explicit frame_cache_c (size_t budget);
+
+      // null if not cached; a hit makes the frame the most recent
+      frame_ptr_t get      (size_t k);
+      bool        contains (size_t k) const;
+      void        put      (size_t k, const frame_ptr_t& frame);
+      void        clear    ();
+
+      size_t   budget    () const;
+      size_t   bytes     () const;
+      size_t   count     () const;
+      uint64_t hits      () const;
+      uint64_t misses    () const;
+      uint64_t evictions () const;
+    private:
+      frame_cache_c (const frame_cache_c&);
+      frame_cache_c& operator = (const frame_cache_c&);
+    private:
+      typedef std::pair <size_t, frame_ptr_t> entry_t;
+      typedef std::list <entry_t>             lru_t;
+
+      mutable std::mutex                  m_mutex;
+      const size_t                        m_budget;
+      size_t                              m_bytes;
+      // most recent first
+      lru_t                               m_lru;
+      std::map <size_t, lru_t::iterator>  m_index;
+      uint64_t                            m_hits;
+      uint64_t                            m_misses;
+      uint64_t                            m_evictions;
+    };
+  } // ns codec
+} // ns iff
+
+#endif
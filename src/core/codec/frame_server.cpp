@@ -0,0 +1,272 @@
+#include <algorithm>
+
+#include "core/codec/frame_server.hpp"
+
+namespace iff
+{
+  namespace codec
+  {
+    frame_server_c::session_t::session_t (size_t cache_bytes)
+      : generation (0),
+	cache      (cache_bytes)
+    {
+    }
+    // ---------------------------------------------------------------
+    frame_server_c::frame_server_c (unsigned threads, size_t cache_bytes)
+      : m_stop        (false),
+	m_cache_bytes (cache_bytes),
+	m_generation  (0),
+	m_want        (0),
+	m_decoded     (0),
+	m_cancelled   (0)
+    {
+      if (threads == 0)
+	{
+	  threads = std::max (1u, std::thread::hardware_concurrency ());
+	}
+      for (unsigned t = 0; t < threads; t++)
+	{
+	  m_workers.push_back (std::thread (&frame_server_c::_work, this));
+	}
+    }
+    // ---------------------------------------------------------------
+    frame_server_c::~frame_server_c ()
+    {
+      {
+	std::lock_guard <std::mutex> lock (m_mutex);
+	m_stop = true;
+	m_generation++;
+	m_queue.clear ();
+      }
+      m_wake.notify_all ();
+      m_done.notify_all ();
+      for (size_t t = 0; t < m_workers.size (); t++)
+	{
+	  m_workers [t].join ();
+	}
+    }
+    // ---------------------------------------------------------------
+    void frame_server_c::set_ready (const ready_t& ready)
+    {
+      std::lock_guard <std::mutex> lock (m_mutex);
+      m_ready = ready;
+    }
+    // ---------------------------------------------------------------
+    anim_decoder_c::status_t frame_server_c::open (int fd, uint64_t offset, uint64_t size)
+    {
+      session_ptr_t s (new session_t (m_cache_bytes));
+      const anim_decoder_c::status_t rc = s->decoder.open (fd, offset, size);
+      std::lock_guard <std::mutex> lock (m_mutex);
+      m_generation++;
+      m_queue.clear ();
+      m_session.reset ();
+      m_wanted.reset ();
+      if (rc == anim_decoder_c::eOK)
+	{
+	  s->generation = m_generation;
+	  m_session     = s;
+	}
+      m_done.notify_all ();
+      return rc;
+    }
+    // ---------------------------------------------------------------
+    void frame_server_c::close ()
+    {
+      std::lock_guard <std::mutex> lock (m_mutex);
+      m_generation++;
+      m_queue.clear ();
+      m_session.reset ();
+      m_wanted.reset ();
+      m_done.notify_all ();
+    }
+    // ---------------------------------------------------------------
+    // The session stays, its decodes start over with a new generation.
+    void frame_server_c::cancel ()
+    {
+      std::lock_guard <std::mutex> lock (m_mutex);
+      m_generation++;
+      m_queue.clear ();
+      if (m_session)
+	{
+	  m_session->generation = m_generation;
+	}
+      m_done.notify_all ();
+    }
+    // ---------------------------------------------------------------
+    std::shared_ptr <const anim_decoder_c> frame_server_c::decoder () const
+    {
+      std::lock_guard <std::mutex> lock (m_mutex);
+      if (!m_session)
+	{
+	  return std::shared_ptr <const anim_decoder_c> ();
+	}
+      return std::shared_ptr <const anim_decoder_c> (m_session, &m_session->decoder);
+    }
+    // ---------------------------------------------------------------
+    void frame_server_c::request (size_t k, size_t ahead)
+    {
+      std::lock_guard <std::mutex> lock (m_mutex);
+      m_queue.clear ();
+      if (!m_session)
+	{
+	  return;
+	}
+      if (k != m_want)
+	{
+	  m_want = k;
+	  m_wanted = m_session->cache.get (k);
+	}
+      const size_t n = m_session->decoder.frames ();
+      ahead = std::min (ahead, n ? n - 1 : 0);
+      for (size_t i = 0; i <= ahead && k < n; i++)
+	{
+	  const size_t f = (k + i) % n;
+	  if (!(f == m_want && m_wanted) && !m_session->cache.contains (f))
+	    {
+	      m_queue.push_back (f);
+	    }
+	}
+      m_wake.notify_all ();
+    }
+    // ---------------------------------------------------------------
+    frame_ptr_t frame_server_c::frame (size_t k)
+    {
+      session_ptr_t s;
+      {
+	std::lock_guard <std::mutex> lock (m_mutex);
+	if (m_wanted && k == m_want)
+	  {
+	    return m_wanted;
+	  }
+	s = m_session;
+      }
+      return s ? s->cache.get (k) : frame_ptr_t ();
+    }
+    // ---------------------------------------------------------------
+    uint64_t frame_server_c::decoded () const
+    {
+      std::lock_guard <std::mutex> lock (m_mutex);
+      return m_decoded;
+    }
+    // ---------------------------------------------------------------
+    uint64_t frame_server_c::cancelled () const
+    {
+      std::lock_guard <std::mutex> lock (m_mutex);
+      return m_cancelled;
+    }
+    // ---------------------------------------------------------------
+    // with m_mutex held
+    bool frame_server_c::_current (uint64_t generation) const
+    {
+      return !m_stop && generation == m_generation;
+    }
+    // ---------------------------------------------------------------
+    void frame_server_c::_work ()
+    {
+      std::unique_lock <std::mutex> lock (m_mutex);
+      while (true)
+	{
+	  while (!m_stop && m_queue.empty ())
+	    {
+	      m_wake.wait (lock);
+	    }
+	  if (m_stop)
+	    {
+	      return;
+	    }
+	  const size_t  k = m_queue.front ();
+	  m_queue.pop_front ();
+	  session_ptr_t s = m_session;
+	  if (!s)
+	    {
+	      continue;
+	    }
+	  lock.unlock ();
+	  _decode (s, k);
+	  lock.lock ();
+	}
+    }
+    // ---------------------------------------------------------------
+    // Down the delta chain to a cached frame or frame 0, then back up
+    // decoding, checking for cancellation before every step.
+    void frame_server_c::_decode (const session_ptr_t& s, size_t k)
+    {
+      const anim_decoder_c& d = s->decoder;
+      uint64_t generation;
+      {
+	std::lock_guard <std::mutex> lock (m_mutex);
+	generation = s->generation;
+      }
+      std::vector <size_t> chain;
+      frame_ptr_t base;
+      for (size_t j = k; ; j = d.base (j))
+	{
+	  base = s->cache.get (j);
+	  if (base)
+	    {
+	      break;
+	    }
+	  chain.push_back (j);
+	  if (j == 0)
+	    {
+	      break;
+	    }
+	}
+      while (!chain.empty ())
+	{
+	  const size_t f = chain.back ();
+	  chain.pop_back ();
+	  const std::pair <uint64_t, size_t> key (generation, f);
+	  {
+	    std::unique_lock <std::mutex> lock (m_mutex);
+	    while (_current (generation) && m_busy.count (key))
+	      {
+		m_done.wait (lock);
+	      }
+	    if (!_current (generation))
+	      {
+		m_cancelled++;
+		return;
+	      }
+	    frame_ptr_t done = s->cache.get (f);
+	    if (done)
+	      {
+		base = done;
+		continue;
+	      }
+	    m_busy.insert (key);
+	  }
+	  std::shared_ptr <std::vector <uint8_t> > out (new std::vector <uint8_t> (d.frame_size ()));
+	  const bool ok = d.decode (f, base ? &(*base) [0] : 0, &(*out) [0]);
+	  ready_t ready;
+	  {
+	    std::lock_guard <std::mutex> lock (m_mutex);
+	    m_busy.erase (key);
+	    if (ok)
+	      {
+		s->cache.put (f, out);
+		m_decoded++;
+		if (_current (generation))
+		  {
+		    ready = m_ready;
+		    if (f == m_want)
+		      {
+			m_wanted = out;
+		      }
+		  }
+	      }
+	  }
+	  m_done.notify_all ();
+	  if (!ok)
+	    {
+	      return;
+	    }
+	  if (ready)
+	    {
+	      ready (f);
+	    }
+	  base = out;
+	}
+    }
+  } // ns codec
+} // ns iff
@@ -0,0 +1,105 @@
+#ifndef __IFF_CODEC_FRAME_SERVER_HPP__
+#define __IFF_CODEC_FRAME_SERVER_HPP__
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "core/codec/anim_decoder.hpp"
+#include "core/codec/frame_cache.hpp"
+
+namespace iff
+{
+  namespace codec
+  {
+    // Decodes the frames of an ILBM or ANIM on worker threads for a
+    // viewer that scrubs or plays it. A request names the frame wanted
+    // now and how many after it to prefetch; it replaces the requests
+    // not yet started. Decoded frames go to a frame_cache_c, and a
+    // frame is decoded from the nearest cached frame down its delta
+    // chain (see anim_decoder_c::base ()), every step cached on the
+    // way. A frame some worker is already decoding is waited for
+    // rather than decoded twice. The frame last requested is held
+    // apart from the cache, so its own prefetches cannot push it out.
+    //
+    // open () and cancel () drop the pending requests and make the
+    // decodes in flight stop before their next delta; those keep the
+    // old file's decoder and cache alive until they stop, so neither
+    // call waits for them.
+    class frame_server_c
+    {
+    public:
+      // called on a worker thread for every frame decoded
+      typedef std::function <void (size_t frame)> ready_t;
+    public:
+      // threads 0 means one per core
+      explicit frame_server_c (unsigned threads = 0, size_t cache_bytes = 64 * 1024 * 1024);
+      // cancels and joins the workers
+      ~frame_server_c ();
+
+      // before open ()
+      void set_ready (const ready_t& ready);
+
+      anim_decoder_c::status_t open (int fd, uint64_t offset, uint64_t size);
+      void close  ();
+      void cancel ();
+
+      // the decoder of the open file, null if none
+      std::shared_ptr <const anim_decoder_c> decoder () const;
+
+      // frame k and the ahead frames after it, wrapping around
+      void        request (size_t k, size_t ahead);
+      // frame k if it is the one requested last or cached and decoded,
+      // null otherwise
+      frame_ptr_t frame   (size_t k);
+
+      // frames decoded, decodes given up on by cancel () or open ()
+      uint64_t decoded   () const;
+      uint64_t cancelled () const;
+    private:
+      frame_server_c (const frame_server_c&);
+      frame_server_c& operator = (const frame_server_c&);
+
+      // what an open () serves
+      struct session_t
+      {
+	session_t (size_t cache_bytes);
+
+	uint64_t       generation;
+	anim_decoder_c decoder;
+	frame_cache_c  cache;
+      };
+      typedef std::shared_ptr <session_t> session_ptr_t;
+
+      void _work ();
+      void _decode (const session_ptr_t& s, size_t k);
+      bool _current (uint64_t generation) const;
+    private:
+      mutable std::mutex        m_mutex;
+      std::condition_variable   m_wake;
+      // a frame left m_busy
+      std::condition_variable   m_done;
+      std::vector <std::thread> m_workers;
+      bool                      m_stop;
+      size_t                    m_cache_bytes;
+      ready_t                   m_ready;
+      uint64_t                  m_generation;
+      session_ptr_t             m_session;
+      std::deque <size_t>       m_queue;
+      // the frame requested last, once decoded
+      size_t                    m_want;
+      frame_ptr_t               m_wanted;
+      // frames being decoded, by generation
+      std::set <std::pair <uint64_t, size_t> > m_busy;
+      uint64_t                  m_decoded;
+      uint64_t                  m_cancelled;
+    };
+  } // ns codec
+} // ns iff
+
+#endif
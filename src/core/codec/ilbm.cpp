@@ -0,0 +1,173 @@
+#include <string.h>
+#include <vector>
+
+#include "core/codec/ilbm.hpp"
+#include "core/codec/records.hpp"
+#include "core/codec/byterun1.hpp"
+#include "core/codec/planar.hpp"
+#include "core/codec/parallel.hpp"
+#include "core/ea/writer.hpp"
+#include "core/trace.hpp"
+
+using namespace iff::ea::literals;
+
+namespace iff
+{
+  namespace codec
+  {
+    bool parse_bmhd (const uint8_t* data, size_t size, bmhd_t& h)
+    {
+      return bmhd_schema_t::decode (data, size, h);
+    }
+    // ---------------------------------------------------------------
+    size_t plane_row_bytes (const bmhd_t& h)
+    {
+      return (((size_t)h.width + 15) >> 4) << 1;
+    }
+    // ---------------------------------------------------------------
+    size_t body_row_bytes (const bmhd_t& h, bool pbm)
+    {
+      if (pbm)
+	{
+	  return ((size_t)h.width + 1) & ~(size_t)1;
+	}
+      const size_t planes = h.nplanes + (h.masking == bmhd_t::eMASK_HAS_MASK ? 1 : 0);
+      return plane_row_bytes (h) * planes;
+    }
+    // ---------------------------------------------------------------
+    size_t chunky_pixel_bytes (const bmhd_t& h)
+    {
+      return h.nplanes <= 8 ? 1 : ((size_t)h.nplanes + 7) >> 3;
+    }
+    // ---------------------------------------------------------------
+    bool decode_body (const bmhd_t& h, bool pbm, const uint8_t* body, size_t size,
+		      uint8_t* frame, isa_t isa)
+    {
+      trace::scope_c span ("decode", "body");
+      const size_t frame_size = body_row_bytes (h, pbm) * h.height;
+      switch (h.compression)
+	{
+	case bmhd_t::eCMP_NONE:
+	  if (size < frame_size)
+	    {
+	      return false;
+	    }
+	  memcpy (frame, body, frame_size);
+	  return true;
+	case bmhd_t::eCMP_BYTERUN1:
+	  return frame_size == 0 || byterun1_decode (body, size, frame, frame_size, isa) != 0;
+	default:
+	  return false;
+	}
+    }
+    // ---------------------------------------------------------------
+    bool frame_to_chunky (const bmhd_t& h, const uint8_t* frame, uint8_t* chunky, isa_t isa)
+    {
+      trace::scope_c span ("decode", "chunky");
+      const size_t plane_bytes = plane_row_bytes (h);
+      const size_t row_bytes   = body_row_bytes (h, false);
+      const size_t pixel_bytes = chunky_pixel_bytes (h);
+      if (h.nplanes == 0 || pixel_bytes > 4)
+	{
+	  return false;
+	}
+      if (pixel_bytes == 1)
+	{
+	  for (size_t y = 0; y < h.height; y++)
+	    {
+	      planar_to_chunky (frame + y * row_bytes, plane_bytes, h.nplanes,
+				chunky + y * h.width, h.width, isa);
+	    }
+	  return true;
+	}
+      // deep images: 8 planes per component, interleaved afterwards
+      std::vector <uint8_t> component (h.width);
+      for (size_t y = 0; y < h.height; y++)
+	{
+	  const uint8_t* row = frame + y * row_bytes;
+	  uint8_t*       out = chunky + y * h.width * pixel_bytes;
+	  for (size_t c = 0; c < pixel_bytes; c++)
+	    {
+	      const unsigned first = (unsigned)c * 8;
+	      const unsigned n = h.nplanes - first < 8 ? h.nplanes - first : 8;
+	      planar_to_chunky (row + first * plane_bytes, plane_bytes, n,
+				component.empty () ? 0 : &component [0], h.width, isa);
+	      for (size_t x = 0; x < h.width; x++)
+		{
+		  out [x * pixel_bytes + c] = component [x];
+		}
+	    }
+	}
+      return true;
+    }
+    // ---------------------------------------------------------------
+    // the unit ByteRun1 restarts at
+    static size_t packed_row_bytes (const bmhd_t& h, bool pbm)
+    {
+      return pbm ? body_row_bytes (h, true) : plane_row_bytes (h);
+    }
+    // ---------------------------------------------------------------
+    static bool encode_band (const bmhd_t& h, bool pbm, const uint8_t* frame,
+			     std::vector <uint8_t>& body, thread_pool_c& pool, isa_t isa)
+    {
+      trace::scope_c span ("encode", "body");
+      const size_t frame_size = body_row_bytes (h, pbm) * h.height;
+      switch (h.compression)
+	{
+	case bmhd_t::eCMP_NONE:
+	  body.insert (body.end (), frame, frame + frame_size);
+	  return true;
+	case bmhd_t::eCMP_BYTERUN1:
+	  {
+	    const size_t row = packed_row_bytes (h, pbm);
+	    byterun1_encode_rows (frame, row, row ? frame_size / row : 0, body, pool, isa);
+	    return true;
+	  }
+	default:
+	  return false;
+	}
+    }
+    // ---------------------------------------------------------------
+    bool encode_body (const bmhd_t& h, bool pbm, const uint8_t* frame,
+		      std::vector <uint8_t>& body, unsigned threads, isa_t isa)
+    {
+      thread_pool_c pool (threads);
+      return encode_band (h, pbm, frame, body, pool, isa);
+    }
+    // ---------------------------------------------------------------
+    bool write_body (ea::writer_c& w, const bmhd_t& h, bool pbm, const uint8_t* frame,
+		     unsigned threads, isa_t isa)
+    {
+      if (h.compression != bmhd_t::eCMP_NONE && h.compression != bmhd_t::eCMP_BYTERUN1)
+	{
+	  return false;
+	}
+      // one set of threads for all the bands
+      thread_pool_c pool (threads);
+      // about 64K of frame per thread and band
+      const size_t row_bytes = body_row_bytes (h, pbm);
+      size_t band = row_bytes ? pool.size () * (64 * 1024) / row_bytes : h.height;
+      if (band == 0)
+	{
+	  band = 1;
+	}
+      if (!w.begin_chunk ("BODY"_id))
+	{
+	  return false;
+	}
+      bmhd_t part = h;
+      std::vector <uint8_t> packed;
+      for (size_t y = 0; y < h.height; y += band)
+	{
+	  part.height = (uint16_t)(h.height - y < band ? h.height - y : band);
+	  packed.clear ();
+	  if (!encode_band (part, pbm, frame + y * row_bytes, packed, pool, isa) ||
+	      (!packed.empty () && !w.write (&packed [0], (std::streamsize)packed.size ())))
+	    {
+	      return false;
+	    }
+	}
+      return w.end ();
+    }
+  } // ns codec
+} // ns iff
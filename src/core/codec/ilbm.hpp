@@ -0,0 +1,82 @@
+#ifndef __IFF_CODEC_ILBM_HPP__
+#define __IFF_CODEC_ILBM_HPP__
+
+#include <cstddef>
+#include <vector>
+#include "core/codec/isa.hpp"
+
+namespace iff
+{
+  namespace ea
+  {
+    class writer_c;
+  } // ns ea
+
+  namespace codec
+  {
+    // ILBM / PBM bitmap header
+    struct bmhd_t
+    {
+      enum
+	{
+	  eMASK_NONE         = 0,
+	  eMASK_HAS_MASK     = 1,
+	  eMASK_TRANSPARENT  = 2,
+	  eMASK_LASSO        = 3
+	};
+      enum
+	{
+	  eCMP_NONE          = 0,
+	  eCMP_BYTERUN1      = 1
+	};
+
+      uint16_t width;
+      uint16_t height;
+      int16_t  x;
+      int16_t  y;
+      uint8_t  nplanes;
+      uint8_t  masking;
+      uint8_t  compression;
+      uint16_t transparent;
+      uint8_t  x_aspect;
+      uint8_t  y_aspect;
+      int16_t  page_width;
+      int16_t  page_height;
+    };
+
+    static const size_t BMHD_SIZE = 20;
+
+    bool parse_bmhd (const uint8_t* data, size_t size, bmhd_t& h);
+
+    // bytes of one row of one plane, ILBM rows are word aligned
+    size_t plane_row_bytes (const bmhd_t& h);
+    // bytes of one BODY row: all planes and the mask plane, if any,
+    // or the chunky pixels of a PBM
+    size_t body_row_bytes  (const bmhd_t& h, bool pbm);
+    // bytes per pixel produced by frame_to_chunky: 1 up to 8 planes,
+    // 3 for 24 bit RGB
+    size_t chunky_pixel_bytes (const bmhd_t& h);
+
+    // Unpacks a BODY into frame, height * body_row_bytes bytes.
+    bool decode_body (const bmhd_t& h, bool pbm, const uint8_t* body, size_t size,
+		      uint8_t* frame, isa_t isa = eBEST);
+
+    // Converts an ILBM frame (as left by decode_body) to chunky pixels,
+    // width * height * chunky_pixel_bytes bytes. Deep images store
+    // red in planes 0..7, green in 8..15 and blue in 16..23.
+    bool frame_to_chunky (const bmhd_t& h, const uint8_t* frame, uint8_t* chunky,
+			  isa_t isa = eBEST);
+
+    // The inverse of decode_body: packs a frame as h.compression says
+    // and appends it to body. ILBM rows are packed a plane row at a
+    // time, PBM rows whole; rows are spread over up to threads threads.
+    bool encode_body (const bmhd_t& h, bool pbm, const uint8_t* frame,
+		      std::vector <uint8_t>& body, unsigned threads = 1, isa_t isa = eBEST);
+    // Writes the BODY chunk of a frame through w a band of rows at a
+    // time, so only one band is ever held packed.
+    bool write_body (ea::writer_c& w, const bmhd_t& h, bool pbm, const uint8_t* frame,
+		     unsigned threads = 1, isa_t isa = eBEST);
+  } // ns codec
+} // ns iff
+
+#endif
@@ -0,0 +1,52 @@
+#include "core/codec/isa.hpp"
+
+namespace iff
+{
+  namespace codec
+  {
+    bool isa_supported (isa_t isa)
+    {
+      switch (isa)
+	{
+	case eSCALAR:
+	  return true;
+#if defined(IFF_CODEC_X86)
+	case eSSE2:
+	  return __builtin_cpu_supports ("sse2");
+	case eAVX2:
+	  return __builtin_cpu_supports ("avx2");
+#endif
+	default:
+	  return false;
+	}
+    }
+    // ---------------------------------------------------------------
+    const char* isa_name (isa_t isa)
+    {
+      switch (isa)
+	{
+	case eSCALAR:
+	  return "scalar";
+	case eSSE2:
+	  return "sse2";
+	case eAVX2:
+	  return "avx2";
+	default:
+	  return "best";
+	}
+    }
+    // ---------------------------------------------------------------
+    isa_t isa_resolve (isa_t isa)
+    {
+      if (isa == eBEST)
+	{
+	  isa = eAVX2;
+	}
+      while (isa != eSCALAR && !isa_supported (isa))
+	{
+	  isa = (isa_t)(isa - 1);
+	}
+      return isa;
+    }
+  } // ns codec
+} // ns iff
@@ -0,0 +1,35 @@
+#ifndef __IFF_CODEC_ISA_HPP__
+#define __IFF_CODEC_ISA_HPP__
+
+#include "core/iff_types.hpp"
+
+// Vector kernels are compiled with per-function target attributes, so
+// the library runs on any x86 CPU and picks the widest variant the CPU
+// supports at run time. Other targets only have the scalar kernels.
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define IFF_CODEC_X86 1
+#endif
+
+namespace iff
+{
+  namespace codec
+  {
+    enum isa_t
+      {
+	eSCALAR,
+	eSSE2,
+	eAVX2,
+	eBEST
+      };
+
+    static const int ISA_COUNT = 3;
+
+    bool        isa_supported (isa_t isa);
+    const char* isa_name      (isa_t isa);
+    // eBEST becomes the widest supported variant, unsupported
+    // variants fall back to the next narrower one
+    isa_t       isa_resolve   (isa_t isa);
+  } // ns codec
+} // ns iff
+
+#endif
@@ -0,0 +1,196 @@
+#ifndef __IFF_CODEC_PARALLEL_HPP__
+#define __IFF_CODEC_PARALLEL_HPP__
+
+#include <cstddef>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace iff
+{
+  namespace codec
+  {
+    // Calls f (i) for every i below n on up to threads threads, the
+    // caller being one of them. Items are handed out one at a time,
+    // so uneven items balance themselves. threads 0 means one per core.
+    template <class F>
+    void parallel_for (size_t n, unsigned threads, F f)
+    {
+      if (threads == 0)
+	{
+	  threads = std::thread::hardware_concurrency ();
+	}
+      if (threads > n)
+	{
+	  threads = (unsigned)n;
+	}
+      if (threads <= 1)
+	{
+	  for (size_t i = 0; i < n; i++)
+	    {
+	      f (i);
+	    }
+	  return;
+	}
+      std::atomic <size_t> next (0);
+      auto work = [&next, n, &f] ()
+	{
+	  for (size_t i = next++; i < n; i = next++)
+	    {
+	      f (i);
+	    }
+	};
+      std::vector <std::thread> pool;
+      for (unsigned t = 1; t < threads; t++)
+	{
+	  pool.push_back (std::thread (work));
+	}
+      work ();
+      for (size_t t = 0; t < pool.size (); t++)
+	{
+	  pool [t].join ();
+	}
+    }
+
+    // The threads of parallel_for () kept across calls, for callers
+    // that hand out many small batches in a row (the bands of a BODY)
+    // and should not start and join threads for each. They start as
+    // run () first needs them and end with the pool.
+    class thread_pool_c
+    {
+    public:
+      // threads counts the caller, 0 means one per core
+      explicit thread_pool_c (unsigned threads = 0);
+      ~thread_pool_c ();
+
+      unsigned size () const;
+      // f (i) for every i below n, as parallel_for (); one run () at a time
+      template <class F>
+      void run (size_t n, F f);
+    private:
+      thread_pool_c (const thread_pool_c&);
+      thread_pool_c& operator = (const thread_pool_c&);
+
+      void _work (uint64_t seen);
+      void _drain ();
+    private:
+      unsigned                 m_size;
+      std::vector <std::thread> m_threads;
+      std::mutex               m_mutex;
+      std::condition_variable  m_wake;
+      std::condition_variable  m_idle;
+      // the current run (): a new generation wakes the threads, busy
+      // counts those not done with it yet
+      uint64_t                 m_generation;
+      unsigned                 m_busy;
+      bool                     m_quit;
+      const std::function <void (size_t)>* m_job;
+      size_t                   m_n;
+      std::atomic <size_t>     m_next;
+    };
+    // ---------------------------------------------------------------
+    inline thread_pool_c::thread_pool_c (unsigned threads)
+      : m_size       (threads ? threads : std::thread::hardware_concurrency ()),
+	m_generation (0),
+	m_busy       (0),
+	m_quit       (false),
+	m_job        (0),
+	m_n          (0),
+	m_next       (0)
+    {
+      if (m_size == 0)
+	{
+	  m_size = 1;
+	}
+    }
+    // ---------------------------------------------------------------
+    inline thread_pool_c::~thread_pool_c ()
+    {
+      {
+	std::lock_guard <std::mutex> lock (m_mutex);
+	m_quit = true;
+      }
+      m_wake.notify_all ();
+      for (size_t t = 0; t < m_threads.size (); t++)
+	{
+	  m_threads [t].join ();
+	}
+    }
+    // ---------------------------------------------------------------
+    inline unsigned thread_pool_c::size () const
+    {
+      return m_size;
+    }
+    // ---------------------------------------------------------------
+    inline void thread_pool_c::_drain ()
+    {
+      for (size_t i = m_next++; i < m_n; i = m_next++)
+	{
+	  (*m_job) (i);
+	}
+    }
+    // ---------------------------------------------------------------
+    // seen is the generation before the thread existed, it only
+    // takes part in later ones
+    inline void thread_pool_c::_work (uint64_t seen)
+    {
+      for (;;)
+	{
+	  {
+	    std::unique_lock <std::mutex> lock (m_mutex);
+	    m_wake.wait (lock, [&] () { return m_quit || m_generation != seen; });
+	    if (m_quit)
+	      {
+		return;
+	      }
+	    seen = m_generation;
+	  }
+	  _drain ();
+	  std::lock_guard <std::mutex> lock (m_mutex);
+	  if (--m_busy == 0)
+	    {
+	      m_idle.notify_one ();
+	    }
+	}
+    }
+    // ---------------------------------------------------------------
+    template <class F>
+    void thread_pool_c::run (size_t n, F f)
+    {
+      if (n <= 1 || m_size <= 1)
+	{
+	  for (size_t i = 0; i < n; i++)
+	    {
+	      f (i);
+	    }
+	  return;
+	}
+      // no more threads than items, the caller included
+      const size_t want = (n < m_size ? n : m_size) - 1;
+      while (m_threads.size () < want)
+	{
+	  m_threads.push_back (std::thread (&thread_pool_c::_work, this, m_generation));
+	}
+      // a reference, nothing to copy or allocate
+      const std::function <void (size_t)> job (std::ref (f));
+      {
+	std::lock_guard <std::mutex> lock (m_mutex);
+	m_job  = &job;
+	m_n    = n;
+	m_next = 0;
+	m_busy = (unsigned)m_threads.size ();
+	m_generation++;
+      }
+      m_wake.notify_all ();
+      _drain ();
+      std::unique_lock <std::mutex> lock (m_mutex);
+      m_idle.wait (lock, [this] () { return m_busy == 0; });
+      m_job = 0;
+    }
+  } // ns codec
+} // ns iff
+
+#endif
@@ -0,0 +1,229 @@
+#include "core/codec/planar.hpp"
+
+#if defined(IFF_CODEC_X86)
+#include <immintrin.h>
+#endif
+
+namespace iff
+{
+  namespace codec
+  {
+    // converts the plane bytes at column b, 8 pixels or fewer
+    static void column_scalar (const uint8_t* row, size_t plane_stride, unsigned nplanes,
+			       size_t b, uint8_t* dst, size_t pixels)
+    {
+      for (size_t k = 0; k < pixels; k++)
+	{
+	  const unsigned shift = 7 - (unsigned)k;
+	  unsigned v = 0;
+	  for (unsigned p = 0; p < nplanes; p++)
+	    {
+	      v |= ((row [p * plane_stride + b] >> shift) & 1u) << p;
+	    }
+	  dst [k] = (uint8_t)v;
+	}
+    }
+    // ---------------------------------------------------------------
+    static void p2c_scalar (const uint8_t* row, size_t plane_stride, unsigned nplanes,
+			    uint8_t* dst, size_t width, size_t x)
+    {
+      for (; x < width; x += 8)
+	{
+	  const size_t left = width - x;
+	  column_scalar (row, plane_stride, nplanes, x >> 3, dst + x, left < 8 ? left : 8);
+	}
+    }
+#if defined(IFF_CODEC_X86)
+    // ---------------------------------------------------------------
+    // The vector variants gather the plane bytes of one column into a
+    // 64 bit word (byte p = plane p), which is an 8x8 bit matrix. Its
+    // transpose holds the pixels in reverse order, bit p = plane p,
+    // so a byte swap of the word finishes the column.
+    //
+    // t = (x ^ (x >> 7)) & 0x00AA00AA00AA00AA; x ^= t ^ (t << 7)
+    // t = (x ^ (x >> 14)) & 0x0000CCCC0000CCCC; x ^= t ^ (t << 14)
+    // t = (x ^ (x >> 28)) & 0x00000000F0F0F0F0; x ^= t ^ (t << 28)
+    __attribute__ ((target ("sse2")))
+    static inline __m128i transpose_sse2 (__m128i x)
+    {
+      __m128i t;
+      t = _mm_and_si128 (_mm_xor_si128 (x, _mm_srli_epi64 (x, 7)),
+			 _mm_set1_epi64x (0x00AA00AA00AA00AALL));
+      x = _mm_xor_si128 (x, _mm_xor_si128 (t, _mm_slli_epi64 (t, 7)));
+      t = _mm_and_si128 (_mm_xor_si128 (x, _mm_srli_epi64 (x, 14)),
+			 _mm_set1_epi64x (0x0000CCCC0000CCCCLL));
+      x = _mm_xor_si128 (x, _mm_xor_si128 (t, _mm_slli_epi64 (t, 14)));
+      t = _mm_and_si128 (_mm_xor_si128 (x, _mm_srli_epi64 (x, 28)),
+			 _mm_set1_epi64x (0x00000000F0F0F0F0LL));
+      x = _mm_xor_si128 (x, _mm_xor_si128 (t, _mm_slli_epi64 (t, 28)));
+      // byte swap of each 64 bit word
+      x = _mm_shufflehi_epi16 (_mm_shufflelo_epi16 (x, _MM_SHUFFLE (0, 1, 2, 3)),
+			       _MM_SHUFFLE (0, 1, 2, 3));
+      return _mm_or_si128 (_mm_slli_epi16 (x, 8), _mm_srli_epi16 (x, 8));
+    }
+    // ---------------------------------------------------------------
+    // 16 columns (128 pixels) per step
+    __attribute__ ((target ("sse2")))
+    static void p2c_sse2 (const uint8_t* row, size_t plane_stride, unsigned nplanes,
+			  uint8_t* dst, size_t width)
+    {
+      size_t x = 0;
+      for (; x + 128 <= width; x += 128)
+	{
+	  const size_t b = x >> 3;
+	  __m128i p [8];
+	  for (unsigned i = 0; i < 8; i++)
+	    {
+	      p [i] = i < nplanes
+		? _mm_loadu_si128 ((const __m128i*)(row + i * plane_stride + b))
+		: _mm_setzero_si128 ();
+	    }
+	  // byte transpose: 8 planes x 16 columns into 16 words
+	  __m128i a [8];
+	  for (unsigned i = 0; i < 4; i++)
+	    {
+	      a [2 * i]     = _mm_unpacklo_epi8 (p [2 * i], p [2 * i + 1]);
+	      a [2 * i + 1] = _mm_unpackhi_epi8 (p [2 * i], p [2 * i + 1]);
+	    }
+	  __m128i c [8];
+	  for (unsigned i = 0; i < 2; i++)
+	    {
+	      c [4 * i]     = _mm_unpacklo_epi16 (a [4 * i],     a [4 * i + 2]);
+	      c [4 * i + 1] = _mm_unpackhi_epi16 (a [4 * i],     a [4 * i + 2]);
+	      c [4 * i + 2] = _mm_unpacklo_epi16 (a [4 * i + 1], a [4 * i + 3]);
+	      c [4 * i + 3] = _mm_unpackhi_epi16 (a [4 * i + 1], a [4 * i + 3]);
+	    }
+	  for (unsigned i = 0; i < 4; i++)
+	    {
+	      const __m128i lo = _mm_unpacklo_epi32 (c [i], c [i + 4]);
+	      const __m128i hi = _mm_unpackhi_epi32 (c [i], c [i + 4]);
+	      _mm_storeu_si128 ((__m128i*)(dst + x + 32 * i),      transpose_sse2 (lo));
+	      _mm_storeu_si128 ((__m128i*)(dst + x + 32 * i + 16), transpose_sse2 (hi));
+	    }
+	}
+      p2c_scalar (row, plane_stride, nplanes, dst, width, x);
+    }
+    // ---------------------------------------------------------------
+    __attribute__ ((target ("avx2")))
+    static inline __m256i transpose_avx2 (__m256i x)
+    {
+      __m256i t;
+      t = _mm256_and_si256 (_mm256_xor_si256 (x, _mm256_srli_epi64 (x, 7)),
+			    _mm256_set1_epi64x (0x00AA00AA00AA00AALL));
+      x = _mm256_xor_si256 (x, _mm256_xor_si256 (t, _mm256_slli_epi64 (t, 7)));
+      t = _mm256_and_si256 (_mm256_xor_si256 (x, _mm256_srli_epi64 (x, 14)),
+			    _mm256_set1_epi64x (0x0000CCCC0000CCCCLL));
+      x = _mm256_xor_si256 (x, _mm256_xor_si256 (t, _mm256_slli_epi64 (t, 14)));
+      t = _mm256_and_si256 (_mm256_xor_si256 (x, _mm256_srli_epi64 (x, 28)),
+			    _mm256_set1_epi64x (0x00000000F0F0F0F0LL));
+      x = _mm256_xor_si256 (x, _mm256_xor_si256 (t, _mm256_slli_epi64 (t, 28)));
+      const __m256i swap = _mm256_setr_epi8 (7, 6, 5, 4, 3, 2, 1, 0,
+					     15, 14, 13, 12, 11, 10, 9, 8,
+					     7, 6, 5, 4, 3, 2, 1, 0,
+					     15, 14, 13, 12, 11, 10, 9, 8);
+      return _mm256_shuffle_epi8 (x, swap);
+    }
+    // ---------------------------------------------------------------
+    // 32 columns (256 pixels) per step. The unpacks work within 128 bit
+    // lanes, so the low lanes hold pixels 0..127 and the high lanes
+    // pixels 128..255.
+    __attribute__ ((target ("avx2")))
+    static void p2c_avx2 (const uint8_t* row, size_t plane_stride, unsigned nplanes,
+			  uint8_t* dst, size_t width)
+    {
+      size_t x = 0;
+      for (; x + 256 <= width; x += 256)
+	{
+	  const size_t b = x >> 3;
+	  __m256i p [8];
+	  for (unsigned i = 0; i < 8; i++)
+	    {
+	      p [i] = i < nplanes
+		? _mm256_loadu_si256 ((const __m256i*)(row + i * plane_stride + b))
+		: _mm256_setzero_si256 ();
+	    }
+	  __m256i a [8];
+	  for (unsigned i = 0; i < 4; i++)
+	    {
+	      a [2 * i]     = _mm256_unpacklo_epi8 (p [2 * i], p [2 * i + 1]);
+	      a [2 * i + 1] = _mm256_unpackhi_epi8 (p [2 * i], p [2 * i + 1]);
+	    }
+	  __m256i c [8];
+	  for (unsigned i = 0; i < 2; i++)
+	    {
+	      c [4 * i]     = _mm256_unpacklo_epi16 (a [4 * i],     a [4 * i + 2]);
+	      c [4 * i + 1] = _mm256_unpackhi_epi16 (a [4 * i],     a [4 * i + 2]);
+	      c [4 * i + 2] = _mm256_unpacklo_epi16 (a [4 * i + 1], a [4 * i + 3]);
+	      c [4 * i + 3] = _mm256_unpackhi_epi16 (a [4 * i + 1], a [4 * i + 3]);
+	    }
+	  for (unsigned i = 0; i < 4; i++)
+	    {
+	      const __m256i lo = transpose_avx2 (_mm256_unpacklo_epi32 (c [i], c [i + 4]));
+	      const __m256i hi = transpose_avx2 (_mm256_unpackhi_epi32 (c [i], c [i + 4]));
+	      _mm256_storeu_si256 ((__m256i*)(dst + x + 32 * i),
+				   _mm256_permute2x128_si256 (lo, hi, 0x20));
+	      _mm256_storeu_si256 ((__m256i*)(dst + x + 128 + 32 * i),
+				   _mm256_permute2x128_si256 (lo, hi, 0x31));
+	    }
+	}
+      if (x + 128 <= width)
+	{
+	  p2c_sse2 (row + (x >> 3), plane_stride, nplanes, dst + x, width - x);
+	  return;
+	}
+      p2c_scalar (row, plane_stride, nplanes, dst, width, x);
+    }
+#endif
+    // ---------------------------------------------------------------
+    void planar_to_chunky (const uint8_t* row, size_t plane_stride, unsigned nplanes,
+			   uint8_t* dst, size_t width, isa_t isa)
+    {
+      if (nplanes > 8)
+	{
+	  nplanes = 8;
+	}
+      switch (isa_resolve (isa))
+	{
+#if defined(IFF_CODEC_X86)
+	case eAVX2:
+	  p2c_avx2 (row, plane_stride, nplanes, dst, width);
+	  return;
+	case eSSE2:
+	  p2c_sse2 (row, plane_stride, nplanes, dst, width);
+	  return;
+#endif
+	default:
+	  p2c_scalar (row, plane_stride, nplanes, dst, width, 0);
+	}
+    }
+    // ---------------------------------------------------------------
+    void chunky_to_planar (const uint8_t* src, size_t width, unsigned nplanes,
+			   uint8_t* row, size_t plane_stride)
+    {
+      if (nplanes > 8)
+	{
+	  nplanes = 8;
+	}
+      const size_t used = (width + 7) >> 3;
+      for (unsigned p = 0; p < nplanes; p++)
+	{
+	  uint8_t* plane = row + p * plane_stride;
+	  for (size_t b = 0; b < used; b++)
+	    {
+	      const size_t x    = b << 3;
+	      const size_t left = width - x < 8 ? width - x : 8;
+	      unsigned v = 0;
+	      for (size_t k = 0; k < left; k++)
+		{
+		  v |= ((src [x + k] >> p) & 1u) << (7 - k);
+		}
+	      plane [b] = (uint8_t)v;
+	    }
+	  for (size_t b = used; b < plane_stride; b++)
+	    {
+	      plane [b] = 0;
+	    }
+	}
+    }
+  } // ns codec
+} // ns iff
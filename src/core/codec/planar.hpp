@@ -0,0 +1,26 @@
+#ifndef __IFF_CODEC_PLANAR_HPP__
+#define __IFF_CODEC_PLANAR_HPP__
+
+#include <cstddef>
+#include "core/codec/isa.hpp"
+
+namespace iff
+{
+  namespace codec
+  {
+    // Converts one row of up to 8 bitplanes to one byte per pixel.
+    // Plane p starts at row + p * plane_stride, pixel x is bit 7 - (x & 7)
+    // of byte x >> 3 and becomes bit p of dst [x]. Exactly width bytes
+    // are written.
+    void planar_to_chunky (const uint8_t* row, size_t plane_stride, unsigned nplanes,
+			   uint8_t* dst, size_t width, isa_t isa = eBEST);
+
+    // The inverse: bit p of src [x] becomes plane p, bits of pixels
+    // past width and the bytes up to plane_stride are cleared. Only
+    // the writers need it, so there is no vector variant.
+    void chunky_to_planar (const uint8_t* src, size_t width, unsigned nplanes,
+			   uint8_t* row, size_t plane_stride);
+  } // ns codec
+} // ns iff
+
+#endif
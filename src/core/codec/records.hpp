@@ -0,0 +1,138 @@
+#ifndef __IFF_CODEC_RECORDS_HPP__
+#define __IFF_CODEC_RECORDS_HPP__
+
+#include "core/codec/schema.hpp"
+#include "core/codec/ilbm.hpp"
+#include "core/codec/anim.hpp"
+
+// Schemas of the fixed layout chunks and of the records of the array
+// chunks, see core/codec/schema.hpp.
+namespace iff
+{
+  namespace codec
+  {
+    // ILBM display mode (Amiga view modes)
+    struct camg_t
+    {
+      enum
+	{
+	  eHAM       = 0x0800,
+	  eEHB       = 0x0080,
+	  eLACE      = 0x0004,
+	  eHIRES     = 0x8000
+	};
+
+      uint32_t view_modes;
+    };
+
+    // one CMAP entry
+    struct cmap_entry_t
+    {
+      uint8_t r;
+      uint8_t g;
+      uint8_t b;
+    };
+
+    // AIFF / AIFC common chunk, AIFC appends the compression type
+    struct comm_t
+    {
+      int16_t  channels;
+      uint32_t frames;
+      int16_t  sample_bits;
+      double   sample_rate;
+    };
+
+    // one point of a 3DS vertex list (chunk 0x4110, after its
+    // 16 bit count); 3DS is little endian
+    struct vertex3_t
+    {
+      float x;
+      float y;
+      float z;
+    };
+
+    // WAVE "fmt " chunk, RIFF is little endian. Extensible formats
+    // append the valid bits, a channel mask and the sub format GUID.
+    struct wave_fmt_t
+    {
+      enum
+	{
+	  ePCM         = 0x0001,
+	  eFLOAT       = 0x0003,
+	  eEXTENSIBLE  = 0xFFFE
+	};
+
+      uint16_t format;
+      uint16_t channels;
+      uint32_t sample_rate;
+      uint32_t byte_rate;
+      uint16_t block_align;
+      uint16_t sample_bits;
+    };
+
+    typedef schema_c <bmhd_t, eBIG_ENDIAN,
+		      IFF_FIELD (bmhd_t, width),
+		      IFF_FIELD (bmhd_t, height),
+		      IFF_FIELD (bmhd_t, x),
+		      IFF_FIELD (bmhd_t, y),
+		      IFF_FIELD (bmhd_t, nplanes),
+		      IFF_FIELD (bmhd_t, masking),
+		      IFF_FIELD (bmhd_t, compression),
+		      pad_c <1>,
+		      IFF_FIELD (bmhd_t, transparent),
+		      IFF_FIELD (bmhd_t, x_aspect),
+		      IFF_FIELD (bmhd_t, y_aspect),
+		      IFF_FIELD (bmhd_t, page_width),
+		      IFF_FIELD (bmhd_t, page_height)> bmhd_schema_t;
+
+    // the 16 reserved bytes at the end are left out, old writers
+    // drop them
+    typedef schema_c <anhd_t, eBIG_ENDIAN,
+		      IFF_FIELD (anhd_t, operation),
+		      IFF_FIELD (anhd_t, mask),
+		      IFF_FIELD (anhd_t, width),
+		      IFF_FIELD (anhd_t, height),
+		      IFF_FIELD (anhd_t, x),
+		      IFF_FIELD (anhd_t, y),
+		      IFF_FIELD (anhd_t, abs_time),
+		      IFF_FIELD (anhd_t, rel_time),
+		      IFF_FIELD (anhd_t, interleave),
+		      pad_c <1>,
+		      IFF_FIELD (anhd_t, bits)> anhd_schema_t;
+
+    typedef schema_c <camg_t, eBIG_ENDIAN,
+		      IFF_FIELD (camg_t, view_modes)> camg_schema_t;
+
+    typedef schema_c <cmap_entry_t, eBIG_ENDIAN,
+		      IFF_FIELD (cmap_entry_t, r),
+		      IFF_FIELD (cmap_entry_t, g),
+		      IFF_FIELD (cmap_entry_t, b)> cmap_schema_t;
+
+    typedef schema_c <comm_t, eBIG_ENDIAN,
+		      IFF_FIELD (comm_t, channels),
+		      IFF_FIELD (comm_t, frames),
+		      IFF_FIELD (comm_t, sample_bits),
+		      IFF_FIELD_AS (comm_t, sample_rate, ieee_extended_c)> comm_schema_t;
+
+    typedef schema_c <vertex3_t, eLITTLE_ENDIAN,
+		      IFF_FIELD (vertex3_t, x),
+		      IFF_FIELD (vertex3_t, y),
+		      IFF_FIELD (vertex3_t, z)> vertex3_schema_t;
+
+    typedef schema_c <wave_fmt_t, eLITTLE_ENDIAN,
+		      IFF_FIELD (wave_fmt_t, format),
+		      IFF_FIELD (wave_fmt_t, channels),
+		      IFF_FIELD (wave_fmt_t, sample_rate),
+		      IFF_FIELD (wave_fmt_t, byte_rate),
+		      IFF_FIELD (wave_fmt_t, block_align),
+		      IFF_FIELD (wave_fmt_t, sample_bits)> wave_fmt_schema_t;
+
+    static_assert (bmhd_schema_t::WIRE_SIZE == BMHD_SIZE, "BMHD is 20 bytes");
+    static_assert (anhd_schema_t::WIRE_SIZE == ANHD_MIN_SIZE, "ANHD is 24 bytes before its pad");
+    static_assert (comm_schema_t::WIRE_SIZE == 18, "COMM is 18 bytes");
+    static_assert (vertex3_schema_t::LANE == 4, "vertices swap as 32 bit lanes");
+    static_assert (wave_fmt_schema_t::WIRE_SIZE == 16, "a PCM fmt chunk is 16 bytes");
+  } // ns codec
+} // ns iff
+
+#endif
@@ -0,0 +1,73 @@
+#include <string.h>
+#include <cmath>
+
+#include "core/codec/schema.hpp"
+
+namespace iff
+{
+  namespace codec
+  {
+    // sign and 15 bit exponent, then a 64 bit mantissa with an
+    // explicit integer bit
+    double ieee_extended_c::extended_to_double (const uint8_t* p)
+    {
+      const int  exponent = ((p [0] & 0x7F) << 8) | p [1];
+      const bool negative = (p [0] & 0x80) != 0;
+      uint64_t mantissa = 0;
+      for (int i = 2; i < 10; i++)
+	{
+	  mantissa = (mantissa << 8) | p [i];
+	}
+      double v;
+      if (exponent == 0 && mantissa == 0)
+	{
+	  v = 0;
+	}
+      else if (exponent == 0x7FFF)
+	{
+	  v = mantissa << 1 ? NAN : HUGE_VAL;
+	}
+      else
+	{
+	  v = ldexp ((double)mantissa, exponent - 16383 - 63);
+	}
+      return negative ? -v : v;
+    }
+    // ---------------------------------------------------------------
+    void ieee_extended_c::double_to_extended (double v, uint8_t* p)
+    {
+      memset (p, 0, 10);
+      if (std::signbit (v))
+	{
+	  p [0] = 0x80;
+	  v = -v;
+	}
+      if (v == 0)
+	{
+	  return;
+	}
+      int      exponent;
+      uint64_t mantissa;
+      if (std::isnan (v) || std::isinf (v))
+	{
+	  exponent = 0x7FFF;
+	  mantissa = std::isnan (v) ? 0xC000000000000000ULL : 0;
+	}
+      else
+	{
+	  // v = m * 2^e with m in [0.5, 1): the integer bit is the top
+	  // bit of m * 2^64
+	  int e;
+	  const double m = frexp (v, &e);
+	  exponent = e - 1 + 16383;
+	  mantissa = (uint64_t)ldexp (m, 64);
+	}
+      p [0] |= (uint8_t)(exponent >> 8);
+      p [1]  = (uint8_t)exponent;
+      for (int i = 9; i >= 2; i--, mantissa >>= 8)
+	{
+	  p [i] = (uint8_t)mantissa;
+	}
+    }
+  } // ns codec
+} // ns iff
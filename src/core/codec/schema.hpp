@@ -0,0 +1,263 @@
+#ifndef __IFF_CODEC_SCHEMA_HPP__
+#define __IFF_CODEC_SCHEMA_HPP__
+
+#include <string.h>
+#include <cstddef>
+
+#include "core/codec/isa.hpp"
+#include "core/codec/audio.hpp"
+
+// Fixed layout chunks (BMHD, ANHD, COMM, ...) are declared once as a
+// native struct plus a schema listing its fields in wire order:
+//
+//   typedef schema_c <camg_t, eBIG_ENDIAN,
+//                     IFF_FIELD (camg_t, view_modes)> camg_schema_t;
+//
+// The wire layout is computed at compile time: every field has a
+// constant offset, WIRE_SIZE is a constant expression, and decode ()
+// unrolls to one load (and byte swap) per field after a single size
+// check; encode () is the same walk storing them. Gaps in the record
+// are pad_c <N> entries, written as zeros. A field whose wire form is
+// not just its native type in the schema's byte order names a codec
+// (see ieee_extended_c).
+//
+// decode_array () decodes a run of records. When every field has the
+// same width the whole run is swapped by swap_samples () first, which
+// uses the vector kernels, and the records are then plain copies.
+namespace iff
+{
+  namespace codec
+  {
+    enum byte_order_t
+      {
+	eBIG_ENDIAN,
+	eLITTLE_ENDIAN
+      };
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    static const byte_order_t HOST_ORDER = eBIG_ENDIAN;
+#else
+    static const byte_order_t HOST_ORDER = eLITTLE_ENDIAN;
+#endif
+
+    // an integral or floating point value stored as its own bytes.
+    // LANE is the width a bulk byte swap may treat it as, 0 for none.
+    template <class M>
+    struct wire_c
+    {
+      static constexpr size_t SIZE = sizeof (M);
+      static constexpr size_t LANE = sizeof (M);
+
+      template <byte_order_t ORDER>
+      static M load (const uint8_t* p)
+      {
+	uint8_t b [sizeof (M)];
+	for (size_t i = 0; i < sizeof (M); i++)
+	  {
+	    b [i] = ORDER == HOST_ORDER ? p [i] : p [sizeof (M) - 1 - i];
+	  }
+	M m;
+	memcpy (&m, b, sizeof (M));
+	return m;
+      }
+
+      template <byte_order_t ORDER>
+      static void store (M m, uint8_t* p)
+      {
+	uint8_t b [sizeof (M)];
+	memcpy (b, &m, sizeof (M));
+	for (size_t i = 0; i < sizeof (M); i++)
+	  {
+	    p [i] = ORDER == HOST_ORDER ? b [i] : b [sizeof (M) - 1 - i];
+	  }
+      }
+    };
+
+    // 80 bit IEEE 754 extended precision, big endian (AIFF sample rates)
+    struct ieee_extended_c
+    {
+      static constexpr size_t SIZE = 10;
+      static constexpr size_t LANE = 0;
+
+      template <byte_order_t ORDER>
+      static double load (const uint8_t* p)
+      {
+	return extended_to_double (p);
+      }
+      template <byte_order_t ORDER>
+      static void store (double v, uint8_t* p)
+      {
+	double_to_extended (v, p);
+      }
+      static double extended_to_double (const uint8_t* p);
+      static void   double_to_extended (double v, uint8_t* p);
+    };
+
+    template <class T, class M, M T::* MEMBER, class CODEC = wire_c <M> >
+    struct field_c
+    {
+      static constexpr size_t SIZE = CODEC::SIZE;
+      static constexpr size_t LANE = CODEC::LANE;
+
+      template <byte_order_t ORDER>
+      static void load (const uint8_t* p, T& t)
+      {
+	t.*MEMBER = (M)CODEC::template load <ORDER> (p);
+      }
+
+      template <byte_order_t ORDER>
+      static void store (const T& t, uint8_t* p)
+      {
+	CODEC::template store <ORDER> (t.*MEMBER, p);
+      }
+    };
+
+    template <size_t N>
+    struct pad_c
+    {
+      static constexpr size_t SIZE = N;
+      static constexpr size_t LANE = 0;
+
+      template <byte_order_t ORDER, class T>
+      static void load (const uint8_t*, T&)
+      {
+      }
+
+      template <byte_order_t ORDER, class T>
+      static void store (const T&, uint8_t* p)
+      {
+	memset (p, 0, N);
+      }
+    };
+
+#define IFF_FIELD(T, M)           iff::codec::field_c <T, decltype (T::M), &T::M>
+#define IFF_FIELD_AS(T, M, CODEC) iff::codec::field_c <T, decltype (T::M), &T::M, CODEC>
+
+    // -------------------------------------------------------------------
+    // the fields from OFFSET on
+    // -------------------------------------------------------------------
+    template <size_t OFFSET, class... FIELDS>
+    struct layout_c;
+
+    template <size_t OFFSET>
+    struct layout_c <OFFSET>
+    {
+      static constexpr size_t END  = OFFSET;
+      // ANY_LANE: no field left to disagree
+      static constexpr size_t LANE = ~(size_t)0;
+
+      template <byte_order_t ORDER, class T>
+      static void load (const uint8_t*, T&)
+      {
+      }
+
+      template <byte_order_t ORDER, class T>
+      static void store (const T&, uint8_t*)
+      {
+      }
+    };
+
+    template <size_t OFFSET, class FIELD, class... REST>
+    struct layout_c <OFFSET, FIELD, REST...>
+    {
+      typedef layout_c <OFFSET + FIELD::SIZE, REST...> rest_t;
+
+      static constexpr size_t END  = rest_t::END;
+      static constexpr size_t LANE =
+	rest_t::LANE == ~(size_t)0 || rest_t::LANE == FIELD::LANE ? FIELD::LANE : 0;
+
+      template <byte_order_t ORDER, class T>
+      static void load (const uint8_t* p, T& t)
+      {
+	FIELD::template load <ORDER> (p + OFFSET, t);
+	rest_t::template load <ORDER> (p, t);
+      }
+
+      template <byte_order_t ORDER, class T>
+      static void store (const T& t, uint8_t* p)
+      {
+	FIELD::template store <ORDER> (t, p + OFFSET);
+	rest_t::template store <ORDER> (t, p);
+      }
+    };
+
+    // -------------------------------------------------------------------
+    template <class T, byte_order_t ORDER, class... FIELDS>
+    class schema_c
+    {
+      typedef layout_c <0, FIELDS...> layout_t;
+    public:
+      typedef T record_t;
+
+      static constexpr size_t WIRE_SIZE = layout_t::END;
+      // width of every field if they all agree, 0 otherwise
+      static constexpr size_t LANE      = layout_t::LANE;
+
+      // false if size is short of WIRE_SIZE. Bytes past it are
+      // ignored, later revisions of a chunk may append fields.
+      static bool decode (const uint8_t* data, size_t size, T& out)
+      {
+	if (size < WIRE_SIZE)
+	  {
+	    return false;
+	  }
+	layout_t::template load <ORDER> (data, out);
+	return true;
+      }
+
+      // writes WIRE_SIZE bytes, pads are zero
+      static void encode (const T& in, uint8_t* data)
+      {
+	layout_t::template store <ORDER> (in, data);
+      }
+
+      // whole records in size bytes
+      static constexpr size_t count (size_t size)
+      {
+	return size / WIRE_SIZE;
+      }
+
+      // decodes min (count (size), max) records, returns how many
+      static size_t decode_array (const uint8_t* data, size_t size, T* out, size_t max,
+				  isa_t isa = eBEST)
+      {
+	size_t n = count (size);
+	if (n > max)
+	  {
+	    n = max;
+	  }
+	if (LANE < 2 || ORDER == HOST_ORDER)
+	  {
+	    for (size_t i = 0; i < n; i++)
+	      {
+		layout_t::template load <ORDER> (data + i * WIRE_SIZE, out [i]);
+	      }
+	    return n;
+	  }
+	// swap a block at a time into host order, then copy
+	enum
+	  {
+	    BLOCK = 4096 / WIRE_SIZE ? 4096 / WIRE_SIZE : 1
+	  };
+	uint8_t host [BLOCK * WIRE_SIZE];
+	for (size_t i = 0; i < n; i += BLOCK)
+	  {
+	    const size_t k = n - i < (size_t)BLOCK ? n - i : (size_t)BLOCK;
+	    swap_samples (data + i * WIRE_SIZE, host, k * WIRE_SIZE / LANE, (unsigned)LANE, isa);
+	    for (size_t j = 0; j < k; j++)
+	      {
+		layout_t::template load <HOST_ORDER> (host + j * WIRE_SIZE, out [i + j]);
+	      }
+	  }
+	return n;
+      }
+    };
+
+    template <class T, byte_order_t ORDER, class... FIELDS>
+    constexpr size_t schema_c <T, ORDER, FIELDS...>::WIRE_SIZE;
+    template <class T, byte_order_t ORDER, class... FIELDS>
+    constexpr size_t schema_c <T, ORDER, FIELDS...>::LANE;
+  } // ns codec
+} // ns iff
+
+#endif
@@ -0,0 +1,548 @@
+#include <fcntl.h>
+#include <unistd.h>
+#include <string.h>
+#include <cmath>
+
+#include "core/codec/transcode.hpp"
+#include "core/codec/audio.hpp"
+#include "core/codec/records.hpp"
+#include "core/generic_iff_reader.hpp"
+#include "core/ea/ea_io.hpp"
+#include "core/riff/riff_io.hpp"
+#include "core/trace.hpp"
+#include "core/fd_io.hpp"
+
+using namespace iff::ea::literals;
+
+// samples converted per block of the streaming loop
+static const size_t BLOCK_BYTES = 1 << 20;
+
+namespace
+{
+  // Finds the first two chunks of the root group with the given ids,
+  // reading headers only and no more of them once both are found.
+  template <class IO_POLICY>
+  class locator_c : public generic_iff_reader_c <IO_POLICY>
+  {
+    typedef generic_iff_reader_c <IO_POLICY> base_t;
+  public:
+    typedef typename base_t::id_t id_t;
+
+    locator_c (const id_t& a, const id_t& b)
+    {
+      ids [0] = a;
+      ids [1] = b;
+      for (int i = 0; i < 2; i++)
+	{
+	  found [i] = false;
+	  pos [i]   = 0;
+	  size [i]  = 0;
+	}
+    }
+    id_t     root;
+    id_t     ids   [2];
+    bool     found [2];
+    uint64_t pos   [2];
+    uint64_t size  [2];
+  private:
+    virtual void _on_chunk_enter (const id_t& id, std::streamsize chunk_size, std::streamsize file_pos)
+    {
+      if (this->_parent_tag () != root)
+	{
+	  return;
+	}
+      for (int i = 0; i < 2; i++)
+	{
+	  if (id == ids [i] && !found [i])
+	    {
+	      found [i] = true;
+	      pos [i]   = (uint64_t)file_pos;
+	      size [i]  = (uint64_t)chunk_size;
+	    }
+	}
+      if (found [0] && found [1])
+	{
+	  // nothing else to learn from the rest of the headers
+	  this->_stop (base_t::eCANCELLED);
+	}
+    }
+    virtual void _on_chunk_exit  (const id_t&, std::streamsize, std::streamsize) {}
+    virtual void _on_group_enter (const id_t&, const id_t& tag, std::streamsize, std::streamsize)
+    {
+      if (this->_parent_tag () == id_t ())
+	{
+	  root = tag;
+	}
+    }
+    virtual void _on_group_exit  (const id_t&, const id_t&, std::streamsize, std::streamsize) {}
+  };
+}
+// ---------------------------------------------------------------
+template <class IO_POLICY>
+static iff::codec::audio_transcoder_c::status_t locate (locator_c <IO_POLICY>& loc, const char* path)
+{
+  typedef iff::codec::audio_transcoder_c t;
+  typename locator_c <IO_POLICY>::status_t rc = loc.open (path);
+  if (rc == loc.eOK)
+    {
+      rc = loc.read ();
+    }
+  switch (rc)
+    {
+    case locator_c <IO_POLICY>::eCANCELLED:
+      // stopped by the locator itself once both are found
+    case locator_c <IO_POLICY>::eOK:
+      return loc.found [0] && loc.found [1] ? t::eOK : t::eNOT_AUDIO;
+    case locator_c <IO_POLICY>::eIO_ERROR:
+      return t::eIO_ERROR;
+    case locator_c <IO_POLICY>::eNOT_IFF:
+      return t::eNOT_AUDIO;
+    default:
+      // no root group at all: the other container, or no container
+      return loc.root == typename locator_c <IO_POLICY>::id_t () ? t::eNOT_AUDIO : t::eCORRUPT;
+    }
+}
+// ---------------------------------------------------------------
+static void put_id (std::vector <uint8_t>& v, iff_id_t id)
+{
+  for (int s = 24; s >= 0; s -= 8)
+    {
+      v.push_back ((uint8_t)(id >> s));
+    }
+}
+// ---------------------------------------------------------------
+static void put_16 (std::vector <uint8_t>& v, uint16_t x, bool big)
+{
+  v.push_back ((uint8_t)(big ? x >> 8 : x));
+  v.push_back ((uint8_t)(big ? x : x >> 8));
+}
+// ---------------------------------------------------------------
+static void put_32 (std::vector <uint8_t>& v, uint32_t x, bool big)
+{
+  for (int i = 0; i < 4; i++)
+    {
+      v.push_back ((uint8_t)(x >> (big ? 24 - 8 * i : 8 * i)));
+    }
+}
+// ---------------------------------------------------------------
+static uint32_t get_32 (const uint8_t* p, bool big)
+{
+  return big
+    ? ((uint32_t)p [0] << 24) | ((uint32_t)p [1] << 16) | ((uint32_t)p [2] << 8) | p [3]
+    : ((uint32_t)p [3] << 24) | ((uint32_t)p [2] << 16) | ((uint32_t)p [1] << 8) | p [0];
+}
+
+namespace iff
+{
+  namespace codec
+  {
+    audio_transcoder_c::audio_transcoder_c ()
+      : m_isa        (eBEST),
+	m_sowt       (false),
+	m_data_bytes (0),
+	m_copied     (false),
+	m_method     (eREAD_WRITE)
+    {
+      memset (&m_format, 0, sizeof (m_format));
+    }
+    // ---------------------------------------------------------------
+    void audio_transcoder_c::set_isa (isa_t isa)
+    {
+      m_isa = isa;
+    }
+    // ---------------------------------------------------------------
+    void audio_transcoder_c::set_sowt (bool sowt)
+    {
+      m_sowt = sowt;
+    }
+    // ---------------------------------------------------------------
+    const audio_format_t& audio_transcoder_c::format () const
+    {
+      return m_format;
+    }
+    // ---------------------------------------------------------------
+    uint64_t audio_transcoder_c::data_bytes () const
+    {
+      return m_data_bytes;
+    }
+    // ---------------------------------------------------------------
+    bool audio_transcoder_c::copied () const
+    {
+      return m_copied;
+    }
+    // ---------------------------------------------------------------
+    copy_method_t audio_transcoder_c::method () const
+    {
+      return m_method;
+    }
+    // ---------------------------------------------------------------
+    const char* audio_transcoder_c::status_name (status_t rc)
+    {
+      switch (rc)
+	{
+	case eOK:
+	  return "ok";
+	case eIO_ERROR:
+	  return "I/O error";
+	case eNOT_AUDIO:
+	  return "not an AIFF or WAV file";
+	case eUNSUPPORTED:
+	  return "unsupported sample format";
+	case eCORRUPT:
+	  return "corrupt file";
+	case eTOO_LARGE:
+	  return "too large for the output format";
+	}
+      return "?";
+    }
+    // ---------------------------------------------------------------
+    audio_transcoder_c::status_t audio_transcoder_c::aiff_to_wav (const char* in, const char* out)
+    {
+      trace::scope_c span ("transcode", "aiff_to_wav");
+      memset (&m_format, 0, sizeof (m_format));
+      m_data_bytes = 0;
+      locator_c <ea::io_c> loc ("COMM"_id, "SSND"_id);
+      status_t rc = locate (loc, in);
+      if (rc != eOK)
+	{
+	  return rc;
+	}
+      const bool aifc = loc.root == "AIFC"_id;
+      if (!aifc && loc.root != "AIFF"_id)
+	{
+	  return eNOT_AUDIO;
+	}
+
+      const int fd = open (in, O_RDONLY);
+      if (fd < 0)
+	{
+	  return eIO_ERROR;
+	}
+      uint8_t comm [22];
+      uint8_t ssnd [8];
+      const size_t comm_size = loc.size [0] < sizeof (comm) ? (size_t)loc.size [0] : sizeof (comm);
+      const bool ok = read_at (fd, loc.pos [0], comm, comm_size) &&
+	loc.size [1] >= sizeof (ssnd) && read_at (fd, loc.pos [1], ssnd, sizeof (ssnd));
+      close (fd);
+      comm_t c;
+      if (!ok || !comm_schema_t::decode (comm, comm_size, c) || (aifc && comm_size < 22))
+	{
+	  return eCORRUPT;
+	}
+
+      m_format.channels     = c.channels > 0 ? (unsigned)c.channels : 0;
+      m_format.frames       = c.frames;
+      m_format.sample_bits  = c.sample_bits > 0 ? (unsigned)c.sample_bits : 0;
+      m_format.sample_bytes = (m_format.sample_bits + 7) / 8;
+      m_format.sample_rate  = c.sample_rate;
+      m_format.floating     = false;
+      conversion_t how = m_format.sample_bytes == 1 ? eFLIP_SIGN : eSWAP;
+      if (aifc)
+	{
+	  switch (get_32 (comm + 18, true))
+	    {
+	    case "NONE"_id:
+	    case "twos"_id:
+	      break;
+	    case "sowt"_id:
+	      how = m_format.sample_bytes == 1 ? eFLIP_SIGN : eCOPY;
+	      break;
+	    case "raw "_id:
+	      how = eCOPY;
+	      if (m_format.sample_bytes != 1)
+		{
+		  return eUNSUPPORTED;
+		}
+	      break;
+	    case "fl32"_id:
+	    case "FL32"_id:
+	      m_format.floating = true;
+	      m_format.sample_bits = 32;
+	      m_format.sample_bytes = 4;
+	      break;
+	    case "fl64"_id:
+	    case "FL64"_id:
+	      m_format.floating = true;
+	      m_format.sample_bits = 64;
+	      m_format.sample_bytes = 8;
+	      break;
+	    default:
+	      return eUNSUPPORTED;
+	    }
+	}
+      const unsigned bytes = m_format.sample_bytes;
+      if (m_format.channels == 0 || bytes == 0 || (bytes > 4 && bytes != 8) ||
+	  !(m_format.sample_rate > 0) || m_format.sample_rate >= 4294967295.0)
+	{
+	  return eUNSUPPORTED;
+	}
+
+      // SSND: data offset and block size, then the sample frames
+      const uint64_t skip  = get_32 (ssnd, true);
+      if (skip > loc.size [1] - 8)
+	{
+	  return eCORRUPT;
+	}
+      const uint64_t block = (uint64_t)m_format.channels * bytes;
+      uint64_t data = loc.size [1] - 8 - skip;
+      if (data > m_format.frames * block)
+	{
+	  data = m_format.frames * block;
+	}
+      data -= data % block;
+      m_format.frames = data / block;
+      m_data_bytes    = data;
+
+      // The plain fmt chunk only describes up to two channels of 8 or
+      // 16 bit integers filling their bytes. Anything else is
+      // WAVE_FORMAT_EXTENSIBLE: cbSize 22, the valid bits, a channel
+      // mask (none past stereo, AIFF does not name its speakers) and
+      // the format as a GUID. Floats add cbSize and a fact chunk.
+      const unsigned code       = m_format.floating ? wave_fmt_t::eFLOAT : wave_fmt_t::ePCM;
+      const bool     extensible = m_format.channels > 2 || m_format.sample_bits != bytes * 8 ||
+	(!m_format.floating && bytes > 2);
+      const uint32_t fmt_size   = wave_fmt_schema_t::WIRE_SIZE +
+	(extensible ? 24 : m_format.floating ? 2 : 0);
+      const uint64_t riff_size  = 4 + 8 + fmt_size + (m_format.floating ? 12 : 0) +
+	8 + data + (data & 1);
+      if (riff_size > 0xFFFFFFFFULL || block > 0xFFFF || m_format.frames > 0xFFFFFFFFULL ||
+	  (uint64_t)(m_format.sample_rate + 0.5) * block > 0xFFFFFFFFULL)
+	{
+	  return eTOO_LARGE;
+	}
+      wave_fmt_t f;
+      f.format      = (uint16_t)(extensible ? (unsigned)wave_fmt_t::eEXTENSIBLE : code);
+      f.channels    = (uint16_t)m_format.channels;
+      f.sample_rate = (uint32_t)(m_format.sample_rate + 0.5);
+      f.block_align = (uint16_t)block;
+      f.byte_rate   = f.sample_rate * f.block_align;
+      f.sample_bits = (uint16_t)(bytes * 8);
+
+      std::vector <uint8_t> header;
+      put_id (header, "RIFF"_id);
+      put_32 (header, (uint32_t)riff_size, false);
+      put_id (header, "WAVE"_id);
+      put_id (header, "fmt "_id);
+      put_32 (header, fmt_size, false);
+      header.resize (header.size () + wave_fmt_schema_t::WIRE_SIZE);
+      wave_fmt_schema_t::encode (f, &header [header.size () - wave_fmt_schema_t::WIRE_SIZE]);
+      if (extensible)
+	{
+	  static const uint8_t guid_tail [14] =
+	    {
+	      0x00, 0x00, 0x00, 0x00, 0x10, 0x00, 0x80, 0x00, 0x00, 0xAA, 0x00, 0x38, 0x9B, 0x71
+	    };
+	  put_16 (header, 22, false);
+	  put_16 (header, (uint16_t)m_format.sample_bits, false);
+	  put_32 (header, m_format.channels == 1 ? 0x4 : m_format.channels == 2 ? 0x3 : 0, false);
+	  put_16 (header, (uint16_t)code, false);
+	  header.insert (header.end (), guid_tail, guid_tail + sizeof (guid_tail));
+	}
+      else if (m_format.floating)
+	{
+	  put_16 (header, 0, false);
+	}
+      if (m_format.floating)
+	{
+	  put_id (header, "fact"_id);
+	  put_32 (header, 4, false);
+	  put_32 (header, (uint32_t)m_format.frames, false);
+	}
+      put_id (header, "data"_id);
+      put_32 (header, (uint32_t)data, false);
+      return _write (in, loc.pos [1] + 8 + skip, header, out, how);
+    }
+    // ---------------------------------------------------------------
+    audio_transcoder_c::status_t audio_transcoder_c::wav_to_aiff (const char* in, const char* out)
+    {
+      trace::scope_c span ("transcode", "wav_to_aiff");
+      memset (&m_format, 0, sizeof (m_format));
+      m_data_bytes = 0;
+      locator_c <riff::io_c> loc ("fmt "_id, "data"_id);
+      status_t rc = locate (loc, in);
+      if (rc != eOK)
+	{
+	  return rc;
+	}
+      if (loc.root != "WAVE"_id)
+	{
+	  return eNOT_AUDIO;
+	}
+
+      const int fd = open (in, O_RDONLY);
+      if (fd < 0)
+	{
+	  return eIO_ERROR;
+	}
+      uint8_t fmt [40];
+      const size_t fmt_size = loc.size [0] < sizeof (fmt) ? (size_t)loc.size [0] : sizeof (fmt);
+      const bool ok = read_at (fd, loc.pos [0], fmt, fmt_size);
+      close (fd);
+      wave_fmt_t f;
+      if (!ok || !wave_fmt_schema_t::decode (fmt, fmt_size, f))
+	{
+	  return eCORRUPT;
+	}
+      unsigned format = f.format;
+      unsigned bits   = f.sample_bits;
+      if (format == wave_fmt_t::eEXTENSIBLE)
+	{
+	  // valid bits at 18, the first two bytes of the GUID at 24
+	  if (fmt_size < 40)
+	    {
+	      return eCORRUPT;
+	    }
+	  const unsigned valid = fmt [18] | (fmt [19] << 8);
+	  format = fmt [24] | (fmt [25] << 8);
+	  bits   = valid ? valid : bits;
+	}
+      if (f.channels == 0 || f.block_align % f.channels != 0)
+	{
+	  return eCORRUPT;
+	}
+      m_format.channels     = f.channels;
+      m_format.sample_bytes = f.block_align / f.channels;
+      m_format.sample_bits  = bits;
+      m_format.sample_rate  = f.sample_rate;
+      m_format.floating     = format == wave_fmt_t::eFLOAT;
+      const unsigned bytes  = m_format.sample_bytes;
+      if ((format != wave_fmt_t::ePCM && format != wave_fmt_t::eFLOAT) ||
+	  bytes == 0 || (bytes > 4 && bytes != 8) || bits == 0 || bits > bytes * 8 ||
+	  (m_format.floating && bytes != 4 && bytes != 8) || f.sample_rate == 0)
+	{
+	  return eUNSUPPORTED;
+	}
+
+      const uint64_t block = f.block_align;
+      const uint64_t data  = loc.size [1] - loc.size [1] % block;
+      m_format.frames = data / block;
+      m_data_bytes    = data;
+
+      // AIFF for plain integers, AIFC for floats and 'sowt'
+      iff_id_t    compression = 0;
+      const char* name        = "";
+      conversion_t how = bytes == 1 ? eFLIP_SIGN : eSWAP;
+      if (m_format.floating)
+	{
+	  compression = bytes == 4 ? "fl32"_id : "fl64"_id;
+	  name        = bytes == 4 ? "32-bit floating point" : "64-bit floating point";
+	}
+      else if (m_sowt && bytes > 1)
+	{
+	  compression = "sowt"_id;
+	  name        = "little-endian";
+	  how         = eCOPY;
+	}
+      // a pascal string padded to an even length
+      const size_t pstring = (strlen (name) + 2) & ~(size_t)1;
+      const size_t comm_size = comm_schema_t::WIRE_SIZE + (compression ? 4 + pstring : 0);
+      const uint64_t form_size = 4 + (compression ? 12 : 0) + 8 + comm_size +
+	8 + 8 + data + (data & 1);
+      if (form_size > 0xFFFFFFFFULL || m_format.frames > 0xFFFFFFFFULL)
+	{
+	  return eTOO_LARGE;
+	}
+
+      comm_t c;
+      c.channels    = (int16_t)m_format.channels;
+      c.frames      = (uint32_t)m_format.frames;
+      c.sample_bits = (int16_t)bits;
+      c.sample_rate = m_format.sample_rate;
+
+      std::vector <uint8_t> header;
+      put_id (header, "FORM"_id);
+      put_32 (header, (uint32_t)form_size, true);
+      put_id (header, compression ? "AIFC"_id : "AIFF"_id);
+      if (compression)
+	{
+	  // the only AIFC version there is
+	  put_id (header, "FVER"_id);
+	  put_32 (header, 4, true);
+	  put_32 (header, 0xA2805140, true);
+	}
+      put_id (header, "COMM"_id);
+      put_32 (header, (uint32_t)comm_size, true);
+      const size_t at = header.size ();
+      header.resize (at + comm_size, 0);
+      comm_schema_t::encode (c, &header [at]);
+      if (compression)
+	{
+	  uint8_t* p = &header [at + comm_schema_t::WIRE_SIZE];
+	  iff::put_be32 (p, compression);
+	  p [4] = (uint8_t)strlen (name);
+	  memcpy (p + 5, name, strlen (name));
+	}
+      put_id (header, "SSND"_id);
+      put_32 (header, (uint32_t)(8 + data), true);
+      put_32 (header, 0, true);
+      put_32 (header, 0, true);
+      return _write (in, loc.pos [1], header, out, how);
+    }
+    // ---------------------------------------------------------------
+    audio_transcoder_c::status_t audio_transcoder_c::_write (const char* in, uint64_t offset,
+							     const std::vector <uint8_t>& header,
+							     const char* out, conversion_t how)
+    {
+      const int in_fd = open (in, O_RDONLY);
+      if (in_fd < 0)
+	{
+	  return eIO_ERROR;
+	}
+      const int out_fd = open (out, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+      if (out_fd < 0)
+	{
+	  close (in_fd);
+	  return eIO_ERROR;
+	}
+      static const uint8_t pad = 0;
+      bool ok = write_all (out_fd, &header [0], header.size ()) &&
+	_stream (in_fd, offset, out_fd, how) &&
+	((m_data_bytes & 1) == 0 || write_all (out_fd, &pad, 1));
+      close (in_fd);
+      ok = close (out_fd) == 0 && ok;
+      if (!ok)
+	{
+	  unlink (out);
+	  return eIO_ERROR;
+	}
+      return eOK;
+    }
+    // ---------------------------------------------------------------
+    bool audio_transcoder_c::_stream (int in, uint64_t offset, int out, conversion_t how)
+    {
+      m_copied = how == eCOPY;
+      if (how == eCOPY)
+	{
+	  return copy_range (in, offset, m_data_bytes, out, &m_method);
+	}
+      m_method = eREAD_WRITE;
+      const unsigned bytes = m_format.sample_bytes;
+      std::vector <uint8_t> buffer (BLOCK_BYTES - BLOCK_BYTES % bytes);
+      for (uint64_t done = 0; done < m_data_bytes; )
+	{
+	  const size_t n = (size_t)(m_data_bytes - done < buffer.size () ? m_data_bytes - done : buffer.size ());
+	  if (!read_at (in, offset + done, &buffer [0], n))
+	    {
+	      return false;
+	    }
+	  if (how == eSWAP)
+	    {
+	      swap_samples (&buffer [0], &buffer [0], n / bytes, bytes, m_isa);
+	    }
+	  else
+	    {
+	      for (size_t i = 0; i < n; i++)
+		{
+		  buffer [i] ^= 0x80;
+		}
+	    }
+	  if (!write_all (out, &buffer [0], n))
+	    {
+	      return false;
+	    }
+	  done += n;
+	}
+      return true;
+    }
+  } // ns codec
+} // ns iff
@@ -0,0 +1,96 @@
+#ifndef __IFF_CODEC_TRANSCODE_HPP__
+#define __IFF_CODEC_TRANSCODE_HPP__
+
+#include <vector>
+#include "core/iff_types.hpp"
+#include "core/copy_range.hpp"
+#include "core/codec/isa.hpp"
+
+namespace iff
+{
+  namespace codec
+  {
+    struct audio_format_t
+    {
+      unsigned channels;
+      uint64_t frames;
+      // significant bits, and the bytes a sample is stored in
+      unsigned sample_bits;
+      unsigned sample_bytes;
+      double   sample_rate;
+      bool     floating;
+    };
+
+    // Converts FORM AIFF / AIFC audio to RIFF WAVE and back.
+    //
+    // Only the headers of the input are read to find COMM and SSND
+    // (fmt and data), the new header is written from them and the
+    // sample data is then streamed: copied by the kernel (see
+    // copy_range ()) when both sides store it alike, as for AIFC
+    // 'sowt' to WAV, otherwise read a block at a time and byte
+    // swapped by swap_samples () (8 bit samples flip their sign
+    // instead, WAV stores them unsigned).
+    //
+    // AIFC inputs may be 'NONE', 'twos', 'sowt', 'raw ', 'fl32' or
+    // 'fl64'; WAV inputs PCM or IEEE float, plain or extensible.
+    // Floating point WAVs become AIFC 'fl32' / 'fl64'. WAVs get a
+    // plain PCM fmt chunk for up to two channels of 8 or 16 bits,
+    // WAVE_FORMAT_EXTENSIBLE otherwise; float WAVs carry a fact chunk.
+    class audio_transcoder_c
+    {
+    public:
+      enum status_t
+	{
+	  eOK,
+	  eIO_ERROR,
+	  // not an AIFF / WAV, or COMM / SSND (fmt / data) missing
+	  eNOT_AUDIO,
+	  // a compression or format without a plain PCM counterpart
+	  eUNSUPPORTED,
+	  eCORRUPT,
+	  // the output would not fit its 32 bit sizes
+	  eTOO_LARGE
+	};
+    public:
+      audio_transcoder_c ();
+
+      void set_isa  (isa_t isa);
+      // wav_to_aiff () writes integer samples of 16 bits and more as
+      // AIFC 'sowt', little endian like the WAV, so they are copied
+      // instead of swapped
+      void set_sowt (bool sowt);
+
+      status_t aiff_to_wav (const char* in, const char* out);
+      status_t wav_to_aiff (const char* in, const char* out);
+
+      // of the last conversion
+      const audio_format_t& format     () const;
+      uint64_t              data_bytes () const;
+      // true if the samples went through unchanged, by method ()
+      bool                  copied     () const;
+      copy_method_t         method     () const;
+
+      static const char* status_name (status_t rc);
+    private:
+      enum conversion_t
+	{
+	  eCOPY,
+	  eSWAP,
+	  eFLIP_SIGN
+	};
+
+      status_t _write (const char* in, uint64_t offset, const std::vector <uint8_t>& header,
+		       const char* out, conversion_t how);
+      bool     _stream (int in, uint64_t offset, int out, conversion_t how);
+    private:
+      isa_t          m_isa;
+      bool           m_sowt;
+      audio_format_t m_format;
+      uint64_t       m_data_bytes;
+      bool           m_copied;
+      copy_method_t  m_method;
+    };
+  } // ns codec
+} // ns iff
+
+#endif
@@ -0,0 +1,135 @@
+#include <errno.h>
+#include <unistd.h>
+#include <vector>
+
+#if defined(__linux__)
+#include <sys/syscall.h>
+#include <sys/sendfile.h>
+#endif
+
+#include "core/copy_range.hpp"
+#include "core/fd_io.hpp"
+
+namespace iff
+{
+#if defined(__linux__)
+  // ---------------------------------------------------------------
+  // through syscall (): older C libraries lack the wrapper
+  static ssize_t sys_copy_file_range (int in_fd, loff_t* in_off, int out_fd, size_t len)
+  {
+#if defined(SYS_copy_file_range)
+    return syscall (SYS_copy_file_range, in_fd, in_off, out_fd, (loff_t*)0, len, 0u);
+#else
+    errno = ENOSYS;
+    return -1;
+#endif
+  }
+  // ---------------------------------------------------------------
+  // the file system or the kind of descriptor does not support it,
+  // as opposed to a real I/O error
+  static bool unsupported (int err)
+  {
+    return err == ENOSYS || err == EXDEV || err == EINVAL || err == EOPNOTSUPP ||
+      err == EBADF || err == ESPIPE;
+  }
+#endif
+  // ---------------------------------------------------------------
+  bool copy_range (int in_fd, uint64_t offset, uint64_t size, int out_fd,
+		   copy_method_t* method)
+  {
+    static const size_t STEP = 1 << 30;
+#if defined(__linux__)
+    bool try_copy     = true;
+    bool try_sendfile = true;
+    while (size > 0)
+      {
+	const size_t step = size < STEP ? (size_t)size : STEP;
+	loff_t       off  = (loff_t)offset;
+	ssize_t      n    = -1;
+	if (try_copy)
+	  {
+	    n = sys_copy_file_range (in_fd, &off, out_fd, step);
+	    if (n < 0 && unsupported (errno))
+	      {
+		try_copy = false;
+		continue;
+	      }
+	    if (method)
+	      {
+		*method = eCOPY_FILE_RANGE;
+	      }
+	  }
+	else if (try_sendfile)
+	  {
+	    n = sendfile (out_fd, in_fd, &off, step);
+	    if (n < 0 && unsupported (errno))
+	      {
+		try_sendfile = false;
+		continue;
+	      }
+	    if (method)
+	      {
+		*method = eSENDFILE;
+	      }
+	  }
+	else
+	  {
+	    break;
+	  }
+	if (n < 0 && errno == EINTR)
+	  {
+	    continue;
+	  }
+	if (n <= 0)
+	  {
+	    // an error, or the input is shorter than it claims
+	    return false;
+	  }
+	offset += (uint64_t)n;
+	size   -= (uint64_t)n;
+      }
+    if (size == 0)
+      {
+	return true;
+      }
+#endif
+    if (method)
+      {
+	*method = eREAD_WRITE;
+      }
+    std::vector <char> buffer (size < (1 << 20) ? (size_t)size : (size_t)(1 << 20));
+    while (size > 0)
+      {
+	const size_t  step = size < buffer.size () ? (size_t)size : buffer.size ();
+	const ssize_t n    = pread (in_fd, &buffer [0], step, (off_t)offset);
+	if (n < 0 && errno == EINTR)
+	  {
+	    continue;
+	  }
+	if (n <= 0)
+	  {
+	    return false;
+	  }
+	if (!write_all (out_fd, &buffer [0], (size_t)n))
+	  {
+	    return false;
+	  }
+	offset += (uint64_t)n;
+	size   -= (uint64_t)n;
+      }
+    return true;
+  }
+  // ---------------------------------------------------------------
+  const char* copy_method_name (copy_method_t method)
+  {
+    switch (method)
+      {
+      case eCOPY_FILE_RANGE:
+	return "copy_file_range";
+      case eSENDFILE:
+	return "sendfile";
+      default:
+	return "read/write";
+      }
+  }
+} // ns iff
@@ -0,0 +1,27 @@
+#ifndef __IFF_CORE_COPY_RANGE_HPP__
+#define __IFF_CORE_COPY_RANGE_HPP__
+
+#include "core/iff_types.hpp"
+
+namespace iff
+{
+  enum copy_method_t
+    {
+      eCOPY_FILE_RANGE,
+      eSENDFILE,
+      eREAD_WRITE
+    };
+
+  // Appends size bytes at offset of in_fd to out_fd at its current
+  // position, leaving in_fd's position alone. The bytes stay in the
+  // kernel when it can: copy_file_range (2) first, which may share
+  // extents on file systems that support it, then sendfile (2), and
+  // pread/write through a user buffer only when neither applies.
+  // method, if given, receives the last method used.
+  bool copy_range (int in_fd, uint64_t offset, uint64_t size, int out_fd,
+		   copy_method_t* method = 0);
+
+  const char* copy_method_name (copy_method_t method);
+} // ns iff
+
+#endif
@@ -0,0 +1,106 @@
+#ifndef __IFF_CORE_DISPATCH_READER_HPP__
+#define __IFF_CORE_DISPATCH_READER_HPP__
+
+#include <vector>
+
+#include "core/generic_iff_reader.hpp"
+#include "core/handler_registry.hpp"
+
+namespace iff
+{
+  // Hands every chunk to the handler bound to its id (and the tag of
+  // any enclosing group, the innermost first) in a compiled registry,
+  // chunks without one cost a lookup. The enclosing tags are gathered
+  // only for ids with bindings to a tag.
+  // The group callbacks and the chunk exit do nothing, subclasses
+  // may override them.
+  template <class IO_POLICY>
+  class dispatch_reader_c : public generic_iff_reader_c <IO_POLICY>
+  {
+    typedef generic_iff_reader_c <IO_POLICY> reader_t;
+  protected:
+    typedef typename reader_t::id_t          id_t;
+  public:
+    // handlers must outlive the reader
+    explicit dispatch_reader_c (const handler_registry_c& handlers);
+  protected:
+    virtual void _on_chunk_enter (const id_t& id, std::streamsize chunk_size, std::streamsize file_pos);
+    virtual void _on_chunk_exit  (const id_t& id, std::streamsize chunk_size, std::streamsize file_pos);
+    virtual void _on_group_enter (const id_t& id, const id_t& tag,
+				  std::streamsize group_size, std::streamsize file_pos);
+    virtual void _on_group_exit  (const id_t& id, const id_t& tag,
+				  std::streamsize group_size, std::streamsize file_pos);
+  private:
+    const handler_registry_c& m_handlers;
+    // tags of the groups enclosing the current chunk, the parent first
+    std::vector <iff_id_t>    m_scope;
+  };
+} // ns iff
+
+// ===================================================
+// Implementation
+// ===================================================
+
+namespace iff
+{
+  template <class IO_POLICY>
+  dispatch_reader_c <IO_POLICY>::dispatch_reader_c (const handler_registry_c& handlers)
+    : m_handlers (handlers)
+  {
+    m_scope.reserve (reader_t::DEFAULT_MAX_DEPTH);
+  }
+  // -------------------------------------------------
+  template <class IO_POLICY>
+  void dispatch_reader_c <IO_POLICY>::_on_chunk_enter (const id_t& id, std::streamsize chunk_size,
+						       std::streamsize file_pos)
+  {
+    const handler_registry_c::slot_t* s = m_handlers.find (id.value ());
+    if (!s)
+      {
+	return;
+      }
+    const size_t depth = this->_depth ();
+    chunk_handler_c* h;
+    if (m_handlers.is_scoped (*s))
+      {
+	m_scope.resize (depth);
+	for (size_t i = 0; i < depth; i++)
+	  {
+	    m_scope [i] = this->_enclosing_tag (i).value ();
+	  }
+	h = m_handlers.match (*s, m_scope.data (), depth);
+      }
+    else
+      {
+	h = m_handlers.match (*s, 0, 0);
+      }
+    if (h)
+      {
+	chunk_event_t ev;
+	ev.parent   = depth ? this->_parent_tag ().value () : 0;
+	ev.id       = id.value ();
+	ev.size     = chunk_size;
+	ev.file_pos = file_pos;
+	h->on_chunk (ev);
+      }
+  }
+  // -------------------------------------------------
+  template <class IO_POLICY>
+  void dispatch_reader_c <IO_POLICY>::_on_chunk_exit (const id_t&, std::streamsize, std::streamsize)
+  {
+  }
+  // -------------------------------------------------
+  template <class IO_POLICY>
+  void dispatch_reader_c <IO_POLICY>::_on_group_enter (const id_t&, const id_t&,
+						       std::streamsize, std::streamsize)
+  {
+  }
+  // -------------------------------------------------
+  template <class IO_POLICY>
+  void dispatch_reader_c <IO_POLICY>::_on_group_exit (const id_t&, const id_t&,
+						      std::streamsize, std::streamsize)
+  {
+  }
+} // ns iff
+
+#endif
@@ -0,0 +1,262 @@
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include <sstream>
+
+#include "core/ea/container.hpp"
+#include "core/ea/ea_io.hpp"
+#include "core/fd_io.hpp"
+
+static const uint64_t MAX_SIZE = 0xFFFFFFFFULL;
+
+// ---------------------------------------------------------------------
+static bool file_size (int fd, uint64_t& size)
+{
+  struct stat st;
+  if (fstat (fd, &st) != 0)
+    {
+      return false;
+    }
+  size = (uint64_t)st.st_size;
+  return true;
+}
+
+namespace iff
+{
+  namespace ea
+  {
+    container_builder_c::container_builder_c ()
+      : m_fd         (-1),
+	m_size       (0),
+	m_children   (0),
+	m_derive_tag (false)
+    {
+    }
+    // -----------------------------------------------------------------
+    container_builder_c::~container_builder_c ()
+    {
+      if (m_fd >= 0)
+	{
+	  close (m_fd);
+	}
+    }
+    // -----------------------------------------------------------------
+    container_builder_c::status_t container_builder_c::open (const char* path, const id_c& id,
+							     const id_c& tag)
+    {
+      if (m_fd >= 0)
+	{
+	  close (m_fd);
+	}
+      m_fd = ::open (path, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+      if (m_fd < 0)
+	{
+	  return eIO_ERROR;
+	}
+      // the size is patched by finish ()
+      uint8_t hdr [12];
+      put_be32 (hdr, id.value ());
+      put_be32 (hdr + 4, 0);
+      put_be32 (hdr + 8, tag.value ());
+      m_size       = 4;
+      m_children   = 0;
+      m_tag        = tag;
+      m_derive_tag = tag == id_c ();
+      return write_all (m_fd, hdr, sizeof (hdr)) ? eOK : eIO_ERROR;
+    }
+    // -----------------------------------------------------------------
+    container_builder_c::status_t container_builder_c::append (const char* path)
+    {
+      if (m_fd < 0)
+	{
+	  return eIO_ERROR;
+	}
+      const int in = ::open (path, O_RDONLY);
+      if (in < 0)
+	{
+	  return eIO_ERROR;
+	}
+      uint8_t  hdr [12];
+      uint64_t have = 0;
+      status_t rc   = eOK;
+      if (!file_size (in, have))
+	{
+	  rc = eIO_ERROR;
+	}
+      else if (have < sizeof (hdr) || !read_at (in, 0, hdr, sizeof (hdr)))
+	{
+	  rc = eNOT_IFF;
+	}
+      else
+	{
+	  const uint64_t size = be32 (hdr + 4);
+	  const uint64_t pad  = size & 1;
+	  if (!io_c::is_group (id_c (be32 (hdr))) || size < 4 || 8 + size > have)
+	    {
+	      rc = eNOT_IFF;
+	    }
+	  else if (m_size + 8 + size + pad > MAX_SIZE)
+	    {
+	      rc = eTOO_LARGE;
+	    }
+	  else if (!copy_range (in, 0, 8 + size, m_fd) ||
+		   (pad && !write_all (m_fd, "", 1)))
+	    {
+	      rc = eIO_ERROR;
+	    }
+	  else
+	    {
+	      const id_c tag (be32 (hdr + 8));
+	      if (m_derive_tag)
+		{
+		  m_tag = m_children == 0 || m_tag == tag ? tag : "    "_id;
+		}
+	      m_size += 8 + size + pad;
+	      m_children++;
+	    }
+	}
+      close (in);
+      return rc;
+    }
+    // -----------------------------------------------------------------
+    container_builder_c::status_t container_builder_c::finish ()
+    {
+      if (m_fd < 0)
+	{
+	  return eIO_ERROR;
+	}
+      uint8_t hdr [8];
+      put_be32 (hdr, (uint32_t)m_size);
+      put_be32 (hdr + 4, m_children || !m_derive_tag ? m_tag.value () : ("    "_id).value ());
+      const bool ok = write_at (m_fd, 4, hdr, 8);
+      const bool closed = close (m_fd) == 0;
+      m_fd = -1;
+      return ok && closed ? eOK : eIO_ERROR;
+    }
+    // -----------------------------------------------------------------
+    uint64_t container_builder_c::size () const
+    {
+      return 8 + m_size;
+    }
+    // -----------------------------------------------------------------
+    unsigned container_builder_c::children () const
+    {
+      return m_children;
+    }
+    // =================================================================
+    bool list_range (int fd, uint64_t& pos, uint64_t end,
+		     std::vector <container_child_t>& items, size_t max)
+    {
+      uint8_t hdr [12];
+      for (size_t n = 0; n < max && pos + 8 <= end; n++)
+	{
+	  if (!read_at (fd, pos, hdr, 8))
+	    {
+	      return false;
+	    }
+	  container_child_t c;
+	  c.id     = id_c (be32 (hdr));
+	  c.tag    = c.id;
+	  c.offset = pos;
+	  c.size   = 8 + (uint64_t)be32 (hdr + 4);
+	  if (c.size > end - pos)
+	    {
+	      return false;
+	    }
+	  if (io_c::is_group (c.id))
+	    {
+	      if (c.size < 12 || !read_at (fd, pos + 8, hdr + 8, 4))
+		{
+		  return false;
+		}
+	      c.tag = id_c (be32 (hdr + 8));
+	    }
+	  items.push_back (c);
+	  pos += c.size + (c.size & 1);
+	}
+      return true;
+    }
+    // -----------------------------------------------------------------
+    static bool list_children (int fd, id_c& id, id_c& tag,
+			       std::vector <container_child_t>& children)
+    {
+      uint64_t have;
+      uint8_t  hdr [12];
+      if (!file_size (fd, have) || !read_at (fd, 0, hdr, sizeof (hdr)))
+	{
+	  return false;
+	}
+      id  = id_c (be32 (hdr));
+      tag = id_c (be32 (hdr + 8));
+      const uint64_t size = be32 (hdr + 4);
+      if ((id != "CAT "_id && id != "LIST"_id) || size < 4 || 8 + size > have)
+	{
+	  return false;
+	}
+      uint64_t pos = 12;
+      return list_range (fd, pos, 8 + size, children);
+    }
+    // -----------------------------------------------------------------
+    bool list_container (const char* path, id_c& id, id_c& tag,
+			 std::vector <container_child_t>& children)
+    {
+      const int fd = ::open (path, O_RDONLY);
+      if (fd < 0)
+	{
+	  return false;
+	}
+      const bool ok = list_children (fd, id, tag, children);
+      close (fd);
+      return ok;
+    }
+    // -----------------------------------------------------------------
+    std::string id_file_name (const id_c& id)
+    {
+      std::string s = id.to_string ();
+      for (size_t i = 0; i < s.size (); i++)
+	{
+	  const char c = s [i];
+	  if (!((c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9')))
+	    {
+	      s [i] = '_';
+	    }
+	}
+      return s;
+    }
+    // -----------------------------------------------------------------
+    bool split_container (const char* path, const std::string& prefix,
+			  std::vector <std::string>* written)
+    {
+      const int fd = ::open (path, O_RDONLY);
+      if (fd < 0)
+	{
+	  return false;
+	}
+      id_c id, tag;
+      std::vector <container_child_t> children;
+      bool ok = list_children (fd, id, tag, children);
+      for (size_t i = 0; ok && i < children.size (); i++)
+	{
+	  std::ostringstream name;
+	  name << prefix << i << "." << id_file_name (children [i].tag);
+	  const int out = ::open (name.str ().c_str (), O_WRONLY | O_CREAT | O_TRUNC, 0666);
+	  if (out < 0)
+	    {
+	      ok = false;
+	      break;
+	    }
+	  // a child file is padded like the child was
+	  ok = copy_range (fd, children [i].offset, children [i].size, out) &&
+	    (!(children [i].size & 1) || write_all (out, "", 1));
+	  ok = close (out) == 0 && ok;
+	  if (written)
+	    {
+	      written->push_back (name.str ());
+	    }
+	}
+      close (fd);
+      return ok;
+    }
+  } // ns ea
+} // ns iff
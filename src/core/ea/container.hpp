@@ -0,0 +1,96 @@
+#ifndef __IFF_CORE_EA_CONTAINER_HPP__
+#define __IFF_CORE_EA_CONTAINER_HPP__
+
+#include <string>
+#include <vector>
+
+#include "core/iff_types.hpp"
+#include "core/copy_range.hpp"
+#include "core/ea/id.hpp"
+
+namespace iff
+{
+  namespace ea
+  {
+    // Packs IFF files into one CAT or LIST. Every file's root group is
+    // copied as it is, kernel side (see copy_range ()); only its header
+    // is read. Odd sized groups are padded and the container size is
+    // patched in by finish (), so the output must be a regular file.
+    class container_builder_c
+    {
+    public:
+      enum status_t
+	{
+	  eOK,
+	  eIO_ERROR,
+	  // the file does not start with a group, or claims more bytes
+	  // than it has
+	  eNOT_IFF,
+	  // the container would exceed 4G
+	  eTOO_LARGE
+	};
+    public:
+      container_builder_c ();
+      ~container_builder_c ();
+
+      // id is CAT or LIST, tag the type of the contents. With no tag
+      // (id_c ()) finish () writes the type the children share, or
+      // "    " if they differ.
+      status_t open    (const char* path, const id_c& id, const id_c& tag = id_c ());
+      status_t append  (const char* path);
+      status_t finish  ();
+
+      uint64_t size     () const;
+      unsigned children () const;
+    private:
+      container_builder_c (const container_builder_c&);
+      container_builder_c& operator = (const container_builder_c&);
+    private:
+      int      m_fd;
+      uint64_t m_size;
+      unsigned m_children;
+      id_c     m_tag;
+      bool     m_derive_tag;
+    };
+
+    // ---------------------------------------------------------------
+    // one child of a container, or any item of a group
+    struct container_child_t
+    {
+      id_c     id;
+      // the group type, the id for chunks
+      id_c     tag;
+      // of the child's header
+      uint64_t offset;
+      // header included, pad byte excluded
+      uint64_t size;
+    };
+
+    // The children of the container at the root of path, from their
+    // headers only. False if the file does not start with a CAT or
+    // LIST, or a child runs past it.
+    bool list_container (const char* path, id_c& id, id_c& tag,
+			 std::vector <container_child_t>& children);
+
+    // Lists up to max items of the range [pos, end) of an open file
+    // from their headers only and advances pos past them; the children
+    // of a group are the range from 12 bytes past its header to its
+    // end. Listing is done when pos + 8 > end. False if an item runs
+    // past end or a header cannot be read, pos is left at that item.
+    bool list_range (int fd, uint64_t& pos, uint64_t end,
+		     std::vector <container_child_t>& items, size_t max = (size_t)-1);
+
+    // id as part of a file name: ids may hold spaces and other
+    // characters file names should not, anything but letters and
+    // digits becomes '_'
+    std::string id_file_name (const id_c& id);
+
+    // Writes every child of the container at path to its own file,
+    // prefix + "<n>.<ID or group type>", copying kernel side. The names
+    // written are appended to written.
+    bool split_container (const char* path, const std::string& prefix,
+			  std::vector <std::string>* written = 0);
+  } // ns ea
+} // ns iff
+
+#endif
@@ -68,23 +68,15 @@ namespace iff
     // -----------------------------------------------------------------
     bool io_c::is_group (const id_c& id)
     {
-      static const id_c FORM ('F', 'O', 'R', 'M');
-      static const id_c LIST ('L', 'I', 'S', 'T');
-      static const id_c CAT  ('C', 'A', 'T', ' ');
-      
-      if (id == FORM)
-	{
-	  return true;
-	}
-      if (id == LIST)
-	{
-	  return true;
-	}
-      if (id == CAT)
+      switch (id)
 	{
+	case "FORM"_id:
+	case "LIST"_id:
+	case "CAT "_id:
 	  return true;
+	default:
+	  return false;
 	}
-      return false;
     }
     // -----------------------------------------------------------------
     std::streamsize io_c::real_size (size_type_t size)
@@ -137,5 +129,10 @@ namespace iff
     {
       return sizeof (word_t);
     }
+    // -----------------------------------------------------------------
+    std::streamsize io_c::size_of_header ()
+    {
+      return 2 * sizeof (word_t);
+    }
   } // ns ea
 } // ne iff
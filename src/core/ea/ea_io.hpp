@@ -23,6 +23,7 @@ namespace iff
 
       static std::streamsize real_size (size_type_t size);
       static std::streamsize size_of_id ();
+      static std::streamsize size_of_header ();
 
       static bool read_group_header (std::istream& is, id_t& id, size_type_t& size, 
 				     std::streamsize& total_size);
@@ -0,0 +1,71 @@
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "core/ea/extract.hpp"
+
+namespace iff
+{
+  namespace ea
+  {
+    extractor_c::collector_c::collector_c ()
+      : refs (0)
+    {
+    }
+    // -----------------------------------------------------------------
+    void extractor_c::collector_c::on_chunk (const chunk_event_t& ev)
+    {
+      chunk_ref_t r;
+      r.parent = ev.parent;
+      r.id     = ev.id;
+      r.offset = (uint64_t)ev.file_pos;
+      r.size   = (uint64_t)ev.size;
+      refs->push_back (r);
+    }
+    // =================================================================
+    extractor_c::extractor_c ()
+      : m_reader   (m_handlers),
+	m_compiled (false)
+    {
+    }
+    // -----------------------------------------------------------------
+    void extractor_c::select (iff_id_t parent, iff_id_t id)
+    {
+      m_handlers.bind (parent, id, &m_collector);
+      m_compiled = false;
+    }
+    // -----------------------------------------------------------------
+    extractor_c::status_t extractor_c::locate (const char* path, std::vector <chunk_ref_t>& refs)
+    {
+      if (!m_compiled)
+	{
+	  m_handlers.compile ();
+	  m_compiled = true;
+	}
+      refs.clear ();
+      m_collector.refs = &refs;
+      status_t rc = m_reader.open (path);
+      if (rc == m_reader.eOK)
+	{
+	  rc = m_reader.read ();
+	}
+      return rc;
+    }
+    // -----------------------------------------------------------------
+    bool extractor_c::extract (int in_fd, const chunk_ref_t& ref, const std::string& out_path,
+			       copy_method_t* method)
+    {
+      const int out = open (out_path.c_str (), O_WRONLY | O_CREAT | O_TRUNC, 0666);
+      if (out < 0)
+	{
+	  return false;
+	}
+      const bool ok = copy_range (in_fd, ref.offset, ref.size, out, method);
+      if (close (out) != 0 || !ok)
+	{
+	  unlink (out_path.c_str ());
+	  return false;
+	}
+      return true;
+    }
+  } // ns ea
+} // ns iff
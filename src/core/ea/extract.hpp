@@ -0,0 +1,69 @@
+#ifndef __IFF_CORE_EA_EXTRACT_HPP__
+#define __IFF_CORE_EA_EXTRACT_HPP__
+
+#include <string>
+#include <vector>
+
+#include "core/handler_registry.hpp"
+#include "core/dispatch_reader.hpp"
+#include "core/copy_range.hpp"
+#include "core/ea/ea_io.hpp"
+
+namespace iff
+{
+  namespace ea
+  {
+    // a chunk payload in a file, offset as in the reader callbacks
+    struct chunk_ref_t
+    {
+      iff_id_t parent;
+      iff_id_t id;
+      uint64_t offset;
+      uint64_t size;
+    };
+
+    // Exports chunk payloads to standalone files. locate () finds the
+    // chunks matching the selectors with the reader, which reads
+    // headers only; extract () then has the kernel copy each payload
+    // (see copy_range ()), so no payload passes through user space
+    // when the platform can avoid it.
+    //
+    // An extractor is not thread safe, batch jobs use one per thread.
+    class extractor_c
+    {
+    public:
+      typedef dispatch_reader_c <io_c> reader_t;
+      typedef reader_t::status_t        status_t;
+    public:
+      extractor_c ();
+
+      // parent handler_registry_c::ANY for chunks in any group
+      void select (iff_id_t parent, iff_id_t id);
+
+      // the selected chunks of path in file order
+      status_t locate (const char* path, std::vector <chunk_ref_t>& refs);
+
+      // writes the payload of ref from in_fd to a new file out_path
+      static bool extract (int in_fd, const chunk_ref_t& ref, const std::string& out_path,
+			   copy_method_t* method = 0);
+    private:
+      class collector_c : public chunk_handler_c
+      {
+      public:
+	collector_c ();
+	virtual void on_chunk (const chunk_event_t& ev);
+	std::vector <chunk_ref_t>* refs;
+      };
+    private:
+      extractor_c (const extractor_c&);
+      extractor_c& operator = (const extractor_c&);
+    private:
+      collector_c             m_collector;
+      handler_registry_c      m_handlers;
+      reader_t                m_reader;
+      bool                    m_compiled;
+    };
+  } // ns ea
+} // ns iff
+
+#endif
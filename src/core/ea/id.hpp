@@ -8,42 +8,76 @@
 #ifndef __IFF_CORE_EA_ID_HPP__
 #define __IFF_CORE_EA_ID_HPP__
 
-#include <iostream>
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <stdexcept>
 #include "core/iff_types.hpp"
 
 namespace iff
 {
   namespace ea
   {
-    class id_c;
-
-    bool operator == (const id_c& a, const id_c& b);
-    bool operator != (const id_c& a, const id_c& b);
-    bool operator <  (const id_c& a, const id_c& b);
-    bool operator <= (const id_c& a, const id_c& b);
-    bool operator >  (const id_c& a, const id_c& b);
-    bool operator >= (const id_c& a, const id_c& b);
-
+    // Four character code. Literal type: ids are compile time
+    // constants and, through the implicit conversion to iff_id_t,
+    // switch labels and operands of the built-in comparisons.
+    //
+    //   switch (id)
+    //     {
+    //     case "FORM"_id:
+    //     case "LIST"_id:
+    //     ...
     class id_c
     {
-      friend bool operator == (const id_c& a, const id_c& b);
-      friend bool operator != (const id_c& a, const id_c& b);
-      friend bool operator <  (const id_c& a, const id_c& b);
-      friend bool operator <= (const id_c& a, const id_c& b);
-      friend bool operator >  (const id_c& a, const id_c& b);
-      friend bool operator >= (const id_c& a, const id_c& b);
-
     public:
-      id_c () {}
-      id_c(char a, char b, char c, char d);
-      ~id_c();
-      id_c (iff_id_t id);
-      
-      std::string to_string () const;
+      constexpr id_c ()
+	: m_id (0)
+      {
+      }
+      constexpr id_c (char a, char b, char c, char d)
+	: m_id (((iff_id_t)(unsigned char)a << 24) | ((iff_id_t)(unsigned char)b << 16) |
+		((iff_id_t)(unsigned char)c << 8)  |  (iff_id_t)(unsigned char)d)
+      {
+      }
+      constexpr id_c (iff_id_t id)
+	: m_id (id)
+      {
+      }
+
+      constexpr operator iff_id_t () const
+      {
+	return m_id;
+      }
+      constexpr iff_id_t value () const
+      {
+	return m_id;
+      }
+      // ends at the first NUL byte
+      std::string to_string () const
+      {
+	const char h [] = { (char)(m_id >> 24), (char)(m_id >> 16), (char)(m_id >> 8), (char)m_id, 0 };
+	return std::string (h);
+      }
     private:
       iff_id_t m_id;
     };
 
+    // the four characters, not the number the conversion would print
+    inline std::ostream& operator << (std::ostream& os, const id_c& id)
+    {
+      return os << id.to_string ();
+    }
+
+    inline namespace literals
+    {
+      // "FORM"_id; anything but four characters does not compile
+      // where a constant is required and throws otherwise
+      constexpr id_c operator "" _id (const char* s, std::size_t n)
+      {
+	return n == 4 ? id_c (s [0], s [1], s [2], s [3])
+	  : throw std::length_error ("an IFF id has four characters");
+      }
+    } // ns literals
   } // ns ea
 } // ns iff
 #endif 
@@ -0,0 +1,223 @@
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "core/ea/patch.hpp"
+#include "core/ea/ea_io.hpp"
+#include "core/fd_io.hpp"
+
+static const uint64_t MAX_SIZE   = 0xFFFFFFFFULL;
+static const size_t   BLOCK_SIZE = 1 << 20;
+
+namespace iff
+{
+  namespace ea
+  {
+    patcher_c::patcher_c ()
+      : m_fd        (-1),
+	m_file_size (0),
+	m_moved     (0)
+    {
+    }
+    // -----------------------------------------------------------------
+    patcher_c::~patcher_c ()
+    {
+      close ();
+    }
+    // -----------------------------------------------------------------
+    patcher_c::status_t patcher_c::open (const char* path)
+    {
+      close ();
+      m_fd = ::open (path, O_RDWR);
+      if (m_fd < 0)
+	{
+	  return eIO_ERROR;
+	}
+      struct stat st;
+      if (fstat (m_fd, &st) != 0)
+	{
+	  close ();
+	  return eIO_ERROR;
+	}
+      m_file_size = (uint64_t)st.st_size;
+      return eOK;
+    }
+    // -----------------------------------------------------------------
+    void patcher_c::close ()
+    {
+      if (m_fd >= 0)
+	{
+	  ::close (m_fd);
+	  m_fd = -1;
+	}
+    }
+    // -----------------------------------------------------------------
+    uint64_t patcher_c::file_size () const
+    {
+      return m_file_size;
+    }
+    // -----------------------------------------------------------------
+    uint64_t patcher_c::bytes_moved () const
+    {
+      return m_moved;
+    }
+    // -----------------------------------------------------------------
+    patcher_c::status_t patcher_c::replace (uint64_t chunk_pos, const void* data, uint64_t size)
+    {
+      m_moved = 0;
+      if (m_fd < 0)
+	{
+	  return eIO_ERROR;
+	}
+      if (size > MAX_SIZE)
+	{
+	  return eTOO_LARGE;
+	}
+      std::vector <size_field_t> path;
+      const status_t rc = _locate (chunk_pos, path);
+      if (rc != eOK)
+	{
+	  return rc;
+	}
+      // the last entry is the chunk itself
+      const uint64_t old_padded = path.back ().size + (path.back ().size & 1);
+      const uint64_t new_padded = size + (size & 1);
+      const int64_t  delta      = (int64_t)new_padded - (int64_t)old_padded;
+      for (size_t i = 0; i + 1 < path.size (); i++)
+	{
+	  if ((int64_t)path [i].size + delta > (int64_t)MAX_SIZE)
+	    {
+	      return eTOO_LARGE;
+	    }
+	}
+
+      if (delta != 0 && !_shift (chunk_pos + old_padded, delta))
+	{
+	  return eIO_ERROR;
+	}
+      static const uint8_t pad = 0;
+      if (!_write (chunk_pos, data, (size_t)size) ||
+	  ((size & 1) && !_write (chunk_pos + size, &pad, 1)) ||
+	  !_write_size (path.back ().pos, size))
+	{
+	  return eIO_ERROR;
+	}
+      if (delta != 0)
+	{
+	  for (size_t i = 0; i + 1 < path.size (); i++)
+	    {
+	      if (!_write_size (path [i].pos, (uint64_t)((int64_t)path [i].size + delta)))
+		{
+		  return eIO_ERROR;
+		}
+	    }
+	}
+      return eOK;
+    }
+    // -----------------------------------------------------------------
+    // Descends from the root into the groups that contain chunk_pos,
+    // skipping their other children by their headers.
+    patcher_c::status_t patcher_c::_locate (uint64_t chunk_pos, std::vector <size_field_t>& path)
+    {
+      uint64_t pos = 0;
+      uint64_t end = m_file_size;
+      while (pos + 8 <= end)
+	{
+	  uint8_t hdr [8];
+	  if (!_read (pos, hdr, 8))
+	    {
+	      return eIO_ERROR;
+	    }
+	  const id_c     id (be32 (hdr));
+	  const uint32_t size = be32 (hdr + 4);
+	  const uint64_t data = pos + 8;
+	  if (size > end - data)
+	    {
+	      return eCORRUPT;
+	    }
+	  size_field_t f;
+	  f.pos  = pos + 4;
+	  f.size = size;
+	  if (io_c::is_group (id))
+	    {
+	      if (chunk_pos > data && chunk_pos < data + size)
+		{
+		  if (size < 4)
+		    {
+		      return eCORRUPT;
+		    }
+		  path.push_back (f);
+		  pos = data + 4;
+		  end = data + size;
+		  continue;
+		}
+	    }
+	  else if (data == chunk_pos)
+	    {
+	      path.push_back (f);
+	      return eOK;
+	    }
+	  if (chunk_pos < data)
+	    {
+	      break;
+	    }
+	  pos = data + size + (size & 1);
+	}
+      return eNOT_FOUND;
+    }
+    // -----------------------------------------------------------------
+    // Moves [from, eof) by delta bytes, back to front when growing so
+    // nothing is overwritten before it is copied.
+    bool patcher_c::_shift (uint64_t from, int64_t delta)
+    {
+      // a file missing its final pad byte has nothing to move
+      const uint64_t tail     = from < m_file_size ? m_file_size - from : 0;
+      const uint64_t new_size = (uint64_t)((int64_t)(from + tail) + delta);
+      std::vector <uint8_t> buffer (tail < BLOCK_SIZE ? (size_t)tail + 1 : BLOCK_SIZE);
+      uint64_t done = 0;
+      while (done < tail)
+	{
+	  const size_t   n   = tail - done < buffer.size () ? (size_t)(tail - done) : buffer.size ();
+	  const uint64_t src = delta > 0 ? from + tail - done - n : from + done;
+	  if (!_read (src, &buffer [0], n) ||
+	      !_write ((uint64_t)((int64_t)src + delta), &buffer [0], n))
+	    {
+	      return false;
+	    }
+	  done += n;
+	}
+      m_moved = tail;
+      if (delta < 0 && ftruncate (m_fd, (off_t)new_size) != 0)
+	{
+	  return false;
+	}
+      m_file_size = new_size;
+      return true;
+    }
+    // -----------------------------------------------------------------
+    bool patcher_c::_read (uint64_t pos, void* data, size_t size)
+    {
+      return read_at (m_fd, pos, data, size);
+    }
+    // -----------------------------------------------------------------
+    bool patcher_c::_write (uint64_t pos, const void* data, size_t size)
+    {
+      if (!write_at (m_fd, pos, data, size))
+	{
+	  return false;
+	}
+      if (pos + size > m_file_size)
+	{
+	  m_file_size = pos + size;
+	}
+      return true;
+    }
+    // -----------------------------------------------------------------
+    bool patcher_c::_write_size (uint64_t pos, uint64_t size)
+    {
+      uint8_t b [4];
+      put_be32 (b, (uint32_t)size);
+      return _write (pos, b, 4);
+    }
+  } // ns ea
+} // ns iff
@@ -0,0 +1,75 @@
+#ifndef __IFF_CORE_EA_PATCH_HPP__
+#define __IFF_CORE_EA_PATCH_HPP__
+
+#include <vector>
+#include "core/iff_types.hpp"
+#include "core/ea/id.hpp"
+
+namespace iff
+{
+  namespace ea
+  {
+    // Rewrites the payload of one chunk of an EA IFF file in place.
+    //
+    // A payload of the same padded size overwrites the old one and its
+    // size field. Otherwise only the bytes after the chunk move, by the
+    // difference of the padded sizes, and the file grows or is
+    // truncated; the size of every enclosing group is adjusted by the
+    // same difference, which also covers a payload that only changes
+    // its pad byte (odd to even length).
+    //
+    // Locating the chunk reads the headers of the groups on its path
+    // and of their children before it, never a payload, so a patch
+    // costs what moves plus a few headers, whatever the file size.
+    class patcher_c
+    {
+    public:
+      enum status_t
+	{
+	  eOK,
+	  eIO_ERROR,
+	  // no chunk has its data at the given offset
+	  eNOT_FOUND,
+	  eCORRUPT,
+	  // a size would not fit its 32 bit field
+	  eTOO_LARGE
+	};
+    public:
+      patcher_c ();
+      ~patcher_c ();
+
+      status_t open  (const char* path);
+      void     close ();
+
+      // chunk_pos is the offset of the chunk data, as reported by the
+      // reader callbacks and index records
+      status_t replace (uint64_t chunk_pos, const void* data, uint64_t size);
+
+      uint64_t file_size   () const;
+      // bytes shifted by the last replace ()
+      uint64_t bytes_moved () const;
+    private:
+      patcher_c (const patcher_c&);
+      patcher_c& operator = (const patcher_c&);
+
+      // position and value of a size field on the path to a chunk
+      struct size_field_t
+      {
+	uint64_t pos;
+	uint32_t size;
+      };
+
+      status_t _locate (uint64_t chunk_pos, std::vector <size_field_t>& path);
+      bool     _shift  (uint64_t from, int64_t delta);
+      bool     _read   (uint64_t pos, void* data, size_t size);
+      bool     _write  (uint64_t pos, const void* data, size_t size);
+      bool     _write_size (uint64_t pos, uint64_t size);
+    private:
+      int      m_fd;
+      uint64_t m_file_size;
+      uint64_t m_moved;
+    };
+  } // ns ea
+} // ns iff
+
+#endif
@@ -0,0 +1,159 @@
+#include "core/ea/writer.hpp"
+#include "core/iff_io.hpp"
+
+static const std::streamsize MAX_SIZE = 0xFFFFFFFFLL;
+
+namespace iff
+{
+  namespace ea
+  {
+    writer_c::writer_c (std::ostream& os)
+      : m_os   (os),
+	m_good (os.good ())
+    {
+    }
+    // -----------------------------------------------------------------
+    writer_c::~writer_c ()
+    {
+    }
+    // -----------------------------------------------------------------
+    bool writer_c::begin_group (const id_c& id, const id_c& tag)
+    {
+      if (!m_good)
+	{
+	  return false;
+	}
+      frame_t f;
+      f.size_pos = m_os.tellp () + std::streamoff (4);
+      f.size     = 4;
+      f.is_group = true;
+      if (!_write_header (id, 0))
+	{
+	  return false;
+	}
+      write_32 (m_os, tag.value (), eBIG_ENDIAN);
+      m_stack.push_back (f);
+      return m_good = m_os.good ();
+    }
+    // -----------------------------------------------------------------
+    bool writer_c::begin_chunk (const id_c& id)
+    {
+      if (!m_good)
+	{
+	  return false;
+	}
+      if (!m_stack.empty () && !m_stack.back ().is_group)
+	{
+	  // chunks do not nest
+	  return m_good = false;
+	}
+      frame_t f;
+      f.size_pos = m_os.tellp () + std::streamoff (4);
+      f.size     = 0;
+      f.is_group = false;
+      if (!_write_header (id, 0))
+	{
+	  return false;
+	}
+      m_stack.push_back (f);
+      return true;
+    }
+    // -----------------------------------------------------------------
+    bool writer_c::write (const void* data, std::streamsize size)
+    {
+      if (!m_good || m_stack.empty () || m_stack.back ().is_group)
+	{
+	  return m_good = false;
+	}
+      frame_t& f = m_stack.back ();
+      if (f.size + size > MAX_SIZE)
+	{
+	  return m_good = false;
+	}
+      m_os.write ((const char*)data, size);
+      f.size += size;
+      return m_good = m_os.good ();
+    }
+    // -----------------------------------------------------------------
+    bool writer_c::end ()
+    {
+      if (!m_good || m_stack.empty ())
+	{
+	  return m_good = false;
+	}
+      const frame_t f = m_stack.back ();
+      m_stack.pop_back ();
+      if (f.size & 1)
+	{
+	  m_os.put (0);
+	}
+      const std::streampos here = m_os.tellp ();
+      m_os.seekp (f.size_pos);
+      write_32 (m_os, (uint32_t)f.size, eBIG_ENDIAN);
+      m_os.seekp (here);
+      if (!m_os.good ())
+	{
+	  return m_good = false;
+	}
+      return _account (8 + f.size + (f.size & 1));
+    }
+    // -----------------------------------------------------------------
+    bool writer_c::chunk (const id_c& id, const void* data, std::streamsize size)
+    {
+      if (!m_good || size > MAX_SIZE)
+	{
+	  return m_good = false;
+	}
+      if (!m_stack.empty () && !m_stack.back ().is_group)
+	{
+	  return m_good = false;
+	}
+      if (!_write_header (id, (uint32_t)size))
+	{
+	  return false;
+	}
+      m_os.write ((const char*)data, size);
+      if (size & 1)
+	{
+	  m_os.put (0);
+	}
+      if (!m_os.good ())
+	{
+	  return m_good = false;
+	}
+      return _account (8 + size + (size & 1));
+    }
+    // -----------------------------------------------------------------
+    unsigned writer_c::depth () const
+    {
+      return (unsigned)m_stack.size ();
+    }
+    // -----------------------------------------------------------------
+    bool writer_c::good () const
+    {
+      return m_good;
+    }
+    // -----------------------------------------------------------------
+    bool writer_c::_write_header (const id_c& id, uint32_t size)
+    {
+      write_32 (m_os, id.value (), eBIG_ENDIAN);
+      write_32 (m_os, size, eBIG_ENDIAN);
+      return m_good = m_os.good ();
+    }
+    // -----------------------------------------------------------------
+    bool writer_c::_account (std::streamsize bytes)
+    {
+      if (m_stack.empty ())
+	{
+	  return true;
+	}
+      frame_t& parent = m_stack.back ();
+      if (parent.size + bytes > MAX_SIZE)
+	{
+	  return m_good = false;
+	}
+      parent.size += bytes;
+      return true;
+    }
+  } // ns ea
+} // ns iff
@@ -0,0 +1,49 @@
+#ifndef __IFF_CORE_EA_WRITER_HPP__
+#define __IFF_CORE_EA_WRITER_HPP__
+
+#include <iostream>
+#include <vector>
+#include "core/iff_types.hpp"
+#include "core/ea/id.hpp"
+
+namespace iff
+{
+  namespace ea
+  {
+    // Streaming EA IFF writer. Groups and chunks opened with begin_*
+    // are closed with end (), which pads odd payloads and backpatches
+    // the size field, so the stream must be seekable. chunk () writes
+    // a chunk whose size is known up front without any seeking.
+    class writer_c
+    {
+    public:
+      explicit writer_c (std::ostream& os);
+      ~writer_c ();
+
+      bool begin_group (const id_c& id, const id_c& tag);
+      bool begin_chunk (const id_c& id);
+      bool write       (const void* data, std::streamsize size);
+      bool end         ();
+
+      bool chunk       (const id_c& id, const void* data, std::streamsize size);
+
+      unsigned depth () const;
+      bool     good  () const;
+    private:
+      bool _write_header (const id_c& id, uint32_t size);
+      bool _account      (std::streamsize bytes);
+    private:
+      struct frame_t
+      {
+	std::streampos  size_pos;
+	std::streamsize size;
+	bool            is_group;
+      };
+      std::ostream&         m_os;
+      std::vector <frame_t> m_stack;
+      bool                  m_good;
+    };
+  } // ns ea
+} // ns iff
+
+#endif
@@ -0,0 +1,69 @@
+#include <errno.h>
+#include <unistd.h>
+
+#include "core/fd_io.hpp"
+
+namespace iff
+{
+  bool read_at (int fd, uint64_t pos, void* data, size_t size)
+  {
+    uint8_t* p = (uint8_t*)data;
+    while (size)
+      {
+	const ssize_t n = pread (fd, p, size, (off_t)pos);
+	if (n < 0 && errno == EINTR)
+	  {
+	    continue;
+	  }
+	if (n <= 0)
+	  {
+	    return false;
+	  }
+	p    += n;
+	pos  += (uint64_t)n;
+	size -= (size_t)n;
+      }
+    return true;
+  }
+  // -----------------------------------------------------------------------
+  bool write_at (int fd, uint64_t pos, const void* data, size_t size)
+  {
+    const uint8_t* p = (const uint8_t*)data;
+    while (size)
+      {
+	const ssize_t n = pwrite (fd, p, size, (off_t)pos);
+	if (n < 0 && errno == EINTR)
+	  {
+	    continue;
+	  }
+	if (n <= 0)
+	  {
+	    return false;
+	  }
+	p    += n;
+	pos  += (uint64_t)n;
+	size -= (size_t)n;
+      }
+    return true;
+  }
+  // -----------------------------------------------------------------------
+  bool write_all (int fd, const void* data, size_t size)
+  {
+    const uint8_t* p = (const uint8_t*)data;
+    while (size)
+      {
+	const ssize_t n = ::write (fd, p, size);
+	if (n < 0 && errno == EINTR)
+	  {
+	    continue;
+	  }
+	if (n <= 0)
+	  {
+	    return false;
+	  }
+	p    += n;
+	size -= (size_t)n;
+      }
+    return true;
+  }
+} // ns iff
@@ -0,0 +1,43 @@
+#ifndef __IFF_CORE_FD_IO_HPP__
+#define __IFF_CORE_FD_IO_HPP__
+
+#include "core/iff_types.hpp"
+
+namespace iff
+{
+  // Big endian fields of bytes already in memory, the way IFF stores
+  // ids and sizes. See iff_io.hpp for streams.
+  inline uint16_t be16 (const uint8_t* p)
+  {
+    return (uint16_t)((p [0] << 8) | p [1]);
+  }
+  // -----------------------------------------------------------------------
+  inline uint32_t be32 (const uint8_t* p)
+  {
+    return ((uint32_t)p [0] << 24) | ((uint32_t)p [1] << 16) | ((uint32_t)p [2] << 8) | p [3];
+  }
+  // -----------------------------------------------------------------------
+  inline void put_be16 (uint8_t* p, uint16_t v)
+  {
+    p [0] = (uint8_t)(v >> 8);
+    p [1] = (uint8_t)v;
+  }
+  // -----------------------------------------------------------------------
+  inline void put_be32 (uint8_t* p, uint32_t v)
+  {
+    p [0] = (uint8_t)(v >> 24);
+    p [1] = (uint8_t)(v >> 16);
+    p [2] = (uint8_t)(v >> 8);
+    p [3] = (uint8_t)v;
+  }
+
+  // Whole transfers on file descriptors: a short read or write goes on
+  // where it stopped and EINTR is retried. False on an error, or when
+  // read_at reaches the end of the file first. write_all writes at the
+  // current position, read_at and write_at leave it alone.
+  bool read_at   (int fd, uint64_t pos, void* data, size_t size);
+  bool write_at  (int fd, uint64_t pos, const void* data, size_t size);
+  bool write_all (int fd, const void* data, size_t size);
+} // ns iff
+
+#endif
@@ -0,0 +1,131 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "core/fdbuf.hpp"
+
+namespace iff
+{
+  fdbuf_c::fdbuf_c ()
+    : m_fd        (-1),
+      m_buffer    (0),
+      m_size      (0),
+      m_file_size (0),
+      m_base      (0)
+  {
+    setg (0, 0, 0);
+  }
+  // -----------------------------------------------------------------------
+  fdbuf_c::~fdbuf_c ()
+  {
+    close ();
+  }
+  // -----------------------------------------------------------------------
+  void fdbuf_c::set_buffer (char* buffer, size_t size)
+  {
+    m_buffer = buffer;
+    m_size   = size;
+    setg (m_buffer, m_buffer, m_buffer);
+  }
+  // -----------------------------------------------------------------------
+  bool fdbuf_c::open (const char* path)
+  {
+    close ();
+    const int fd = ::open (path, O_RDONLY);
+    if (fd < 0)
+      {
+	return false;
+      }
+    struct stat st;
+    if (fstat (fd, &st) != 0 || !S_ISREG (st.st_mode))
+      {
+	::close (fd);
+	return false;
+      }
+    m_fd        = fd;
+    m_file_size = (uint64_t)st.st_size;
+    m_base      = 0;
+    setg (m_buffer, m_buffer, m_buffer);
+    return true;
+  }
+  // -----------------------------------------------------------------------
+  void fdbuf_c::close ()
+  {
+    if (m_fd >= 0)
+      {
+	::close (m_fd);
+	m_fd = -1;
+      }
+    m_file_size = 0;
+    m_base      = 0;
+    setg (m_buffer, m_buffer, m_buffer);
+  }
+  // -----------------------------------------------------------------------
+  bool fdbuf_c::is_open () const
+  {
+    return m_fd >= 0;
+  }
+  // -----------------------------------------------------------------------
+  fdbuf_c::int_type fdbuf_c::underflow ()
+  {
+    if (gptr () < egptr ())
+      {
+	return traits_type::to_int_type (*gptr ());
+      }
+    if (m_fd < 0 || !m_buffer)
+      {
+	return traits_type::eof ();
+      }
+    m_base += (uint64_t)(egptr () - eback ());
+    ssize_t n;
+    do
+      {
+	n = pread (m_fd, m_buffer, m_size, (off_t)m_base);
+      }
+    while (n < 0 && errno == EINTR);
+    if (n <= 0)
+      {
+	setg (m_buffer, m_buffer, m_buffer);
+	return traits_type::eof ();
+      }
+    setg (m_buffer, m_buffer, m_buffer + n);
+    return traits_type::to_int_type (*gptr ());
+  }
+  // -----------------------------------------------------------------------
+  fdbuf_c::pos_type fdbuf_c::seekoff (off_type off, std::ios::seekdir dir, std::ios::openmode which)
+  {
+    off_type base = 0;
+    if (dir == std::ios::cur)
+      {
+	base = (off_type)m_base + (gptr () - eback ());
+      }
+    else if (dir == std::ios::end)
+      {
+	base = (off_type)m_file_size;
+      }
+    return seekpos (pos_type (base + off), which);
+  }
+  // -----------------------------------------------------------------------
+  // A target inside the buffered window only moves gptr (); anything
+  // else drops the window and the next underflow () reads there.
+  fdbuf_c::pos_type fdbuf_c::seekpos (pos_type pos, std::ios::openmode which)
+  {
+    const off_type p = off_type (pos);
+    if (!(which & std::ios::in) || m_fd < 0 || p < 0)
+      {
+	return pos_type (off_type (-1));
+      }
+    const uint64_t target = (uint64_t)p;
+    if (target >= m_base && target <= m_base + (uint64_t)(egptr () - eback ()))
+      {
+	setg (eback (), eback () + (target - m_base), egptr ());
+      }
+    else
+      {
+	m_base = target;
+	setg (m_buffer, m_buffer, m_buffer);
+      }
+    return pos;
+  }
+} // ns iff
@@ -0,0 +1,44 @@
+#ifndef __IFF_CORE_FDBUF_HPP__
+#define __IFF_CORE_FDBUF_HPP__
+
+#include <streambuf>
+#include <iostream>
+
+#include "core/iff_types.hpp"
+
+namespace iff
+{
+  // Read-only, seekable std::streambuf over a file descriptor, filled
+  // with pread () into a buffer owned by the caller. Unlike
+  // std::filebuf it opens with ::open (), so opening and closing
+  // never touch the heap.
+  class fdbuf_c : public std::streambuf
+  {
+  public:
+    fdbuf_c ();
+    virtual ~fdbuf_c ();
+
+    // must precede open (), the buffer is kept across reopens
+    void set_buffer (char* buffer, size_t size);
+
+    bool open     (const char* path);
+    void close    ();
+    bool is_open  () const;
+  protected:
+    virtual int_type underflow ();
+    virtual pos_type seekoff (off_type off, std::ios::seekdir dir, std::ios::openmode which);
+    virtual pos_type seekpos (pos_type pos, std::ios::openmode which);
+  private:
+    fdbuf_c (const fdbuf_c&);
+    fdbuf_c& operator = (const fdbuf_c&);
+  private:
+    int      m_fd;
+    char*    m_buffer;
+    size_t   m_size;
+    uint64_t m_file_size;
+    // file position of eback ()
+    uint64_t m_base;
+  };
+} // ns iff
+
+#endif
@@ -1,10 +1,39 @@
 #ifndef __GENERIC_IFF_READER_HPP__
 #define __GENERIC_IFF_READER_HPP__
 
-#include <fstream>
+#include <atomic>
+#include <istream>
+#include <vector>
+#include <chrono>
 
+#include "core/reader_stats.hpp"
+#include "core/trace.hpp"
+#include "core/membuf.hpp"
+#include "core/fdbuf.hpp"
+#include "core/memory_budget.hpp"
 
 
+// A reader may be opened and read any number of times. Once it has
+// parsed a file, parsing it again performs no heap allocations: files
+// are read with open ()/pread () into a buffer inside the reader (no
+// FILE, unlike std::filebuf) and the per file state is reused.
+//
+// Groups are walked with an explicit stack, preallocated for the
+// configured depth limit; files nested deeper fail with eTOO_DEEP
+// instead of exhausting the call stack.
+//
+// Every size is validated against the file and the enclosing group
+// before it is used (eCORRUPT otherwise). Each header therefore
+// consumes at least IO_POLICY::size_of_header () new bytes, which
+// bounds headers, events and seeks by the input size.
+//
+// With a memory budget the depth stack is reserved from it on open,
+// so a reader never holds more than the budget allows (eNO_MEMORY).
+// Callbacks may end the walk early with _stop ().
+//
+// Two members may be called from other threads while read () runs:
+// consumed () tells how far the walk has got, cancel () makes read ()
+// return eCANCELLED before it takes on the next chunk or group.
 template <class IO_POLICY>
 class generic_iff_reader_c
 {
@@ -13,9 +42,18 @@ public:
   {
     eOK,
     eNOT_IFF,
-    eIO_ERROR
+    eIO_ERROR,
+    eTOO_DEEP,
+    eCORRUPT,
+    eNO_MEMORY,
+    eCANCELLED
   };
 
+  enum
+    {
+      DEFAULT_MAX_DEPTH = 1024
+    };
+
 public:
   typedef typename IO_POLICY::id_t        id_t;
   
@@ -23,7 +61,29 @@ public:
   generic_iff_reader_c ();
   virtual ~generic_iff_reader_c ();
   status_t open (const char* path);
+  // parses memory owned by the caller, it must outlive read ()
+  status_t open (const void* data, std::streamsize size);
   status_t read ();
+
+  void     set_max_depth (unsigned depth);
+  unsigned max_depth     () const;
+
+  // budget for the reader's own allocations, 0 for none. It must
+  // outlive the reader.
+  void     set_memory_budget (iff::memory_budget_c* budget);
+
+  // size of the file opened last
+  std::streamsize file_size () const;
+
+  // Thread safe. Bytes of the file walked past by read (), file_size ()
+  // once it succeeds; it advances a header or a whole chunk at a time.
+  std::streamsize consumed () const;
+  // Thread safe. Ends the current or next read () with eCANCELLED;
+  // it holds until the next open ().
+  void            cancel ();
+
+  // counters of the last open ()/read (), see core/reader_stats.hpp
+  const iff::reader_stats_t& stats () const;
 protected:
   // CALLBACKS
   virtual void _on_chunk_enter (const id_t& id, std::streamsize chunk_size, std::streamsize file_pos) = 0;
@@ -35,261 +95,490 @@ protected:
   
   virtual void _on_group_exit  (const id_t& id, const id_t& tag,
 				std::streamsize group_size, std::streamsize file_pos) = 0;
-private:
-  status_t _on_chunk_enter_safe (const id_t& id, std::streamsize chunk_size, std::streamsize file_pos);
 
-  status_t _on_chunk_exit_safe  (const id_t& id, std::streamsize chunk_size, std::streamsize file_pos);
+  // ends read () with status why (not eOK) once the current callback returns
+  void _stop (status_t why);
 
-  status_t _on_group_enter_safe (const id_t& id, const id_t& tag, 
-				 std::streamsize group_size, 
-				 std::streamsize file_pos);
-  
-  status_t _on_group_exit_safe  (const id_t& id, const id_t& tag,
-				 std::streamsize group_size, 
-				 std::streamsize file_pos);
+  // tag of the group enclosing the current callback, id_t () at the root
+  id_t _parent_tag () const;
+  // number of groups enclosing the current callback, and the tag of
+  // the one up levels out (0 is the parent), id_t () past the root
+  size_t _depth () const;
+  id_t   _enclosing_tag (size_t up) const;
 private:
-  status_t _read_group (const id_t& id, std::streamsize group_size, std::streamsize& has_so_far);
-  status_t _read_group_contents (std::streamsize group_size, std::streamsize& has_so_far);
-  status_t _read_chunk (const id_t& id, std::streamsize chunk_size, std::streamsize& has_so_far);
+  status_t _read_root  ();
+  status_t _walk       ();
+  status_t _enter_group (const id_t& id, std::streamsize group_size);
+  status_t _leave_group ();
+  status_t _read_chunk  (const id_t& id, std::streamsize chunk_size);
+  bool     _read_header (id_t& id, std::streamsize& size);
+  status_t _open        ();
+  void     _skip_to     (std::streamsize pos);
+  bool     _charge      ();
+
+  std::streamsize _tellg ();
+  void            _seekg (std::streamoff off, std::ios::seekdir dir);
 private:
-  std::ifstream   m_ifs;
-  std::streamsize m_file_size;
+  enum
+    {
+      IO_BUFFER_SIZE  = 8192,
+      MAX_HEADER_SIZE = 64
+    };
+
+  // a group being walked; start is the file position right after
+  // its size field, where the tag (if any) and the contents begin
+  struct frame_t
+  {
+    id_t            id;
+    id_t            tag;
+    std::streamsize size;
+    std::streamsize start;
+  };
+
+  iff::fdbuf_c          m_filebuf;
+  iff::membuf_c         m_membuf;
+  // reads through m_filebuf or m_membuf
+  std::istream          m_ifs;
+  char                  m_io_buffer [IO_BUFFER_SIZE];
+  std::streamsize       m_file_size;
+  // position of m_ifs, tracked here instead of asking the stream.
+  // It may run past m_file_size by a pad byte missing at the end.
+  std::streamsize       m_pos;
+  unsigned              m_max_depth;
+  std::vector <frame_t> m_stack;
+  iff::reader_stats_t   m_stats;
+  status_t              m_stop;
+  std::atomic <bool>            m_cancel;
+  std::atomic <std::streamsize> m_consumed;
+  iff::memory_budget_c* m_budget;
+  // bytes of m_budget held by this reader
+  size_t                m_charged;
 };
 
 // ===================================================================
 template <class IO_POLICY>
 generic_iff_reader_c<IO_POLICY>::generic_iff_reader_c ()
+  : m_ifs       (&m_filebuf),
+    m_file_size (0),
+    m_pos       (0),
+    m_max_depth (DEFAULT_MAX_DEPTH),
+    m_stop      (eOK),
+    m_cancel    (false),
+    m_consumed  (0),
+    m_budget    (0),
+    m_charged   (0)
 {
+  // must precede the first open (), the fdbuf keeps it across reopens
+  m_filebuf.set_buffer (m_io_buffer, sizeof (m_io_buffer));
+  m_stack.reserve (m_max_depth);
 }
 // -------------------------------------------------------------------
 template <class IO_POLICY>
 generic_iff_reader_c<IO_POLICY>::~generic_iff_reader_c ()
 {
+  if (m_budget)
+    {
+      m_budget->release (m_charged);
+    }
 }
 // -------------------------------------------------------------------
 template <class IO_POLICY>
 typename generic_iff_reader_c<IO_POLICY>::status_t
 generic_iff_reader_c<IO_POLICY>::open (const char* path)
 {
-  m_ifs.open (path, std::ios::binary);
+  m_stats.reset ();
+  if (m_filebuf.is_open ())
+    {
+      m_filebuf.close ();
+    }
+  if (!m_filebuf.open (path))
+    {
+      return eIO_ERROR;
+    }
+  m_ifs.rdbuf (&m_filebuf);
+  return _open ();
+}
+// -------------------------------------------------------------------
+template <class IO_POLICY>
+typename generic_iff_reader_c<IO_POLICY>::status_t
+generic_iff_reader_c<IO_POLICY>::open (const void* data, std::streamsize size)
+{
+  m_stats.reset ();
+  if (m_filebuf.is_open ())
+    {
+      m_filebuf.close ();
+    }
+  m_membuf.set ((const char*)data, size);
+  m_ifs.rdbuf (&m_membuf);
+  return _open ();
+}
+// -------------------------------------------------------------------
+template <class IO_POLICY>
+typename generic_iff_reader_c<IO_POLICY>::status_t
+generic_iff_reader_c<IO_POLICY>::_open ()
+{
+  m_cancel.store (false);
+  m_consumed.store (0);
+  if (!_charge ())
+    {
+      return eNO_MEMORY;
+    }
   if (!m_ifs.good ())
     {
       return eIO_ERROR;
     }
-  m_ifs.seekg (0, std::ios::end);
-  m_file_size = m_ifs.tellg();
-  m_ifs.seekg (0, std::ios::beg);
+  _seekg (0, std::ios::end);
+  m_file_size = _tellg ();
+  _seekg (0, std::ios::beg);
+  m_pos = 0;
   if (IO_POLICY::has_header ())
     {
       const unsigned w = IO_POLICY::bytes_in_header ();
-      char* hdr = new char [w];
+      char hdr [MAX_HEADER_SIZE];
+      if (w > sizeof (hdr))
+	{
+	  return eNOT_IFF;
+	}
       m_ifs.read (hdr, w);
       if (!m_ifs.good ())
 	{
-	  delete [] hdr;
 	  return eIO_ERROR;
 	}
-      const bool rc = IO_POLICY::check_header (hdr);
-      if (!rc)
+      IFF_STAT (m_stats.bytes_read += w);
+      m_pos = w;
+      if (!IO_POLICY::check_header (hdr))
 	{
 	  return eNOT_IFF;
 	}
-      delete [] hdr;
     }
   return eOK;
 }
 // -------------------------------------------------------------------
 template <class IO_POLICY>
-typename generic_iff_reader_c<IO_POLICY>::status_t
-generic_iff_reader_c<IO_POLICY>::read ()
+void generic_iff_reader_c<IO_POLICY>::set_max_depth (unsigned depth)
 {
-  id_t        id;
-  typename IO_POLICY::size_type_t hsize;
-  std::streamsize sz;
-  if (!IO_POLICY::read_group_header (m_ifs, id, hsize, sz))
-    {
-      return eIO_ERROR;
-    }
-
-  std::streamsize has_so_far = sz;
-  if (IO_POLICY::is_group (id))
-    {
-      return _read_group (id, hsize, has_so_far);
-    }
-  if (!IO_POLICY::should_start_with_group ())
+  m_max_depth = depth;
+  m_stack.reserve (depth);
+}
+// -------------------------------------------------------------------
+template <class IO_POLICY>
+unsigned generic_iff_reader_c<IO_POLICY>::max_depth () const
+{
+  return m_max_depth;
+}
+// -------------------------------------------------------------------
+template <class IO_POLICY>
+void generic_iff_reader_c<IO_POLICY>::set_memory_budget (iff::memory_budget_c* budget)
+{
+  if (m_budget)
     {
-      return _read_chunk (id, hsize, has_so_far);
+      m_budget->release (m_charged);
     }
-  return eNOT_IFF;
+  m_budget  = budget;
+  m_charged = 0;
 }
 // -------------------------------------------------------------------
+// The stream buffer lives inside the reader, the depth stack is the
+// only heap memory it holds.
 template <class IO_POLICY>
-typename generic_iff_reader_c<IO_POLICY>::status_t
-generic_iff_reader_c<IO_POLICY>::_read_group (const id_t& id, std::streamsize group_size, std::streamsize& has_so_far)
+bool generic_iff_reader_c<IO_POLICY>::_charge ()
 {
-  if (!m_ifs.good ())
+  if (!m_budget)
     {
-      return eIO_ERROR;
+      return true;
     }
-
-  has_so_far += sizeof (group_size);
-  const std::streamsize real_group_size = IO_POLICY::real_size (group_size);
-  const std::streamsize group_start     = m_ifs.tellg();
-  id_t tag = id;
-  std::streamsize in_grp_size = 0;
-  if (IO_POLICY::group_has_tag ())
+  const size_t need = m_stack.capacity () * sizeof (frame_t);
+  if (need > m_charged)
     {
-      std::streamsize tag_size;
-      if (!IO_POLICY::read_group_id (m_ifs, tag, tag_size))
+      if (!m_budget->reserve (need - m_charged))
 	{
-	  return eIO_ERROR;
+	  return false;
 	}
-      has_so_far += tag_size;
-      in_grp_size += tag_size;
-    }
-  
-  if (eOK != this->_on_group_enter_safe (id, tag, group_size, group_start))
-    {
-      return eIO_ERROR;
+      m_charged = need;
     }
-  
-  status_t rc = _read_group_contents (group_size, in_grp_size);
-  if (rc != eOK)
+  return true;
+}
+// -------------------------------------------------------------------
+template <class IO_POLICY>
+void generic_iff_reader_c<IO_POLICY>::_stop (status_t why)
+{
+  m_stop = why;
+}
+// -------------------------------------------------------------------
+template <class IO_POLICY>
+typename generic_iff_reader_c<IO_POLICY>::id_t
+generic_iff_reader_c<IO_POLICY>::_parent_tag () const
+{
+  // a group is pushed after its enter callback, so the top is always
+  // the parent
+  return m_stack.empty () ? id_t () : m_stack.back ().tag;
+}
+// -------------------------------------------------------------------
+template <class IO_POLICY>
+size_t generic_iff_reader_c<IO_POLICY>::_depth () const
+{
+  return m_stack.size ();
+}
+// -------------------------------------------------------------------
+template <class IO_POLICY>
+typename generic_iff_reader_c<IO_POLICY>::id_t
+generic_iff_reader_c<IO_POLICY>::_enclosing_tag (size_t up) const
+{
+  return up < m_stack.size () ? m_stack [m_stack.size () - 1 - up].tag : id_t ();
+}
+// -------------------------------------------------------------------
+template <class IO_POLICY>
+std::streamsize generic_iff_reader_c<IO_POLICY>::file_size () const
+{
+  return m_file_size;
+}
+// -------------------------------------------------------------------
+template <class IO_POLICY>
+std::streamsize generic_iff_reader_c<IO_POLICY>::consumed () const
+{
+  return m_consumed.load (std::memory_order_relaxed);
+}
+// -------------------------------------------------------------------
+template <class IO_POLICY>
+void generic_iff_reader_c<IO_POLICY>::cancel ()
+{
+  m_cancel.store (true);
+}
+// -------------------------------------------------------------------
+template <class IO_POLICY>
+const iff::reader_stats_t& generic_iff_reader_c<IO_POLICY>::stats () const
+{
+  return m_stats;
+}
+// -------------------------------------------------------------------
+template <class IO_POLICY>
+typename generic_iff_reader_c<IO_POLICY>::status_t
+generic_iff_reader_c<IO_POLICY>::read ()
+{
+  IFF_STAT (const std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now ());
+  m_stack.clear ();
+  m_stop = eOK;
+  m_consumed.store (0, std::memory_order_relaxed);
+  IFF_TRACE_BEGIN ("reader", "read");
+  status_t rc = m_cancel.load () ? eCANCELLED : _read_root ();
+  if (rc == eOK)
     {
-      return rc;
+      rc = m_stop;
     }
-  has_so_far += in_grp_size;
-
-
-  m_ifs.seekg (group_start, std::ios::beg);
-  m_ifs.seekg (real_group_size, std::ios::cur);
-  if (!m_ifs.good ())
+  if (rc == eOK)
     {
-      return eIO_ERROR;
+      m_consumed.store (m_file_size, std::memory_order_relaxed);
     }
-  
-  return  this->_on_group_exit_safe (id, tag, group_size, group_start + real_group_size);
+  IFF_TRACE_END ("reader", "read");
+  IFF_STAT (m_stats.wall_time += std::chrono::duration <double> (std::chrono::steady_clock::now () - t0).count ());
+  return rc;
 }
 // -------------------------------------------------------------------
 template <class IO_POLICY>
 typename generic_iff_reader_c<IO_POLICY>::status_t
-generic_iff_reader_c<IO_POLICY>::_read_chunk (const id_t& id, std::streamsize chunk_size, std::streamsize& has_so_far)
+generic_iff_reader_c<IO_POLICY>::_read_root ()
 {
-  const std::streamsize now = m_ifs.tellg();
-  if (!m_ifs.good ())
+  id_t            id;
+  std::streamsize size;
+  if (!_read_header (id, size))
     {
       return eIO_ERROR;
     }
-  if (eOK != this->_on_chunk_enter_safe (id, chunk_size, now))
+  if (size > m_file_size - m_pos)
     {
-      return eIO_ERROR;
+      return eCORRUPT;
     }
-  const std::streamsize skip = IO_POLICY::real_size (chunk_size);
-  m_ifs.seekg (skip, std::ios::cur);
-  if (!m_ifs.good ())
+  if (IO_POLICY::is_group (id))
     {
-      return eIO_ERROR;
+      const status_t rc = _enter_group (id, size);
+      if (rc != eOK)
+	{
+	  return rc;
+	}
+      return _walk ();
+    }
+  if (!IO_POLICY::should_start_with_group ())
+    {
+      return _read_chunk (id, size);
     }
-  has_so_far += skip;
-  return this->_on_chunk_exit_safe (id, chunk_size, now + skip);
+  return eNOT_IFF;
 }
 // -------------------------------------------------------------------
 template <class IO_POLICY>
 typename generic_iff_reader_c<IO_POLICY>::status_t
-generic_iff_reader_c<IO_POLICY>::_read_group_contents (std::streamsize group_size, std::streamsize& has_so_far)
+generic_iff_reader_c<IO_POLICY>::_walk ()
 {
-  
-  while (has_so_far < group_size)
+  while (!m_stack.empty ())
     {
-      const std::streamsize start = m_ifs.tellg ();
-      
-      id_t        id;
-      typename IO_POLICY::size_type_t hsize;
-      std::streamsize sz;
-      if (!IO_POLICY::read_group_header (m_ifs, id, hsize, sz))
+      if (m_stop != eOK)
 	{
-	  return eIO_ERROR;
+	  return m_stop;
 	}
-
-      if (IO_POLICY::is_group (id))
+      m_consumed.store (m_pos < m_file_size ? m_pos : m_file_size, std::memory_order_relaxed);
+      if (m_cancel.load (std::memory_order_relaxed))
 	{
-	  std::streamsize gs = sz;
-
-	  status_t rc =  _read_group (id, hsize, gs);
-	  if (rc != eOK)
+	  return eCANCELLED;
+	}
+      const frame_t& top  = m_stack.back ();
+      const std::streamsize left = top.start + top.size - m_pos;
+      status_t rc;
+      if (left >= IO_POLICY::size_of_header ())
+	{
+	  id_t            id;
+	  std::streamsize size;
+	  if (!_read_header (id, size))
+	    {
+	      return eIO_ERROR;
+	    }
+	  if (size > left - IO_POLICY::size_of_header ())
+	    {
+	      // claims more than the enclosing group holds
+	      return eCORRUPT;
+	    }
+	  if (IO_POLICY::is_group (id))
+	    {
+	      rc = _enter_group (id, size);
+	    }
+	  else
 	    {
-	      return rc;
+	      rc = _read_chunk (id, size);
 	    }
-	  has_so_far += gs;
 	}
       else
 	{
-	  has_so_far += sz;
-	  std::streamsize cs = 0;
-	  status_t rc = _read_chunk (id, hsize, cs);
-	  if (rc != eOK)
-	    {
-	      return rc;
-	    }
-	  has_so_far += cs;
+	  // done, a tail too short for a header is slack
+	  rc = _leave_group ();
+	}
+      if (rc != eOK)
+	{
+	  return rc;
 	}
     }
   return eOK;
 }
 // -------------------------------------------------------------------
-#define IFF_SAFE_PROLOG							\
-  const std::streamsize now = m_ifs.tellg();				\
-  if (!m_ifs.good ())							\
-    return eIO_ERROR
+template <class IO_POLICY>
+typename generic_iff_reader_c<IO_POLICY>::status_t
+generic_iff_reader_c<IO_POLICY>::_enter_group (const id_t& id, std::streamsize group_size)
+{
+  if (m_stack.size () >= m_max_depth)
+    {
+      return eTOO_DEEP;
+    }
+  frame_t f;
+  f.id    = id;
+  f.tag   = id;
+  f.size  = group_size;
+  f.start = m_pos;
+  if (IO_POLICY::group_has_tag ())
+    {
+      if (group_size < IO_POLICY::size_of_id ())
+	{
+	  return eCORRUPT;
+	}
+      std::streamsize tag_size;
+      if (!IO_POLICY::read_group_id (m_ifs, f.tag, tag_size))
+	{
+	  return eIO_ERROR;
+	}
+      IFF_STAT (m_stats.bytes_read += tag_size);
+      m_pos += tag_size;
+    }
+  IFF_TRACE_BEGIN ("group", f.tag.to_string ().c_str ());
+  IFF_STAT (m_stats.events++);
+  this->_on_group_enter (f.id, f.tag, f.size, f.start);
 
-#define IFF_SAFE_EPILOG							\
-  if (!m_ifs.good ()) return eIO_ERROR;					\
-  m_ifs.seekg (now, std::ios::beg);					\
-  if (!m_ifs.good ())  return eIO_ERROR;				\
-  return eOK
+  m_stack.push_back (f);
+  IFF_STAT (if (m_stack.size () > m_stats.max_depth) m_stats.max_depth = (unsigned)m_stack.size ());
+  return eOK;
+}
 // -------------------------------------------------------------------
 template <class IO_POLICY>
 typename generic_iff_reader_c<IO_POLICY>::status_t
-generic_iff_reader_c<IO_POLICY>::_on_chunk_enter_safe (const id_t& id, 
-						       std::streamsize chunk_size, 
-						       std::streamsize file_pos)
+generic_iff_reader_c<IO_POLICY>::_leave_group ()
 {
-  IFF_SAFE_PROLOG;
-  this->_on_chunk_enter (id, chunk_size, file_pos);
-  IFF_SAFE_EPILOG;
+  const frame_t f = m_stack.back ();
+  m_stack.pop_back ();
+
+  const std::streamsize end = f.start + IO_POLICY::real_size (f.size);
+  _skip_to (end);
+  if (!m_ifs.good ())
+    {
+      return eIO_ERROR;
+    }
+  IFF_STAT (m_stats.events++);
+  this->_on_group_exit (f.id, f.tag, f.size, end);
+  IFF_TRACE_END ("group", f.tag.to_string ().c_str ());
+  return eOK;
 }
 // -------------------------------------------------------------------
 template <class IO_POLICY>
 typename generic_iff_reader_c<IO_POLICY>::status_t
-generic_iff_reader_c<IO_POLICY>::_on_chunk_exit_safe  (const id_t& id, std::streamsize chunk_size, 
-						       std::streamsize file_pos)
+generic_iff_reader_c<IO_POLICY>::_read_chunk (const id_t& id, std::streamsize chunk_size)
 {
-  IFF_SAFE_PROLOG;
-  this->_on_chunk_exit (id, chunk_size, file_pos);
-  IFF_SAFE_EPILOG;
-}
+  const std::streamsize now = m_pos;
+  IFF_TRACE_BEGIN ("chunk", id.to_string ().c_str ());
+  IFF_STAT (m_stats.events++);
+  this->_on_chunk_enter (id, chunk_size, now);
 
+  _skip_to (now + IO_POLICY::real_size (chunk_size));
+  if (!m_ifs.good ())
+    {
+      return eIO_ERROR;
+    }
+  IFF_STAT (m_stats.events++);
+  this->_on_chunk_exit (id, chunk_size, m_pos);
+  IFF_TRACE_END ("chunk", id.to_string ().c_str ());
+  return eOK;
+}
 // -------------------------------------------------------------------
 template <class IO_POLICY>
-typename generic_iff_reader_c<IO_POLICY>::status_t
-generic_iff_reader_c<IO_POLICY>::_on_group_enter_safe (const id_t& id, const id_t& tag, 
-						       std::streamsize chunk_size, 
-						       std::streamsize file_pos)
+bool generic_iff_reader_c<IO_POLICY>::_read_header (id_t& id, std::streamsize& size)
 {
-  IFF_SAFE_PROLOG;
-  this->_on_group_enter (id, tag, chunk_size, file_pos);
-  IFF_SAFE_EPILOG;
+  typename IO_POLICY::size_type_t hsize;
+  std::streamsize sz;
+  if (!IO_POLICY::read_group_header (m_ifs, id, hsize, sz))
+    {
+      return false;
+    }
+  IFF_STAT (m_stats.headers++);
+  IFF_STAT (m_stats.bytes_read += sz);
+  m_pos += sz;
+  size   = hsize;
+  return true;
 }
 // -------------------------------------------------------------------
 template <class IO_POLICY>
-typename generic_iff_reader_c<IO_POLICY>::status_t
-generic_iff_reader_c<IO_POLICY>::_on_group_exit_safe  (const id_t& id, const id_t& tag,
-						       std::streamsize chunk_size, 
-						       std::streamsize file_pos)
+void generic_iff_reader_c<IO_POLICY>::_skip_to (std::streamsize pos)
+{
+  // the stream never moves past the end, a missing final pad byte
+  // only advances the logical position
+  const std::streamsize from = m_pos < m_file_size ? m_pos : m_file_size;
+  const std::streamsize to   = pos   < m_file_size ? pos   : m_file_size;
+  if (to > from && to - from < IO_BUFFER_SIZE)
+    {
+      // most likely still buffered: consume it instead of dropping
+      // the buffer with a seek
+      m_ifs.ignore (to - from);
+    }
+  else if (to != from)
+    {
+      _seekg (to, std::ios::beg);
+    }
+  m_pos = pos;
+}
+// -------------------------------------------------------------------
+template <class IO_POLICY>
+inline std::streamsize generic_iff_reader_c<IO_POLICY>::_tellg ()
+{
+  IFF_STAT (m_stats.tellg_calls++);
+  return m_ifs.tellg ();
+}
+// -------------------------------------------------------------------
+template <class IO_POLICY>
+inline void generic_iff_reader_c<IO_POLICY>::_seekg (std::streamoff off, std::ios::seekdir dir)
 {
-  IFF_SAFE_PROLOG;
-  this->_on_group_exit (id, tag, chunk_size, file_pos);
-  IFF_SAFE_EPILOG;
+  IFF_STAT (m_stats.seekg_calls++);
+  m_ifs.seekg (off, dir);
 }
 #endif
-
@@ -15,6 +15,8 @@ namespace iff
 
     virtual status_t open (const char* filename);
     virtual status_t read ();
+
+    virtual const reader_stats_t& stats () const;
   private:
     class iff_reader_c : public generic_iff_reader_c <IO_POLICY>
     {
@@ -110,6 +112,17 @@ namespace iff
       }
     return eBAD_FILE;
   }
+  // -------------------------------------------------------
+  template <class IO_POLICY> 
+  const reader_stats_t& generic_parser_c <IO_POLICY>::stats () const
+  {
+    static const reader_stats_t empty;
+    if (!m_reader)
+      {
+	return empty;
+      }
+    return m_reader->stats ();
+  }
   // =======================================================
   template <class IO_POLICY> 
   generic_parser_c <IO_POLICY>::
@@ -0,0 +1,185 @@
+#include <algorithm>
+
+#include "core/handler_registry.hpp"
+
+namespace iff
+{
+  static const unsigned SEED_ATTEMPTS   = 8;
+  static const uint32_t MAX_DISPLACEMENT = 1u << 16;
+
+  // ---------------------------------------------------------------
+  static uint32_t round_up_pow2 (size_t n)
+  {
+    uint32_t p = 1;
+    while (p < n)
+      {
+	p <<= 1;
+      }
+    return p;
+  }
+  // ---------------------------------------------------------------
+  chunk_handler_c::~chunk_handler_c ()
+  {
+  }
+  // ===============================================================
+  handler_registry_c::handler_registry_c ()
+    : m_seed        (0),
+      m_slot_mask   (0),
+      m_bucket_mask (0),
+      m_perfect     (false)
+  {
+  }
+  // ---------------------------------------------------------------
+  void handler_registry_c::bind (iff_id_t parent, iff_id_t id, chunk_handler_c* handler)
+  {
+    binding_t b;
+    b.parent  = parent;
+    b.id      = id;
+    b.handler = handler;
+    m_bindings.push_back (b);
+  }
+  // ---------------------------------------------------------------
+  void handler_registry_c::bind (iff_id_t id, chunk_handler_c* handler)
+  {
+    bind (ANY, id, handler);
+  }
+  // ---------------------------------------------------------------
+  size_t handler_registry_c::size () const
+  {
+    return m_bindings.size ();
+  }
+  // ---------------------------------------------------------------
+  bool handler_registry_c::is_perfect () const
+  {
+    return m_perfect;
+  }
+  // ---------------------------------------------------------------
+  void handler_registry_c::compile ()
+  {
+    // by id, then tags before ANY; equal bindings keep their order so
+    // the last one bound can win below
+    std::stable_sort (m_bindings.begin (), m_bindings.end (),
+		      [] (const binding_t& a, const binding_t& b)
+		      {
+			return a.id != b.id ? a.id < b.id : a.parent > b.parent;
+		      });
+    std::vector <binding_t> unique;
+    unique.reserve (m_bindings.size ());
+    for (size_t i = 0; i < m_bindings.size (); i++)
+      {
+	if (i + 1 < m_bindings.size () &&
+	    m_bindings [i + 1].id == m_bindings [i].id &&
+	    m_bindings [i + 1].parent == m_bindings [i].parent)
+	  {
+	    continue;
+	  }
+	unique.push_back (m_bindings [i]);
+      }
+    m_bindings.swap (unique);
+
+    std::vector <slot_t> ids;
+    for (uint32_t i = 0; i < m_bindings.size (); i++)
+      {
+	if (ids.empty () || ids.back ().id != m_bindings [i].id)
+	  {
+	    slot_t s;
+	    s.id    = m_bindings [i].id;
+	    s.first = i;
+	    s.count = 0;
+	    ids.push_back (s);
+	  }
+	ids.back ().count++;
+      }
+
+    m_displace.clear ();
+    m_slots.clear ();
+    m_perfect = false;
+    if (ids.empty ())
+      {
+	return;
+      }
+    for (unsigned attempt = 1; attempt <= SEED_ATTEMPTS; attempt++)
+      {
+	if (_place (ids, _mix (attempt * 0x9E3779B9U)))
+	  {
+	    m_perfect = true;
+	    return;
+	  }
+      }
+    // sorted by id already
+    m_slots.swap (ids);
+  }
+  // ---------------------------------------------------------------
+  // Hash and displace: ids are spread over buckets of about four by
+  // their first hash, then the largest buckets first get the smallest
+  // displacement moving all their ids to free slots at once.
+  bool handler_registry_c::_place (const std::vector <slot_t>& ids, uint32_t seed)
+  {
+    const uint32_t nslots   = round_up_pow2 (ids.size () + ids.size () / 4 + 1);
+    const uint32_t nbuckets = round_up_pow2 ((ids.size () + 3) / 4);
+
+    std::vector <std::vector <uint32_t> > buckets (nbuckets);
+    for (uint32_t i = 0; i < ids.size (); i++)
+      {
+	buckets [_mix (ids [i].id ^ seed) & (nbuckets - 1)].push_back (i);
+      }
+    std::vector <uint32_t> order (nbuckets);
+    for (uint32_t b = 0; b < nbuckets; b++)
+      {
+	order [b] = b;
+      }
+    std::stable_sort (order.begin (), order.end (),
+		      [&buckets] (uint32_t a, uint32_t b)
+		      {
+			return buckets [a].size () > buckets [b].size ();
+		      });
+
+    std::vector <slot_t>   slots (nslots);
+    std::vector <uint8_t>  used  (nslots, 0);
+    std::vector <uint32_t> displace (nbuckets, 0);
+    std::vector <uint32_t> taken;
+    for (uint32_t k = 0; k < nbuckets && !buckets [order [k]].empty (); k++)
+      {
+	const std::vector <uint32_t>& bucket = buckets [order [k]];
+	uint32_t d = 0;
+	for (; d < MAX_DISPLACEMENT; d++)
+	  {
+	    taken.clear ();
+	    for (size_t j = 0; j < bucket.size (); j++)
+	      {
+		const uint32_t h = _mix (ids [bucket [j]].id ^ seed);
+		const uint32_t s = _mix (h + d * 0x9E3779B9U) & (nslots - 1);
+		if (used [s])
+		  {
+		    break;
+		  }
+		used [s] = 1;
+		taken.push_back (s);
+	      }
+	    if (taken.size () == bucket.size ())
+	      {
+		break;
+	      }
+	    for (size_t j = 0; j < taken.size (); j++)
+	      {
+		used [taken [j]] = 0;
+	      }
+	  }
+	if (d == MAX_DISPLACEMENT)
+	  {
+	    return false;
+	  }
+	displace [order [k]] = d;
+	for (size_t j = 0; j < bucket.size (); j++)
+	  {
+	    slots [taken [j]] = ids [bucket [j]];
+	  }
+      }
+    m_slots.swap (slots);
+    m_displace.swap (displace);
+    m_seed        = seed;
+    m_slot_mask   = nslots - 1;
+    m_bucket_mask = nbuckets - 1;
+    return true;
+  }
+} // ns iff
@@ -0,0 +1,194 @@
+#ifndef __IFF_CORE_HANDLER_REGISTRY_HPP__
+#define __IFF_CORE_HANDLER_REGISTRY_HPP__
+
+#include <vector>
+
+#include "core/iff_types.hpp"
+
+namespace iff
+{
+  // a chunk as reported to a handler, positions as in the reader
+  // callbacks. parent is the tag of the directly enclosing group
+  // (ILBM, ANIM, ...), 0 for a chunk at the root.
+  struct chunk_event_t
+  {
+    iff_id_t        parent;
+    iff_id_t        id;
+    std::streamsize size;
+    std::streamsize file_pos;
+  };
+
+  class chunk_handler_c
+  {
+  public:
+    virtual ~chunk_handler_c ();
+    virtual void on_chunk (const chunk_event_t& ev) = 0;
+  };
+
+  // Binds handlers to chunk ids, optionally only inside groups of a
+  // given tag (ILBM/BODY and ANIM/DLTA are different bindings). A
+  // binding to a tag wins over one to ANY.
+  //
+  // compile () turns the bindings into a perfect hash over the
+  // distinct ids (hash and displace). It is not minimal: the table
+  // has about 1.25 slots per id, rounded up to a power of two, so
+  // that a slot is a mask away from the hash. A lookup is two hashes, one
+  // displacement and one slot compare whatever the number of
+  // bindings, and an unbound id stops at the compare. Should no
+  // displacement be found it falls back to binary search of a sorted
+  // array. Lookups before the first compile () find nothing.
+  class handler_registry_c
+  {
+  public:
+    static const iff_id_t ANY = 0;
+
+    // the bindings of one id are m_bindings [first, first + count)
+    struct slot_t
+    {
+      iff_id_t id;
+      uint32_t first;
+      uint32_t count;
+    };
+  public:
+    handler_registry_c ();
+
+    // a second binding of the same parent and id replaces the first
+    void bind (iff_id_t parent, iff_id_t id, chunk_handler_c* handler);
+    void bind (iff_id_t id, chunk_handler_c* handler);
+    void compile ();
+
+    // 0 if nothing is bound
+    chunk_handler_c* lookup (iff_id_t parent, iff_id_t id) const;
+    // the same for a chunk nested in depth groups whose tags are
+    // scope [0] (the parent) to scope [depth - 1] (the outermost):
+    // the binding to the innermost of them wins, then the one to
+    // ANY. ANIM/DLTA thus matches the DLTA in an ILBM of an ANIM.
+    chunk_handler_c* lookup (const iff_id_t* scope, size_t depth, iff_id_t id) const;
+
+    // The same in two steps, for callers that gather the scope only
+    // when it matters: find () is the whole cost of an unbound id
+    // (0), the scope is needed only if is_scoped ().
+    const slot_t*    find      (iff_id_t id) const;
+    bool             is_scoped (const slot_t& s) const;
+    chunk_handler_c* match     (const slot_t& s, const iff_id_t* scope, size_t depth) const;
+
+    size_t size       () const;
+    // false once compile () had to fall back to binary search
+    bool   is_perfect () const;
+  private:
+    struct binding_t
+    {
+      iff_id_t         parent;
+      iff_id_t         id;
+      chunk_handler_c* handler;
+    };
+    static uint32_t _mix (uint32_t x);
+    bool _place (const std::vector <slot_t>& ids, uint32_t seed);
+    chunk_handler_c* _match (const slot_t& s, iff_id_t parent) const;
+  private:
+    std::vector <binding_t> m_bindings;
+    std::vector <slot_t>    m_slots;
+    std::vector <uint32_t>  m_displace;
+    uint32_t                m_seed;
+    uint32_t                m_slot_mask;
+    uint32_t                m_bucket_mask;
+    bool                    m_perfect;
+  };
+  // ---------------------------------------------------------------
+  inline uint32_t handler_registry_c::_mix (uint32_t x)
+  {
+    x ^= x >> 16;
+    x *= 0x85EBCA6BU;
+    x ^= x >> 13;
+    x *= 0xC2B2AE35U;
+    x ^= x >> 16;
+    return x;
+  }
+  // ---------------------------------------------------------------
+  inline chunk_handler_c* handler_registry_c::_match (const slot_t& s, iff_id_t parent) const
+  {
+    // bindings to a tag sort before the one to ANY
+    const binding_t* b   = m_bindings.data () + s.first;
+    const binding_t* end = b + s.count;
+    for (; b != end; ++b)
+      {
+	if (b->parent == parent || b->parent == ANY)
+	  {
+	    return b->handler;
+	  }
+      }
+    return 0;
+  }
+  // ---------------------------------------------------------------
+  inline const handler_registry_c::slot_t* handler_registry_c::find (iff_id_t id) const
+  {
+    if (m_slots.empty ())
+      {
+	return 0;
+      }
+    if (m_perfect)
+      {
+	const uint32_t h = _mix (id ^ m_seed);
+	const uint32_t d = m_displace [h & m_bucket_mask];
+	const slot_t&  s = m_slots [_mix (h + d * 0x9E3779B9U) & m_slot_mask];
+	// an empty slot has no bindings, whatever its id
+	return s.id == id && s.count ? &s : 0;
+      }
+    size_t lo = 0;
+    size_t hi = m_slots.size ();
+    while (lo < hi)
+      {
+	const size_t mid = (lo + hi) / 2;
+	if (m_slots [mid].id < id)
+	  {
+	    lo = mid + 1;
+	  }
+	else
+	  {
+	    hi = mid;
+	  }
+      }
+    return lo < m_slots.size () && m_slots [lo].id == id ? &m_slots [lo] : 0;
+  }
+  // ---------------------------------------------------------------
+  inline chunk_handler_c* handler_registry_c::lookup (iff_id_t parent, iff_id_t id) const
+  {
+    const slot_t* s = find (id);
+    return s ? _match (*s, parent) : 0;
+  }
+  // ---------------------------------------------------------------
+  inline chunk_handler_c* handler_registry_c::lookup (const iff_id_t* scope, size_t depth,
+						      iff_id_t id) const
+  {
+    const slot_t* s = find (id);
+    return s ? match (*s, scope, depth) : 0;
+  }
+  // ---------------------------------------------------------------
+  inline bool handler_registry_c::is_scoped (const slot_t& s) const
+  {
+    // bindings to a tag sort before the one to ANY
+    return m_bindings [s.first].parent != ANY;
+  }
+  // ---------------------------------------------------------------
+  inline chunk_handler_c* handler_registry_c::match (const slot_t& s, const iff_id_t* scope,
+						     size_t depth) const
+  {
+    const binding_t* begin = m_bindings.data () + s.first;
+    const binding_t* end   = begin + s.count;
+    for (size_t i = 0; i < depth; i++)
+      {
+	for (const binding_t* b = begin; b != end; ++b)
+	  {
+	    if (b->parent == scope [i] && b->parent != ANY)
+	      {
+		return b->handler;
+	      }
+	  }
+      }
+    // the binding to ANY, if any, sorts last
+    return end [-1].parent == ANY ? end [-1].handler : 0;
+  }
+  // ---------------------------------------------------------------
+} // ns iff
+
+#endif
@@ -0,0 +1,200 @@
+#include <string.h>
+
+#include "core/index.hpp"
+
+namespace iff
+{
+  static void put_le (char* p, uint64_t v, unsigned bytes)
+  {
+    for (unsigned i = 0; i < bytes; i++, v >>= 8)
+      {
+	p [i] = (char)(v & 0xFF);
+      }
+  }
+  // -----------------------------------------------------------
+  static uint64_t get_le (const char* p, unsigned bytes)
+  {
+    uint64_t v = 0;
+    for (unsigned i = bytes; i > 0; i--)
+      {
+	v = (v << 8) | (unsigned char)p [i - 1];
+      }
+    return v;
+  }
+  // -----------------------------------------------------------
+  static void encode_header (char* p, uint64_t file_size, uint64_t count)
+  {
+    memset (p, 0, INDEX_HEADER_SIZE);
+    memcpy (p, "IFFX", 4);
+    put_le (p + 4,  INDEX_VERSION, 2);
+    put_le (p + 6,  INDEX_RECORD_SIZE, 2);
+    put_le (p + 8,  file_size, 8);
+    put_le (p + 16, count, 8);
+  }
+  // ===========================================================
+  index_writer_c::index_writer_c (std::ostream& os, memory_budget_c* budget, size_t buffer_size)
+    : m_os       (os),
+      m_budget   (budget),
+      m_capacity (buffer_size - buffer_size % INDEX_RECORD_SIZE),
+      m_reserved (0),
+      m_records  (0)
+  {
+    if (m_capacity == 0)
+      {
+	m_capacity = INDEX_RECORD_SIZE;
+      }
+  }
+  // -----------------------------------------------------------
+  index_writer_c::~index_writer_c ()
+  {
+    if (m_budget)
+      {
+	m_budget->release (m_reserved);
+      }
+  }
+  // -----------------------------------------------------------
+  index_writer_c::status_t index_writer_c::begin (uint64_t file_size)
+  {
+    if (m_reserved < m_capacity)
+      {
+	if (m_budget && !m_budget->reserve (m_capacity - m_reserved))
+	  {
+	    return eNO_MEMORY;
+	  }
+	m_reserved = m_capacity;
+	m_buffer.reserve (m_capacity);
+      }
+    m_buffer.clear ();
+    m_records = 0;
+    m_start   = m_os.tellp ();
+
+    char hdr [INDEX_HEADER_SIZE];
+    encode_header (hdr, file_size, 0);
+    m_os.write (hdr, sizeof (hdr));
+    return m_os.good () ? eOK : eIO_ERROR;
+  }
+  // -----------------------------------------------------------
+  index_writer_c::status_t index_writer_c::add (const index_record_t& r)
+  {
+    if (m_buffer.size () + INDEX_RECORD_SIZE > m_capacity)
+      {
+	const status_t rc = _flush ();
+	if (rc != eOK)
+	  {
+	    return rc;
+	  }
+      }
+    char p [INDEX_RECORD_SIZE];
+    memset (p, 0, sizeof (p));
+    put_le (p,      r.kind, 1);
+    put_le (p + 2,  r.depth, 2);
+    put_le (p + 4,  r.id, 4);
+    put_le (p + 8,  r.tag, 4);
+    put_le (p + 16, r.size, 8);
+    put_le (p + 24, r.offset, 8);
+    m_buffer.insert (m_buffer.end (), p, p + sizeof (p));
+    m_records++;
+    return eOK;
+  }
+  // -----------------------------------------------------------
+  index_writer_c::status_t index_writer_c::_flush ()
+  {
+    if (!m_buffer.empty ())
+      {
+	m_os.write (&m_buffer [0], m_buffer.size ());
+	m_buffer.clear ();
+      }
+    return m_os.good () ? eOK : eIO_ERROR;
+  }
+  // -----------------------------------------------------------
+  index_writer_c::status_t index_writer_c::finish ()
+  {
+    const status_t rc = _flush ();
+    if (rc != eOK)
+      {
+	return rc;
+      }
+    if (m_start == std::streampos (-1))
+      {
+	// a pipe: readers take records up to the end of the stream
+	m_os.flush ();
+	return m_os.good () ? eOK : eIO_ERROR;
+      }
+    const std::streampos end = m_os.tellp ();
+    char count [8];
+    put_le (count, m_records, 8);
+    m_os.seekp (m_start + std::streamoff (16));
+    m_os.write (count, sizeof (count));
+    m_os.seekp (end);
+    m_os.flush ();
+    return m_os.good () ? eOK : eIO_ERROR;
+  }
+  // -----------------------------------------------------------
+  uint64_t index_writer_c::records () const
+  {
+    return m_records;
+  }
+  // ===========================================================
+  index_reader_c::index_reader_c (std::istream& is)
+    : m_is          (is),
+      m_file_size   (0),
+      m_count       (0),
+      m_read        (0),
+      m_record_size (INDEX_RECORD_SIZE)
+  {
+  }
+  // -----------------------------------------------------------
+  bool index_reader_c::open ()
+  {
+    char hdr [INDEX_HEADER_SIZE];
+    if (!m_is.read (hdr, sizeof (hdr)) || memcmp (hdr, "IFFX", 4) != 0)
+      {
+	return false;
+      }
+    // later versions may append fields to a record, never reorder them
+    m_record_size = (unsigned)get_le (hdr + 6, 2);
+    if (get_le (hdr + 4, 2) < 1 || m_record_size < INDEX_RECORD_SIZE)
+      {
+	return false;
+      }
+    m_file_size = get_le (hdr + 8, 8);
+    m_count     = get_le (hdr + 16, 8);
+    m_read      = 0;
+    return true;
+  }
+  // -----------------------------------------------------------
+  bool index_reader_c::next (index_record_t& r)
+  {
+    if (m_count && m_read >= m_count)
+      {
+	return false;
+      }
+    char p [INDEX_RECORD_SIZE];
+    if (!m_is.read (p, sizeof (p)))
+      {
+	return false;
+      }
+    if (m_record_size > INDEX_RECORD_SIZE)
+      {
+	m_is.ignore (m_record_size - INDEX_RECORD_SIZE);
+      }
+    r.kind   = (uint8_t)get_le (p, 1);
+    r.depth  = (uint16_t)get_le (p + 2, 2);
+    r.id     = (iff_id_t)get_le (p + 4, 4);
+    r.tag    = (iff_id_t)get_le (p + 8, 4);
+    r.size   = get_le (p + 16, 8);
+    r.offset = get_le (p + 24, 8);
+    m_read++;
+    return true;
+  }
+  // -----------------------------------------------------------
+  uint64_t index_reader_c::file_size () const
+  {
+    return m_file_size;
+  }
+  // -----------------------------------------------------------
+  uint64_t index_reader_c::count () const
+  {
+    return m_count;
+  }
+} // ns iff
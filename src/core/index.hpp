@@ -0,0 +1,119 @@
+#ifndef __IFF_CORE_INDEX_HPP__
+#define __IFF_CORE_INDEX_HPP__
+
+#include <iostream>
+#include <vector>
+
+#include "core/iff_types.hpp"
+#include "core/memory_budget.hpp"
+
+// Binary structure index: the chunks and groups of a file as fixed
+// size records in file order, written while the file is parsed so the
+// structure never has to be held in memory.
+//
+// All fields are little endian.
+//
+//   header (32 bytes)
+//     0  "IFFX"
+//     4  u16 version (1)
+//     6  u16 record size (32)
+//     8  u64 size of the indexed file
+//    16  u64 number of records, 0 if the writer could not seek back
+//    24  u64 reserved
+//
+//   record (32 bytes)
+//     0  u8  kind (1 group, 2 chunk)
+//     1  u8  reserved
+//     2  u16 depth, 0 for top level objects
+//     4  u32 id
+//     8  u32 tag, the id for chunks
+//    12  u32 reserved
+//    16  u64 size as stored in the header
+//    24  u64 offset of the data (groups: of the tag) in the file
+
+namespace iff
+{
+  struct index_record_t
+  {
+    enum
+      {
+	eGROUP = 1,
+	eCHUNK = 2
+      };
+
+    uint8_t  kind;
+    uint16_t depth;
+    iff_id_t id;
+    iff_id_t tag;
+    uint64_t size;
+    uint64_t offset;
+  };
+
+  static const size_t INDEX_HEADER_SIZE = 32;
+  static const size_t INDEX_RECORD_SIZE = 32;
+  static const uint16_t INDEX_VERSION   = 1;
+  // ===================================================================
+  class index_writer_c
+  {
+  public:
+    enum status_t
+      {
+	eOK,
+	eIO_ERROR,
+	eNO_MEMORY
+      };
+
+    enum
+      {
+	DEFAULT_BUFFER_SIZE = 64 * 1024
+      };
+  public:
+    // buffer_size is rounded down to whole records; the buffer is
+    // reserved from budget by begin ()
+    index_writer_c (std::ostream& os, memory_budget_c* budget = 0,
+		    size_t buffer_size = DEFAULT_BUFFER_SIZE);
+    ~index_writer_c ();
+
+    status_t begin  (uint64_t file_size);
+    status_t add    (const index_record_t& r);
+    // flushes, and patches the record count if the stream can seek
+    status_t finish ();
+
+    uint64_t records () const;
+  private:
+    index_writer_c (const index_writer_c&);
+    index_writer_c& operator = (const index_writer_c&);
+
+    status_t _flush ();
+  private:
+    std::ostream&        m_os;
+    memory_budget_c*     m_budget;
+    size_t               m_capacity;
+    size_t               m_reserved;
+    std::vector <char>   m_buffer;
+    std::streampos       m_start;
+    uint64_t             m_records;
+  };
+  // ===================================================================
+  class index_reader_c
+  {
+  public:
+    explicit index_reader_c (std::istream& is);
+
+    // reads and checks the header
+    bool open ();
+    // false at the end of the index or on a short record
+    bool next (index_record_t& r);
+
+    uint64_t file_size () const;
+    uint64_t count     () const;
+  private:
+    std::istream& m_is;
+    uint64_t      m_file_size;
+    uint64_t      m_count;
+    uint64_t      m_read;
+    unsigned      m_record_size;
+  };
+} // ns iff
+
+#endif
@@ -0,0 +1,141 @@
+#ifndef __IFF_CORE_INDEX_BUILDER_HPP__
+#define __IFF_CORE_INDEX_BUILDER_HPP__
+
+#include "core/generic_iff_reader.hpp"
+#include "core/index.hpp"
+
+namespace iff
+{
+  // Streams the structure of a file to an index_writer_c while it is
+  // parsed. Memory stays bounded by the reader's depth stack and the
+  // writer's buffer whatever the size of the file, so this is the
+  // structure mode for huge files under a tight memory budget.
+  template <class IO_POLICY>
+  class index_builder_c : public generic_iff_reader_c <IO_POLICY>
+  {
+    typedef generic_iff_reader_c <IO_POLICY> reader_t;
+    typedef typename reader_t::id_t          id_t;
+  public:
+    typedef typename reader_t::status_t      status_t;
+
+    // budget covers the reader, the writer reserves its own buffer
+    explicit index_builder_c (index_writer_c& out, memory_budget_c* budget = 0);
+
+    status_t build (const char* path);
+  private:
+    virtual void _on_chunk_enter (const id_t& id, std::streamsize chunk_size, std::streamsize file_pos);
+    virtual void _on_chunk_exit  (const id_t& id, std::streamsize chunk_size, std::streamsize file_pos);
+    virtual void _on_group_enter (const id_t& id, const id_t& tag,
+				  std::streamsize group_size, std::streamsize file_pos);
+    virtual void _on_group_exit  (const id_t& id, const id_t& tag,
+				  std::streamsize group_size, std::streamsize file_pos);
+
+    void _emit (uint8_t kind, const id_t& id, const id_t& tag,
+		std::streamsize size, std::streamsize file_pos);
+    static status_t _status (index_writer_c::status_t rc);
+  private:
+    index_writer_c& m_out;
+    uint16_t        m_depth;
+  };
+} // ns iff
+
+// ===================================================
+// Implementation
+// ===================================================
+
+namespace iff
+{
+  template <class IO_POLICY>
+  index_builder_c <IO_POLICY>::index_builder_c (index_writer_c& out, memory_budget_c* budget)
+    : m_out   (out),
+      m_depth (0)
+  {
+    this->set_memory_budget (budget);
+  }
+  // -------------------------------------------------
+  template <class IO_POLICY>
+  typename index_builder_c <IO_POLICY>::status_t
+  index_builder_c <IO_POLICY>::_status (index_writer_c::status_t rc)
+  {
+    switch (rc)
+      {
+      case index_writer_c::eOK:
+	return reader_t::eOK;
+      case index_writer_c::eNO_MEMORY:
+	return reader_t::eNO_MEMORY;
+      default:
+	return reader_t::eIO_ERROR;
+      }
+  }
+  // -------------------------------------------------
+  template <class IO_POLICY>
+  typename index_builder_c <IO_POLICY>::status_t
+  index_builder_c <IO_POLICY>::build (const char* path)
+  {
+    status_t rc = this->open (path);
+    if (rc != reader_t::eOK)
+      {
+	return rc;
+      }
+    rc = _status (m_out.begin ((uint64_t)this->file_size ()));
+    if (rc != reader_t::eOK)
+      {
+	return rc;
+      }
+    m_depth = 0;
+    rc = this->read ();
+    if (rc != reader_t::eOK)
+      {
+	return rc;
+      }
+    return _status (m_out.finish ());
+  }
+  // -------------------------------------------------
+  template <class IO_POLICY>
+  void index_builder_c <IO_POLICY>::_emit (uint8_t kind, const id_t& id, const id_t& tag,
+					   std::streamsize size, std::streamsize file_pos)
+  {
+    index_record_t r;
+    r.kind   = kind;
+    r.depth  = m_depth;
+    r.id     = id.value ();
+    r.tag    = tag.value ();
+    r.size   = (uint64_t)size;
+    r.offset = (uint64_t)file_pos;
+    const status_t rc = _status (m_out.add (r));
+    if (rc != reader_t::eOK)
+      {
+	this->_stop (rc);
+      }
+  }
+  // -------------------------------------------------
+  template <class IO_POLICY>
+  void index_builder_c <IO_POLICY>::_on_chunk_enter (const id_t& id, std::streamsize chunk_size,
+						     std::streamsize file_pos)
+  {
+    _emit (index_record_t::eCHUNK, id, id, chunk_size, file_pos);
+  }
+  // -------------------------------------------------
+  template <class IO_POLICY>
+  void index_builder_c <IO_POLICY>::_on_chunk_exit (const id_t&, std::streamsize, std::streamsize)
+  {
+  }
+  // -------------------------------------------------
+  template <class IO_POLICY>
+  void index_builder_c <IO_POLICY>::_on_group_enter (const id_t& id, const id_t& tag,
+						     std::streamsize group_size,
+						     std::streamsize file_pos)
+  {
+    _emit (index_record_t::eGROUP, id, tag, group_size, file_pos);
+    m_depth++;
+  }
+  // -------------------------------------------------
+  template <class IO_POLICY>
+  void index_builder_c <IO_POLICY>::_on_group_exit (const id_t&, const id_t&,
+						    std::streamsize, std::streamsize)
+  {
+    m_depth--;
+  }
+} // ns iff
+
+#endif
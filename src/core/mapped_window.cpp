@@ -0,0 +1,118 @@
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "core/mapped_window.hpp"
+
+namespace iff
+{
+  mapped_window_c::mapped_window_c (size_t window)
+    : m_fd        (-1),
+      m_window    (window),
+      m_file_size (0),
+      m_base      (0),
+      m_start     (0),
+      m_length    (0),
+      m_remaps    (0)
+  {
+    const size_t page = (size_t)sysconf (_SC_PAGESIZE);
+    // at least two pages, so that any request up to a page fits
+    // whatever its alignment
+    m_window = (m_window + page - 1) / page * page;
+    if (m_window < 2 * page)
+      {
+	m_window = 2 * page;
+      }
+  }
+  // -----------------------------------------------------------
+  mapped_window_c::~mapped_window_c ()
+  {
+    _unmap ();
+  }
+  // -----------------------------------------------------------
+  bool mapped_window_c::attach (int fd)
+  {
+    detach ();
+    struct stat st;
+    if (fd < 0 || fstat (fd, &st) != 0)
+      {
+	return false;
+      }
+    m_fd        = fd;
+    m_file_size = (uint64_t)st.st_size;
+    return true;
+  }
+  // -----------------------------------------------------------
+  void mapped_window_c::detach ()
+  {
+    _unmap ();
+    m_fd        = -1;
+    m_file_size = 0;
+  }
+  // -----------------------------------------------------------
+  const uint8_t* mapped_window_c::at (uint64_t offset, size_t size)
+  {
+    if (m_fd < 0 || offset > m_file_size || size > m_file_size - offset)
+      {
+	return 0;
+      }
+    if (m_base && offset >= m_start && offset + size <= m_start + m_length)
+      {
+	return m_base + (offset - m_start);
+      }
+    const uint64_t page = (uint64_t)sysconf (_SC_PAGESIZE);
+    // a quarter of the window behind the request, the rest ahead, so
+    // scrolling either way stays inside for a while
+    uint64_t start = offset > m_window / 4 ? offset - m_window / 4 : 0;
+    start -= start % page;
+    if (offset + size > start + m_window)
+      {
+	start = (offset - offset % page);
+	if (offset + size > start + m_window)
+	  {
+	    return 0;
+	  }
+      }
+    uint64_t length = m_file_size - start;
+    if (length > m_window)
+      {
+	length = m_window;
+      }
+    _unmap ();
+    void* p = mmap (0, (size_t)length, PROT_READ, MAP_SHARED, m_fd, (off_t)start);
+    if (p == MAP_FAILED)
+      {
+	return 0;
+      }
+    m_base   = (const uint8_t*)p;
+    m_start  = start;
+    m_length = (size_t)length;
+    m_remaps++;
+    return m_base + (offset - m_start);
+  }
+  // -----------------------------------------------------------
+  uint64_t mapped_window_c::file_size () const
+  {
+    return m_file_size;
+  }
+  // -----------------------------------------------------------
+  size_t mapped_window_c::window () const
+  {
+    return m_window;
+  }
+  // -----------------------------------------------------------
+  uint64_t mapped_window_c::remaps () const
+  {
+    return m_remaps;
+  }
+  // -----------------------------------------------------------
+  void mapped_window_c::_unmap ()
+  {
+    if (m_base)
+      {
+	munmap ((void*)m_base, m_length);
+	m_base   = 0;
+	m_length = 0;
+      }
+  }
+} // ns iff
@@ -0,0 +1,48 @@
+#ifndef __IFF_CORE_MAPPED_WINDOW_HPP__
+#define __IFF_CORE_MAPPED_WINDOW_HPP__
+
+#include <stddef.h>
+#include "core/iff_types.hpp"
+
+namespace iff
+{
+  // Random read access to a file of any size through one mmap window.
+  // A request outside the current window maps a new one around it, so
+  // a viewer scrolling through gigabytes maps a bounded amount and
+  // remaps only every window bytes or so. The descriptor belongs to
+  // the caller and has to outlive the window.
+  class mapped_window_c
+  {
+  public:
+    explicit mapped_window_c (size_t window = 16 * 1024 * 1024);
+    ~mapped_window_c ();
+
+    // false if fd cannot be stat'ed
+    bool attach (int fd);
+    void detach ();
+
+    // size bytes at offset, 0 if they are not all in the file, do not
+    // fit a window or the mapping fails. Valid until the next call.
+    const uint8_t* at (uint64_t offset, size_t size);
+
+    uint64_t file_size () const;
+    size_t   window    () const;
+    // mappings made so far
+    uint64_t remaps    () const;
+  private:
+    mapped_window_c (const mapped_window_c&);
+    mapped_window_c& operator = (const mapped_window_c&);
+
+    void _unmap ();
+  private:
+    int            m_fd;
+    size_t         m_window;
+    uint64_t       m_file_size;
+    const uint8_t* m_base;
+    uint64_t       m_start;
+    size_t         m_length;
+    uint64_t       m_remaps;
+  };
+} // ns iff
+
+#endif
@@ -0,0 +1,56 @@
+#ifndef __IFF_CORE_MEMBUF_HPP__
+#define __IFF_CORE_MEMBUF_HPP__
+
+#include <streambuf>
+#include <iostream>
+
+namespace iff
+{
+  // Read-only, seekable std::streambuf over memory owned by the caller.
+  // Seeking outside the buffer fails instead of extending it.
+  class membuf_c : public std::streambuf
+  {
+  public:
+    membuf_c ()
+    {
+      set (0, 0);
+    }
+
+    void set (const char* data, std::streamsize size)
+    {
+      char* p = const_cast <char*> (data);
+      setg (p, p, p + size);
+    }
+  protected:
+    virtual pos_type seekoff (off_type off, std::ios::seekdir dir, std::ios::openmode which)
+    {
+      if (!(which & std::ios::in))
+	{
+	  return pos_type (off_type (-1));
+	}
+      off_type base = 0;
+      if (dir == std::ios::cur)
+	{
+	  base = gptr () - eback ();
+	}
+      else if (dir == std::ios::end)
+	{
+	  base = egptr () - eback ();
+	}
+      return seekpos (pos_type (base + off), which);
+    }
+
+    virtual pos_type seekpos (pos_type pos, std::ios::openmode which)
+    {
+      const off_type p = off_type (pos);
+      if (!(which & std::ios::in) || p < 0 || p > egptr () - eback ())
+	{
+	  return pos_type (off_type (-1));
+	}
+      setg (eback (), eback () + p, egptr ());
+      return pos;
+    }
+  };
+} // ns iff
+
+#endif
@@ -0,0 +1,73 @@
+#ifndef __IFF_CORE_MEMORY_BUDGET_HPP__
+#define __IFF_CORE_MEMORY_BUDGET_HPP__
+
+#include <cstddef>
+#include <atomic>
+
+namespace iff
+{
+  // A hard cap on the memory a parse may hold. Readers, structure
+  // builders and payload windows reserve what they are about to
+  // allocate and fail with a status instead of allocating past the
+  // cap. One budget may be shared by several threads.
+  class memory_budget_c
+  {
+  public:
+    static const size_t UNLIMITED = ~(size_t)0;
+
+    explicit memory_budget_c (size_t limit = UNLIMITED)
+      : m_used  (0),
+	m_peak  (0),
+	m_limit (limit)
+    {
+    }
+
+    // all or nothing: false, and nothing reserved, if bytes do not fit
+    bool reserve (size_t bytes)
+    {
+      size_t used = m_used.load (std::memory_order_relaxed);
+      do
+	{
+	  if (bytes > m_limit - used)
+	    {
+	      return false;
+	    }
+	}
+      while (!m_used.compare_exchange_weak (used, used + bytes, std::memory_order_relaxed));
+
+      size_t peak = m_peak.load (std::memory_order_relaxed);
+      while (used + bytes > peak &&
+	     !m_peak.compare_exchange_weak (peak, used + bytes, std::memory_order_relaxed))
+	{
+	}
+      return true;
+    }
+
+    void release (size_t bytes)
+    {
+      m_used.fetch_sub (bytes, std::memory_order_relaxed);
+    }
+
+    size_t used  () const
+    {
+      return m_used.load (std::memory_order_relaxed);
+    }
+    size_t peak  () const
+    {
+      return m_peak.load (std::memory_order_relaxed);
+    }
+    size_t limit () const
+    {
+      return m_limit;
+    }
+  private:
+    memory_budget_c (const memory_budget_c&);
+    memory_budget_c& operator = (const memory_budget_c&);
+  private:
+    std::atomic <size_t> m_used;
+    std::atomic <size_t> m_peak;
+    const size_t         m_limit;
+  };
+} // ns iff
+
+#endif
@@ -8,5 +8,10 @@ namespace iff
   parser_c::~parser_c ()
   {
   }
+  const reader_stats_t& parser_c::stats () const
+  {
+    static const reader_stats_t empty;
+    return empty;
+  }
 }
 
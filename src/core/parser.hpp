@@ -4,6 +4,8 @@
 #include <iostream>
 #include <string>
 
+#include "core/reader_stats.hpp"
+
 namespace iff
 {
   
@@ -23,6 +25,9 @@ namespace iff
     
     virtual status_t open (const char* filename) = 0;
     virtual status_t read () = 0;
+
+    // counters of the last read (); all zero unless a subclass keeps them
+    virtual const reader_stats_t& stats () const;
   protected:
     virtual void _on_chunk_enter (const std::string& id, 
 				  std::streamsize chunk_size, 
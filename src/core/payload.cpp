@@ -0,0 +1,63 @@
+#include "core/payload.hpp"
+
+namespace iff
+{
+  payload_reader_c::payload_reader_c (std::istream& is, size_t window, memory_budget_c* budget)
+    : m_is       (is),
+      m_budget   (budget),
+      m_window   (window ? window : 1),
+      m_reserved (0),
+      m_left     (0)
+  {
+  }
+  // -----------------------------------------------------------
+  payload_reader_c::~payload_reader_c ()
+  {
+    if (m_budget)
+      {
+	m_budget->release (m_reserved);
+      }
+  }
+  // -----------------------------------------------------------
+  payload_reader_c::status_t payload_reader_c::open (uint64_t offset, uint64_t size)
+  {
+    if (m_reserved == 0)
+      {
+	if (m_budget && !m_budget->reserve (m_window))
+	  {
+	    return eNO_MEMORY;
+	  }
+	m_reserved = m_window;
+	m_buffer.resize (m_window);
+      }
+    m_is.clear ();
+    m_is.seekg ((std::streamoff)offset);
+    m_left = size;
+    return m_is.good () ? eOK : eIO_ERROR;
+  }
+  // -----------------------------------------------------------
+  payload_reader_c::status_t payload_reader_c::next (const uint8_t*& data, size_t& size)
+  {
+    size = 0;
+    data = m_buffer.empty () ? 0 : &m_buffer [0];
+    if (m_left == 0)
+      {
+	return eOK;
+      }
+    const size_t n = m_left < m_window ? (size_t)m_left : m_window;
+    m_is.read ((char*)&m_buffer [0], n);
+    if (m_is.gcount () != (std::streamsize)n)
+      {
+	m_left = 0;
+	return eIO_ERROR;
+      }
+    m_left -= n;
+    size    = n;
+    return eOK;
+  }
+  // -----------------------------------------------------------
+  uint64_t payload_reader_c::left () const
+  {
+    return m_left;
+  }
+} // ns iff
@@ -0,0 +1,48 @@
+#ifndef __IFF_CORE_PAYLOAD_HPP__
+#define __IFF_CORE_PAYLOAD_HPP__
+
+#include <iostream>
+#include <vector>
+
+#include "core/iff_types.hpp"
+#include "core/memory_budget.hpp"
+
+namespace iff
+{
+  // Reads a chunk payload through a fixed window instead of loading it
+  // whole, so payload views of any size cost at most window bytes.
+  class payload_reader_c
+  {
+  public:
+    enum status_t
+      {
+	eOK,
+	eIO_ERROR,
+	eNO_MEMORY
+      };
+  public:
+    // the window is reserved from budget by the first open ()
+    payload_reader_c (std::istream& is, size_t window, memory_budget_c* budget = 0);
+    ~payload_reader_c ();
+
+    // offset and size as reported for the chunk, see index_record_t
+    status_t open (uint64_t offset, uint64_t size);
+    // the next part of the payload, size 0 once it is exhausted.
+    // data stays valid until the next call.
+    status_t next (const uint8_t*& data, size_t& size);
+
+    uint64_t left () const;
+  private:
+    payload_reader_c (const payload_reader_c&);
+    payload_reader_c& operator = (const payload_reader_c&);
+  private:
+    std::istream&         m_is;
+    memory_budget_c*      m_budget;
+    size_t                m_window;
+    size_t                m_reserved;
+    std::vector <uint8_t> m_buffer;
+    uint64_t              m_left;
+  };
+} // ns iff
+
+#endif
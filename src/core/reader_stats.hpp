@@ -0,0 +1,45 @@
+#ifndef __IFF_CORE_READER_STATS_HPP__
+#define __IFF_CORE_READER_STATS_HPP__
+
+#include "core/iff_types.hpp"
+
+// Hot path counters are compiled in only when IFF_HAS_STATS is defined
+// (cmake option optHAS_STATS). Without it every IFF_STAT statement
+// vanishes and reader_stats_t stays zeroed.
+#if defined(IFF_HAS_STATS)
+#define IFF_STAT(S) S
+#else
+#define IFF_STAT(S)
+#endif
+
+namespace iff
+{
+  struct reader_stats_t
+  {
+    uint64_t tellg_calls;
+    uint64_t seekg_calls;
+    uint64_t bytes_read;
+    uint64_t headers;
+    uint64_t events;
+    unsigned max_depth;
+    double   wall_time;   // seconds spent in read ()
+
+    reader_stats_t ()
+    {
+      reset ();
+    }
+
+    void reset ()
+    {
+      tellg_calls = 0;
+      seekg_calls = 0;
+      bytes_read  = 0;
+      headers     = 0;
+      events      = 0;
+      max_depth   = 0;
+      wall_time   = 0;
+    }
+  };
+} // ns iff
+
+#endif
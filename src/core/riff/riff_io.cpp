@@ -0,0 +1,96 @@
+#include <string.h>
+#include "core/riff/riff_io.hpp"
+#include "core/iff_io.hpp"
+
+using namespace iff::ea::literals;
+
+namespace iff
+{
+  namespace riff
+  {
+    // -----------------------------------------------------------------
+    bool io_c::has_header ()
+    {
+      return false;
+    }
+    // -----------------------------------------------------------------
+    unsigned io_c::bytes_in_header ()
+    {
+      return 4;
+    }
+    // -----------------------------------------------------------------
+    bool io_c::check_header (const char* hdr)
+    {
+      if (!hdr)
+	{
+	  return false;
+	}
+      return memcmp (hdr, "RIFF", 4) == 0;
+    }
+    // -----------------------------------------------------------------
+    bool io_c::is_group (const id_c& id)
+    {
+      switch (id)
+	{
+	case "RIFF"_id:
+	case "LIST"_id:
+	  return true;
+	default:
+	  return false;
+	}
+    }
+    // -----------------------------------------------------------------
+    std::streamsize io_c::real_size (size_type_t size)
+    {
+      return (std::streamsize)size + (size & 1);
+    }
+    // -----------------------------------------------------------------
+    bool io_c::group_has_tag ()
+    {
+      return true;
+    }
+    // -----------------------------------------------------------------
+    bool io_c::should_start_with_group ()
+    {
+      return true;
+    }
+    // -----------------------------------------------------------------
+    bool io_c::read_group_header (std::istream& is, id_t& id, size_type_t& size,
+				  std::streamsize& total_size)
+    {
+      // the id reads as a big endian word to keep its character order
+      const uint32_t i = read_32 (is, eBIG_ENDIAN);
+      const uint32_t s = read_32 (is, eLITTLE_ENDIAN);
+      if (!is.good ())
+	{
+	  return false;
+	}
+      id   = id_c (i);
+      size = s;
+      total_size = 8;
+      return true;
+    }
+    // -----------------------------------------------------------------
+    bool io_c::read_group_id (std::istream& is, id_t& id, std::streamsize& size)
+    {
+      const uint32_t i = read_32 (is, eBIG_ENDIAN);
+      if (!is.good ())
+	{
+	  return false;
+	}
+      id   = id_c (i);
+      size = 4;
+      return true;
+    }
+    // -----------------------------------------------------------------
+    std::streamsize io_c::size_of_id ()
+    {
+      return 4;
+    }
+    // -----------------------------------------------------------------
+    std::streamsize io_c::size_of_header ()
+    {
+      return 8;
+    }
+  } // ns riff
+} // ns iff
@@ -2,6 +2,10 @@
 
 namespace iff 
 {
+  object_c::object_c ()
+  {
+  }
+  // --------------------------------------------------------
   object_c::~object_c ()
   {
   }
@@ -100,14 +104,42 @@ namespace iff
     m_objects.push_back (obj);
   }
   // ===========================================================
-  structure_c::structure_c (const char* file_name, std::streamsize file_size)
+  structure_c::structure_c (const char* file_name, std::streamsize file_size,
+			    memory_budget_c* budget)
     : m_file_name (file_name),
-      m_root      ("", 0, file_size)
+      m_root      ("", 0, file_size),
+      m_budget    (budget),
+      m_reserved  (0)
   {
   }
   // -----------------------------------------------------------
   structure_c::~structure_c ()
   {
+    if (m_budget)
+      {
+	m_budget->release (m_reserved);
+      }
+  }
+  // -----------------------------------------------------------
+  bool structure_c::reserve (size_t bytes)
+  {
+    if (m_budget && !m_budget->reserve (bytes))
+      {
+	return false;
+      }
+    m_reserved += bytes;
+    return true;
+  }
+  // -----------------------------------------------------------
+  size_t structure_c::reserved () const
+  {
+    return m_reserved;
+  }
+  // -----------------------------------------------------------
+  size_t structure_c::node_cost (size_t object_size)
+  {
+    // list node (two links and the pointer) and two allocator headers
+    return object_size + 3 * sizeof (void*) + 2 * 16;
   }
   // -----------------------------------------------------------
   void structure_c::add (object_c* obj)
@@ -5,6 +5,8 @@
 #include <iostream>
 #include <list>
 
+#include "core/memory_budget.hpp"
+
 namespace iff
 {
   class object_c
@@ -66,10 +68,17 @@ namespace iff
   {
     typedef group_c::iterator_t iterator_t;
   public:
-    structure_c (const char* file_name, std::streamsize file_size);
+    // objects added to a structure with a budget must be reserved
+    // from it first, the structure releases them when destroyed
+    structure_c (const char* file_name, std::streamsize file_size,
+		 memory_budget_c* budget = 0);
     ~structure_c ();
 
     void add (object_c* obj);
+    bool reserve (size_t bytes);
+    size_t reserved () const;
+    // estimated heap bytes of one object, allocator overhead included
+    static size_t node_cost (size_t object_size);
     
     iterator_t begin () const;
     iterator_t end   () const;
@@ -79,6 +88,8 @@ namespace iff
   private:
     std::string     m_file_name;
     group_c         m_root;
+    memory_budget_c* m_budget;
+    size_t          m_reserved;
   };
   
 } // ns iff
@@ -0,0 +1,171 @@
+#ifndef __IFF_CORE_STRUCTURE_BUILDER_HPP__
+#define __IFF_CORE_STRUCTURE_BUILDER_HPP__
+
+#include <vector>
+
+#include "core/generic_iff_reader.hpp"
+#include "core/structure.hpp"
+#include "core/memory_budget.hpp"
+
+namespace iff
+{
+  // Parses a file into a structure_c. With a memory budget the
+  // structure and every node are charged to it as they are made; a file whose structure does
+  // not fit fails with eNO_MEMORY and leaves the budget as it was.
+  // Files too large for any budget are better served by
+  // index_builder_c, which streams the structure out instead.
+  template <class IO_POLICY>
+  class structure_builder_c : public generic_iff_reader_c <IO_POLICY>
+  {
+    typedef generic_iff_reader_c <IO_POLICY> reader_t;
+    typedef typename reader_t::id_t          id_t;
+  public:
+    typedef typename reader_t::status_t      status_t;
+
+    explicit structure_builder_c (memory_budget_c* budget = 0);
+
+    // 0 on failure, status () tells why. The caller owns the result.
+    structure_c* build (const char* path);
+    status_t     status () const;
+
+    // estimated heap bytes of one node, allocator overhead included
+    static size_t node_cost (size_t object_size);
+  private:
+    virtual void _on_chunk_enter (const id_t& id, std::streamsize chunk_size, std::streamsize file_pos);
+    virtual void _on_chunk_exit  (const id_t& id, std::streamsize chunk_size, std::streamsize file_pos);
+    virtual void _on_group_enter (const id_t& id, const id_t& tag,
+				  std::streamsize group_size, std::streamsize file_pos);
+    virtual void _on_group_exit  (const id_t& id, const id_t& tag,
+				  std::streamsize group_size, std::streamsize file_pos);
+
+    void _add (object_c* obj);
+  private:
+    memory_budget_c*        m_budget;
+    structure_c*            m_structure;
+    std::vector <group_c*>  m_groups;
+    status_t                m_status;
+  };
+} // ns iff
+
+// ===================================================
+// Implementation
+// ===================================================
+
+namespace iff
+{
+  template <class IO_POLICY>
+  structure_builder_c <IO_POLICY>::structure_builder_c (memory_budget_c* budget)
+    : m_budget    (budget),
+      m_structure (0),
+      m_status    (reader_t::eOK)
+  {
+    this->set_memory_budget (budget);
+  }
+  // -------------------------------------------------
+  template <class IO_POLICY>
+  size_t structure_builder_c <IO_POLICY>::node_cost (size_t object_size)
+  {
+    return structure_c::node_cost (object_size);
+  }
+  // -------------------------------------------------
+  template <class IO_POLICY>
+  structure_c* structure_builder_c <IO_POLICY>::build (const char* path)
+  {
+    m_status = this->open (path);
+    if (m_status != reader_t::eOK)
+      {
+	return 0;
+      }
+    // the parent stack is bounded by the depth limit
+    const size_t stack_bytes = this->max_depth () * sizeof (group_c*);
+    if (m_budget && !m_budget->reserve (stack_bytes))
+      {
+	m_status = reader_t::eNO_MEMORY;
+	return 0;
+      }
+    m_groups.clear ();
+    m_groups.reserve (this->max_depth ());
+    // the structure itself counts too, as in structure_cache_c::footprint ()
+    m_structure = new structure_c (path, this->file_size (), m_budget);
+    m_status = m_structure->reserve (sizeof (structure_c)) ? this->read () : reader_t::eNO_MEMORY;
+    if (m_budget)
+      {
+	m_budget->release (stack_bytes);
+      }
+    std::vector <group_c*> ().swap (m_groups);
+
+    structure_c* result = m_structure;
+    m_structure = 0;
+    if (m_status != reader_t::eOK)
+      {
+	delete result;
+	return 0;
+      }
+    return result;
+  }
+  // -------------------------------------------------
+  template <class IO_POLICY>
+  typename structure_builder_c <IO_POLICY>::status_t
+  structure_builder_c <IO_POLICY>::status () const
+  {
+    return m_status;
+  }
+  // -------------------------------------------------
+  template <class IO_POLICY>
+  void structure_builder_c <IO_POLICY>::_add (object_c* obj)
+  {
+    if (m_groups.empty ())
+      {
+	m_structure->add (obj);
+      }
+    else
+      {
+	m_groups.back ()->add (obj);
+      }
+  }
+  // -------------------------------------------------
+  template <class IO_POLICY>
+  void structure_builder_c <IO_POLICY>::_on_chunk_enter (const id_t& id,
+							  std::streamsize chunk_size,
+							  std::streamsize file_pos)
+  {
+    if (!m_structure->reserve (node_cost (sizeof (chunk_c))))
+      {
+	this->_stop (reader_t::eNO_MEMORY);
+	return;
+      }
+    _add (new chunk_c (id.to_string (), file_pos, chunk_size));
+  }
+  // -------------------------------------------------
+  template <class IO_POLICY>
+  void structure_builder_c <IO_POLICY>::_on_chunk_exit (const id_t&, std::streamsize, std::streamsize)
+  {
+  }
+  // -------------------------------------------------
+  template <class IO_POLICY>
+  void structure_builder_c <IO_POLICY>::_on_group_enter (const id_t& id, const id_t& tag,
+							  std::streamsize group_size,
+							  std::streamsize file_pos)
+  {
+    if (!m_structure->reserve (node_cost (sizeof (group_c))))
+      {
+	this->_stop (reader_t::eNO_MEMORY);
+	return;
+      }
+    group_c* g = new group_c (id.to_string (), tag.to_string (), file_pos, group_size);
+    _add (g);
+    m_groups.push_back (g);
+  }
+  // -------------------------------------------------
+  template <class IO_POLICY>
+  void structure_builder_c <IO_POLICY>::_on_group_exit (const id_t&, const id_t&,
+							 std::streamsize, std::streamsize)
+  {
+    if (!m_groups.empty ())
+      {
+	m_groups.pop_back ();
+      }
+  }
+} // ns iff
+
+#endif
@@ -0,0 +1,273 @@
+#include <sys/stat.h>
+
+#include "core/structure_cache.hpp"
+
+namespace iff
+{
+  bool structure_cache_c::key_t::operator == (const key_t& other) const
+  {
+    return dev == other.dev && ino == other.ino && size == other.size &&
+      mtime_ns == other.mtime_ns;
+  }
+  // -----------------------------------------------------------
+  size_t structure_cache_c::key_hash_t::operator () (const key_t& k) const
+  {
+    uint64_t h = k.ino * 0x9E3779B97F4A7C15ull;
+    h ^= (k.dev + (h << 6) + (h >> 2));
+    h ^= (k.size + (h << 6) + (h >> 2)) * 0xC2B2AE3D27D4EB4Full;
+    h ^= ((uint64_t)k.mtime_ns + (h << 6) + (h >> 2));
+    return (size_t)(h ^ (h >> 29));
+  }
+  // ===========================================================
+  structure_cache_c::structure_cache_c (const loader_t& loader, size_t budget, unsigned shards)
+    : m_loader    (loader),
+      m_budget    (budget),
+      m_bytes     (0),
+      m_count     (0),
+      m_clock     (0),
+      m_hits      (0),
+      m_misses    (0),
+      m_loads     (0),
+      m_evictions (0)
+  {
+    for (unsigned i = 0; i < (shards ? shards : 1); i++)
+      {
+	m_shards.push_back (new shard_t);
+      }
+  }
+  // -----------------------------------------------------------
+  // no get () may be running, so nothing is loading
+  structure_cache_c::~structure_cache_c ()
+  {
+    clear ();
+    for (size_t i = 0; i < m_shards.size (); i++)
+      {
+	delete m_shards [i];
+      }
+  }
+  // -----------------------------------------------------------
+  structure_cache_c::shard_t& structure_cache_c::_shard (const key_t& k)
+  {
+    return *m_shards [key_hash_t () (k) % m_shards.size ()];
+  }
+  // -----------------------------------------------------------
+  static size_t objects_footprint (const group_c::iterator_t& begin,
+				   const group_c::iterator_t& end)
+  {
+    size_t n = 0;
+    for (group_c::iterator_t i = begin; i != end; ++i)
+      {
+	if ((*i)->is_group ())
+	  {
+	    const group_c* g = static_cast <const group_c*> (*i);
+	    n += structure_c::node_cost (sizeof (group_c)) + objects_footprint (g->begin (), g->end ());
+	  }
+	else
+	  {
+	    n += structure_c::node_cost (sizeof (chunk_c));
+	  }
+      }
+    return n;
+  }
+  // -----------------------------------------------------------
+  size_t structure_cache_c::footprint (const structure_c& s)
+  {
+    return sizeof (structure_c) + objects_footprint (s.begin (), s.end ());
+  }
+  // -----------------------------------------------------------
+  bool structure_cache_c::_key (const char* path, key_t& k)
+  {
+    struct stat st;
+    if (!path || stat (path, &st) != 0)
+      {
+	return false;
+      }
+    k.dev      = (uint64_t)st.st_dev;
+    k.ino      = (uint64_t)st.st_ino;
+    k.size     = (uint64_t)st.st_size;
+    k.mtime_ns = (int64_t)st.st_mtim.tv_sec * 1000000000 + st.st_mtim.tv_nsec;
+    return true;
+  }
+  // -----------------------------------------------------------
+  structure_cache_c::structure_ptr_t structure_cache_c::get (const char* path)
+  {
+    key_t k;
+    if (!_key (path, k))
+      {
+	return structure_ptr_t ();
+      }
+
+    shard_t& s = _shard (k);
+    std::shared_future <structure_ptr_t> other;
+    std::promise <structure_ptr_t>       promise;
+    entry_t* mine = 0;
+    {
+      std::lock_guard <std::mutex> lock (s.mutex);
+      std::unordered_map <key_t, entry_t*, key_hash_t>::iterator i = s.entries.find (k);
+      if (i != s.entries.end ())
+	{
+	  entry_t* e = i->second;
+	  if (e->bytes)
+	    {
+	      s.lru.splice (s.lru.begin (), s.lru, e->lru);
+	      e->stamp = ++m_clock;
+	    }
+	  other = e->result;
+	  m_hits++;
+	}
+      else
+	{
+	  mine = new entry_t;
+	  mine->key    = k;
+	  mine->result = promise.get_future ().share ();
+	  mine->bytes  = 0;
+	  mine->stamp  = 0;
+	  mine->lru    = s.lru.end ();
+	  s.entries [k] = mine;
+	  m_misses++;
+	}
+    }
+    if (!mine)
+      {
+	// ready, or being loaded by another thread
+	return other.get ();
+      }
+
+    m_loads++;
+    structure_ptr_t result;
+    try
+      {
+	result.reset (m_loader (path));
+      }
+    catch (...)
+      {
+	// the waiters must be woken whatever happens
+      }
+    // The loader opened path again: a file replaced or written since
+    // the stat above is not the one keyed by k.
+    key_t now;
+    if (result && (!_key (path, now) || !(now == k)))
+      {
+	result.reset ();
+      }
+    const size_t bytes = result ? footprint (*result) : 0;
+    promise.set_value (result);
+    {
+      std::lock_guard <std::mutex> lock (s.mutex);
+      if (!result)
+	{
+	  s.entries.erase (k);
+	  delete mine;
+	  return result;
+	}
+      s.lru.push_front (mine);
+      mine->lru   = s.lru.begin ();
+      mine->bytes = bytes;
+      mine->stamp = ++m_clock;
+      m_bytes += bytes;
+      m_count++;
+    }
+    _evict (mine);
+    return result;
+  }
+  // -----------------------------------------------------------
+  // Stamps are taken under the shard lock, so the back of each shard
+  // is its oldest entry and the oldest of the backs is the oldest of
+  // all. Each round peeks at the backs one shard at a time, then drops
+  // the oldest if nobody used it meanwhile. keep, just loaded, is
+  // never dropped: while it is the back of its shard everything else
+  // there is newer, so the shard is passed over.
+  void structure_cache_c::_evict (const entry_t* keep)
+  {
+    while (m_bytes > m_budget)
+      {
+	shard_t* oldest = 0;
+	uint64_t stamp  = 0;
+	for (size_t i = 0; i < m_shards.size (); i++)
+	  {
+	    shard_t& s = *m_shards [i];
+	    std::lock_guard <std::mutex> lock (s.mutex);
+	    if (!s.lru.empty () && s.lru.back () != keep &&
+		(!oldest || s.lru.back ()->stamp < stamp))
+	      {
+		oldest = &s;
+		stamp  = s.lru.back ()->stamp;
+	      }
+	  }
+	if (!oldest)
+	  {
+	    return;
+	  }
+	std::lock_guard <std::mutex> lock (oldest->mutex);
+	if (!oldest->lru.empty () && oldest->lru.back ()->stamp == stamp)
+	  {
+	    _drop (*oldest, oldest->lru.back ());
+	    m_evictions++;
+	  }
+      }
+  }
+  // -----------------------------------------------------------
+  void structure_cache_c::_drop (shard_t& s, entry_t* e)
+  {
+    s.lru.erase (e->lru);
+    s.entries.erase (e->key);
+    m_bytes -= e->bytes;
+    m_count--;
+    delete e;
+  }
+  // -----------------------------------------------------------
+  void structure_cache_c::set_budget (size_t bytes)
+  {
+    m_budget = bytes;
+    _evict (0);
+  }
+  // -----------------------------------------------------------
+  // entries being loaded stay, their loaders still use them
+  void structure_cache_c::clear ()
+  {
+    for (size_t i = 0; i < m_shards.size (); i++)
+      {
+	shard_t& s = *m_shards [i];
+	std::lock_guard <std::mutex> lock (s.mutex);
+	while (!s.lru.empty ())
+	  {
+	    _drop (s, s.lru.back ());
+	  }
+      }
+  }
+  // -----------------------------------------------------------
+  size_t structure_cache_c::budget () const
+  {
+    return m_budget;
+  }
+  // -----------------------------------------------------------
+  size_t structure_cache_c::bytes () const
+  {
+    return m_bytes;
+  }
+  // -----------------------------------------------------------
+  size_t structure_cache_c::count () const
+  {
+    return m_count;
+  }
+  // -----------------------------------------------------------
+  uint64_t structure_cache_c::hits () const
+  {
+    return m_hits;
+  }
+  // -----------------------------------------------------------
+  uint64_t structure_cache_c::misses () const
+  {
+    return m_misses;
+  }
+  // -----------------------------------------------------------
+  uint64_t structure_cache_c::loads () const
+  {
+    return m_loads;
+  }
+  // -----------------------------------------------------------
+  uint64_t structure_cache_c::evictions () const
+  {
+    return m_evictions;
+  }
+} // ns iff
@@ -0,0 +1,129 @@
+#ifndef __IFF_CORE_STRUCTURE_CACHE_HPP__
+#define __IFF_CORE_STRUCTURE_CACHE_HPP__
+
+#include <atomic>
+#include <functional>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "core/structure.hpp"
+#include "core/structure_builder.hpp"
+
+namespace iff
+{
+  // Parsed structures shared between threads, keyed by what the file
+  // is rather than its name: device, inode, size and mtime. A file
+  // that changes gets a new entry, the stale one ages out. Entries
+  // are spread over shards with a lock each, so lookups of different
+  // files rarely contend. A miss parses the file once: threads asking
+  // for a file being parsed wait for that parse instead of starting
+  // their own. Structures are dropped least recently used first,
+  // across all shards, once their estimated heap footprint passes the
+  // budget; a structure handed out stays valid for its holder after
+  // that.
+  class structure_cache_c
+  {
+  public:
+    typedef std::shared_ptr <const structure_c> structure_ptr_t;
+    // parses path, 0 on failure
+    typedef std::function <structure_c* (const char* path)> loader_t;
+
+    static const size_t DEFAULT_BUDGET = 256 * 1024 * 1024;
+  public:
+    structure_cache_c (const loader_t& loader, size_t budget = DEFAULT_BUDGET,
+		       unsigned shards = 16);
+    ~structure_cache_c ();
+
+    // null if path cannot be stat'ed or parsed, or changed while it
+    // was parsed; failures are not cached
+    structure_ptr_t get (const char* path);
+
+    void   set_budget (size_t bytes);
+    size_t budget     () const;
+    // footprint of the structures held, and how many
+    size_t bytes      () const;
+    size_t count      () const;
+    void   clear      ();
+
+    uint64_t hits      () const;
+    uint64_t misses    () const;
+    // loader calls
+    uint64_t loads     () const;
+    uint64_t evictions () const;
+
+    // estimated heap bytes of a structure, see structure_c::node_cost ()
+    static size_t footprint (const structure_c& s);
+  private:
+    structure_cache_c (const structure_cache_c&);
+    structure_cache_c& operator = (const structure_cache_c&);
+
+    struct key_t
+    {
+      uint64_t dev;
+      uint64_t ino;
+      uint64_t size;
+      int64_t  mtime_ns;
+
+      bool operator == (const key_t& other) const;
+    };
+    struct key_hash_t
+    {
+      size_t operator () (const key_t& k) const;
+    };
+    struct entry_t;
+    typedef std::list <entry_t*> lru_t;
+    struct entry_t
+    {
+      key_t                                  key;
+      std::shared_future <structure_ptr_t>   result;
+      // 0 while loading, loading entries are never evicted
+      size_t                                 bytes;
+      // of the last use, from m_clock
+      uint64_t                               stamp;
+      lru_t::iterator                        lru;
+    };
+    struct shard_t
+    {
+      std::mutex                                          mutex;
+      std::unordered_map <key_t, entry_t*, key_hash_t>    entries;
+      // loaded entries, most recent (highest stamp) first
+      lru_t                                               lru;
+    };
+
+    static bool _key (const char* path, key_t& k);
+    shard_t& _shard (const key_t& k);
+    // drops the least recent entry of all shards while over budget,
+    // with no shard locked; keep is spared
+    void _evict (const entry_t* keep);
+    void _drop  (shard_t& s, entry_t* e);
+  private:
+    loader_t               m_loader;
+    std::atomic <size_t>   m_budget;
+    std::atomic <size_t>   m_bytes;
+    std::atomic <size_t>   m_count;
+    std::vector <shard_t*> m_shards;
+    std::atomic <uint64_t> m_clock;
+    std::atomic <uint64_t> m_hits;
+    std::atomic <uint64_t> m_misses;
+    std::atomic <uint64_t> m_loads;
+    std::atomic <uint64_t> m_evictions;
+  };
+
+  // The process wide cache of structures parsed with IO_POLICY.
+  template <class IO_POLICY>
+  structure_cache_c& shared_structure_cache ()
+  {
+    static structure_cache_c cache ([] (const char* path) -> structure_c*
+				    {
+				      structure_builder_c <IO_POLICY> builder;
+				      return builder.build (path);
+				    });
+    return cache;
+  }
+} // ns iff
+
+#endif
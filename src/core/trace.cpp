@@ -0,0 +1,231 @@
+#include <string.h>
+#include <stdio.h>
+#include <fstream>
+#include <chrono>
+
+#include "core/trace.hpp"
+
+namespace
+{
+  const size_t NAME_SIZE    = 16;
+  const size_t BLOCK_EVENTS = 4096;
+
+  struct event_t
+  {
+    uint64_t    ts;        // ns since the trace epoch
+    const char* category;
+    char        phase;
+    char        name [NAME_SIZE];
+  };
+
+  struct block_t
+  {
+    block_t*                m_next;
+    std::atomic <uint32_t>  m_count;
+    event_t                 m_events [BLOCK_EVENTS];
+  };
+
+  // One per live thread. Only the owning thread appends; the dumper
+  // reads the published counts. A buffer outlives its thread, which
+  // marks it idle on exit, and the next thread to record claims it,
+  // so the buffers number the most threads ever recording at once.
+  struct buffer_t
+  {
+    buffer_t*               m_next;
+    uint32_t                m_tid;
+    block_t*                m_head;
+    std::atomic <block_t*>  m_tail;
+    std::atomic <bool>      m_idle;
+  };
+
+  // releases the thread's buffer when the thread exits
+  struct owner_t
+  {
+    buffer_t* m_buffer;
+    ~owner_t ()
+    {
+      if (m_buffer)
+	{
+	  m_buffer->m_idle.store (true, std::memory_order_release);
+	}
+    }
+  };
+
+  std::atomic <buffer_t*> s_buffers (0);
+  std::atomic <uint32_t>  s_next_tid (1);
+  thread_local owner_t    t_owner = {0};
+
+  const std::chrono::steady_clock::time_point s_epoch = std::chrono::steady_clock::now ();
+
+  // -------------------------------------------------------------
+  block_t* new_block ()
+  {
+    block_t* b = new block_t;
+    b->m_next = 0;
+    b->m_count.store (0, std::memory_order_relaxed);
+    return b;
+  }
+  // -------------------------------------------------------------
+  // the events of a thread that claims an idle buffer go on under the
+  // tid of the threads that had it before, which are gone
+  buffer_t* this_thread_buffer ()
+  {
+    if (t_owner.m_buffer)
+      {
+	return t_owner.m_buffer;
+      }
+    for (buffer_t* b = s_buffers.load (std::memory_order_acquire); b; b = b->m_next)
+      {
+	bool idle = true;
+	if (b->m_idle.load (std::memory_order_relaxed) &&
+	    b->m_idle.compare_exchange_strong (idle, false, std::memory_order_acquire,
+					       std::memory_order_relaxed))
+	  {
+	    t_owner.m_buffer = b;
+	    return b;
+	  }
+      }
+    buffer_t* b = new buffer_t;
+    b->m_tid  = s_next_tid.fetch_add (1, std::memory_order_relaxed);
+    b->m_head = new_block ();
+    b->m_tail.store (b->m_head, std::memory_order_relaxed);
+    b->m_idle.store (false, std::memory_order_relaxed);
+    buffer_t* head = s_buffers.load (std::memory_order_relaxed);
+    do
+      {
+	b->m_next = head;
+      }
+    while (!s_buffers.compare_exchange_weak (head, b, std::memory_order_release,
+					     std::memory_order_relaxed));
+    t_owner.m_buffer = b;
+    return b;
+  }
+  // -------------------------------------------------------------
+  void record (const char* category, const char* name, char phase)
+  {
+    const uint64_t ts = (uint64_t)std::chrono::duration_cast <std::chrono::nanoseconds>
+      (std::chrono::steady_clock::now () - s_epoch).count ();
+
+    buffer_t* buf = this_thread_buffer ();
+    block_t*  blk = buf->m_tail.load (std::memory_order_relaxed);
+    uint32_t  n   = blk->m_count.load (std::memory_order_relaxed);
+    if (n == BLOCK_EVENTS)
+      {
+	block_t* fresh = new_block ();
+	blk->m_next = fresh;
+	buf->m_tail.store (fresh, std::memory_order_release);
+	blk = fresh;
+	n   = 0;
+      }
+    event_t& e = blk->m_events [n];
+    e.ts       = ts;
+    e.category = category;
+    e.phase    = phase;
+    strncpy (e.name, name ? name : "", NAME_SIZE - 1);
+    e.name [NAME_SIZE - 1] = 0;
+    blk->m_count.store (n + 1, std::memory_order_release);
+  }
+  // -------------------------------------------------------------
+  void write_json_string (std::ostream& os, const char* s)
+  {
+    os << '"';
+    for (; *s; s++)
+      {
+	const unsigned char c = (unsigned char)*s;
+	if (c == '"' || c == '\\')
+	  {
+	    os << '\\' << (char)c;
+	  }
+	else if (c < 0x20 || c > 0x7E)
+	  {
+	    char esc [8];
+	    snprintf (esc, sizeof (esc), "\\u%04x", c);
+	    os << esc;
+	  }
+	else
+	  {
+	    os << (char)c;
+	  }
+      }
+    os << '"';
+  }
+}
+
+namespace iff
+{
+  namespace trace
+  {
+    std::atomic <bool> g_enabled (false);
+    // -------------------------------------------------------------
+    void enable (bool on)
+    {
+      g_enabled.store (on, std::memory_order_relaxed);
+    }
+    // -------------------------------------------------------------
+    void begin (const char* category, const char* name)
+    {
+      record (category, name, 'B');
+    }
+    // -------------------------------------------------------------
+    void end (const char* category, const char* name)
+    {
+      record (category, name, 'E');
+    }
+    // -------------------------------------------------------------
+    bool dump (std::ostream& os)
+    {
+      os << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+      bool first = true;
+      for (buffer_t* b = s_buffers.load (std::memory_order_acquire); b; b = b->m_next)
+	{
+	  const block_t* last = b->m_tail.load (std::memory_order_acquire);
+	  for (const block_t* blk = b->m_head; blk; blk = (blk == last) ? 0 : blk->m_next)
+	    {
+	      const uint32_t n = blk->m_count.load (std::memory_order_acquire);
+	      for (uint32_t i = 0; i < n; i++)
+		{
+		  const event_t& e = blk->m_events [i];
+		  char ts [32];
+		  snprintf (ts, sizeof (ts), "%.3f", (double)e.ts / 1000.0);
+		  os << (first ? "\n" : ",\n") << "{\"name\":";
+		  write_json_string (os, e.name);
+		  os << ",\"cat\":";
+		  write_json_string (os, e.category);
+		  os << ",\"ph\":\"" << e.phase << "\",\"ts\":" << ts
+		     << ",\"pid\":1,\"tid\":" << b->m_tid << "}";
+		  first = false;
+		}
+	    }
+	}
+      os << "\n]}\n";
+      return os.good ();
+    }
+    // -------------------------------------------------------------
+    bool dump (const char* path)
+    {
+      std::ofstream ofs (path);
+      if (!ofs.good ())
+	{
+	  return false;
+	}
+      return dump (ofs);
+    }
+    // -------------------------------------------------------------
+    void clear ()
+    {
+      for (buffer_t* b = s_buffers.load (std::memory_order_acquire); b; b = b->m_next)
+	{
+	  block_t* blk = b->m_head->m_next;
+	  while (blk)
+	    {
+	      block_t* victim = blk;
+	      blk = blk->m_next;
+	      delete victim;
+	    }
+	  b->m_head->m_next = 0;
+	  b->m_head->m_count.store (0, std::memory_order_relaxed);
+	  b->m_tail.store (b->m_head, std::memory_order_release);
+	}
+    }
+  } // ns trace
+} // ns iff
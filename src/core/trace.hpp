@@ -0,0 +1,76 @@
+#ifndef __IFF_CORE_TRACE_HPP__
+#define __IFF_CORE_TRACE_HPP__
+
+#include <iostream>
+#include <atomic>
+#include "core/iff_types.hpp"
+
+// Begin/end timestamps of parse and decode phases, dumped in the
+// Chrome trace event format (chrome://tracing, ui.perfetto.dev).
+//
+// Every thread appends to its own buffer, so recording takes no locks.
+// A thread that exits leaves its buffer to the next one that records.
+// While tracing is disabled each IFF_TRACE_* costs one relaxed load
+// and a branch that is always predicted.
+
+#define IFF_TRACE_BEGIN(CATEGORY, NAME)					\
+  do { if (iff::trace::enabled ()) iff::trace::begin (CATEGORY, NAME); } while (0)
+
+#define IFF_TRACE_END(CATEGORY, NAME)					\
+  do { if (iff::trace::enabled ()) iff::trace::end (CATEGORY, NAME); } while (0)
+
+namespace iff
+{
+  namespace trace
+  {
+    extern std::atomic <bool> g_enabled;
+
+    inline bool enabled ()
+    {
+      return g_enabled.load (std::memory_order_relaxed);
+    }
+
+    void enable (bool on);
+
+    // category must be a string literal, name is copied (15 chars max)
+    void begin (const char* category, const char* name);
+    void end   (const char* category, const char* name);
+
+    // dump and clear must not race with threads that are recording
+    bool dump  (std::ostream& os);
+    bool dump  (const char* path);
+    void clear ();
+
+    // scoped span for decoder stages and other user code
+    class scope_c
+    {
+    public:
+      scope_c (const char* category, const char* name)
+	: m_category (category),
+	  m_name     (name),
+	  m_active   (enabled ())
+      {
+	if (m_active)
+	  {
+	    begin (m_category, m_name);
+	  }
+      }
+      ~scope_c ()
+      {
+	if (m_active)
+	  {
+	    end (m_category, m_name);
+	  }
+      }
+    private:
+      scope_c (const scope_c&);
+      scope_c& operator = (const scope_c&);
+    private:
+      const char* m_category;
+      const char* m_name;
+      const bool  m_active;
+    };
+  } // ns trace
+} // ns iff
+
+#endif
@@ -0,0 +1,187 @@
+#include <algorithm>
+
+#include <QFont>
+#include <QFontMetrics>
+#include <QPainter>
+#include <QPaintEvent>
+#include <QScrollBar>
+
+#include "gui/hex_view.hpp"
+
+namespace
+{
+  // the payload shades of the marks by depth, headers use darker()
+  const QRgb SHADES [] =
+    {
+      0xdde8f7, 0xe3f3dc, 0xf7eedb, 0xefdff2, 0xdcf1f1, 0xf5dede
+    };
+  const size_t SHADE_COUNT = sizeof (SHADES) / sizeof (SHADES [0]);
+
+  struct mark_less_t
+  {
+    bool operator () (uint64_t pos, const hex_mark_t& m) const
+    {
+      return pos < m.offset;
+    }
+  };
+}
+// ---------------------------------------------------------------
+hex_view_c::hex_view_c (QWidget* parent)
+  : QAbstractScrollArea (parent),
+    m_offset (0),
+    m_size   (0)
+{
+  QFont font ("Monospace");
+  font.setStyleHint (QFont::TypeWriter);
+  setFont (font);
+  setHorizontalScrollBarPolicy (Qt::ScrollBarAsNeeded);
+  setVerticalScrollBarPolicy (Qt::ScrollBarAlwaysOn);
+  viewport ()->setAutoFillBackground (true);
+  viewport ()->setBackgroundRole (QPalette::Base);
+}
+// ---------------------------------------------------------------
+hex_view_c::~hex_view_c ()
+{
+}
+// ---------------------------------------------------------------
+bool hex_view_c::attach (int fd)
+{
+  show_range (0, 0);
+  return m_map.attach (fd);
+}
+// ---------------------------------------------------------------
+void hex_view_c::detach ()
+{
+  show_range (0, 0);
+  m_map.detach ();
+}
+// ---------------------------------------------------------------
+void hex_view_c::show_range (uint64_t offset, uint64_t size, const marks_t& marks)
+{
+  const bool same = offset == m_offset && size == m_size;
+  m_offset = offset;
+  m_size   = size;
+  m_fill   = marks;
+  m_marks.clear ();
+  _update_scroll ();
+  if (!same)
+    {
+      verticalScrollBar ()->setValue (0);
+    }
+  viewport ()->update ();
+}
+// ---------------------------------------------------------------
+void hex_view_c::refresh ()
+{
+  viewport ()->update ();
+}
+// ---------------------------------------------------------------
+// Scroll positions are rows. EA IFF sizes are 32 bit, so the rows of
+// any range fit the scroll bar's int.
+void hex_view_c::_update_scroll ()
+{
+  const QFontMetrics fm (font ());
+  const int visible = std::max (1, viewport ()->height () / fm.height ());
+  const uint64_t rows = (m_size + ROW - 1) / ROW;
+  const int last = rows > (uint64_t)visible ? (int)(rows - visible) : 0;
+  verticalScrollBar ()->setRange (0, last);
+  verticalScrollBar ()->setPageStep (visible);
+  verticalScrollBar ()->setSingleStep (1);
+
+  // offset, hex and ASCII columns
+  const int width = fm.width (QLatin1Char ('0')) * (10 + 2 + 3 * ROW + 1 + ROW);
+  horizontalScrollBar ()->setRange (0, std::max (0, width - viewport ()->width ()));
+  horizontalScrollBar ()->setPageStep (viewport ()->width ());
+}
+// ---------------------------------------------------------------
+void hex_view_c::resizeEvent (QResizeEvent* event)
+{
+  QAbstractScrollArea::resizeEvent (event);
+  _update_scroll ();
+}
+// ---------------------------------------------------------------
+// The innermost mark holding pos: if the last mark starting at or
+// before pos has ended, the one holding pos encloses it.
+int hex_view_c::_mark_at (uint64_t pos) const
+{
+  std::vector <hex_mark_t>::const_iterator i =
+    std::upper_bound (m_marks.begin (), m_marks.end (), pos, mark_less_t ());
+  int m = (int)(i - m_marks.begin ()) - 1;
+  while (m >= 0 && pos >= m_marks [m].offset + m_marks [m].size)
+    {
+      m = m_marks [m].parent;
+    }
+  return m;
+}
+// ---------------------------------------------------------------
+void hex_view_c::paintEvent (QPaintEvent* event)
+{
+  QPainter painter (viewport ());
+  const QFontMetrics fm (font ());
+  const int cw   = fm.width (QLatin1Char ('0'));
+  const int lh   = fm.height ();
+  const int x0   = -horizontalScrollBar ()->value () + cw / 2;
+  const int xhex = x0 + cw * 12;
+  const int xasc = xhex + cw * (3 * ROW + 1);
+
+  const uint64_t first = (uint64_t)verticalScrollBar ()->value ();
+  const int      top   = event->rect ().top () / lh;
+  const int      bottom = event->rect ().bottom () / lh + 1;
+  m_marks.clear ();
+  if (m_fill)
+    {
+      const uint64_t begin = std::min (m_size, (first + top) * ROW);
+      const uint64_t end   = std::min (m_size, (first + bottom + 1) * ROW);
+      m_fill (m_offset + begin, m_offset + end, m_marks);
+    }
+  for (int r = top; r <= bottom; r++)
+    {
+      const uint64_t rel = (first + r) * ROW;
+      if (rel >= m_size)
+	{
+	  break;
+	}
+      const uint64_t pos = m_offset + rel;
+      const unsigned n   = (unsigned)std::min <uint64_t> (ROW, m_size - rel);
+      const uint8_t* p   = m_map.at (pos, n);
+      const int      y   = r * lh;
+
+      painter.setPen (palette ().color (QPalette::Dark));
+      painter.drawText (x0, y + fm.ascent (),
+			QString ("%1").arg ((qulonglong)pos, 10, 16, QLatin1Char ('0')));
+      if (!p)
+	{
+	  painter.drawText (xhex, y + fm.ascent (), tr ("cannot read the file here"));
+	  continue;
+	}
+      for (unsigned c = 0; c < n; c++)
+	{
+	  const uint64_t at = pos + c;
+	  const int      xh = xhex + cw * (3 * c);
+	  const int      xa = xasc + cw * c;
+	  const int      m  = _mark_at (at);
+	  if (m >= 0)
+	    {
+	      const hex_mark_t& mark = m_marks [m];
+	      QColor shade (SHADES [mark.depth % SHADE_COUNT]);
+	      if (at - mark.offset < mark.header)
+		{
+		  shade = shade.darker (125);
+		}
+	      painter.fillRect (xh, y, cw * 3, lh, shade);
+	      painter.fillRect (xa, y, cw, lh, shade);
+	      if (at == mark.offset)
+		{
+		  painter.fillRect (xh, y, 2, lh, shade.darker (200));
+		  painter.fillRect (xa, y, 1, lh, shade.darker (200));
+		}
+	    }
+	  static const char HEX [] = "0123456789abcdef";
+	  const char digits [3] = {HEX [p [c] >> 4], HEX [p [c] & 15], 0};
+	  const char ascii  [2] = {p [c] >= 0x20 && p [c] < 0x7f ? (char)p [c] : '.', 0};
+	  painter.setPen (palette ().color (QPalette::Text));
+	  painter.drawText (xh + cw / 2, y + fm.ascent (), QLatin1String (digits));
+	  painter.drawText (xa, y + fm.ascent (), QLatin1String (ascii));
+	}
+    }
+}
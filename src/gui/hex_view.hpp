@@ -0,0 +1,66 @@
+#ifndef __IFF_GUI_HEX_VIEW_HPP__
+#define __IFF_GUI_HEX_VIEW_HPP__
+
+#include <functional>
+#include <vector>
+#include <QAbstractScrollArea>
+
+#include "core/mapped_window.hpp"
+
+// a chunk or group drawn over the bytes
+struct hex_mark_t
+{
+  // of the header, header included
+  uint64_t offset;
+  uint64_t size;
+  unsigned header;
+  // index of the enclosing mark, -1 at the top
+  int      parent;
+  unsigned depth;
+};
+
+// Hex and ASCII rows of a range of the open file. Only the rows on
+// screen are painted, from a mapped window of the file that slides
+// along as the view scrolls, so a payload of gigabytes scrolls as
+// freely as a small one and nothing is read up front. Marks shade the
+// bytes of nested chunks by depth, their headers stronger, with a bar
+// where each one starts. Marks are asked for at every paint and only
+// for the bytes on screen, so a range with millions of chunks costs
+// no more than one with a few.
+class hex_view_c : public QAbstractScrollArea
+{
+  Q_OBJECT
+public:
+  // appends to marks those overlapping [begin, end) and the ones
+  // enclosing them, sorted by offset, each after its parent
+  typedef std::function <void (uint64_t begin, uint64_t end,
+			       std::vector <hex_mark_t>& marks)> marks_t;
+public:
+  explicit hex_view_c (QWidget* parent = 0);
+  ~hex_view_c ();
+
+  // fd belongs to the caller and has to stay open while attached
+  bool attach (int fd);
+  void detach ();
+
+  void show_range (uint64_t offset, uint64_t size, const marks_t& marks = marks_t ());
+  // the marks of the range changed, ask again
+  void refresh ();
+protected:
+  void paintEvent  (QPaintEvent* event);
+  void resizeEvent (QResizeEvent* event);
+private:
+  void _update_scroll ();
+  int  _mark_at (uint64_t pos) const;
+private:
+  static const unsigned ROW = 16;
+
+  iff::mapped_window_c     m_map;
+  uint64_t                 m_offset;
+  uint64_t                 m_size;
+  marks_t                  m_fill;
+  // those of the last paint
+  std::vector <hex_mark_t> m_marks;
+};
+
+#endif
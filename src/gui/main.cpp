@@ -1,21 +1,17 @@
-#include <QtGui>
+#include <QApplication>
 
- int main(int argc, char *argv[])
- {
-     QApplication app(argc, argv);
+#include "gui/main_window.hpp"
 
-     QDirModel model;
-     QTreeView tree;
-     tree.setModel(&model);
+int main (int argc, char* argv [])
+{
+  QApplication app (argc, argv);
 
-     // Demonstrating look and feel features
-     tree.setAnimated(false);
-     tree.setIndentation(20);
-     tree.setSortingEnabled(true);
-
-     tree.setWindowTitle(QObject::tr("Dir View"));
-     tree.resize(640, 480);
-     tree.show();
-
-     return app.exec();
- }
+  main_window_c w;
+  w.show ();
+  const QStringList args = app.arguments ();
+  if (args.size () > 1)
+    {
+      w.open_file (args [1]);
+    }
+  return app.exec ();
+}
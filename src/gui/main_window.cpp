@@ -0,0 +1,160 @@
+#include <algorithm>
+
+#include <QAction>
+#include <QApplication>
+#include <QFileDialog>
+#include <QHeaderView>
+#include <QKeySequence>
+#include <QMenu>
+#include <QMenuBar>
+#include <QMessageBox>
+#include <QSplitter>
+#include <QStatusBar>
+#include <QTabWidget>
+#include <QTreeView>
+
+#include "gui/main_window.hpp"
+#include "gui/structure_model.hpp"
+
+main_window_c::main_window_c (QWidget* parent)
+  : QMainWindow (parent),
+    m_model (new structure_model_c (this)),
+    m_splitter (new QSplitter (Qt::Horizontal, this)),
+    m_tree (new QTreeView (m_splitter)),
+    m_tabs (new QTabWidget (m_splitter)),
+    m_hex (new hex_view_c (m_tabs)),
+    m_preview (new preview_view_c (m_tabs))
+{
+  m_tree->setModel (m_model);
+  m_tree->setUniformRowHeights (true);
+  m_tree->setAnimated (false);
+  m_tree->header ()->setStretchLastSection (false);
+  m_splitter->addWidget (m_tree);
+  m_tabs->addTab (m_hex, tr ("Bytes"));
+  m_tabs->addTab (m_preview, tr ("Preview"));
+  m_splitter->addWidget (m_tabs);
+  m_splitter->setStretchFactor (1, 1);
+  setCentralWidget (m_splitter);
+
+  connect (m_tree->selectionModel (), SIGNAL (currentChanged (const QModelIndex&, const QModelIndex&)),
+	   this, SLOT (_on_current (const QModelIndex&)));
+  connect (m_model, SIGNAL (rowsInserted (const QModelIndex&, int, int)),
+	   this, SLOT (_on_rows_inserted (const QModelIndex&)));
+
+  QMenu* file = menuBar ()->addMenu (tr ("&File"));
+  QAction* open = file->addAction (tr ("&Open..."));
+  open->setShortcut (QKeySequence::Open);
+  connect (open, SIGNAL (triggered ()), this, SLOT (_on_open ()));
+  QAction* quit = file->addAction (tr ("&Quit"));
+  quit->setShortcut (QKeySequence::Quit);
+  connect (quit, SIGNAL (triggered ()), qApp, SLOT (quit ()));
+
+  setWindowTitle (tr ("IFF Viewer"));
+  resize (1200, 700);
+}
+// ---------------------------------------------------------------
+main_window_c::~main_window_c ()
+{
+}
+// ---------------------------------------------------------------
+bool main_window_c::open_file (const QString& path)
+{
+  m_hex->detach ();
+  m_preview->clear ();
+  if (!m_model->open (path))
+    {
+      QMessageBox::warning (this, windowTitle (), tr ("%1 is not an IFF file").arg (path));
+      return false;
+    }
+  // the root items are listed, show the first group's children
+  m_tree->expand (m_model->index (0, 0));
+  for (int c = 0; c < structure_model_c::eCOLUMN_COUNT; c++)
+    {
+      m_tree->resizeColumnToContents (c);
+    }
+  m_hex->attach (m_model->fd ());
+  statusBar ()->showMessage (path);
+  return true;
+}
+// ---------------------------------------------------------------
+void main_window_c::_on_open ()
+{
+  const QString path = QFileDialog::getOpenFileName (this, tr ("Open IFF file"));
+  if (!path.isEmpty ())
+    {
+      open_file (path);
+    }
+}
+// ---------------------------------------------------------------
+// n and whatever of its listed subtree overlaps [begin, end), in file
+// order; the children of a node are in file order too, so the first
+// one reaching begin is a binary search away
+void main_window_c::_marks (const structure_model_c::node_t* n, int parent, unsigned depth,
+			    uint64_t begin, uint64_t end, std::vector <hex_mark_t>& marks)
+{
+  hex_mark_t m;
+  m.offset = n->item.offset;
+  m.size   = n->item.size;
+  m.header = n->is_group ? 12 : 8;
+  m.parent = parent;
+  m.depth  = depth;
+  marks.push_back (m);
+  const int self = (int)marks.size () - 1;
+  std::vector <structure_model_c::node_t*>::const_iterator i =
+    std::upper_bound (n->children.begin (), n->children.end (), begin,
+		      [] (uint64_t pos, const structure_model_c::node_t* c)
+		      {
+			return pos < c->item.offset + c->item.size;
+		      });
+  for (; i != n->children.end () && (*i)->item.offset < end; ++i)
+    {
+      _marks (*i, self, depth + 1, begin, end, marks);
+    }
+}
+// ---------------------------------------------------------------
+// the bytes of the node, header included
+void main_window_c::_show (const QModelIndex& index)
+{
+  const structure_model_c::node_t* n = m_model->node (index);
+  if (!n)
+    {
+      m_hex->show_range (0, 0);
+      return;
+    }
+  m_hex->show_range (n->item.offset, n->item.size,
+		     [n] (uint64_t begin, uint64_t end, std::vector <hex_mark_t>& marks)
+		     {
+		       _marks (n, -1, 0, begin, end, marks);
+		     });
+}
+// ---------------------------------------------------------------
+// A group may be a picture or an animation; decoding it starts in
+// the background whether or not its tab is up.
+void main_window_c::_on_current (const QModelIndex& current)
+{
+  _show (current);
+  const structure_model_c::node_t* n = m_model->node (current);
+  if (n && n->is_group)
+    {
+      m_preview->show_form (m_model->fd (), n->item.offset, n->item.size);
+    }
+  else
+    {
+      m_preview->clear ();
+    }
+}
+// ---------------------------------------------------------------
+// children listed under the node on display get their marks at the
+// next paint
+void main_window_c::_on_rows_inserted (const QModelIndex& parent)
+{
+  const QModelIndex current = m_tree->currentIndex ();
+  for (QModelIndex i = parent; i.isValid () && current.isValid (); i = i.parent ())
+    {
+      if (i.internalPointer () == current.internalPointer ())
+	{
+	  m_hex->refresh ();
+	  return;
+	}
+    }
+}
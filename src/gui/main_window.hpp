@@ -0,0 +1,43 @@
+#ifndef __IFF_GUI_MAIN_WINDOW_HPP__
+#define __IFF_GUI_MAIN_WINDOW_HPP__
+
+#include <vector>
+#include <QMainWindow>
+#include <QModelIndex>
+
+#include "gui/hex_view.hpp"
+#include "gui/preview_view.hpp"
+#include "gui/structure_model.hpp"
+
+class QSplitter;
+class QTabWidget;
+class QTreeView;
+
+// The file's chunk tree on the left; the bytes of the selected node
+// and, for pictures and animations, its preview on the right.
+class main_window_c : public QMainWindow
+{
+  Q_OBJECT
+public:
+  explicit main_window_c (QWidget* parent = 0);
+  ~main_window_c ();
+
+  bool open_file (const QString& path);
+private slots:
+  void _on_open ();
+  void _on_current (const QModelIndex& current);
+  void _on_rows_inserted (const QModelIndex& parent);
+private:
+  void _show (const QModelIndex& index);
+  static void _marks (const structure_model_c::node_t* n, int parent, unsigned depth,
+		      uint64_t begin, uint64_t end, std::vector <hex_mark_t>& marks);
+private:
+  structure_model_c* m_model;
+  QSplitter*         m_splitter;
+  QTreeView*         m_tree;
+  QTabWidget*        m_tabs;
+  hex_view_c*        m_hex;
+  preview_view_c*    m_preview;
+};
+
+#endif
@@ -0,0 +1,185 @@
+#include <QHBoxLayout>
+#include <QImage>
+#include <QLabel>
+#include <QPixmap>
+#include <QPushButton>
+#include <QScrollArea>
+#include <QSlider>
+#include <QTimer>
+#include <QVBoxLayout>
+
+#include "gui/preview_view.hpp"
+
+static const size_t NONE = (size_t)-1;
+
+preview_view_c::preview_view_c (QWidget* parent)
+  : QWidget  (parent),
+    m_server (0),
+    m_area   (new QScrollArea (this)),
+    m_image  (new QLabel (m_area)),
+    m_slider (new QSlider (Qt::Horizontal, this)),
+    m_play   (new QPushButton (tr ("Play"), this)),
+    m_info   (new QLabel (this)),
+    m_timer  (new QTimer (this)),
+    m_frames (0),
+    m_pos    (0),
+    m_shown  (NONE)
+{
+  m_image->setAlignment (Qt::AlignCenter);
+  m_area->setWidget (m_image);
+  m_area->setWidgetResizable (true);
+  m_area->setAlignment (Qt::AlignCenter);
+  m_play->setCheckable (true);
+  m_timer->setSingleShot (true);
+
+  QHBoxLayout* controls = new QHBoxLayout;
+  controls->addWidget (m_play);
+  controls->addWidget (m_slider, 1);
+  controls->addWidget (m_info);
+  QVBoxLayout* layout = new QVBoxLayout (this);
+  layout->addWidget (m_area, 1);
+  layout->addLayout (controls);
+
+  connect (m_slider, SIGNAL (valueChanged (int)), this, SLOT (_on_scrub (int)));
+  connect (m_play, SIGNAL (toggled (bool)), this, SLOT (_on_play (bool)));
+  connect (m_timer, SIGNAL (timeout ()), this, SLOT (_on_tick ()));
+
+  // from a worker thread, queued to this one
+  m_server.set_ready ([this] (size_t frame)
+		      {
+			QMetaObject::invokeMethod (this, "_on_ready", Qt::QueuedConnection,
+						   Q_ARG (int, (int)frame));
+		      });
+  clear ();
+}
+// ---------------------------------------------------------------
+preview_view_c::~preview_view_c ()
+{
+  m_server.set_ready (iff::codec::frame_server_c::ready_t ());
+  m_server.close ();
+}
+// ---------------------------------------------------------------
+void preview_view_c::clear ()
+{
+  m_timer->stop ();
+  m_server.close ();
+  m_frames = 0;
+  m_pos    = 0;
+  m_shown  = NONE;
+  m_image->clear ();
+  m_info->clear ();
+  m_play->setChecked (false);
+  m_play->setEnabled (false);
+  m_slider->blockSignals (true);
+  m_slider->setRange (0, 0);
+  m_slider->blockSignals (false);
+  m_slider->setEnabled (false);
+}
+// ---------------------------------------------------------------
+bool preview_view_c::show_form (int fd, uint64_t offset, uint64_t size)
+{
+  clear ();
+  const iff::codec::anim_decoder_c::status_t rc = m_server.open (fd, offset, size);
+  if (rc != iff::codec::anim_decoder_c::eOK)
+    {
+      m_image->setText (QString::fromLatin1 (iff::codec::anim_decoder_c::status_name (rc)));
+      return false;
+    }
+  m_frames = m_server.decoder ()->frames ();
+  m_slider->blockSignals (true);
+  m_slider->setRange (0, (int)m_frames - 1);
+  m_slider->blockSignals (false);
+  m_slider->setEnabled (m_frames > 1);
+  m_play->setEnabled (m_frames > 1);
+  _show (0);
+  return true;
+}
+// ---------------------------------------------------------------
+// on screen now if it is decoded, otherwise when _on_ready () says so
+void preview_view_c::_show (size_t k)
+{
+  m_pos = k;
+  m_server.request (k, PREFETCH);
+  if (!_render ())
+    {
+      m_info->setText (tr ("%1 / %2, decoding").arg (k + 1).arg (m_frames));
+    }
+}
+// ---------------------------------------------------------------
+bool preview_view_c::_render ()
+{
+  std::shared_ptr <const iff::codec::anim_decoder_c> d = m_server.decoder ();
+  const iff::codec::frame_ptr_t f = m_server.frame (m_pos);
+  if (!d || !f)
+    {
+      return false;
+    }
+  QImage image (d->bmhd ().width, d->bmhd ().height, QImage::Format_RGB32);
+  if (!d->to_argb (&(*f) [0], reinterpret_cast <uint32_t*> (image.bits ())))
+    {
+      return false;
+    }
+  m_image->setPixmap (QPixmap::fromImage (image));
+  m_shown = m_pos;
+  m_info->setText (m_frames > 1 ? tr ("%1 / %2").arg (m_pos + 1).arg (m_frames) : QString ());
+  return true;
+}
+// ---------------------------------------------------------------
+// ready frames other than the one waited for are there for later
+void preview_view_c::_on_ready (int frame)
+{
+  if ((size_t)frame == m_pos && m_shown != m_pos)
+    {
+      _render ();
+    }
+}
+// ---------------------------------------------------------------
+void preview_view_c::_on_scrub (int frame)
+{
+  if (frame >= 0 && (size_t)frame < m_frames && (size_t)frame != m_pos)
+    {
+      _show ((size_t)frame);
+    }
+}
+// ---------------------------------------------------------------
+void preview_view_c::_on_play (bool on)
+{
+  m_play->setText (on ? tr ("Pause") : tr ("Play"));
+  if (on)
+    {
+      m_timer->start (_interval (m_pos));
+    }
+  else
+    {
+      m_timer->stop ();
+    }
+}
+// ---------------------------------------------------------------
+// Steps once the frame due has been shown for its time; a frame not
+// decoded yet holds playback back rather than being skipped.
+void preview_view_c::_on_tick ()
+{
+  if (m_frames < 2)
+    {
+      return;
+    }
+  if (m_shown != m_pos)
+    {
+      m_timer->start (5);
+      return;
+    }
+  const size_t next = (m_pos + 1) % m_frames;
+  m_slider->blockSignals (true);
+  m_slider->setValue ((int)next);
+  m_slider->blockSignals (false);
+  _show (next);
+  m_timer->start (_interval (next));
+}
+// ---------------------------------------------------------------
+// ANHD times are in jiffies, 1/60 s
+int preview_view_c::_interval (size_t k) const
+{
+  std::shared_ptr <const iff::codec::anim_decoder_c> d = m_server.decoder ();
+  const uint32_t jiffies = d ? d->rel_time (k) : 0;
+  return (int)((jiffies ? jiffies : 1) * 1000 / 60);
+}
@@ -0,0 +1,58 @@
+#ifndef __IFF_GUI_PREVIEW_VIEW_HPP__
+#define __IFF_GUI_PREVIEW_VIEW_HPP__
+
+#include <QWidget>
+
+#include "core/codec/frame_server.hpp"
+
+class QLabel;
+class QPushButton;
+class QScrollArea;
+class QSlider;
+class QTimer;
+
+// The picture of a FORM ILBM / PBM, or a FORM ANIM with a scrub bar
+// and play button. Frames are decoded by an iff::codec::frame_server_c
+// on worker threads; the UI thread only asks for frames and converts
+// the one on screen to RGB. Moving the scrub bar asks for that frame
+// and prefetches the next few; playback steps at the ANHD timing and
+// waits when the frame due is not decoded yet. Showing another FORM
+// cancels what is being decoded for the last one.
+class preview_view_c : public QWidget
+{
+  Q_OBJECT
+public:
+  explicit preview_view_c (QWidget* parent = 0);
+  ~preview_view_c ();
+
+  // offset and size of the FORM's header, size header included; fd
+  // has to stay open while shown. False if it is no picture.
+  bool show_form (int fd, uint64_t offset, uint64_t size);
+  void clear ();
+private slots:
+  void _on_ready (int frame);
+  void _on_scrub (int frame);
+  void _on_play  (bool on);
+  void _on_tick  ();
+private:
+  void _show (size_t k);
+  bool _render ();
+  int  _interval (size_t k) const;
+private:
+  // frames decoded ahead of the scrub position
+  static const size_t PREFETCH = 8;
+
+  iff::codec::frame_server_c m_server;
+  QScrollArea* m_area;
+  QLabel*      m_image;
+  QSlider*     m_slider;
+  QPushButton* m_play;
+  QLabel*      m_info;
+  QTimer*      m_timer;
+  size_t       m_frames;
+  // the frame wanted on screen, and the one there
+  size_t       m_pos;
+  size_t       m_shown;
+};
+
+#endif
@@ -0,0 +1,260 @@
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include <QBrush>
+#include <QColor>
+
+#include "gui/structure_model.hpp"
+#include "core/ea/ea_io.hpp"
+
+structure_model_c::structure_model_c (QObject* parent)
+  : QAbstractItemModel (parent),
+    m_fd (-1)
+{
+  m_root.is_group = true;
+  m_root.parent   = 0;
+  m_root.row      = 0;
+  m_root.next     = 0;
+  m_root.listed   = true;
+  m_root.corrupt  = false;
+}
+// ---------------------------------------------------------------
+structure_model_c::~structure_model_c ()
+{
+  close ();
+}
+// ---------------------------------------------------------------
+void structure_model_c::_free (node_t* n)
+{
+  for (size_t i = 0; i < n->children.size (); i++)
+    {
+      _free (n->children [i]);
+      delete n->children [i];
+    }
+  n->children.clear ();
+}
+// ---------------------------------------------------------------
+void structure_model_c::close ()
+{
+  beginResetModel ();
+  _free (&m_root);
+  if (m_fd >= 0)
+    {
+      ::close (m_fd);
+      m_fd = -1;
+    }
+  m_path.clear ();
+  endResetModel ();
+}
+// ---------------------------------------------------------------
+// The items at the root are listed right away, there are few of them
+// (one for a plain FORM file); everything below waits for fetchMore.
+bool structure_model_c::open (const QString& path)
+{
+  close ();
+  const int fd = ::open (path.toLocal8Bit ().constData (), O_RDONLY);
+  struct stat st;
+  if (fd < 0 || fstat (fd, &st) != 0)
+    {
+      if (fd >= 0)
+	{
+	  ::close (fd);
+	}
+      return false;
+    }
+  beginResetModel ();
+  m_fd   = fd;
+  m_path = path;
+  m_root.item.offset = 0;
+  m_root.item.size   = (uint64_t)st.st_size;
+  m_root.next        = 0;
+  m_root.listed      = false;
+  m_root.corrupt     = false;
+  std::vector <node_t*> added;
+  while (!m_root.listed)
+    {
+      _list (&m_root, added);
+      m_root.children.insert (m_root.children.end (), added.begin (), added.end ());
+    }
+  endResetModel ();
+  return !m_root.children.empty ();
+}
+// ---------------------------------------------------------------
+QString structure_model_c::path () const
+{
+  return m_path;
+}
+// ---------------------------------------------------------------
+int structure_model_c::fd () const
+{
+  return m_fd;
+}
+// ---------------------------------------------------------------
+// the next batch of children of n from their headers, not yet added
+void structure_model_c::_list (node_t* n, std::vector <node_t*>& added)
+{
+  const uint64_t end = n == &m_root ? n->item.size : n->item.offset + n->item.size;
+  if (n->next == 0 && n != &m_root)
+    {
+      n->next = n->item.offset + 12;
+    }
+  std::vector <iff::ea::container_child_t> items;
+  const bool ok = iff::ea::list_range (m_fd, n->next, end, items, BATCH);
+  added.clear ();
+  for (size_t i = 0; i < items.size (); i++)
+    {
+      node_t* c   = new node_t;
+      c->item     = items [i];
+      c->is_group = iff::ea::io_c::is_group (items [i].id);
+      c->parent   = n;
+      c->row      = (int)(n->children.size () + i);
+      c->next     = 0;
+      c->listed   = !c->is_group;
+      c->corrupt  = false;
+      added.push_back (c);
+    }
+  n->corrupt = n->corrupt || !ok;
+  n->listed  = !ok || n->next + 8 > end;
+}
+// ---------------------------------------------------------------
+structure_model_c::node_t* structure_model_c::_node (const QModelIndex& index) const
+{
+  if (!index.isValid ())
+    {
+      return const_cast <node_t*> (&m_root);
+    }
+  return static_cast <node_t*> (index.internalPointer ());
+}
+// ---------------------------------------------------------------
+const structure_model_c::node_t* structure_model_c::node (const QModelIndex& index) const
+{
+  return index.isValid () ? _node (index) : 0;
+}
+// ---------------------------------------------------------------
+QModelIndex structure_model_c::index (int row, int column, const QModelIndex& parent) const
+{
+  const node_t* p = _node (parent);
+  if (row < 0 || column < 0 || column >= eCOLUMN_COUNT || (size_t)row >= p->children.size ())
+    {
+      return QModelIndex ();
+    }
+  return createIndex (row, column, p->children [row]);
+}
+// ---------------------------------------------------------------
+QModelIndex structure_model_c::parent (const QModelIndex& child) const
+{
+  const node_t* n = node (child);
+  if (!n || n->parent == &m_root)
+    {
+      return QModelIndex ();
+    }
+  return createIndex (n->parent->row, 0, n->parent);
+}
+// ---------------------------------------------------------------
+int structure_model_c::rowCount (const QModelIndex& parent) const
+{
+  if (parent.column () > 0)
+    {
+      return 0;
+    }
+  return (int)_node (parent)->children.size ();
+}
+// ---------------------------------------------------------------
+int structure_model_c::columnCount (const QModelIndex&) const
+{
+  return eCOLUMN_COUNT;
+}
+// ---------------------------------------------------------------
+bool structure_model_c::hasChildren (const QModelIndex& parent) const
+{
+  const node_t* n = _node (parent);
+  // a group shows its expander before its children are listed
+  return n->is_group && (!n->listed || !n->children.empty ());
+}
+// ---------------------------------------------------------------
+bool structure_model_c::canFetchMore (const QModelIndex& parent) const
+{
+  const node_t* n = _node (parent);
+  return m_fd >= 0 && n->is_group && !n->listed;
+}
+// ---------------------------------------------------------------
+void structure_model_c::fetchMore (const QModelIndex& parent)
+{
+  node_t* n = _node (parent);
+  if (!canFetchMore (parent))
+    {
+      return;
+    }
+  std::vector <node_t*> added;
+  _list (n, added);
+  if (!added.empty ())
+    {
+      const int first = (int)n->children.size ();
+      beginInsertRows (parent, first, first + (int)added.size () - 1);
+      n->children.insert (n->children.end (), added.begin (), added.end ());
+      endInsertRows ();
+    }
+  if (n->corrupt && parent.isValid ())
+    {
+      emit dataChanged (createIndex (n->row, 0, n), createIndex (n->row, eCOLUMN_COUNT - 1, n));
+    }
+}
+// ---------------------------------------------------------------
+QVariant structure_model_c::data (const QModelIndex& index, int role) const
+{
+  const node_t* n = node (index);
+  if (!n)
+    {
+      return QVariant ();
+    }
+  if (role == Qt::ForegroundRole && n->corrupt)
+    {
+      return QBrush (QColor (Qt::red));
+    }
+  if (role == Qt::ToolTipRole && n->corrupt)
+    {
+      return tr ("a child runs past the end of this group");
+    }
+  if (role == Qt::TextAlignmentRole && index.column () >= eCOLUMN_OFFSET)
+    {
+      return (int)(Qt::AlignRight | Qt::AlignVCenter);
+    }
+  if (role != Qt::DisplayRole)
+    {
+      return QVariant ();
+    }
+  switch (index.column ())
+    {
+    case eCOLUMN_ID:
+      return QString::fromLatin1 (n->item.id.to_string ().c_str ());
+    case eCOLUMN_TYPE:
+      return n->is_group ? QString::fromLatin1 (n->item.tag.to_string ().c_str ()) : QString ();
+    case eCOLUMN_OFFSET:
+      return QString::number ((qulonglong)n->item.offset);
+    case eCOLUMN_SIZE:
+      // of the payload, as the chunk header states it
+      return QString::number ((qulonglong)(n->item.size - 8));
+    }
+  return QVariant ();
+}
+// ---------------------------------------------------------------
+QVariant structure_model_c::headerData (int section, Qt::Orientation orientation, int role) const
+{
+  if (orientation != Qt::Horizontal || role != Qt::DisplayRole)
+    {
+      return QVariant ();
+    }
+  switch (section)
+    {
+    case eCOLUMN_ID:
+      return tr ("ID");
+    case eCOLUMN_TYPE:
+      return tr ("Type");
+    case eCOLUMN_OFFSET:
+      return tr ("Offset");
+    case eCOLUMN_SIZE:
+      return tr ("Size");
+    }
+  return QVariant ();
+}
@@ -0,0 +1,78 @@
+#ifndef __IFF_GUI_STRUCTURE_MODEL_HPP__
+#define __IFF_GUI_STRUCTURE_MODEL_HPP__
+
+#include <vector>
+#include <QAbstractItemModel>
+#include <QString>
+
+#include "core/ea/container.hpp"
+
+// The chunk tree of one EA IFF file for the views. Nothing is parsed
+// up front: opening lists the items at the root, and a group lists
+// its children only when a view expands it (canFetchMore/fetchMore),
+// a batch at a time, from their headers. Memory follows what has been
+// expanded, not the file size.
+class structure_model_c : public QAbstractItemModel
+{
+  Q_OBJECT
+public:
+  enum column_t
+    {
+      eCOLUMN_ID,
+      eCOLUMN_TYPE,
+      eCOLUMN_OFFSET,
+      eCOLUMN_SIZE,
+      eCOLUMN_COUNT
+    };
+
+  struct node_t
+  {
+    iff::ea::container_child_t item;
+    bool                  is_group;
+    node_t*               parent;
+    int                   row;
+    std::vector <node_t*> children;
+    // where listing the children goes on, and whether it is done
+    uint64_t              next;
+    bool                  listed;
+    // a child ran past the end of this group
+    bool                  corrupt;
+  };
+public:
+  explicit structure_model_c (QObject* parent = 0);
+  ~structure_model_c ();
+
+  bool    open  (const QString& path);
+  void    close ();
+  QString path  () const;
+  // descriptor of the open file, -1 if none
+  int     fd    () const;
+
+  // the node of an index, 0 for the root
+  const node_t* node (const QModelIndex& index) const;
+
+  // QAbstractItemModel
+  QModelIndex index       (int row, int column, const QModelIndex& parent = QModelIndex ()) const;
+  QModelIndex parent      (const QModelIndex& child) const;
+  int         rowCount    (const QModelIndex& parent = QModelIndex ()) const;
+  int         columnCount (const QModelIndex& parent = QModelIndex ()) const;
+  QVariant    data        (const QModelIndex& index, int role = Qt::DisplayRole) const;
+  QVariant    headerData  (int section, Qt::Orientation orientation,
+			   int role = Qt::DisplayRole) const;
+  bool        hasChildren  (const QModelIndex& parent = QModelIndex ()) const;
+  bool        canFetchMore (const QModelIndex& parent) const;
+  void        fetchMore    (const QModelIndex& parent);
+private:
+  node_t* _node (const QModelIndex& index) const;
+  void    _list (node_t* n, std::vector <node_t*>& added);
+  static void _free (node_t* n);
+private:
+  // children listed per fetchMore
+  static const size_t BATCH = 256;
+
+  QString  m_path;
+  int      m_fd;
+  node_t   m_root;
+};
+
+#endif
@@ -0,0 +1,119 @@
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <cstdlib>
+#include <cstdio>
+
+#include <unistd.h>
+
+#include "test/check.hpp"
+
+#if !defined(IFF_SAMPLES_DIR)
+#define IFF_SAMPLES_DIR "samples"
+#endif
+
+static unsigned s_checks   = 0;
+static unsigned s_failures = 0;
+static std::vector <std::string> s_temp_files;
+
+// ---------------------------------------------------------------
+bool check_report (bool ok, const char* what, const char* file, int line)
+{
+  s_checks++;
+  if (!ok)
+    {
+      s_failures++;
+      std::cerr << file << ":" << line << ": CHECK failed: " << what << std::endl;
+    }
+  return ok;
+}
+// ---------------------------------------------------------------
+std::string check_temp_name ()
+{
+  const char* dir = getenv ("TMPDIR");
+  std::string name = std::string (dir ? dir : "/tmp") + "/iff_check_XXXXXX";
+  std::vector <char> templ (name.begin (), name.end ());
+  templ.push_back (0);
+  const int fd = mkstemp (&templ [0]);
+  if (fd < 0)
+    {
+      return std::string ();
+    }
+  close (fd);
+  name = &templ [0];
+  s_temp_files.push_back (name);
+  return name;
+}
+// ---------------------------------------------------------------
+std::string check_temp_file (const iff::synth::params_t& p)
+{
+  const std::string name = check_temp_name ();
+  if (name.empty ())
+    {
+      return name;
+    }
+
+  std::ofstream ofs (name.c_str (), std::ios::binary | std::ios::trunc);
+  if (!iff::synth::generate (ofs, p))
+    {
+      return std::string ();
+    }
+  return name;
+}
+// ---------------------------------------------------------------
+std::string check_sample (const char* name)
+{
+  return std::string (IFF_SAMPLES_DIR) + "/" + name;
+}
+// ---------------------------------------------------------------
+uint32_t check_random (uint32_t& state)
+{
+  state = state * 1664525u + 1013904223u;
+  return state >> 16;
+}
+// ---------------------------------------------------------------
+int main (int, char* [])
+{
+  struct entry_t
+  {
+    const char* name;
+    void (*fn) ();
+  };
+  static const entry_t checks [] =
+    {
+      {"stats", &check_stats},
+      {"trace", &check_trace},
+      {"alloc", &check_alloc},
+      {"nesting", &check_nesting},
+      {"corrupt", &check_corrupt},
+      {"budget", &check_budget},
+      {"id", &check_id},
+      {"dispatch", &check_dispatch},
+      {"schema", &check_schema},
+      {"capi", &check_capi},
+      {"patch", &check_patch},
+      {"extract", &check_extract},
+      {"container", &check_container},
+      {"anim", &check_anim},
+      {"byterun1", &check_byterun1},
+      {"transcode", &check_transcode},
+      {"mapped", &check_mapped},
+      {"preview", &check_preview},
+      {"async", &check_async},
+      {"structure_cache", &check_structure_cache},
+      {"fd_io", &check_fd_io}
+    };
+
+  for (size_t i = 0; i < sizeof (checks) / sizeof (checks [0]); i++)
+    {
+      const unsigned failed = s_failures;
+      checks [i].fn ();
+      std::cout << (failed == s_failures ? "ok   " : "FAIL ") << checks [i].name << std::endl;
+    }
+  for (size_t i = 0; i < s_temp_files.size (); i++)
+    {
+      remove (s_temp_files [i].c_str ());
+    }
+  std::cout << s_checks << " checks, " << s_failures << " failures" << std::endl;
+  return s_failures ? 1 : 0;
+}
@@ -0,0 +1,45 @@
+#ifndef __IFF_TEST_CHECK_HPP__
+#define __IFF_TEST_CHECK_HPP__
+
+#include <string>
+#include "tools/synth.hpp"
+
+#define CHECK(C) check_report ((C), #C, __FILE__, __LINE__)
+
+bool        check_report (bool ok, const char* what, const char* file, int line);
+
+// an empty temporary file, it is removed when iff_check exits
+std::string check_temp_name ();
+// generates a synthetic file, removed like check_temp_name ()
+std::string check_temp_file (const iff::synth::params_t& p);
+std::string check_sample    (const char* name);
+// a linear congruential step, the same sequence everywhere; the
+// high bits of state, the low ones repeat too soon
+uint32_t    check_random    (uint32_t& state);
+
+// -------------------------------------------------------------------
+// checks, one entry per area
+// -------------------------------------------------------------------
+void check_stats ();
+void check_trace ();
+void check_alloc ();
+void check_nesting ();
+void check_corrupt ();
+void check_budget ();
+void check_id ();
+void check_dispatch ();
+void check_schema ();
+void check_capi ();
+void check_patch ();
+void check_extract ();
+void check_container ();
+void check_anim ();
+void check_byterun1 ();
+void check_transcode ();
+void check_mapped ();
+void check_preview ();
+void check_async ();
+void check_structure_cache ();
+void check_fd_io ();
+
+#endif
@@ -0,0 +1,74 @@
+#include "test/check.hpp"
+#include "core/generic_iff_reader.hpp"
+#include "core/generic_parser.hpp"
+#include "core/ea/ea_io.hpp"
+#include "bench/probe.hpp"
+
+static const unsigned REPEATS = 3;
+
+namespace
+{
+  class null_reader_c : public generic_iff_reader_c <iff::ea::io_c>
+  {
+  private:
+    virtual void _on_chunk_enter (const id_t&, std::streamsize, std::streamsize) {}
+    virtual void _on_chunk_exit  (const id_t&, std::streamsize, std::streamsize) {}
+    virtual void _on_group_enter (const id_t&, const id_t&, std::streamsize, std::streamsize) {}
+    virtual void _on_group_exit  (const id_t&, const id_t&, std::streamsize, std::streamsize) {}
+  };
+  // -------------------------------------------------------------
+  class null_parser_c : public iff::generic_parser_c <iff::ea::io_c>
+  {
+  private:
+    virtual void _on_chunk_enter (const std::string&, std::streamsize, std::streamsize) {}
+    virtual void _on_chunk_exit  (const std::string&, std::streamsize, std::streamsize) {}
+    virtual void _on_group_enter (const std::string&, const std::string&,
+				  std::streamsize, std::streamsize) {}
+    virtual void _on_group_exit  (const std::string&, const std::string&,
+				  std::streamsize, std::streamsize) {}
+  };
+}
+// ---------------------------------------------------------------
+// The first parse may allocate, every following parse of the same
+// file with the same object must not.
+template <class READER>
+static void check_steady_state (READER& r, const std::string& path)
+{
+  CHECK (r.open (path.c_str ()) == READER::eOK);
+  CHECK (r.read () == READER::eOK);
+
+  iff::bench::counters_t before;
+  iff::bench::counters_t after;
+  iff::bench::snapshot (before);
+  for (unsigned i = 0; i < REPEATS; i++)
+    {
+      CHECK (r.open (path.c_str ()) == READER::eOK);
+      CHECK (r.read () == READER::eOK);
+    }
+  iff::bench::snapshot (after);
+  if (!CHECK (after.allocs == before.allocs))
+    {
+      std::cerr << "  " << path << ": " << (after.allocs - before.allocs)
+		<< " allocations in " << REPEATS << " parses" << std::endl;
+    }
+}
+// ---------------------------------------------------------------
+void check_alloc ()
+{
+  static const char* samples [] =
+    {
+      "Anti-CBS.anim", "Berserk.anim", "BoingTrek.anim", "FAUG.anim", "Half-OS.anim",
+      "IronMan.anim", "OGRYN.IFF", "OldSpaceDock.anim", "SpaceDock1.anim",
+      "SpaceDock2.anim", "TNGFly.anim", "TP_SEX.LBM", "Videoscape2.anim",
+      "Xam-Yot.anim", "ZOOM.LBM", "test.aif", "test2.rbs"
+    };
+  // one reader and one parser for the whole corpus, as a service would
+  null_reader_c reader;
+  null_parser_c parser;
+  for (size_t i = 0; i < sizeof (samples) / sizeof (samples [0]); i++)
+    {
+      const std::string path = check_sample (samples [i]);
+      check_steady_state (reader, path);
+      check_steady_state (parser, path);
+    }
+}
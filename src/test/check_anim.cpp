@@ -0,0 +1,249 @@
+#include <string.h>
+#include <fstream>
+#include <vector>
+
+#include "test/check.hpp"
+#include "core/codec/anim_writer.hpp"
+#include "core/codec/planar.hpp"
+#include "bench/corpus.hpp"
+
+using namespace iff::ea::literals;
+using iff::codec::bmhd_t;
+using iff::codec::anhd_t;
+using iff::bench::chunk_t;
+
+typedef std::vector <uint8_t> frame_t;
+
+// ---------------------------------------------------------------
+// Plays an op 5 ANIM the way a double buffering player does and
+// returns every frame, false if any chunk does not decode.
+static bool play (const std::string& path, bmhd_t& h, std::vector <frame_t>& frames)
+{
+  std::vector <uint8_t> data;
+  std::vector <chunk_t> chunks;
+  if (!iff::bench::load_file (path, data) || data.empty () ||
+      !iff::bench::list_chunks (&data [0], data.size (), chunks))
+    {
+      return false;
+    }
+  frames.clear ();
+  frame_t buffers [2];
+  bool has_bmhd = false;
+  anhd_t a;
+  bool has_anhd = false;
+  for (size_t i = 0; i < chunks.size (); i++)
+    {
+      const chunk_t& c = chunks [i];
+      const uint8_t* p = &data [c.offset];
+      if (c.id == "BMHD"_id)
+	{
+	  has_bmhd = iff::codec::parse_bmhd (p, c.size, h);
+	}
+      else if (c.id == "BODY"_id && has_bmhd && frames.empty ())
+	{
+	  buffers [0].resize (iff::codec::body_row_bytes (h, false) * h.height);
+	  if (!iff::codec::decode_body (h, false, p, c.size, &buffers [0][0]))
+	    {
+	      return false;
+	    }
+	  buffers [1] = buffers [0];
+	  frames.push_back (buffers [0]);
+	}
+      else if (c.id == "ANHD"_id)
+	{
+	  has_anhd = iff::codec::parse_anhd (p, c.size, a);
+	}
+      else if (c.id == "DLTA"_id)
+	{
+	  if (!has_anhd || a.operation != anhd_t::eOP_BYTE_VERTICAL || frames.empty ())
+	    {
+	      return false;
+	    }
+	  frame_t& target = buffers [a.interleave == 1 ? 0 : frames.size () & 1];
+	  if (!iff::codec::anim5_decode (h, p, c.size, &target [0]))
+	    {
+	      return false;
+	    }
+	  frames.push_back (target);
+	  has_anhd = false;
+	}
+    }
+  return !frames.empty ();
+}
+// ---------------------------------------------------------------
+static void check_planar ()
+{
+  bmhd_t h;
+  memset (&h, 0, sizeof (h));
+  h.width   = 37;
+  h.height  = 1;
+  h.nplanes = 5;
+  const size_t plane_bytes = iff::codec::plane_row_bytes (h);
+  uint32_t seed = 7;
+  std::vector <uint8_t> pixels (h.width), back (h.width);
+  for (size_t x = 0; x < pixels.size (); x++)
+    {
+      pixels [x] = (uint8_t)(check_random (seed) & 31);
+    }
+  std::vector <uint8_t> row (plane_bytes * h.nplanes, 0xFF);
+  iff::codec::chunky_to_planar (&pixels [0], h.width, h.nplanes, &row [0], plane_bytes);
+  iff::codec::planar_to_chunky (&row [0], plane_bytes, h.nplanes, &back [0], h.width);
+  CHECK (pixels == back);
+  // the pad bits and bytes are cleared
+  CHECK ((row [4] & 0x07) == 0 && row [5] == 0);
+}
+// ---------------------------------------------------------------
+// a box moving over a gradient, a noisy strip and a repeated frame
+static std::vector <frame_t> synthetic_frames (const bmhd_t& h, size_t count)
+{
+  std::vector <frame_t> frames;
+  uint32_t seed = 1;
+  for (size_t f = 0; f < count; f++)
+    {
+      frame_t pixels (h.width * h.height);
+      for (size_t y = 0; y < h.height; y++)
+	{
+	  for (size_t x = 0; x < h.width; x++)
+	    {
+	      uint8_t v = (uint8_t)((x / 8 + y / 4) & 31);
+	      if (x >= (f * 3) % h.width && x < (f * 3) % h.width + 12 && y >= 10 && y < 30)
+		{
+		  v = (uint8_t)(f & 31);
+		}
+	      if (y >= 40 && y < 44 && x < 24)
+		{
+		  v = (uint8_t)(check_random (seed) & 31);
+		}
+	      pixels [y * h.width + x] = v;
+	    }
+	}
+      if (f == count / 2)
+	{
+	  pixels = frames.back ();
+	}
+      frames.push_back (pixels);
+    }
+  return frames;
+}
+// ---------------------------------------------------------------
+static bool write_anim (const std::string& path, const bmhd_t& h,
+			const std::vector <frame_t>& chunky, unsigned threads)
+{
+  std::ofstream os (path.c_str (), std::ios::out | std::ios::binary | std::ios::trunc);
+  iff::codec::anim_writer_c w (os, h, threads);
+  iff::codec::cmap_entry_t grey [32];
+  for (unsigned i = 0; i < 32; i++)
+    {
+      grey [i].r = grey [i].g = grey [i].b = (uint8_t)(i * 8);
+    }
+  w.set_palette (grey, 32);
+  for (size_t i = 0; i < chunky.size (); i++)
+    {
+      if (!w.add_chunky (&chunky [i][0]))
+	{
+	  return false;
+	}
+    }
+  return w.finish () && w.frames () == chunky.size ();
+}
+// ---------------------------------------------------------------
+// chunky frames in, the same frames out of the player, and the file
+// does not depend on the thread count
+static void check_round_trip ()
+{
+  bmhd_t h;
+  memset (&h, 0, sizeof (h));
+  h.width   = 100;
+  h.height  = 50;
+  h.nplanes = 5;
+  h.x_aspect = h.y_aspect = 1;
+  const std::vector <frame_t> chunky = synthetic_frames (h, 41);
+
+  const std::string one  = check_temp_name ();
+  const std::string many = check_temp_name ();
+  CHECK (write_anim (one, h, chunky, 1));
+  CHECK (write_anim (many, h, chunky, 3));
+  std::vector <uint8_t> a, b;
+  CHECK (iff::bench::load_file (one, a) && iff::bench::load_file (many, b) && a == b);
+
+  bmhd_t got;
+  std::vector <frame_t> frames;
+  if (!CHECK (play (many, got, frames)))
+    {
+      return;
+    }
+  CHECK (got.width == h.width && got.height == h.height && got.nplanes == h.nplanes);
+  CHECK (frames.size () == chunky.size ());
+  bool same = frames.size () == chunky.size ();
+  frame_t pixels (h.width * h.height);
+  for (size_t i = 0; same && i < frames.size (); i++)
+    {
+      same = iff::codec::frame_to_chunky (got, &frames [i][0], &pixels [0]) &&
+	pixels == chunky [i];
+    }
+  CHECK (same);
+}
+// ---------------------------------------------------------------
+// A tall column changing every third row needs more than 255 ops
+// the greedy way and is stored as one uniq span instead.
+static void check_long_column ()
+{
+  bmhd_t h;
+  memset (&h, 0, sizeof (h));
+  h.width   = 16;
+  h.height  = 900;
+  h.nplanes = 1;
+  const size_t size = iff::codec::body_row_bytes (h, false) * h.height;
+  frame_t ref (size, 0), cur (size, 0);
+  for (size_t y = 0; y < h.height; y += 3)
+    {
+      cur [y * 2] = (uint8_t)(y | 1);
+    }
+  std::vector <uint8_t> dlta, dlta4;
+  CHECK (iff::codec::anim5_encode (h, &ref [0], &cur [0], dlta));
+  CHECK (iff::codec::anim5_encode (h, &ref [0], &cur [0], dlta4, 4));
+  CHECK (dlta == dlta4);
+  // column 0: no skip, 898 rows in 127 row uniq ops
+  CHECK (dlta.size () > 64 && dlta [64] == 8);
+  frame_t out = ref;
+  CHECK (iff::codec::anim5_decode (h, &dlta [0], dlta.size (), &out [0]));
+  CHECK (out == cur);
+
+  // nothing changed: no plane is stored
+  CHECK (iff::codec::anim5_encode (h, &ref [0], &ref [0], dlta));
+  CHECK (dlta.size () == 64);
+}
+// ---------------------------------------------------------------
+// the frames of a real animation, encoded again, play back the same
+static void check_sample_anim (const char* name)
+{
+  bmhd_t h;
+  std::vector <frame_t> frames;
+  if (!CHECK (play (check_sample (name), h, frames)))
+    {
+      return;
+    }
+  const std::string path = check_temp_name ();
+  {
+    std::ofstream os (path.c_str (), std::ios::out | std::ios::binary | std::ios::trunc);
+    iff::codec::anim_writer_c w (os, h, 4);
+    for (size_t i = 0; i < frames.size (); i++)
+      {
+	w.add_frame (&frames [i][0]);
+      }
+    CHECK (w.finish ());
+  }
+  bmhd_t got;
+  std::vector <frame_t> again;
+  CHECK (play (path, got, again));
+  CHECK (again == frames);
+}
+// ---------------------------------------------------------------
+void check_anim ()
+{
+  check_planar ();
+  check_round_trip ();
+  check_long_column ();
+  check_sample_anim ("Half-OS.anim");
+  check_sample_anim ("Berserk.anim");
+}
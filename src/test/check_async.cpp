@@ -0,0 +1,193 @@
+#include <sstream>
+#include <vector>
+
+#include "test/check.hpp"
+#include "core/async_parser.hpp"
+#include "core/index_builder.hpp"
+#include "core/ea/ea_io.hpp"
+
+typedef generic_iff_reader_c <iff::ea::io_c> reader_t;
+typedef iff::async_parser_c <iff::ea::io_c>  async_parser_t;
+typedef iff::index_builder_c <iff::ea::io_c> index_builder_t;
+
+namespace
+{
+  // cancels itself on the chunk number "at", as another thread would
+  class cancelling_reader_c : public generic_iff_reader_c <iff::ea::io_c>
+  {
+  public:
+    explicit cancelling_reader_c (uint64_t at_)
+      : at (at_),
+	chunks (0)
+    {
+    }
+    uint64_t at;
+    uint64_t chunks;
+  private:
+    virtual void _on_chunk_enter (const id_t&, std::streamsize, std::streamsize)
+    {
+      if (++chunks == at)
+	{
+	  cancel ();
+	}
+    }
+    virtual void _on_chunk_exit  (const id_t&, std::streamsize, std::streamsize) {}
+    virtual void _on_group_enter (const id_t&, const id_t&, std::streamsize, std::streamsize) {}
+    virtual void _on_group_exit  (const id_t&, const id_t&, std::streamsize, std::streamsize) {}
+  };
+}
+// ---------------------------------------------------------------
+// what index_builder_c makes of the file
+static std::vector <iff::index_record_t> index_records (const std::string& path)
+{
+  std::vector <iff::index_record_t> out;
+  std::stringstream idx;
+  {
+    iff::index_writer_c writer (idx);
+    index_builder_t     builder (writer);
+    if (builder.build (path.c_str ()) != index_builder_t::eOK)
+      {
+	return out;
+      }
+  }
+  iff::index_reader_c reader (idx);
+  iff::index_record_t r;
+  if (reader.open ())
+    {
+      while (reader.next (r))
+	{
+	  out.push_back (r);
+	}
+    }
+  return out;
+}
+// ---------------------------------------------------------------
+static bool same_records (const std::vector <iff::index_record_t>& a,
+			  const std::vector <iff::index_record_t>& b)
+{
+  if (a.size () != b.size ())
+    {
+      return false;
+    }
+  for (size_t i = 0; i < a.size (); i++)
+    {
+      if (a [i].kind != b [i].kind || a [i].depth != b [i].depth || a [i].id != b [i].id ||
+	  a [i].tag != b [i].tag || a [i].size != b [i].size || a [i].offset != b [i].offset)
+	{
+	  return false;
+	}
+    }
+  return true;
+}
+// ---------------------------------------------------------------
+// The records arrive in parts, together the whole index, while the
+// progress only ever grows, up to the file size.
+static void check_progress (const std::string& path)
+{
+  const std::vector <iff::index_record_t> expected = index_records (path);
+  CHECK (!expected.empty ());
+
+  async_parser_t parser (64);
+  CHECK (parser.start (path.c_str ()) == reader_t::eOK);
+  std::vector <iff::index_record_t> got;
+  uint64_t last  = 0;
+  bool     grows = true;
+  size_t   parts = 0;
+  bool     done  = false;
+  while (!done)
+    {
+      done = parser.wait_for (std::chrono::milliseconds (50));
+      const uint64_t now = parser.consumed ();
+      grows = grows && now >= last && now <= parser.file_size ();
+      last  = now;
+      parts += parser.take (got) ? 1 : 0;
+    }
+  parser.take (got);
+  CHECK (grows);
+  CHECK (parser.status () == reader_t::eOK);
+  CHECK (parser.consumed () == parser.file_size ());
+  CHECK (same_records (got, expected));
+  CHECK (parts >= 1);
+
+  // again with the same parser
+  CHECK (parser.start (path.c_str ()) == reader_t::eOK);
+  CHECK (parser.wait () == reader_t::eOK);
+  got.clear ();
+  CHECK (parser.take (got) == expected.size () && parser.done ());
+}
+// ---------------------------------------------------------------
+// A batch far larger than the file: the records of its few big
+// chunks still go out as the walk reaches them, none is lost.
+static void check_big_chunks (const std::string& path)
+{
+  const std::vector <iff::index_record_t> expected = index_records (path);
+  async_parser_t parser (1 << 20);
+  CHECK (parser.start (path.c_str ()) == reader_t::eOK);
+  std::vector <iff::index_record_t> got;
+  size_t parts = 0;
+  while (!parser.wait_for (std::chrono::milliseconds (50)))
+    {
+      parts += parser.take (got) ? 1 : 0;
+    }
+  parts += parser.take (got) ? 1 : 0;
+  CHECK (parser.status () == reader_t::eOK);
+  CHECK (same_records (got, expected));
+  CHECK (parts >= 1);
+}
+// ---------------------------------------------------------------
+static void check_cancel (const std::string& path)
+{
+  // the walk stops before the next chunk, and stays cancelled until
+  // the next open ()
+  cancelling_reader_c reader (100);
+  CHECK (reader.open (path.c_str ()) == cancelling_reader_c::eOK);
+  CHECK (reader.read () == cancelling_reader_c::eCANCELLED);
+  CHECK (reader.chunks == 100);
+  CHECK (reader.consumed () > 0 && reader.consumed () < reader.file_size ());
+  CHECK (reader.read () == cancelling_reader_c::eCANCELLED);
+  reader.at = 0;
+  reader.chunks = 0;
+  CHECK (reader.open (path.c_str ()) == cancelling_reader_c::eOK);
+  CHECK (reader.read () == cancelling_reader_c::eOK);
+  CHECK (reader.consumed () == reader.file_size ());
+
+  // from another thread: what was delivered is a prefix of the file
+  const std::vector <iff::index_record_t> expected = index_records (path);
+  async_parser_t parser;
+  CHECK (parser.start (path.c_str ()) == reader_t::eOK);
+  parser.cancel ();
+  CHECK (parser.wait () == reader_t::eCANCELLED);
+  std::vector <iff::index_record_t> got;
+  parser.take (got);
+  CHECK (got.size () < expected.size ());
+  got.resize (std::min (got.size (), expected.size ()));
+  CHECK (same_records (got, std::vector <iff::index_record_t> (expected.begin (),
+								 expected.begin () + got.size ())));
+
+  // nothing runs after a failed start
+  CHECK (parser.start (check_sample ("no such file").c_str ()) == reader_t::eIO_ERROR);
+  CHECK (parser.done () && parser.status () == reader_t::eIO_ERROR);
+}
+// ---------------------------------------------------------------
+void check_async ()
+{
+  iff::synth::params_t p;
+  iff::synth::default_params (iff::synth::eTINY, p);
+  p.count = 200000;
+  p.size  = 16;
+  const std::string tiny = check_temp_file (p);
+  if (CHECK (!tiny.empty ()))
+    {
+      check_progress (tiny);
+      check_cancel (tiny);
+    }
+  check_progress (check_sample ("Half-OS.anim"));
+
+  p.count = 16;
+  p.size  = 256 * 1024;
+  const std::string big = check_temp_file (p);
+  if (CHECK (!big.empty ()))
+    {
+      check_big_chunks (big);
+    }
+}
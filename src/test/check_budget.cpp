@@ -0,0 +1,201 @@
+#include <string.h>
+#include <sstream>
+#include <fstream>
+#include <vector>
+
+#include "test/check.hpp"
+#include "core/structure_builder.hpp"
+#include "core/index_builder.hpp"
+#include "core/payload.hpp"
+#include "core/structure_cache.hpp"
+#include "core/ea/ea_io.hpp"
+
+using namespace iff::ea::literals;
+
+typedef iff::structure_builder_c <iff::ea::io_c> structure_builder_t;
+typedef iff::index_builder_c <iff::ea::io_c>     index_builder_t;
+
+namespace
+{
+  class counting_reader_c : public generic_iff_reader_c <iff::ea::io_c>
+  {
+  public:
+    counting_reader_c ()
+      : objects (0)
+    {
+    }
+    uint64_t objects;
+  private:
+    virtual void _on_chunk_enter (const id_t&, std::streamsize, std::streamsize)
+    {
+      objects++;
+    }
+    virtual void _on_chunk_exit  (const id_t&, std::streamsize, std::streamsize) {}
+    virtual void _on_group_enter (const id_t&, const id_t&, std::streamsize, std::streamsize)
+    {
+      objects++;
+    }
+    virtual void _on_group_exit  (const id_t&, const id_t&, std::streamsize, std::streamsize) {}
+  };
+}
+// ---------------------------------------------------------------
+static uint64_t count_objects (const iff::group_c::iterator_t& begin,
+			       const iff::group_c::iterator_t& end)
+{
+  uint64_t n = 0;
+  for (iff::group_c::iterator_t i = begin; i != end; ++i)
+    {
+      n++;
+      if ((*i)->is_group ())
+	{
+	  const iff::group_c* g = static_cast <const iff::group_c*> (*i);
+	  n += count_objects (g->begin (), g->end ());
+	}
+    }
+  return n;
+}
+// ---------------------------------------------------------------
+// The structure is charged to the budget while it lives, and a file
+// that does not fit fails cleanly and gives everything back.
+static void check_structure (const std::string& path)
+{
+  counting_reader_c counter;
+  CHECK (counter.open (path.c_str ()) == counting_reader_c::eOK);
+  CHECK (counter.read () == counting_reader_c::eOK);
+
+  iff::memory_budget_c budget;
+  {
+    structure_builder_t builder (&budget);
+    iff::structure_c* s = builder.build (path.c_str ());
+    if (CHECK (s != 0))
+      {
+	CHECK (count_objects (s->begin (), s->end ()) == counter.objects);
+	CHECK (s->reserved () >= counter.objects * sizeof (iff::chunk_c));
+	// the structure object included, as the cache counts it
+	CHECK (s->reserved () == iff::structure_cache_c::footprint (*s));
+	delete s;
+      }
+  }
+  CHECK (budget.used () == 0);
+
+  iff::memory_budget_c tight (budget.peak () / 2);
+  {
+    structure_builder_t builder (&tight);
+    CHECK (builder.build (path.c_str ()) == 0);
+    CHECK (builder.status () == structure_builder_t::eNO_MEMORY);
+    CHECK (tight.peak () <= tight.limit ());
+  }
+  CHECK (tight.used () == 0);
+}
+// ---------------------------------------------------------------
+// Streaming the structure of a large file out as an index fits in a
+// budget far smaller than its in-memory structure, and the index
+// holds every object.
+static void check_index (const std::string& path)
+{
+  counting_reader_c counter;
+  CHECK (counter.open (path.c_str ()) == counting_reader_c::eOK);
+  CHECK (counter.read () == counting_reader_c::eOK);
+
+  static const size_t CAP = 64 * 1024;
+  iff::memory_budget_c budget (CAP);
+  std::stringstream    idx;
+  {
+    iff::index_writer_c writer (idx, &budget, 4096);
+    index_builder_t     builder (writer, &budget);
+    CHECK (builder.build (path.c_str ()) == index_builder_t::eOK);
+    CHECK (writer.records () == counter.objects);
+    CHECK (budget.peak () <= CAP);
+    CHECK (counter.objects * structure_builder_t::node_cost (sizeof (iff::chunk_c)) > CAP);
+  }
+  CHECK (budget.used () == 0);
+
+  iff::index_reader_c reader (idx);
+  CHECK (reader.open ());
+  CHECK (reader.count () == counter.objects);
+  uint64_t records = 0;
+  iff::index_record_t r;
+  bool ordered = true;
+  uint64_t last = 0;
+  while (reader.next (r))
+    {
+      ordered = ordered && r.offset >= last && r.offset + r.size <= reader.file_size ();
+      last = r.offset;
+      records++;
+    }
+  CHECK (ordered);
+  CHECK (records == counter.objects);
+
+  // a cap below the reader's depth stack fails before parsing
+  iff::memory_budget_c none (16);
+  std::stringstream    idx2;
+  iff::index_writer_c  writer (idx2, &none);
+  index_builder_t      builder (writer, &none);
+  CHECK (builder.build (path.c_str ()) == index_builder_t::eNO_MEMORY);
+}
+// ---------------------------------------------------------------
+// A payload read through a small window matches the file.
+static void check_payload (const std::string& path)
+{
+  std::stringstream idx;
+  {
+    iff::index_writer_c writer (idx);
+    index_builder_t     builder (writer);
+    CHECK (builder.build (path.c_str ()) == index_builder_t::eOK);
+  }
+  iff::index_reader_c reader (idx);
+  CHECK (reader.open ());
+  iff::index_record_t body;
+  bool found = false;
+  while (!found && reader.next (body))
+    {
+      found = body.kind == iff::index_record_t::eCHUNK &&
+	body.id == "BODY"_id;
+    }
+  if (!CHECK (found))
+    {
+      return;
+    }
+
+  std::ifstream ifs (path.c_str (), std::ios::in | std::ios::binary);
+  std::vector <char> whole ((size_t)body.size);
+  ifs.seekg ((std::streamoff)body.offset);
+  ifs.read (&whole [0], whole.size ());
+
+  iff::memory_budget_c   budget (1000);
+  iff::payload_reader_c  payload (ifs, 1000, &budget);
+  CHECK (payload.open (body.offset, body.size) == iff::payload_reader_c::eOK);
+  uint64_t total = 0;
+  bool same = true;
+  const uint8_t* data;
+  size_t size;
+  while (payload.next (data, size) == iff::payload_reader_c::eOK && size)
+    {
+      same = same && memcmp (data, &whole [total], size) == 0;
+      total += size;
+    }
+  CHECK (same);
+  CHECK (total == body.size);
+  CHECK (budget.peak () == 1000);
+
+  iff::payload_reader_c greedy (ifs, 1001, &budget);
+  CHECK (greedy.open (body.offset, body.size) == iff::payload_reader_c::eNO_MEMORY);
+}
+// ---------------------------------------------------------------
+void check_budget ()
+{
+  check_structure (check_sample ("Half-OS.anim"));
+
+  iff::synth::params_t p;
+  iff::synth::default_params (iff::synth::eTINY, p);
+  p.count = 20000;
+  p.size  = 16;
+  const std::string tiny = check_temp_file (p);
+  if (CHECK (!tiny.empty ()))
+    {
+      check_structure (tiny);
+      check_index (tiny);
+    }
+
+  check_payload (check_sample ("ZOOM.LBM"));
+}
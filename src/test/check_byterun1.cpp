@@ -0,0 +1,204 @@
+#include <string.h>
+#include <sstream>
+#include <vector>
+
+#include "test/check.hpp"
+#include "core/codec/byterun1.hpp"
+#include "core/codec/ilbm.hpp"
+#include "core/codec/parallel.hpp"
+#include "core/ea/writer.hpp"
+#include "core/ea/id.hpp"
+#include "bench/corpus.hpp"
+
+using namespace iff::ea::literals;
+using iff::codec::bmhd_t;
+
+// ---------------------------------------------------------------
+// The reference: the same shortest path, every op length tried at
+// every position.
+static size_t reference_size (const uint8_t* src, size_t size)
+{
+  std::vector <size_t> cost (size + 1, (size_t)-1);
+  cost [0] = 0;
+  for (size_t i = 0; i < size; i++)
+    {
+      for (size_t n = 1; n <= 128 && i + n <= size; n++)
+	{
+	  if (cost [i] + n + 1 < cost [i + n])
+	    {
+	      cost [i + n] = cost [i] + n + 1;
+	    }
+	}
+      for (size_t n = 2; n <= 128 && i + n <= size && src [i + n - 1] == src [i]; n++)
+	{
+	  if (cost [i] + 2 < cost [i + n])
+	    {
+	      cost [i + n] = cost [i] + 2;
+	    }
+	}
+    }
+  return cost [size];
+}
+// ---------------------------------------------------------------
+// rows of short and long runs between noise, the lengths around
+// the 128 byte limits
+static std::vector <uint8_t> random_row (uint32_t& seed, size_t size)
+{
+  std::vector <uint8_t> row;
+  while (row.size () < size)
+    {
+      const uint32_t r = check_random (seed);
+      size_t n = 1 + r % 7;
+      switch (r % 5)
+	{
+	case 0:
+	  n = 120 + r % 20;
+	  break;
+	case 1:
+	  n = 250 + r % 10;
+	  break;
+	}
+      const bool repeat = (r >> 8) & 1;
+      const uint8_t v = (uint8_t)check_random (seed);
+      for (size_t k = 0; k < n && row.size () < size; k++)
+	{
+	  row.push_back (repeat ? v : (uint8_t)(check_random (seed) & 3));
+	}
+    }
+  return row;
+}
+// ---------------------------------------------------------------
+static void check_rows ()
+{
+  uint32_t seed = 11;
+  bool optimal = true, round_trip = true, same_isa = true, bounded = true;
+  for (size_t size = 1; size < 700; size += 1 + size / 8)
+    {
+      for (int t = 0; t < 8; t++)
+	{
+	  const std::vector <uint8_t> row = random_row (seed, size);
+	  std::vector <uint8_t> packed;
+	  iff::codec::byterun1_packer_c scalar (iff::codec::eSCALAR);
+	  const size_t n = scalar.pack (&row [0], size, packed);
+	  optimal = optimal && n == packed.size () && n == reference_size (&row [0], size);
+	  bounded = bounded && n <= iff::codec::byterun1_bound (size);
+
+	  std::vector <uint8_t> back (size);
+	  round_trip = round_trip &&
+	    iff::codec::byterun1_decode (&packed [0], n, &back [0], size) == n && back == row;
+
+	  for (int v = iff::codec::eSSE2; v < iff::codec::ISA_COUNT; v++)
+	    {
+	      if (!iff::codec::isa_supported ((iff::codec::isa_t)v))
+		{
+		  continue;
+		}
+	      std::vector <uint8_t> other;
+	      iff::codec::byterun1_packer_c packer ((iff::codec::isa_t)v);
+	      packer.pack (&row [0], size, other);
+	      same_isa = same_isa && other == packed;
+	    }
+	}
+    }
+  CHECK (optimal);
+  CHECK (bounded);
+  CHECK (round_trip);
+  CHECK (same_isa);
+
+  // constant and alternating rows
+  std::vector <uint8_t> flat (1000, 7), out;
+  iff::codec::byterun1_packer_c packer;
+  CHECK (packer.pack (&flat [0], flat.size (), out) == 16);
+  std::vector <uint8_t> noise (256);
+  for (size_t i = 0; i < noise.size (); i++)
+    {
+      noise [i] = (uint8_t)(i & 1);
+    }
+  out.clear ();
+  CHECK (packer.pack (&noise [0], noise.size (), out) == 258);
+}
+// ---------------------------------------------------------------
+// a sample frame packed again, on one thread and on several,
+// in memory and through the writer, unpacks to itself
+static void check_body (const char* name)
+{
+  std::vector <uint8_t> data;
+  if (!CHECK (iff::bench::load_file (check_sample (name), data)))
+    {
+      return;
+    }
+  // the first BMHD and BODY of the file
+  std::vector <iff::bench::chunk_t> chunks;
+  iff::bench::list_chunks (&data [0], data.size (), chunks);
+  bmhd_t h;
+  size_t body = 0, body_size = 0;
+  bool has_bmhd = false;
+  for (size_t i = 0; i < chunks.size () && !body; i++)
+    {
+      const uint8_t* p = &data [chunks [i].offset];
+      if (chunks [i].id == "BMHD"_id)
+	{
+	  has_bmhd = iff::codec::parse_bmhd (p, chunks [i].size, h);
+	}
+      else if (chunks [i].id == "BODY"_id && has_bmhd)
+	{
+	  body = chunks [i].offset;
+	  body_size = chunks [i].size;
+	}
+    }
+  if (!CHECK (body != 0 && body + body_size <= data.size ()))
+    {
+      return;
+    }
+  std::vector <uint8_t> frame (iff::codec::body_row_bytes (h, false) * h.height);
+  CHECK (iff::codec::decode_body (h, false, &data [body], body_size, &frame [0]));
+
+  h.compression = bmhd_t::eCMP_BYTERUN1;
+  std::vector <uint8_t> one, many;
+  CHECK (iff::codec::encode_body (h, false, &frame [0], one, 1));
+  CHECK (iff::codec::encode_body (h, false, &frame [0], many, 4));
+  CHECK (one == many);
+  std::vector <uint8_t> back (frame.size ());
+  CHECK (iff::codec::decode_body (h, false, &one [0], one.size (), &back [0]) && back == frame);
+
+  std::stringstream os;
+  iff::ea::writer_c w (os);
+  CHECK (iff::codec::write_body (w, h, false, &frame [0], 2));
+  const std::string chunk = os.str ();
+  CHECK (chunk.size () == 8 + one.size () + (one.size () & 1));
+  CHECK (chunk.size () >= 8 && memcmp (chunk.data () + 8, &one [0], one.size ()) == 0);
+}
+// ---------------------------------------------------------------
+// one pool for many runs, as write_body () uses it: every item of
+// every run done exactly once, packing the same as on one thread
+static void check_pool ()
+{
+  iff::codec::thread_pool_c pool (4);
+  CHECK (pool.size () == 4);
+  bool once = true;
+  for (size_t n = 0; n < 50; n++)
+    {
+      std::vector <std::atomic <unsigned> > hits (n);
+      pool.run (n, [&] (size_t i) { hits [i]++; });
+      for (size_t i = 0; i < n; i++)
+	{
+	  once = once && hits [i] == 1;
+	}
+    }
+  CHECK (once);
+
+  uint32_t seed = 3;
+  std::vector <uint8_t> rows = random_row (seed, 300 * 1024);
+  std::vector <uint8_t> one, many;
+  iff::codec::byterun1_encode_rows (&rows [0], 1024, rows.size () / 1024, one, 1);
+  iff::codec::byterun1_encode_rows (&rows [0], 1024, rows.size () / 1024, many, pool);
+  CHECK (one == many);
+}
+// ---------------------------------------------------------------
+void check_byterun1 ()
+{
+  check_rows ();
+  check_pool ();
+  check_body ("ZOOM.LBM");
+  check_body ("TP_SEX.LBM");
+}
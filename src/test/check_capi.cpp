@@ -0,0 +1,72 @@
+#include <cstdlib>
+#include <sstream>
+#include <vector>
+
+#include "test/check.hpp"
+#include "capi/iff.h"
+#include "core/index_builder.hpp"
+#include "core/ea/ea_io.hpp"
+#include "bench/corpus.hpp"
+
+extern "C" iff_status_t check_capi_parse_c (const char* path, iff_event_t** events, size_t* count);
+
+typedef iff::index_builder_c <iff::ea::io_c> index_builder_t;
+
+// ---------------------------------------------------------------
+// the events are the records of the binary index of the same file
+static void check_file (const std::string& path)
+{
+  std::stringstream idx;
+  {
+    iff::index_writer_c writer (idx);
+    index_builder_t     builder (writer);
+    CHECK (builder.build (path.c_str ()) == index_builder_t::eOK);
+  }
+  iff::index_reader_c reader (idx);
+  CHECK (reader.open ());
+
+  iff_event_t* events = 0;
+  size_t       count  = 0;
+  CHECK (check_capi_parse_c (path.c_str (), &events, &count) == IFF_OK);
+  CHECK (count == reader.count ());
+
+  bool same = events != 0;
+  iff::index_record_t r;
+  for (size_t i = 0; i < count && same && reader.next (r); i++)
+    {
+      const iff_event_t& e = events [i];
+      same = e.kind == r.kind && e.depth == r.depth && e.id == r.id && e.tag == r.tag &&
+	e.size == r.size && e.offset == r.offset;
+    }
+  CHECK (same);
+  free (events);
+
+  // a short array keeps its prefix and reports the full count
+  std::vector <iff_event_t> few (3);
+  size_t n = 0;
+  CHECK (iff_parse_file (path.c_str (), &few [0], few.size (), &n) == IFF_TRUNCATED);
+  CHECK (n == count);
+
+  std::vector <uint8_t> data;
+  if (CHECK (iff::bench::load_file (path, data) && !data.empty ()))
+    {
+      std::vector <iff_event_t> all (count);
+      CHECK (iff_parse_memory (&data [0], data.size (), &all [0], all.size (), &n) == IFF_OK);
+      CHECK (n == count);
+      CHECK (all [2].offset == few [2].offset && all [2].id == few [2].id);
+    }
+}
+// ---------------------------------------------------------------
+void check_capi ()
+{
+  CHECK (iff_api_version () == IFF_C_API_VERSION);
+  check_file (check_sample ("Half-OS.anim"));
+  check_file (check_sample ("test.aif"));
+
+  size_t n = 1;
+  CHECK (iff_parse_file (0, 0, 0, &n) == IFF_BAD_ARGUMENT);
+  CHECK (iff_parse_file ("/nonexistent/file", 0, 0, &n) == IFF_IO_ERROR && n == 0);
+  static const char junk [] = "this is not an IFF file at all";
+  CHECK (iff_parse_memory (junk, sizeof (junk), 0, 0, &n) != IFF_OK);
+  CHECK (std::string (iff_status_string (IFF_TRUNCATED)).size () > 0);
+}
@@ -0,0 +1,21 @@
+/* compiled as C: the header must stay valid C */
+#include <stdlib.h>
+
+#include "capi/iff.h"
+
+/* the usual two call pattern: size the array, then fill it */
+iff_status_t check_capi_parse_c (const char* path, iff_event_t** events, size_t* count)
+{
+  iff_status_t rc = iff_parse_file (path, NULL, 0, count);
+  *events = NULL;
+  if (rc != IFF_TRUNCATED && rc != IFF_OK)
+    {
+      return rc;
+    }
+  *events = (iff_event_t*) malloc ((*count + 1) * sizeof (iff_event_t));
+  if (!*events)
+    {
+      return IFF_NO_MEMORY;
+    }
+  return iff_parse_file (path, *events, *count + 1, count);
+}
@@ -0,0 +1,140 @@
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <fstream>
+#include <vector>
+
+#include "test/check.hpp"
+#include "core/ea/container.hpp"
+#include "bench/corpus.hpp"
+
+using namespace iff::ea::literals;
+using iff::ea::container_builder_c;
+
+// ---------------------------------------------------------------
+// packing copies every file as a child, splitting gives the files back
+static void check_round_trip (const std::vector <std::string>& files, const iff::ea::id_c& id,
+			      const iff::ea::id_c& expected_tag)
+{
+  const std::string packed = check_temp_name ();
+  container_builder_c out;
+  CHECK (out.open (packed.c_str (), id) == container_builder_c::eOK);
+  for (size_t i = 0; i < files.size (); i++)
+    {
+      CHECK (out.append (files [i].c_str ()) == container_builder_c::eOK);
+    }
+  CHECK (out.finish () == container_builder_c::eOK);
+  CHECK (out.children () == files.size ());
+
+  std::vector <uint8_t> whole;
+  CHECK (iff::bench::load_file (packed, whole));
+  CHECK (whole.size () == out.size ());
+
+  iff::ea::id_c got_id, got_tag;
+  std::vector <iff::ea::container_child_t> children;
+  if (!CHECK (iff::ea::list_container (packed.c_str (), got_id, got_tag, children)))
+    {
+      return;
+    }
+  CHECK (got_id == id && got_tag == expected_tag);
+  CHECK (children.size () == files.size ());
+
+  const std::string prefix = check_temp_name () + ".";
+  std::vector <std::string> written;
+  CHECK (iff::ea::split_container (packed.c_str (), prefix, &written));
+  CHECK (written.size () == files.size ());
+  bool same = true;
+  for (size_t i = 0; i < files.size () && i < written.size (); i++)
+    {
+      std::vector <uint8_t> a, b;
+      same = same && iff::bench::load_file (files [i], a) && iff::bench::load_file (written [i], b);
+      // the sources may carry slack after their root group, the
+      // split files end with the pad of an odd group
+      const size_t n = (size_t)children [i].size;
+      same = same && a.size () >= n && b.size () == n + (n & 1);
+      same = same && std::equal (b.begin (), b.begin () + n, a.begin ());
+      same = same && std::equal (b.begin (), b.end (), whole.begin () + (size_t)children [i].offset);
+      remove (written [i].c_str ());
+    }
+  CHECK (same);
+}
+// ---------------------------------------------------------------
+// listing a group a few items at a time gives the same items as at
+// once, and a truncated file stops at the item running past its end
+static void check_list_range (const std::string& path)
+{
+  std::vector <uint8_t> whole;
+  const int fd = open (path.c_str (), O_RDONLY);
+  if (!CHECK (fd >= 0 && iff::bench::load_file (path, whole)))
+    {
+      return;
+    }
+  std::vector <iff::ea::container_child_t> root, all, some;
+  uint64_t pos = 0;
+  CHECK (iff::ea::list_range (fd, pos, whole.size (), root));
+  if (CHECK (root.size () == 1 && root [0].id == "FORM"_id && root [0].tag == "ANIM"_id))
+    {
+      const uint64_t end = root [0].offset + root [0].size;
+      pos = root [0].offset + 12;
+      CHECK (iff::ea::list_range (fd, pos, end, all));
+      CHECK (pos >= end && all.size () > 1);
+      pos = root [0].offset + 12;
+      bool ok = true;
+      while (ok && pos + 8 <= end)
+	{
+	  const size_t before = some.size ();
+	  ok = iff::ea::list_range (fd, pos, end, some, 3) && some.size () - before <= 3;
+	}
+      CHECK (ok && some.size () == all.size ());
+      bool same = some.size () == all.size ();
+      for (size_t i = 0; same && i < all.size (); i++)
+	{
+	  same = some [i].offset == all [i].offset && some [i].tag == all [i].tag &&
+	    all [i].id == "FORM"_id && all [i].tag == "ILBM"_id;
+	}
+      CHECK (same);
+
+      // the last item claims bytes past a shorter range
+      pos = root [0].offset + 12;
+      std::vector <iff::ea::container_child_t> cut;
+      CHECK (!iff::ea::list_range (fd, pos, end - 1, cut));
+      CHECK (cut.size () == all.size () - 1 && pos == all.back ().offset);
+    }
+  close (fd);
+}
+// ---------------------------------------------------------------
+void check_container ()
+{
+  check_list_range (check_sample ("Half-OS.anim"));
+
+  std::vector <std::string> anims;
+  anims.push_back (check_sample ("Half-OS.anim"));
+  anims.push_back (check_sample ("Berserk.anim"));
+  check_round_trip (anims, "LIST"_id, "ANIM"_id);
+
+  anims.push_back (check_sample ("ZOOM.LBM"));
+  check_round_trip (anims, "CAT "_id, "    "_id);
+
+  // an odd sized FORM is padded inside the container and when split
+  const std::string odd = check_temp_name ();
+  {
+    std::ofstream ofs (odd.c_str (), std::ios::out | std::ios::binary | std::ios::trunc);
+    static const char form [] = "FORM\0\0\0\x0dTESTABCD\0\0\0\x01z";
+    ofs.write (form, sizeof (form) - 1);
+  }
+  std::vector <std::string> files (2, odd);
+  check_round_trip (files, "CAT "_id, "TEST"_id);
+
+  container_builder_c out;
+  const std::string bad = check_temp_name ();
+  CHECK (out.open (bad.c_str (), "CAT "_id, "TEST"_id) == container_builder_c::eOK);
+  CHECK (out.append (check_sample ("05military-abrams-tank.3DS").c_str ()) == container_builder_c::eNOT_IFF);
+  CHECK (out.append (odd.c_str ()) == container_builder_c::eOK);
+  CHECK (out.finish () == container_builder_c::eOK);
+  CHECK (out.size () == 12 + 22);
+
+  iff::ea::id_c id, tag;
+  std::vector <iff::ea::container_child_t> children;
+  CHECK (!iff::ea::list_container (odd.c_str (), id, tag, children));
+}
@@ -0,0 +1,87 @@
+#include <fstream>
+#include <vector>
+#include <iterator>
+
+#include "test/check.hpp"
+#include "core/generic_iff_reader.hpp"
+#include "core/ea/ea_io.hpp"
+#include "core/fd_io.hpp"
+
+namespace
+{
+  class null_reader_c : public generic_iff_reader_c <iff::ea::io_c>
+  {
+  public:
+    null_reader_c ()
+      : events (0)
+    {
+    }
+    unsigned events;
+  private:
+    virtual void _on_chunk_enter (const id_t&, std::streamsize, std::streamsize) { events++; }
+    virtual void _on_chunk_exit  (const id_t&, std::streamsize, std::streamsize) { events++; }
+    virtual void _on_group_enter (const id_t&, const id_t&, std::streamsize, std::streamsize) { events++; }
+    virtual void _on_group_exit  (const id_t&, const id_t&, std::streamsize, std::streamsize) { events++; }
+  };
+}
+// ---------------------------------------------------------------
+static void put_be32 (std::vector <char>& d, size_t at, uint32_t v)
+{
+  iff::put_be32 ((uint8_t*)&d [at], v);
+}
+// ---------------------------------------------------------------
+static null_reader_c::status_t parse (const std::vector <char>& d, unsigned* events = 0)
+{
+  null_reader_c r;
+  null_reader_c::status_t rc = r.open (&d [0], (std::streamsize)d.size ());
+  if (rc == null_reader_c::eOK)
+    {
+      rc = r.read ();
+    }
+  if (events)
+    {
+      *events = r.events;
+    }
+  return rc;
+}
+// ---------------------------------------------------------------
+void check_corrupt ()
+{
+  std::ifstream ifs (check_sample ("test2.rbs").c_str (), std::ios::binary);
+  const std::vector <char> orig ((std::istreambuf_iterator <char> (ifs)),
+				 std::istreambuf_iterator <char> ());
+  CHECK (orig.size () == 16840);
+  if (orig.size () != 16840)
+    {
+      return;
+    }
+
+  // memory and file input agree
+  unsigned from_memory = 0;
+  CHECK (parse (orig, &from_memory) == null_reader_c::eOK);
+  null_reader_c from_file;
+  CHECK (from_file.open (check_sample ("test2.rbs").c_str ()) == null_reader_c::eOK);
+  CHECK (from_file.read () == null_reader_c::eOK);
+  CHECK (from_memory == from_file.events && from_memory > 0);
+
+  std::vector <char> d;
+
+  // the root claims more than the file holds
+  d = orig;
+  put_be32 (d, 4, 0x7FFFFFFF);
+  CHECK (parse (d) == null_reader_c::eCORRUPT);
+
+  // HEAD (at 12) claims more than its CAT holds
+  d = orig;
+  put_be32 (d, 16, 0xFFFFFFF0u);
+  CHECK (parse (d) == null_reader_c::eCORRUPT);
+
+  // a group too small for its own tag
+  d = orig;
+  put_be32 (d, 4, 2);
+  CHECK (parse (d) == null_reader_c::eCORRUPT);
+
+  // truncated in the middle of a chunk
+  d.assign (orig.begin (), orig.begin () + 1000);
+  CHECK (parse (d) == null_reader_c::eCORRUPT);
+}
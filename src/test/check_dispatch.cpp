@@ -0,0 +1,193 @@
+#include <vector>
+#include <set>
+
+#include "test/check.hpp"
+#include "core/dispatch_reader.hpp"
+#include "core/ea/ea_io.hpp"
+
+using namespace iff::ea::literals;
+
+typedef iff::dispatch_reader_c <iff::ea::io_c> dispatch_reader_t;
+
+namespace
+{
+  class counter_c : public iff::chunk_handler_c
+  {
+  public:
+    counter_c ()
+      : calls (0)
+    {
+    }
+    virtual void on_chunk (const iff::chunk_event_t& ev)
+    {
+      calls++;
+      parents.insert (ev.parent);
+    }
+    unsigned            calls;
+    std::set <iff_id_t> parents;
+  };
+
+  // counts chunks by (enclosing tag, id) the slow way
+  class tally_reader_c : public generic_iff_reader_c <iff::ea::io_c>
+  {
+  public:
+    tally_reader_c (iff_id_t parent, iff_id_t id)
+      : count (0),
+	m_parent (parent),
+	m_id (id)
+    {
+    }
+    unsigned count;
+  private:
+    virtual void _on_chunk_enter (const id_t& id, std::streamsize, std::streamsize)
+    {
+      if (id == m_id && (m_parent == iff::handler_registry_c::ANY || _encloses ()))
+	{
+	  count++;
+	}
+    }
+    bool _encloses () const
+    {
+      for (size_t up = 0; up < _depth (); up++)
+	{
+	  if (_enclosing_tag (up) == m_parent)
+	    {
+	      return true;
+	    }
+	}
+      return false;
+    }
+    virtual void _on_chunk_exit  (const id_t&, std::streamsize, std::streamsize) {}
+    virtual void _on_group_enter (const id_t&, const id_t&, std::streamsize, std::streamsize) {}
+    virtual void _on_group_exit  (const id_t&, const id_t&, std::streamsize, std::streamsize) {}
+
+    iff_id_t m_parent;
+    iff_id_t m_id;
+  };
+}
+// ---------------------------------------------------------------
+static unsigned tally (const std::string& path, iff_id_t parent, iff_id_t id)
+{
+  tally_reader_c r (parent, id);
+  CHECK (r.open (path.c_str ()) == tally_reader_c::eOK);
+  CHECK (r.read () == tally_reader_c::eOK);
+  return r.count;
+}
+// ---------------------------------------------------------------
+// An animation holds ILBM forms inside an ANIM form: BODY is bound
+// under ILBM only, DLTA under ANIM only (it sits in the ILBM of each
+// frame) and BMHD anywhere.
+static void check_file (const std::string& path, bool anim)
+{
+  counter_c body, dlta, bmhd, any_body;
+  iff::handler_registry_c handlers;
+  handlers.bind ("ILBM"_id, "BODY"_id, &body);
+  handlers.bind ("ANIM"_id, "DLTA"_id, &dlta);
+  handlers.bind ("BMHD"_id, &bmhd);
+  handlers.compile ();
+
+  dispatch_reader_t r (handlers);
+  CHECK (r.open (path.c_str ()) == dispatch_reader_t::eOK);
+  CHECK (r.read () == dispatch_reader_t::eOK);
+
+  CHECK (body.calls == tally (path, "ILBM"_id, "BODY"_id));
+  CHECK (dlta.calls == tally (path, "ANIM"_id, "DLTA"_id));
+  CHECK (bmhd.calls == tally (path, iff::handler_registry_c::ANY, "BMHD"_id));
+  CHECK (body.calls > 0 && bmhd.calls > 0);
+  CHECK (body.parents.size () == 1 && *body.parents.begin () == "ILBM"_id);
+  CHECK ((dlta.calls > 0) == anim);
+  CHECK (dlta.parents.size () == (anim ? 1U : 0U));
+}
+// ---------------------------------------------------------------
+static void check_bindings ()
+{
+  counter_c a, b, c;
+  iff::handler_registry_c handlers;
+  CHECK (handlers.lookup (0, "BODY"_id) == 0);
+
+  handlers.bind ("BODY"_id, &a);
+  handlers.bind ("ILBM"_id, "BODY"_id, &b);
+  handlers.bind ("ANIM"_id, "DLTA"_id, &a);
+  handlers.bind ("ANIM"_id, "DLTA"_id, &c);
+  handlers.compile ();
+
+  CHECK (handlers.size () == 3);
+  CHECK (handlers.lookup ("ILBM"_id, "BODY"_id) == &b);
+  CHECK (handlers.lookup ("PBM "_id, "BODY"_id) == &a);
+  CHECK (handlers.lookup (0, "BODY"_id) == &a);
+  CHECK (handlers.lookup ("ANIM"_id, "DLTA"_id) == &c);
+  CHECK (handlers.lookup ("ILBM"_id, "DLTA"_id) == 0);
+  CHECK (handlers.lookup ("ILBM"_id, "CMAP"_id) == 0);
+  CHECK (handlers.lookup ("ILBM"_id, 0) == 0);
+
+  // the innermost enclosing tag wins, then ANY
+  const iff_id_t frame [] = {"ILBM"_id, "ANIM"_id};
+  const iff_id_t pbm []   = {"PBM "_id, "ANIM"_id};
+  CHECK (handlers.lookup (frame, 2, "DLTA"_id) == &c);
+  CHECK (handlers.lookup (frame, 1, "DLTA"_id) == 0);
+  CHECK (handlers.lookup (frame, 2, "BODY"_id) == &b);
+  CHECK (handlers.lookup (pbm, 2, "BODY"_id) == &a);
+  CHECK (handlers.lookup (frame, 0, "BODY"_id) == &a);
+  CHECK (handlers.lookup (frame, 2, "CMAP"_id) == 0);
+
+  // only ids bound to a tag need the scope
+  const iff::handler_registry_c::slot_t* s = handlers.find ("BODY"_id);
+  CHECK (handlers.find ("CMAP"_id) == 0);
+  CHECK (s != 0 && handlers.is_scoped (*s) && handlers.match (*s, frame, 2) == &b);
+  iff::handler_registry_c any;
+  any.bind ("CMAP"_id, &a);
+  any.compile ();
+  s = any.find ("CMAP"_id);
+  CHECK (s != 0 && !any.is_scoped (*s) && any.match (*s, 0, 0) == &a);
+}
+// ---------------------------------------------------------------
+// thousands of ids still compile to a perfect hash, every bound id
+// is found and nothing else
+static void check_large ()
+{
+  std::vector <counter_c> counters (4000);
+  iff::handler_registry_c handlers;
+  uint32_t x = 12345;
+  std::vector <iff_id_t> ids;
+  std::set <iff_id_t>    bound;
+  while (ids.size () < counters.size ())
+    {
+      x = x * 1664525U + 1013904223U;
+      if (bound.insert (x).second)
+	{
+	  ids.push_back (x);
+	}
+    }
+  for (size_t i = 0; i < ids.size (); i++)
+    {
+      handlers.bind (ids [i], &counters [i]);
+    }
+  handlers.compile ();
+  CHECK (handlers.is_perfect ());
+
+  bool found = true;
+  for (size_t i = 0; i < ids.size (); i++)
+    {
+      found = found && handlers.lookup (0, ids [i]) == &counters [i];
+    }
+  CHECK (found);
+
+  unsigned stray = 0;
+  for (uint32_t i = 0; i < 100000; i++)
+    {
+      x = x * 1664525U + 1013904223U;
+      if (!bound.count (x) && handlers.lookup (0, x))
+	{
+	  stray++;
+	}
+    }
+  CHECK (stray == 0);
+}
+// ---------------------------------------------------------------
+void check_dispatch ()
+{
+  check_bindings ();
+  check_large ();
+  check_file (check_sample ("Half-OS.anim"), true);
+  check_file (check_sample ("ZOOM.LBM"), false);
+}
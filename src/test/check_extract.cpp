@@ -0,0 +1,92 @@
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "test/check.hpp"
+#include "core/ea/extract.hpp"
+#include "bench/corpus.hpp"
+
+using namespace iff::ea::literals;
+
+// ---------------------------------------------------------------
+static bool same_bytes (const std::vector <uint8_t>& data, const iff::ea::chunk_ref_t& ref,
+			const std::vector <uint8_t>& out)
+{
+  return out.size () == ref.size &&
+    std::equal (out.begin (), out.end (), data.begin () + (size_t)ref.offset);
+}
+// ---------------------------------------------------------------
+// every selected payload lands in its file byte for byte
+static void check_file (const std::string& path)
+{
+  iff::ea::extractor_c x;
+  x.select (iff::handler_registry_c::ANY, "BODY"_id);
+  x.select ("ILBM"_id, "CMAP"_id);
+  std::vector <iff::ea::chunk_ref_t> refs;
+  CHECK (x.locate (path.c_str (), refs) == iff::ea::extractor_c::reader_t::eOK);
+  CHECK (!refs.empty ());
+
+  std::vector <uint8_t> data;
+  CHECK (iff::bench::load_file (path, data));
+  const int fd = open (path.c_str (), O_RDONLY);
+  if (!CHECK (fd >= 0))
+    {
+      return;
+    }
+  const std::string out = check_temp_name ();
+  bool ok = true;
+  for (size_t i = 0; i < refs.size (); i++)
+    {
+      ok = ok && (refs [i].id == "BODY"_id || refs [i].parent == "ILBM"_id);
+      std::vector <uint8_t> got;
+      ok = ok && iff::ea::extractor_c::extract (fd, refs [i], out) &&
+	iff::bench::load_file (out, got) && same_bytes (data, refs [i], got);
+    }
+  CHECK (ok);
+
+  // into a pipe copy_file_range may not apply, the fallbacks must
+  int p [2];
+  if (CHECK (pipe (p) == 0))
+    {
+      const iff::ea::chunk_ref_t& r = refs [0];
+      const size_t n = r.size < 4096 ? (size_t)r.size : 4096;
+      CHECK (iff::copy_range (fd, r.offset, n, p [1]));
+      std::vector <uint8_t> got (n);
+      CHECK (read (p [0], &got [0], n) == (ssize_t)n);
+      CHECK (std::equal (got.begin (), got.end (), data.begin () + (size_t)r.offset));
+      close (p [0]);
+      close (p [1]);
+    }
+
+  // a range past the end of the input fails instead of writing less
+  const int devnull = open ("/dev/null", O_WRONLY);
+  CHECK (!iff::copy_range (fd, data.size () - 10, 20, devnull));
+  close (devnull);
+  close (fd);
+}
+// ---------------------------------------------------------------
+// the deltas of an animation sit in the ILBM of each frame, ANIM/DLTA
+// still selects them
+static void check_scoped (const std::string& path)
+{
+  iff::ea::extractor_c x;
+  x.select ("ANIM"_id, "DLTA"_id);
+  std::vector <iff::ea::chunk_ref_t> refs;
+  CHECK (x.locate (path.c_str (), refs) == iff::ea::extractor_c::reader_t::eOK);
+  CHECK (!refs.empty ());
+  bool ok = true;
+  for (size_t i = 0; i < refs.size (); i++)
+    {
+      ok = ok && refs [i].id == "DLTA"_id && refs [i].parent == "ILBM"_id;
+    }
+  CHECK (ok);
+}
+// ---------------------------------------------------------------
+void check_extract ()
+{
+  check_file (check_sample ("ZOOM.LBM"));
+  check_file (check_sample ("Half-OS.anim"));
+  check_scoped (check_sample ("Half-OS.anim"));
+}
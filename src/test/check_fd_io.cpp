@@ -0,0 +1,86 @@
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <thread>
+#include <vector>
+
+#include "test/check.hpp"
+#include "core/fd_io.hpp"
+
+// ---------------------------------------------------------------
+static void check_byte_order ()
+{
+  uint8_t b [4];
+  iff::put_be32 (b, 0x464f524du);
+  CHECK (b [0] == 'F' && b [1] == 'O' && b [2] == 'R' && b [3] == 'M');
+  CHECK (iff::be32 (b) == 0x464f524du);
+  iff::put_be16 (b, 0xfffe);
+  CHECK (b [0] == 0xff && b [1] == 0xfe);
+  CHECK (iff::be16 (b) == 0xfffe);
+}
+// ---------------------------------------------------------------
+// Positioned transfers round trip and leave the file position alone;
+// a read that runs into the end of the file fails.
+static void check_positioned ()
+{
+  const std::string path = check_temp_name ();
+  const int fd = ::open (path.c_str (), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (!CHECK (fd >= 0))
+    {
+      return;
+    }
+  std::vector <uint8_t> data (100000);
+  for (size_t i = 0; i < data.size (); i++)
+    {
+      data [i] = (uint8_t)(i * 7);
+    }
+  CHECK (iff::write_at (fd, 16, &data [0], data.size ()));
+  CHECK (::lseek (fd, 0, SEEK_CUR) == 0);
+
+  std::vector <uint8_t> back (data.size ());
+  CHECK (iff::read_at (fd, 16, &back [0], back.size ()));
+  CHECK (back == data);
+
+  uint8_t tail [8];
+  CHECK (!iff::read_at (fd, 16 + data.size () - 4, tail, sizeof (tail)));
+  CHECK (iff::read_at (fd, 16 + data.size () - 4, tail, 4));
+  CHECK (tail [3] == data.back ());
+  ::close (fd);
+}
+// ---------------------------------------------------------------
+// More than a pipe buffer goes through in short writes.
+static void check_pipe ()
+{
+  int p [2];
+  if (!CHECK (::pipe (p) == 0))
+    {
+      return;
+    }
+  std::vector <uint8_t> data (1 << 20);
+  for (size_t i = 0; i < data.size (); i++)
+    {
+      data [i] = (uint8_t)(i >> 3);
+    }
+  std::vector <uint8_t> got;
+  std::thread reader ([&] ()
+    {
+      uint8_t buf [4096];
+      ssize_t n;
+      while ((n = ::read (p [0], buf, sizeof (buf))) > 0)
+	{
+	  got.insert (got.end (), buf, buf + n);
+	}
+    });
+  CHECK (iff::write_all (p [1], &data [0], data.size ()));
+  ::close (p [1]);
+  reader.join ();
+  ::close (p [0]);
+  CHECK (got == data);
+}
+// ---------------------------------------------------------------
+void check_fd_io ()
+{
+  check_byte_order ();
+  check_positioned ();
+  check_pipe ();
+}
@@ -0,0 +1,60 @@
+#include <map>
+#include <sstream>
+
+#include "test/check.hpp"
+#include "core/ea/id.hpp"
+
+using iff::ea::id_c;
+using namespace iff::ea::literals;
+
+// everything the literal type promises is checked at compile time
+static_assert ("FORM"_id == id_c ('F', 'O', 'R', 'M'), "literal and char constructor agree");
+static_assert ("FORM"_id.value () == 0x464F524DU, "ids are big endian codes");
+static_assert (id_c (0x464F524DU) == "FORM"_id, "integral constructor");
+static_assert ("CAT "_id < "FORM"_id, "ordered by code");
+static_assert (id_c ('\xff', 0, 0, 0).value () == 0xFF000000U, "chars are not sign extended");
+
+// ---------------------------------------------------------------
+static int classify (const id_c& id)
+{
+  switch (id)
+    {
+    case "FORM"_id:
+    case "LIST"_id:
+    case "CAT "_id:
+      return 1;
+    case "BODY"_id:
+      return 2;
+    default:
+      return 0;
+    }
+}
+// ---------------------------------------------------------------
+void check_id ()
+{
+  CHECK (classify ("LIST"_id) == 1);
+  CHECK (classify (id_c ('B', 'O', 'D', 'Y')) == 2);
+  CHECK (classify ("DLTA"_id) == 0);
+  CHECK ("ILBM"_id.to_string () == "ILBM");
+  CHECK (id_c ('A', 'B', 0, 'D').to_string () == "AB");
+  std::ostringstream os;
+  os << "CMAP"_id;
+  CHECK (os.str () == "CMAP");
+
+  std::map <id_c, int> m;
+  m ["BMHD"_id] = 1;
+  m ["BODY"_id] = 2;
+  CHECK (m.find (id_c ('B', 'O', 'D', 'Y'))->second == 2);
+
+  bool threw = false;
+  try
+    {
+      const id_c bad = operator "" _id ("FOO", 3);
+      (void)bad;
+    }
+  catch (const std::length_error&)
+    {
+      threw = true;
+    }
+  CHECK (threw);
+}
@@ -0,0 +1,66 @@
+#include <fcntl.h>
+#include <unistd.h>
+#include <string.h>
+
+#include <vector>
+
+#include "test/check.hpp"
+#include "core/mapped_window.hpp"
+#include "bench/corpus.hpp"
+
+// ---------------------------------------------------------------
+// Rows read through a small window match the file wherever they are,
+// including across window edges and at the very end, and scrolling
+// maps about once per window.
+static void check_scroll (const std::string& path)
+{
+  std::vector <uint8_t> whole;
+  if (!CHECK (iff::bench::load_file (path, whole)) || !CHECK (whole.size () > 64))
+    {
+      return;
+    }
+  const int fd = ::open (path.c_str (), O_RDONLY);
+  if (!CHECK (fd >= 0))
+    {
+      return;
+    }
+  iff::mapped_window_c map (1);
+  CHECK (map.attach (fd));
+  CHECK (map.file_size () == whole.size ());
+
+  static const size_t ROW = 48;
+  bool same = true;
+  for (uint64_t pos = 0; pos < whole.size (); pos += ROW)
+    {
+      const size_t n = (size_t)std::min <uint64_t> (ROW, whole.size () - pos);
+      const uint8_t* p = map.at (pos, n);
+      same = same && p && memcmp (p, &whole [(size_t)pos], n) == 0;
+    }
+  CHECK (same);
+  CHECK (map.remaps () <= whole.size () / (map.window () / 2) + 1);
+
+  // and backwards
+  same = true;
+  for (uint64_t pos = whole.size () - 1; pos > 0; pos -= std::min <uint64_t> (pos, 997))
+    {
+      const uint8_t* p = map.at (pos, 1);
+      same = same && p && *p == whole [(size_t)pos];
+    }
+  CHECK (same);
+
+  CHECK (map.at (whole.size (), 0) != 0);
+  CHECK (map.at (whole.size () - 1, 2) == 0);
+  CHECK (map.at (0, map.window () + 1) == 0);
+  map.detach ();
+  CHECK (map.at (0, 1) == 0);
+  ::close (fd);
+}
+// ---------------------------------------------------------------
+void check_mapped ()
+{
+  check_scroll (check_sample ("Half-OS.anim"));
+  check_scroll (check_sample ("ZOOM.LBM"));
+
+  iff::mapped_window_c map;
+  CHECK (!map.attach (-1));
+}
@@ -0,0 +1,236 @@
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <vector>
+
+#include "test/check.hpp"
+#include "core/generic_iff_reader.hpp"
+#include "core/ea/ea_io.hpp"
+
+#if !defined(IFF_NESTING_GOLDEN)
+#define IFF_NESTING_GOLDEN "nesting_golden.txt"
+#endif
+
+namespace
+{
+  struct event_t
+  {
+    bool            enter;
+    bool            group;
+    iff_id_t        id;
+    iff_id_t        tag;
+    std::streamsize size;
+    std::streamsize pos;
+  };
+  // -------------------------------------------------------------
+  class recording_reader_c : public generic_iff_reader_c <iff::ea::io_c>
+  {
+  public:
+    std::vector <event_t> events;
+  private:
+    void _add (bool enter, bool group, const id_t& id, const id_t& tag,
+	       std::streamsize size, std::streamsize pos)
+    {
+      event_t e;
+      e.enter = enter;
+      e.group = group;
+      e.id    = id.value ();
+      e.tag   = tag.value ();
+      e.size  = size;
+      e.pos   = pos;
+      events.push_back (e);
+    }
+    virtual void _on_chunk_enter (const id_t& id, std::streamsize size, std::streamsize pos)
+    {
+      _add (true, false, id, id, size, pos);
+    }
+    virtual void _on_chunk_exit  (const id_t& id, std::streamsize size, std::streamsize pos)
+    {
+      _add (false, false, id, id, size, pos);
+    }
+    virtual void _on_group_enter (const id_t& id, const id_t& tag, std::streamsize size, std::streamsize pos)
+    {
+      _add (true, true, id, tag, size, pos);
+    }
+    virtual void _on_group_exit  (const id_t& id, const id_t& tag, std::streamsize size, std::streamsize pos)
+    {
+      _add (false, true, id, tag, size, pos);
+    }
+  };
+}
+// ---------------------------------------------------------------
+// Every exit must match the innermost open enter, end where the
+// enter said it would and lie inside its parent.
+static bool well_nested (const std::vector <event_t>& events, unsigned& max_depth)
+{
+  std::vector <event_t> open;
+  max_depth = 0;
+  for (size_t i = 0; i < events.size (); i++)
+    {
+      const event_t& e = events [i];
+      if (e.enter)
+	{
+	  if (!open.empty () && !open.back ().group)
+	    {
+	      return false;
+	    }
+	  open.push_back (e);
+	  unsigned groups = 0;
+	  for (size_t k = 0; k < open.size (); k++)
+	    {
+	      groups += open [k].group ? 1 : 0;
+	    }
+	  if (groups > max_depth)
+	    {
+	      max_depth = groups;
+	    }
+	  continue;
+	}
+      if (open.empty ())
+	{
+	  return false;
+	}
+      const event_t b = open.back ();
+      open.pop_back ();
+      const std::streamsize padded = b.size + (b.size & 1);
+      if (b.group != e.group || b.size != e.size || e.pos != b.pos + padded)
+	{
+	  return false;
+	}
+      if (!open.empty ())
+	{
+	  const event_t& parent = open.back ();
+	  if (b.pos < parent.pos || e.pos > parent.pos + parent.size + (parent.size & 1))
+	    {
+	      return false;
+	    }
+	}
+    }
+  return open.empty ();
+}
+// ---------------------------------------------------------------
+// fnv1a64 over one "kind id tag size pos" line per event, kind c/C
+// for a chunk enter/exit and g/G for a group
+static uint64_t event_hash (const std::vector <event_t>& events)
+{
+  uint64_t h = 0xCBF29CE484222325ULL;
+  for (size_t i = 0; i < events.size (); i++)
+    {
+      const event_t& e = events [i];
+      char line [96];
+      const char kind = e.group ? (e.enter ? 'g' : 'G') : (e.enter ? 'c' : 'C');
+      snprintf (line, sizeof (line), "%c %08x %08x %lld %lld\n", kind, (unsigned)e.id,
+		(unsigned)e.tag, (long long)e.size, (long long)e.pos);
+      for (const char* p = line; *p; p++)
+	{
+	  h ^= (uint8_t)*p;
+	  h *= 0x100000001B3ULL;
+	}
+    }
+  return h;
+}
+// ---------------------------------------------------------------
+// The enter/exit sequence of every sample against the golden one,
+// so a change of traversal order shows up.
+static void check_golden ()
+{
+  std::map <std::string, std::pair <uint64_t, uint64_t> > golden;
+  std::ifstream ifs (IFF_NESTING_GOLDEN);
+  std::string line;
+  while (std::getline (ifs, line))
+    {
+      char sample [256];
+      unsigned long long events;
+      unsigned long long hash;
+      if (!line.empty () && line [0] != '#' &&
+	  sscanf (line.c_str (), "%255s %llu %llx", sample, &events, &hash) == 3)
+	{
+	  golden [sample] = std::make_pair ((uint64_t)events, (uint64_t)hash);
+	}
+    }
+  if (!CHECK (!golden.empty ()))
+    {
+      return;
+    }
+  for (std::map <std::string, std::pair <uint64_t, uint64_t> >::const_iterator i = golden.begin ();
+       i != golden.end (); ++i)
+    {
+      recording_reader_c r;
+      CHECK (r.open (check_sample (i->first.c_str ()).c_str ()) == recording_reader_c::eOK);
+      CHECK (r.read () == recording_reader_c::eOK);
+      const uint64_t hash = event_hash (r.events);
+      if (!CHECK (r.events.size () == i->second.first && hash == i->second.second))
+	{
+	  char got [64];
+	  snprintf (got, sizeof (got), "%llu %016llx",
+		    (unsigned long long)r.events.size (), (unsigned long long)hash);
+	  std::cerr << "  " << i->first << ": " << got << std::endl;
+	}
+    }
+}
+// ---------------------------------------------------------------
+void check_nesting ()
+{
+  check_golden ();
+
+  iff::synth::params_t p;
+  iff::synth::default_params (iff::synth::eDEEP, p);
+  p.depth = 3000;
+  const std::string deep = check_temp_file (p);
+
+  {
+    // deeper than the default limit: a clean failure, no recursion
+    recording_reader_c r;
+    CHECK (r.open (deep.c_str ()) == recording_reader_c::eOK);
+    CHECK (r.read () == recording_reader_c::eTOO_DEEP);
+    // every accepted level reported its FORM and its LEVL chunk
+    CHECK (r.events.size () == 3 * recording_reader_c::DEFAULT_MAX_DEPTH);
+  }
+  {
+    recording_reader_c r;
+    r.set_max_depth (p.depth);
+    CHECK (r.open (deep.c_str ()) == recording_reader_c::eOK);
+    CHECK (r.read () == recording_reader_c::eOK);
+    // FORM, LEVL enter, LEVL exit per level, DATA and the group exits
+    CHECK (r.events.size () == 4 * p.depth + 2);
+    unsigned depth = 0;
+    CHECK (well_nested (r.events, depth));
+    CHECK (depth == p.depth);
+#if defined(IFF_HAS_STATS)
+    CHECK (r.stats ().max_depth == p.depth);
+#endif
+  }
+
+  p.depth = 100000;
+  {
+    recording_reader_c r;
+    r.set_max_depth (p.depth);
+    CHECK (r.open (check_temp_file (p).c_str ()) == recording_reader_c::eOK);
+    CHECK (r.read () == recording_reader_c::eOK);
+    CHECK (r.events.size () == 4 * p.depth + 2);
+  }
+
+  iff::synth::default_params (iff::synth::eCAT, p);
+  p.count = 5000;
+  {
+    recording_reader_c r;
+    CHECK (r.open (check_temp_file (p).c_str ()) == recording_reader_c::eOK);
+    CHECK (r.read () == recording_reader_c::eOK);
+    // CAT plus 5000 FORMs holding one chunk each, none dropped
+    CHECK (r.events.size () == 2 + 4 * p.count);
+    unsigned depth = 0;
+    CHECK (well_nested (r.events, depth));
+    CHECK (depth == 2);
+  }
+
+  static const char* samples [] = {"test2.rbs", "BoingTrek.anim", "Xam-Yot.anim", "OGRYN.IFF"};
+  for (size_t i = 0; i < sizeof (samples) / sizeof (samples [0]); i++)
+    {
+      recording_reader_c r;
+      CHECK (r.open (check_sample (samples [i]).c_str ()) == recording_reader_c::eOK);
+      CHECK (r.read () == recording_reader_c::eOK);
+      unsigned depth = 0;
+      CHECK (well_nested (r.events, depth));
+    }
+}
@@ -0,0 +1,134 @@
+#include <sstream>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+#include "test/check.hpp"
+#include "core/dispatch_reader.hpp"
+#include "core/ea/ea_io.hpp"
+#include "core/ea/writer.hpp"
+#include "core/ea/patch.hpp"
+
+using namespace iff::ea::literals;
+using iff::ea::patcher_c;
+
+namespace
+{
+  class position_c : public iff::chunk_handler_c
+  {
+  public:
+    position_c ()
+      : pos (-1)
+    {
+    }
+    virtual void on_chunk (const iff::chunk_event_t& ev)
+    {
+      pos = ev.file_pos;
+    }
+    std::streamsize pos;
+  };
+}
+// ---------------------------------------------------------------
+// ANIM { ILBM { BMHD ANNO BODY } ILBM { AUTH DLTA } }, the BODY is
+// large enough that moving it takes several blocks
+static std::string build (const std::string& anno, const std::string& auth,
+			  const std::string& dlta = std::string (51, 2))
+{
+  std::string body (3 * 1024 * 1024 + 17, 0);
+  for (size_t i = 0; i < body.size (); i++)
+    {
+      body [i] = (char)(i * 13 + (i >> 11));
+    }
+  const std::string bmhd (20, 1);
+
+  std::stringstream ss;
+  iff::ea::writer_c w (ss);
+  w.begin_group ("FORM"_id, "ANIM"_id);
+  w.begin_group ("FORM"_id, "ILBM"_id);
+  w.chunk ("BMHD"_id, bmhd.data (), bmhd.size ());
+  w.chunk ("ANNO"_id, anno.data (), anno.size ());
+  w.chunk ("BODY"_id, body.data (), body.size ());
+  w.end ();
+  w.begin_group ("FORM"_id, "ILBM"_id);
+  w.chunk ("AUTH"_id, auth.data (), auth.size ());
+  w.chunk ("DLTA"_id, dlta.data (), dlta.size ());
+  w.end ();
+  w.end ();
+  return w.good () ? ss.str () : std::string ();
+}
+// ---------------------------------------------------------------
+static std::streamsize find (const std::string& path, iff_id_t id)
+{
+  position_c at;
+  iff::handler_registry_c handlers;
+  handlers.bind (id, &at);
+  handlers.compile ();
+  iff::dispatch_reader_c <iff::ea::io_c> r (handlers);
+  if (r.open (path.c_str ()) != r.eOK || r.read () != r.eOK)
+    {
+      return -1;
+    }
+  return at.pos;
+}
+// ---------------------------------------------------------------
+static std::string contents (const std::string& path)
+{
+  std::ifstream ifs (path.c_str (), std::ios::in | std::ios::binary);
+  return std::string (std::istreambuf_iterator <char> (ifs), std::istreambuf_iterator <char> ());
+}
+// ---------------------------------------------------------------
+// patching a chunk gives the file the writer produces with the new
+// payload, whatever the change of size or padding
+static void check_replace (const std::string& path, iff_id_t id,
+			   const std::string& anno, const std::string& auth,
+			   const std::string& payload, bool moves)
+{
+  {
+    std::ofstream ofs (path.c_str (), std::ios::out | std::ios::binary | std::ios::trunc);
+    ofs << build (anno, auth);
+  }
+  const std::streamsize pos = find (path, id);
+  if (!CHECK (pos > 0))
+    {
+      return;
+    }
+  patcher_c p;
+  CHECK (p.open (path.c_str ()) == patcher_c::eOK);
+  CHECK (p.replace ((uint64_t)pos, payload.data (), payload.size ()) == patcher_c::eOK);
+  CHECK ((p.bytes_moved () > 0) == moves);
+  p.close ();
+
+  const std::string expected =
+    id == "ANNO"_id ? build (payload, auth) :
+    id == "AUTH"_id ? build (anno, payload) : build (anno, auth, payload);
+  CHECK (p.file_size () == expected.size ());
+  CHECK (contents (path) == expected);
+}
+// ---------------------------------------------------------------
+void check_patch ()
+{
+  const std::string path = check_temp_name ();
+  if (!CHECK (!path.empty ()))
+    {
+      return;
+    }
+  // same size, odd to even and back within the same padded size,
+  // then changes of the padded size
+  check_replace (path, "ANNO"_id, "hello", "me", "HELLO", false);
+  check_replace (path, "ANNO"_id, "hello", "me", "hello!", false);
+  check_replace (path, "ANNO"_id, "hell", "me", "hel", false);
+  check_replace (path, "ANNO"_id, "hell", "me", "hello", true);
+  check_replace (path, "ANNO"_id, "hell", "me", std::string (5000, 'x'), true);
+  check_replace (path, "ANNO"_id, std::string (5001, 'x'), "me", "", true);
+  check_replace (path, "AUTH"_id, "a", "me", "someone else", true);
+  check_replace (path, "DLTA"_id, "a", "me", "", false);
+
+  patcher_c p;
+  CHECK (p.open (path.c_str ()) == patcher_c::eOK);
+  CHECK (p.replace (13, "x", 1) == patcher_c::eNOT_FOUND);
+  CHECK (p.replace (p.file_size () + 8, "x", 1) == patcher_c::eNOT_FOUND);
+  CHECK (p.replace ((uint64_t)find (path, "BMHD"_id), 0, 0x100000000ULL) == patcher_c::eTOO_LARGE);
+
+  patcher_c none;
+  CHECK (none.open ("/nonexistent/file") == patcher_c::eIO_ERROR);
+}
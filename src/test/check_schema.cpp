@@ -0,0 +1,220 @@
+#include <string.h>
+#include <vector>
+
+#include "test/check.hpp"
+#include "core/ea/id.hpp"
+#include "core/codec/records.hpp"
+#include "core/fd_io.hpp"
+#include "bench/corpus.hpp"
+
+using namespace iff::ea::literals;
+using namespace iff::codec;
+using iff::bench::chunk_t;
+
+namespace
+{
+  // a big endian record of equal width fields, decoded by the bulk
+  // byte swap
+  struct rgb16_t
+  {
+    uint16_t r;
+    uint16_t g;
+    uint16_t b;
+  };
+  typedef schema_c <rgb16_t, eBIG_ENDIAN,
+		    IFF_FIELD (rgb16_t, r),
+		    IFF_FIELD (rgb16_t, g),
+		    IFF_FIELD (rgb16_t, b)> rgb16_schema_t;
+
+  static_assert (rgb16_schema_t::WIRE_SIZE == 6 && rgb16_schema_t::LANE == 2, "uniform layout");
+  static_assert (bmhd_schema_t::LANE == 0 && comm_schema_t::LANE == 0, "mixed layouts");
+  static_assert (cmap_schema_t::LANE == 1, "bytes only");
+  static_assert (rgb16_schema_t::count (13) == 2, "whole records only");
+}
+// ---------------------------------------------------------------
+static const chunk_t* find (const std::vector <chunk_t>& chunks, iff_id_t id)
+{
+  for (size_t i = 0; i < chunks.size (); i++)
+    {
+      if (chunks [i].id == id)
+	{
+	  return &chunks [i];
+	}
+    }
+  return 0;
+}
+// ---------------------------------------------------------------
+static bool load (const char* name, std::vector <uint8_t>& data, std::vector <chunk_t>& chunks)
+{
+  if (!iff::bench::load_file (check_sample (name), data) || data.empty ())
+    {
+      return false;
+    }
+  return iff::bench::list_chunks (&data [0], data.size (), chunks);
+}
+// ---------------------------------------------------------------
+static void check_ilbm ()
+{
+  std::vector <uint8_t> data;
+  std::vector <chunk_t> chunks;
+  if (!CHECK (load ("TP_SEX.LBM", data, chunks)))
+    {
+      return;
+    }
+  const chunk_t* c = find (chunks, "BMHD"_id);
+  bmhd_t h;
+  if (!CHECK (c && bmhd_schema_t::decode (&data [c->offset], c->size, h)))
+    {
+      return;
+    }
+  const uint8_t* p = &data [c->offset];
+  CHECK (h.width == iff::be16 (p) && h.height == iff::be16 (p + 2));
+  CHECK (h.nplanes == p [8] && h.compression == p [10]);
+  CHECK (h.transparent == iff::be16 (p + 12) && h.x_aspect == p [14]);
+  CHECK (h.page_height == (int16_t)iff::be16 (p + 18));
+  CHECK (!bmhd_schema_t::decode (p, BMHD_SIZE - 1, h));
+
+  c = find (chunks, "CMAP"_id);
+  if (CHECK (c != 0))
+    {
+      std::vector <cmap_entry_t> cmap (256);
+      const size_t n = cmap_schema_t::decode_array (&data [c->offset], c->size, &cmap [0], cmap.size ());
+      CHECK (n == c->size / 3 || n == 256);
+      CHECK (cmap [n - 1].b == data [c->offset + 3 * n - 1]);
+    }
+}
+// ---------------------------------------------------------------
+static void check_comm ()
+{
+  std::vector <uint8_t> data;
+  std::vector <chunk_t> chunks;
+  if (!CHECK (load ("test.aif", data, chunks)))
+    {
+      return;
+    }
+  const chunk_t* c = find (chunks, "COMM"_id);
+  comm_t h;
+  if (CHECK (c && comm_schema_t::decode (&data [c->offset], c->size, h)))
+    {
+      CHECK (h.channels == 2);
+      CHECK (h.frames == 0x5BC5);
+      CHECK (h.sample_bits == 64);
+      CHECK (h.sample_rate == 8000.0);
+    }
+  static const uint8_t cd [10] = {0x40, 0x0E, 0xAC, 0x44, 0, 0, 0, 0, 0, 0};
+  CHECK (ieee_extended_c::extended_to_double (cd) == 44100.0);
+}
+// ---------------------------------------------------------------
+// 3DS chunks: 16 bit id and 32 bit size (header included), little
+// endian. The vertex lists sit in 4D4D/3D3D/4000 (after a name)/4100.
+static void collect_points (const std::vector <uint8_t>& d, size_t off, size_t end,
+			    std::vector <std::pair <size_t, size_t> >& lists)
+{
+  while (off + 6 <= end)
+    {
+      const unsigned id = d [off] | (d [off + 1] << 8);
+      const size_t   n  = d [off + 2] | (d [off + 3] << 8) | (d [off + 4] << 16) | ((size_t)d [off + 5] << 24);
+      if (n < 6 || n > end - off)
+	{
+	  return;
+	}
+      if (id == 0x4D4D || id == 0x3D3D || id == 0x4100)
+	{
+	  collect_points (d, off + 6, off + n, lists);
+	}
+      else if (id == 0x4000)
+	{
+	  size_t name = off + 6;
+	  while (name < off + n && d [name])
+	    {
+	      name++;
+	    }
+	  collect_points (d, name + 1, off + n, lists);
+	}
+      else if (id == 0x4110 && n >= 8)
+	{
+	  lists.push_back (std::make_pair (off + 8, (size_t)(d [off + 6] | (d [off + 7] << 8))));
+	}
+      off += n;
+    }
+}
+// ---------------------------------------------------------------
+static void check_vertices ()
+{
+  std::vector <uint8_t> data;
+  if (!CHECK (iff::bench::load_file (check_sample ("05military-abrams-tank.3DS"), data)))
+    {
+      return;
+    }
+  std::vector <std::pair <size_t, size_t> > lists;
+  collect_points (data, 0, data.size (), lists);
+  CHECK (lists.size () > 100);
+
+  bool same = true;
+  size_t total = 0;
+  std::vector <vertex3_t> v;
+  for (size_t i = 0; i < lists.size (); i++)
+    {
+      const size_t off   = lists [i].first;
+      const size_t count = lists [i].second;
+      v.resize (count + 1);
+      const size_t n = vertex3_schema_t::decode_array (&data [off], data.size () - off, &v [0], count);
+      same = same && n == count;
+      for (size_t k = 0; k < n && same; k++)
+	{
+	  float f [3];
+	  for (int j = 0; j < 3; j++)
+	    {
+	      const uint8_t* p = &data [off + 12 * k + 4 * j];
+	      const uint32_t u = p [0] | (p [1] << 8) | (p [2] << 16) | ((uint32_t)p [3] << 24);
+	      memcpy (&f [j], &u, 4);
+	    }
+	  same = v [k].x == f [0] && v [k].y == f [1] && v [k].z == f [2];
+	}
+      total += n;
+    }
+  CHECK (same);
+  CHECK (total > 10000);
+}
+// ---------------------------------------------------------------
+// the bulk swap gives the same records as field by field decoding
+// with every kernel, across block boundaries
+static void check_bulk ()
+{
+  std::vector <uint8_t> wire (6 * 3001);
+  for (size_t i = 0; i < wire.size (); i++)
+    {
+      wire [i] = (uint8_t)(i * 7 + (i >> 5));
+    }
+  std::vector <rgb16_t> ref (3001);
+  bool ok = true;
+  for (size_t i = 0; i < ref.size (); i++)
+    {
+      ok = ok && rgb16_schema_t::decode (&wire [6 * i], 6, ref [i]);
+    }
+  CHECK (ok);
+  CHECK (ref [1].g == iff::be16 (&wire [8]));
+  for (int isa = eSCALAR; isa < ISA_COUNT; isa++)
+    {
+      if (!isa_supported ((isa_t)isa))
+	{
+	  continue;
+	}
+      std::vector <rgb16_t> out (3001);
+      CHECK (rgb16_schema_t::decode_array (&wire [0], wire.size () - 1, &out [0], out.size (), (isa_t)isa) == 3000);
+      bool same = true;
+      for (size_t i = 0; i < 3000; i++)
+	{
+	  same = same && out [i].r == ref [i].r && out [i].g == ref [i].g && out [i].b == ref [i].b;
+	}
+      CHECK (same);
+    }
+}
+// ---------------------------------------------------------------
+void check_schema ()
+{
+  check_ilbm ();
+  check_comm ();
+  check_vertices ();
+  check_bulk ();
+}
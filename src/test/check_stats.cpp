@@ -0,0 +1,105 @@
+#include "test/check.hpp"
+#include "core/generic_iff_reader.hpp"
+#include "core/ea/ea_io.hpp"
+
+#if defined(IFF_HAS_STATS)
+// Upper bound of tellg/seekg calls per decoded header. Raising it
+// means the reader started to hit the stream harder.
+static const uint64_t REPOSITIONS_PER_HEADER = 1;
+// open () positions the stream to learn the file size
+static const uint64_t REPOSITIONS_IN_OPEN    = 3;
+
+namespace
+{
+  class counting_reader_c : public generic_iff_reader_c <iff::ea::io_c>
+  {
+  public:
+    counting_reader_c ()
+      : groups (0),
+	chunks (0)
+    {
+    }
+    unsigned groups;
+    unsigned chunks;
+  private:
+    virtual void _on_chunk_enter (const id_t&, std::streamsize, std::streamsize)
+    {
+      chunks++;
+    }
+    virtual void _on_chunk_exit  (const id_t&, std::streamsize, std::streamsize)
+    {
+    }
+    virtual void _on_group_enter (const id_t&, const id_t&, std::streamsize, std::streamsize)
+    {
+      groups++;
+    }
+    virtual void _on_group_exit  (const id_t&, const id_t&, std::streamsize, std::streamsize)
+    {
+    }
+  };
+}
+// ---------------------------------------------------------------
+static bool parse (const std::string& path, counting_reader_c& r)
+{
+  return CHECK (!path.empty ())
+    && CHECK (r.open (path.c_str ()) == counting_reader_c::eOK)
+    && CHECK (r.read () == counting_reader_c::eOK);
+}
+// ---------------------------------------------------------------
+static void check_io_budget (const iff::reader_stats_t& st)
+{
+  CHECK (st.tellg_calls + st.seekg_calls
+	 <= REPOSITIONS_PER_HEADER * st.headers + REPOSITIONS_IN_OPEN);
+}
+#endif
+// ---------------------------------------------------------------
+void check_stats ()
+{
+#if defined(IFF_HAS_STATS)
+  iff::synth::params_t p;
+
+  iff::synth::default_params (iff::synth::eTINY, p);
+  p.count = 1000;
+  {
+    counting_reader_c r;
+    if (parse (check_temp_file (p), r))
+      {
+	const iff::reader_stats_t& st = r.stats ();
+	CHECK (r.groups == 1 && r.chunks == 1000);
+	CHECK (st.headers == 1001);
+	CHECK (st.events == 2 * st.headers);
+	CHECK (st.max_depth == 1);
+	CHECK (st.bytes_read == 8 * st.headers + 4);
+	check_io_budget (st);
+      }
+  }
+
+  iff::synth::default_params (iff::synth::eDEEP, p);
+  p.depth = 50;
+  {
+    counting_reader_c r;
+    if (parse (check_temp_file (p), r))
+      {
+	const iff::reader_stats_t& st = r.stats ();
+	CHECK (r.groups == 50 && r.chunks == 51);
+	CHECK (st.headers == 101);
+	CHECK (st.max_depth == 50);
+	CHECK (st.bytes_read == 8 * st.headers + 4 * 50);
+	check_io_budget (st);
+      }
+  }
+
+  static const char* samples [] = {"test2.rbs", "ZOOM.LBM", "Half-OS.anim", "test.aif"};
+  for (size_t i = 0; i < sizeof (samples) / sizeof (samples [0]); i++)
+    {
+      counting_reader_c r;
+      if (parse (check_sample (samples [i]), r))
+	{
+	  const iff::reader_stats_t& st = r.stats ();
+	  CHECK (st.headers == r.groups + r.chunks);
+	  CHECK (st.events == 2 * st.headers);
+	  check_io_budget (st);
+	}
+    }
+#endif
+}
@@ -0,0 +1,256 @@
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <thread>
+#include <vector>
+
+#include "test/check.hpp"
+#include "core/structure_cache.hpp"
+#include "core/ea/ea_io.hpp"
+#include "bench/corpus.hpp"
+
+typedef iff::structure_builder_c <iff::ea::io_c> structure_builder_t;
+typedef iff::structure_cache_c::structure_ptr_t  structure_ptr_t;
+
+namespace
+{
+  std::atomic <unsigned> loads (0);
+
+  // slow enough for the threads of check_single_flight to pile up
+  iff::structure_c* slow_load (const char* path)
+  {
+    loads++;
+    std::this_thread::sleep_for (std::chrono::milliseconds (20));
+    structure_builder_t builder;
+    return builder.build (path);
+  }
+}
+// ---------------------------------------------------------------
+static bool copy_file (const std::string& from, const std::string& to)
+{
+  std::vector <uint8_t> data;
+  if (!iff::bench::load_file (from, data))
+    {
+      return false;
+    }
+  std::ofstream os (to.c_str (), std::ios::out | std::ios::binary | std::ios::trunc);
+  os.write ((const char*)&data [0], data.size ());
+  return os.good ();
+}
+// ---------------------------------------------------------------
+// many threads missing on one file at once parse it once
+static void check_single_flight (const std::string& path)
+{
+  loads = 0;
+  iff::structure_cache_c cache (&slow_load);
+  static const unsigned THREADS = 16;
+  std::vector <structure_ptr_t> got (THREADS);
+  std::vector <std::thread>     pool;
+  std::atomic <unsigned>        ready (0);
+  for (unsigned t = 0; t < THREADS; t++)
+    {
+      pool.push_back (std::thread ([&, t] ()
+				   {
+				     ready++;
+				     while (ready < THREADS)
+				       {
+				       }
+				     got [t] = cache.get (path.c_str ());
+				   }));
+    }
+  for (unsigned t = 0; t < THREADS; t++)
+    {
+      pool [t].join ();
+    }
+  bool same = got [0] != 0;
+  for (unsigned t = 1; t < THREADS; t++)
+    {
+      same = same && got [t] == got [0];
+    }
+  CHECK (same);
+  CHECK (loads == 1 && cache.loads () == 1);
+  CHECK (cache.misses () == 1 && cache.hits () == THREADS - 1);
+  CHECK (cache.count () == 1 && cache.bytes () == iff::structure_cache_c::footprint (*got [0]));
+  CHECK (cache.bytes () >= got [0]->reserved ());
+
+  // a hit afterwards, no load
+  CHECK (cache.get (path.c_str ()) == got [0] && loads == 1);
+}
+// ---------------------------------------------------------------
+// A file that changes is parsed again, one that cannot be parsed is
+// not cached, and a structure handed out outlives its eviction.
+static void check_identity ()
+{
+  const std::string a = check_temp_name ();
+  const std::string b = check_temp_name ();
+  CHECK (copy_file (check_sample ("ZOOM.LBM"), a));
+  CHECK (copy_file (check_sample ("Half-OS.anim"), b));
+
+  loads = 0;
+  iff::structure_cache_c cache (&slow_load, iff::structure_cache_c::DEFAULT_BUDGET, 4);
+  const structure_ptr_t first = cache.get (a.c_str ());
+  CHECK (first && cache.get (a.c_str ()) == first && loads == 1);
+
+  // same size, another mtime
+  struct timeval times [2];
+  times [0].tv_sec  = times [1].tv_sec  = 1000000000;
+  times [0].tv_usec = times [1].tv_usec = 0;
+  CHECK (utimes (a.c_str (), times) == 0);
+  const structure_ptr_t again = cache.get (a.c_str ());
+  CHECK (again && again != first && loads == 2);
+
+  // another file under the same name
+  CHECK (copy_file (b, a));
+  const structure_ptr_t other = cache.get (a.c_str ());
+  CHECK (other && other->file_size () != first->file_size () && loads == 3);
+
+  const std::string junk = check_temp_name ();
+  {
+    std::ofstream os (junk.c_str (), std::ios::out | std::ios::binary | std::ios::trunc);
+    os << "not an IFF file at all";
+  }
+  CHECK (!cache.get (junk.c_str ()) && !cache.get (junk.c_str ()) && loads == 5);
+  CHECK (!cache.get ((junk + ".missing").c_str ()) && loads == 5);
+  CHECK (cache.count () == 3);
+
+  // a budget of one structure keeps the most recent one only
+  cache.set_budget (iff::structure_cache_c::footprint (*other));
+  CHECK (cache.count () <= 2 && cache.bytes () <= cache.budget ());
+  cache.set_budget (1);
+  CHECK (cache.count () == 0 && cache.bytes () == 0 && cache.evictions () == 3);
+  CHECK (first->file_size () > 0);
+  CHECK (cache.get (b.c_str ()) && cache.count () == 1);
+  const structure_ptr_t kept = cache.get (a.c_str ());
+  CHECK (kept && cache.count () == 1);
+
+  cache.clear ();
+  CHECK (cache.count () == 0 && cache.bytes () == 0);
+}
+// ---------------------------------------------------------------
+// touches the file before parsing it, as a writer racing the cache
+static iff::structure_c* touching_load (const char* path)
+{
+  struct timeval times [2];
+  times [0].tv_sec  = times [1].tv_sec  = 1000000000 + (long)++loads;
+  times [0].tv_usec = times [1].tv_usec = 0;
+  utimes (path, times);
+  structure_builder_t builder;
+  return builder.build (path);
+}
+// ---------------------------------------------------------------
+// A file changed between the stat and the parse is not cached under
+// the old identity, and eviction takes the least recently used
+// structure of all shards.
+static void check_recency ()
+{
+  const std::string racy = check_temp_name ();
+  CHECK (copy_file (check_sample ("ZOOM.LBM"), racy));
+  loads = 0;
+  iff::structure_cache_c touching (&touching_load);
+  CHECK (!touching.get (racy.c_str ()) && touching.count () == 0 && loads == 1);
+
+  std::vector <std::string> files;
+  for (unsigned i = 0; i < 4; i++)
+    {
+      files.push_back (check_temp_name ());
+      CHECK (copy_file (check_sample ("ZOOM.LBM"), files.back ()));
+    }
+  loads = 0;
+  iff::structure_cache_c cache (&slow_load, iff::structure_cache_c::DEFAULT_BUDGET, 4);
+  const structure_ptr_t s = cache.get (files [0].c_str ());
+  if (!CHECK (s != 0))
+    {
+      return;
+    }
+  // room for three, least recent first: 1 2 0
+  cache.set_budget (3 * iff::structure_cache_c::footprint (*s));
+  CHECK (cache.get (files [1].c_str ()) && cache.get (files [2].c_str ()));
+  CHECK (cache.get (files [0].c_str ()) == s && loads == 3);
+
+  // each get () names the file and whether it must load; the three
+  // held are listed after it
+  static const struct
+  {
+    unsigned file;
+    bool     load;
+  } steps [] = {
+    {3, true},		// 2 0 3
+    {1, true},		// 0 3 1
+    {0, false},		// 3 1 0
+    {3, false},		// 1 0 3
+    {2, true},		// 0 3 2
+    {0, false}		// 3 2 0
+  };
+  bool lru = true;
+  for (size_t i = 0; i < sizeof (steps) / sizeof (steps [0]); i++)
+    {
+      const unsigned n = loads;
+      lru = lru && cache.get (files [steps [i].file].c_str ()) &&
+	loads == n + (steps [i].load ? 1 : 0) && cache.count () == 3;
+    }
+  CHECK (lru);
+}
+// ---------------------------------------------------------------
+// threads asking for a few files over and over, under a budget that
+// holds only some of them
+static void check_contention ()
+{
+  std::vector <std::string> paths;
+  paths.push_back (check_sample ("ZOOM.LBM"));
+  paths.push_back (check_sample ("Half-OS.anim"));
+  paths.push_back (check_sample ("Berserk.anim"));
+
+  loads = 0;
+  iff::structure_cache_c sizing (&slow_load);
+  size_t largest = 0;
+  for (size_t i = 0; i < paths.size (); i++)
+    {
+      const structure_ptr_t s = sizing.get (paths [i].c_str ());
+      largest = s ? std::max (largest, iff::structure_cache_c::footprint (*s)) : largest;
+    }
+  iff::structure_cache_c cache ([] (const char* path) -> iff::structure_c*
+				{
+				  structure_builder_t builder;
+				  return builder.build (path);
+				}, 2 * largest, 2);
+  std::atomic <unsigned> bad (0);
+  std::vector <std::thread> pool;
+  for (unsigned t = 0; t < 8; t++)
+    {
+      pool.push_back (std::thread ([&, t] ()
+				   {
+				     for (unsigned i = 0; i < 200; i++)
+				       {
+					 const std::string& p = paths [(t + i) % paths.size ()];
+					 const structure_ptr_t s = cache.get (p.c_str ());
+					 if (!s || s->file_name () != p)
+					   {
+					     bad++;
+					   }
+				       }
+				   }));
+    }
+  for (size_t t = 0; t < pool.size (); t++)
+    {
+      pool [t].join ();
+    }
+  CHECK (bad == 0);
+  CHECK (cache.hits () + cache.misses () == 8 * 200);
+  CHECK (cache.bytes () <= cache.budget ());
+}
+// ---------------------------------------------------------------
+void check_structure_cache ()
+{
+  check_single_flight (check_sample ("Half-OS.anim"));
+  check_identity ();
+  check_recency ();
+  check_contention ();
+
+  iff::structure_cache_c& shared = iff::shared_structure_cache <iff::ea::io_c> ();
+  CHECK (&shared == &iff::shared_structure_cache <iff::ea::io_c> ());
+  const structure_ptr_t s = shared.get (check_sample ("ZOOM.LBM").c_str ());
+  CHECK (s && shared.get (check_sample ("ZOOM.LBM").c_str ()) == s);
+}
@@ -0,0 +1,114 @@
+#include <stdlib.h>
+#include <sstream>
+#include <thread>
+#include <string>
+#include <set>
+
+#include "test/check.hpp"
+#include "core/trace.hpp"
+#include "core/dispatch_reader.hpp"
+#include "core/ea/ea_io.hpp"
+
+typedef iff::dispatch_reader_c <iff::ea::io_c> dispatch_reader_t;
+
+static const unsigned SPANS = 10000;
+
+static void record_spans ()
+{
+  for (unsigned i = 0; i < SPANS; i++)
+    {
+      iff::trace::scope_c s ("check", "span");
+    }
+}
+// ---------------------------------------------------------------
+static size_t count (const std::string& s, const char* what)
+{
+  size_t n = 0;
+  for (size_t pos = s.find (what); pos != std::string::npos; pos = s.find (what, pos + 1))
+    {
+      n++;
+    }
+  return n;
+}
+// ---------------------------------------------------------------
+static std::set <unsigned> tids (const std::string& s)
+{
+  std::set <unsigned> found;
+  static const char TID [] = "\"tid\":";
+  for (size_t pos = s.find (TID); pos != std::string::npos; pos = s.find (TID, pos + 1))
+    {
+      found.insert ((unsigned)strtoul (s.c_str () + pos + sizeof (TID) - 1, 0, 10));
+    }
+  return found;
+}
+// ---------------------------------------------------------------
+// a read of an ILBM records the read, its FORM and its chunks
+static void check_reader ()
+{
+  iff::trace::clear ();
+  iff::handler_registry_c handlers;
+  handlers.compile ();
+  dispatch_reader_t r (handlers);
+  iff::trace::enable (true);
+  CHECK (r.open (check_sample ("ZOOM.LBM").c_str ()) == dispatch_reader_t::eOK);
+  CHECK (r.read () == dispatch_reader_t::eOK);
+  iff::trace::enable (false);
+
+  std::ostringstream os;
+  CHECK (iff::trace::dump (os));
+  const std::string json = os.str ();
+  CHECK (count (json, "\"cat\":\"reader\"") == 2);
+  CHECK (count (json, "\"name\":\"ILBM\",\"cat\":\"group\"") == 2);
+  CHECK (count (json, "\"name\":\"BMHD\",\"cat\":\"chunk\"") == 2);
+  CHECK (count (json, "\"name\":\"BODY\",\"cat\":\"chunk\"") == 2);
+  CHECK (count (json, "\"ph\":\"B\"") == count (json, "\"ph\":\"E\""));
+  iff::trace::clear ();
+}
+// ---------------------------------------------------------------
+void check_trace ()
+{
+  iff::trace::clear ();
+
+  // disabled: nothing is recorded
+  record_spans ();
+  {
+    std::ostringstream os;
+    CHECK (iff::trace::dump (os));
+    CHECK (count (os.str (), "\"ph\"") == 0);
+  }
+
+  iff::trace::enable (true);
+  std::thread a (&record_spans);
+  std::thread b (&record_spans);
+  a.join ();
+  b.join ();
+  iff::trace::enable (false);
+
+  std::ostringstream os;
+  CHECK (iff::trace::dump (os));
+  const std::string json = os.str ();
+  CHECK (count (json, "\"ph\":\"B\"") == 2 * SPANS);
+  CHECK (count (json, "\"ph\":\"E\"") == 2 * SPANS);
+  CHECK (json.find ("\"traceEvents\":[") != std::string::npos);
+  // b may have taken over the buffer of a finished a
+  CHECK (tids (json).size () == 1 || tids (json).size () == 2);
+
+  // threads one after the other reuse the buffers of those gone
+  iff::trace::clear ();
+  iff::trace::enable (true);
+  for (unsigned i = 0; i < 50; i++)
+    {
+      std::thread t ([] () { iff::trace::scope_c s ("check", "span"); });
+      t.join ();
+    }
+  iff::trace::enable (false);
+  {
+    std::ostringstream os;
+    CHECK (iff::trace::dump (os));
+    CHECK (count (os.str (), "\"ph\":\"B\"") == 50);
+    CHECK (tids (os.str ()).size () == 1);
+  }
+  iff::trace::clear ();
+
+  check_reader ();
+}
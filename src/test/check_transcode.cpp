@@ -0,0 +1,192 @@
+#include <string.h>
+#include <fstream>
+#include <vector>
+#include <algorithm>
+
+#include "test/check.hpp"
+#include "core/codec/transcode.hpp"
+#include "core/codec/records.hpp"
+#include "bench/corpus.hpp"
+
+using iff::codec::audio_transcoder_c;
+
+// ---------------------------------------------------------------
+static void put_32le (std::vector <uint8_t>& v, uint32_t x)
+{
+  for (int i = 0; i < 4; i++)
+    {
+      v.push_back ((uint8_t)(x >> (8 * i)));
+    }
+}
+// ---------------------------------------------------------------
+static void put_16le (std::vector <uint8_t>& v, uint16_t x)
+{
+  v.push_back ((uint8_t)x);
+  v.push_back ((uint8_t)(x >> 8));
+}
+// ---------------------------------------------------------------
+// a PCM WAV with a LIST INFO ahead of its fmt chunk, as the
+// writers of tagged files lay them out
+static std::string make_wav (unsigned channels, unsigned bytes, uint32_t frames)
+{
+  std::vector <uint8_t> data;
+  uint32_t seed = 5;
+  for (size_t i = 0; i < (size_t)frames * channels * bytes; i++)
+    {
+      seed = seed * 1664525u + 1013904223u;
+      data.push_back ((uint8_t)(seed >> 24));
+    }
+  std::vector <uint8_t> w;
+  w.insert (w.end (), "RIFF", "RIFF" + 4);
+  put_32le (w, 0);
+  w.insert (w.end (), "WAVE", "WAVE" + 4);
+  w.insert (w.end (), "LIST", "LIST" + 4);
+  put_32le (w, 4 + 8 + 5 + 1);
+  w.insert (w.end (), "INFO", "INFO" + 4);
+  w.insert (w.end (), "INAM", "INAM" + 4);
+  put_32le (w, 5);
+  w.insert (w.end (), "test", "test" + 5);
+  w.push_back (0);
+  w.insert (w.end (), "fmt ", "fmt " + 4);
+  put_32le (w, 16);
+  put_16le (w, 1);
+  put_16le (w, (uint16_t)channels);
+  put_32le (w, 22050);
+  put_32le (w, 22050 * channels * bytes);
+  put_16le (w, (uint16_t)(channels * bytes));
+  put_16le (w, (uint16_t)(bytes * 8));
+  w.insert (w.end (), "data", "data" + 4);
+  put_32le (w, (uint32_t)data.size ());
+  w.insert (w.end (), data.begin (), data.end ());
+  if (data.size () & 1)
+    {
+      w.push_back (0);
+    }
+  const uint32_t riff = (uint32_t)w.size () - 8;
+  memcpy (&w [4], &riff, 4);
+
+  const std::string path = check_temp_name ();
+  std::ofstream os (path.c_str (), std::ios::out | std::ios::binary | std::ios::trunc);
+  os.write ((const char*)&w [0], w.size ());
+  return path;
+}
+// ---------------------------------------------------------------
+static bool same_file (const std::string& a, const std::string& b)
+{
+  std::vector <uint8_t> x, y;
+  return iff::bench::load_file (a, x) && iff::bench::load_file (b, y) && x == y;
+}
+// ---------------------------------------------------------------
+// WAV -> AIFF -> WAV gives back the WAV minus its LIST chunk
+static void check_pcm (unsigned channels, unsigned bytes, uint32_t frames)
+{
+  const std::string wav  = make_wav (channels, bytes, frames);
+  const std::string aif  = check_temp_name ();
+  const std::string back = check_temp_name ();
+  const std::string sowt = check_temp_name ();
+  const std::string back2 = check_temp_name ();
+
+  audio_transcoder_c t;
+  CHECK (t.wav_to_aiff (wav.c_str (), aif.c_str ()) == audio_transcoder_c::eOK);
+  CHECK (t.format ().channels == channels && t.format ().frames == frames);
+  CHECK (t.format ().sample_bits == bytes * 8 && !t.copied ());
+  CHECK (t.aiff_to_wav (aif.c_str (), back.c_str ()) == audio_transcoder_c::eOK);
+  CHECK (t.data_bytes () == (uint64_t)frames * channels * bytes);
+
+  // the AIFC 'sowt' way copies the samples both ways
+  t.set_sowt (true);
+  CHECK (t.wav_to_aiff (wav.c_str (), sowt.c_str ()) == audio_transcoder_c::eOK);
+  CHECK (t.copied () == (bytes > 1));
+  CHECK (t.aiff_to_wav (sowt.c_str (), back2.c_str ()) == audio_transcoder_c::eOK);
+  CHECK (t.copied () == (bytes > 1));
+  CHECK (same_file (back, back2));
+
+  std::vector <uint8_t> in, out;
+  if (CHECK (iff::bench::load_file (wav, in) && iff::bench::load_file (back, out)))
+    {
+      // drop the LIST chunk (8 + 18 bytes) and fix the RIFF size
+      in.erase (in.begin () + 12, in.begin () + 12 + 26);
+      const uint32_t riff = (uint32_t)in.size () - 8;
+      memcpy (&in [4], &riff, 4);
+      if (channels <= 2 && bytes <= 2)
+	{
+	  CHECK (in == out);
+	}
+      else if (CHECK (out.size () == in.size () + 24))
+	{
+	  // WAVE_FORMAT_EXTENSIBLE: cbSize 22, the valid bits and the
+	  // PCM GUID ahead of the same data chunk
+	  CHECK (out [16] == 40 && out [20] == 0xFE && out [21] == 0xFF);
+	  CHECK (out [36] == 22 && out [38] == bytes * 8 && out [44] == 1 && out [59] == 0x71);
+	  CHECK (std::equal (in.begin () + 36, in.end (), out.begin () + 60));
+	}
+    }
+}
+// ---------------------------------------------------------------
+// the float AIFC sample goes to a float WAV and comes back
+static void check_float ()
+{
+  const std::string aif  = check_sample ("test.aif");
+  const std::string wav  = check_temp_name ();
+  const std::string aif2 = check_temp_name ();
+  const std::string wav2 = check_temp_name ();
+  audio_transcoder_c t;
+  CHECK (t.aiff_to_wav (aif.c_str (), wav.c_str ()) == audio_transcoder_c::eOK);
+  CHECK (t.format ().floating && t.format ().sample_bytes == 8);
+  const uint64_t bytes = t.data_bytes ();
+  CHECK (bytes == t.format ().frames * t.format ().channels * 8);
+  CHECK (t.wav_to_aiff (wav.c_str (), aif2.c_str ()) == audio_transcoder_c::eOK);
+  CHECK (t.aiff_to_wav (aif2.c_str (), wav2.c_str ()) == audio_transcoder_c::eOK);
+  CHECK (same_file (wav, wav2));
+
+  // fmt with cbSize 0 (stereo at most) and a fact chunk holding the
+  // frame count
+  std::vector <uint8_t> w;
+  if (CHECK (t.format ().channels <= 2) &&
+      CHECK (iff::bench::load_file (wav, w) && w.size () == 58 + bytes))
+    {
+      iff::codec::wave_fmt_t f;
+      CHECK (memcmp (&w [0], "RIFF", 4) == 0 && memcmp (&w [8], "WAVEfmt ", 8) == 0);
+      CHECK (w [16] == 18 && w [36] == 0 && w [37] == 0);
+      CHECK (iff::codec::wave_fmt_schema_t::decode (&w [20], 16, f));
+      CHECK (f.format == iff::codec::wave_fmt_t::eFLOAT && f.sample_bits == 64);
+      CHECK (f.block_align == f.channels * 8 && f.byte_rate == f.sample_rate * f.block_align);
+      uint32_t frames;
+      memcpy (&frames, &w [46], 4);
+      CHECK (memcmp (&w [38], "fact", 4) == 0 && frames == t.format ().frames);
+      CHECK (memcmp (&w [50], "data", 4) == 0);
+    }
+
+  // not audio at all
+  CHECK (t.aiff_to_wav (check_sample ("ZOOM.LBM").c_str (), wav2.c_str ()) ==
+	 audio_transcoder_c::eNOT_AUDIO);
+  CHECK (t.wav_to_aiff (aif.c_str (), wav2.c_str ()) == audio_transcoder_c::eNOT_AUDIO);
+}
+// ---------------------------------------------------------------
+static void check_extended ()
+{
+  static const double rates [] = {8000, 22050, 44100, 48000, 96000, 11025.5, 0.25, 1e-300};
+  bool same = true;
+  for (size_t i = 0; i < sizeof (rates) / sizeof (rates [0]); i++)
+    {
+      uint8_t p [10];
+      iff::codec::ieee_extended_c::double_to_extended (rates [i], p);
+      same = same && iff::codec::ieee_extended_c::extended_to_double (p) == rates [i];
+    }
+  CHECK (same);
+  // 44100 as every AIFF writer stores it
+  static const uint8_t k44100 [10] = {0x40, 0x0E, 0xAC, 0x44, 0, 0, 0, 0, 0, 0};
+  uint8_t p [10];
+  iff::codec::ieee_extended_c::double_to_extended (44100, p);
+  CHECK (memcmp (p, k44100, 10) == 0);
+}
+// ---------------------------------------------------------------
+void check_transcode ()
+{
+  check_extended ();
+  check_pcm (2, 2, 1001);
+  check_pcm (1, 1, 333);
+  check_pcm (3, 3, 257);
+  check_pcm (2, 4, 100);
+  check_float ();
+}
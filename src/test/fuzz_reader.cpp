@@ -0,0 +1,279 @@
+// Fuzz target for the generic reader.
+//
+// Every input goes through each IO policy and must stay within budgets
+// proportional to its size: headers, events and stream repositionings
+// are bounded by the byte count, a reused reader must not allocate and
+// the wall time is capped. A blown budget aborts, which libFuzzer
+// reports as a crash.
+//
+// Built with optHAS_FUZZER (clang) this is a libFuzzer target. Otherwise
+// it is a standalone driver that runs the given files and, with -r,
+// random mutations of them.
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include "core/generic_iff_reader.hpp"
+#include "core/ea/ea_io.hpp"
+#include "core/riff/riff_io.hpp"
+#include "bench/probe.hpp"
+
+// open () positions the stream to learn the input size
+static const uint64_t REPOSITIONS_IN_OPEN = 3;
+static const double   TIME_BASE           = 0.05;   // seconds
+static const double   TIME_PER_BYTE       = 1e-6;
+
+#define BUDGET(C)							\
+  do { if (!(C)) budget_failed (#C, policy_name, size); } while (0)
+
+static void budget_failed (const char* what, const char* policy, size_t size)
+{
+  std::cerr << "budget exceeded [" << policy << ", " << size << " bytes]: "
+	    << what << std::endl;
+  abort ();
+}
+// ---------------------------------------------------------------
+namespace
+{
+  template <class IO_POLICY>
+  class fuzz_reader_c : public generic_iff_reader_c <IO_POLICY>
+  {
+    typedef typename generic_iff_reader_c <IO_POLICY>::id_t id_t;
+  public:
+    uint64_t headers;
+    uint64_t events;
+  private:
+    virtual void _on_chunk_enter (const id_t&, std::streamsize, std::streamsize)
+    {
+      headers++;
+      events++;
+    }
+    virtual void _on_chunk_exit  (const id_t&, std::streamsize, std::streamsize)
+    {
+      events++;
+    }
+    virtual void _on_group_enter (const id_t&, const id_t&, std::streamsize, std::streamsize)
+    {
+      headers++;
+      events++;
+    }
+    virtual void _on_group_exit  (const id_t&, const id_t&, std::streamsize, std::streamsize)
+    {
+      events++;
+    }
+  };
+}
+// ---------------------------------------------------------------
+template <class IO_POLICY>
+static void fuzz_one (const char* policy_name, const uint8_t* data, size_t size)
+{
+  // reused across inputs, as a service would do
+  static fuzz_reader_c <IO_POLICY> reader;
+  reader.headers = 0;
+  reader.events  = 0;
+
+  iff::bench::counters_t before;
+  iff::bench::counters_t after;
+  iff::bench::snapshot (before);
+  const std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now ();
+
+  if (reader.open (data, (std::streamsize)size) == fuzz_reader_c <IO_POLICY>::eOK)
+    {
+      reader.read ();
+    }
+
+  const double seconds = std::chrono::duration <double>
+    (std::chrono::steady_clock::now () - t0).count ();
+  iff::bench::snapshot (after);
+
+  BUDGET (reader.headers <= size / (size_t)IO_POLICY::size_of_header ());
+  BUDGET (reader.events <= 2 * reader.headers);
+  BUDGET (after.allocs == before.allocs);
+  BUDGET (seconds <= TIME_BASE + TIME_PER_BYTE * size);
+#if defined(IFF_HAS_STATS)
+  const iff::reader_stats_t& st = reader.stats ();
+  BUDGET (st.tellg_calls + st.seekg_calls <= st.headers + REPOSITIONS_IN_OPEN);
+#endif
+}
+// ---------------------------------------------------------------
+extern "C" int LLVMFuzzerTestOneInput (const uint8_t* data, size_t size)
+{
+  fuzz_one <iff::ea::io_c> ("ea", data, size);
+  fuzz_one <iff::riff::io_c> ("riff", data, size);
+  return 0;
+}
+
+#if !defined(IFF_LIBFUZZER)
+// ===============================================================
+// standalone driver
+// ===============================================================
+class rng_c
+{
+public:
+  explicit rng_c (uint64_t seed)
+    : m_state (seed ? seed : 1)
+  {
+  }
+  uint64_t next ()
+  {
+    m_state ^= m_state >> 12;
+    m_state ^= m_state << 25;
+    m_state ^= m_state >> 27;
+    return m_state * 0x2545F4914F6CDD1DULL;
+  }
+  size_t below (size_t n)
+  {
+    return n ? (size_t)(next () % n) : 0;
+  }
+private:
+  uint64_t m_state;
+};
+// ---------------------------------------------------------------
+// the mutations aim at the sizes: that is where readers go wrong
+static void mutate (std::vector <uint8_t>& d, rng_c& rng)
+{
+  if (d.empty ())
+    {
+      return;
+    }
+  const size_t at = rng.below (d.size ()) & ~(size_t)3;
+  switch (rng.below (6))
+    {
+    case 0:
+      d [rng.below (d.size ())] ^= (uint8_t)(1 << rng.below (8));
+      break;
+    case 1:
+    case 2:
+      {
+	static const uint32_t sizes [] = {0, 1, 3, 4, 7, 8, 0x7FFFFFFF, 0x80000000u, 0xFFFFFFFFu};
+	const uint32_t v = rng.below (2) ? sizes [rng.below (9)] : (uint32_t)rng.next ();
+	for (size_t i = 0; i < 4 && at + i < d.size (); i++)
+	  {
+	    d [at + i] = (uint8_t)(v >> (24 - 8 * i));
+	  }
+      }
+      break;
+    case 3:
+      d.resize (rng.below (d.size ()));
+      break;
+    case 4:
+      {
+	static const char* ids [] = {"FORM", "LIST", "CAT ", "PROP"};
+	const char* id = ids [rng.below (4)];
+	for (size_t i = 0; i < 4 && at + i < d.size (); i++)
+	  {
+	    d [at + i] = (uint8_t)id [i];
+	  }
+      }
+      break;
+    default:
+      {
+	const size_t from = rng.below (d.size ());
+	const size_t n    = rng.below (64);
+	std::vector <uint8_t> piece (d.begin () + from,
+				     d.begin () + std::min (d.size (), from + n));
+	d.insert (d.begin () + rng.below (d.size ()), piece.begin (), piece.end ());
+      }
+      break;
+    }
+}
+// ---------------------------------------------------------------
+static bool load (const std::string& path, std::vector <uint8_t>& d)
+{
+  std::ifstream ifs (path.c_str (), std::ios::binary);
+  if (!ifs.good ())
+    {
+      return false;
+    }
+  d.assign (std::istreambuf_iterator <char> (ifs), std::istreambuf_iterator <char> ());
+  return true;
+}
+// ---------------------------------------------------------------
+static void collect (const std::string& path, std::vector <std::string>& files)
+{
+  struct stat st;
+  if (stat (path.c_str (), &st) != 0)
+    {
+      return;
+    }
+  if (!S_ISDIR (st.st_mode))
+    {
+      files.push_back (path);
+      return;
+    }
+  DIR* dir = opendir (path.c_str ());
+  if (!dir)
+    {
+      return;
+    }
+  while (struct dirent* e = readdir (dir))
+    {
+      if (e->d_name [0] != '.')
+	{
+	  collect (path + "/" + e->d_name, files);
+	}
+    }
+  closedir (dir);
+}
+// ---------------------------------------------------------------
+int main (int argc, char* argv [])
+{
+  unsigned rounds = 0;
+  uint64_t seed   = 1;
+  std::vector <std::string> files;
+  for (int i = 1; i < argc; i++)
+    {
+      if (strcmp (argv [i], "-r") == 0 && i + 1 < argc)
+	{
+	  rounds = (unsigned)atoi (argv [++i]);
+	}
+      else if (strcmp (argv [i], "-s") == 0 && i + 1 < argc)
+	{
+	  seed = strtoull (argv [++i], 0, 0);
+	}
+      else
+	{
+	  collect (argv [i], files);
+	}
+    }
+  if (files.empty ())
+    {
+      std::cerr << "USAGE " << argv [0] << " [-r mutations_per_file] [-s seed] file|dir ..." << std::endl;
+      return 1;
+    }
+
+  rng_c    rng (seed);
+  uint64_t inputs = 0;
+  for (size_t f = 0; f < files.size (); f++)
+    {
+      std::vector <uint8_t> orig;
+      if (!load (files [f], orig))
+	{
+	  continue;
+	}
+      LLVMFuzzerTestOneInput (orig.empty () ? 0 : &orig [0], orig.size ());
+      inputs++;
+      std::vector <uint8_t> d;
+      for (unsigned r = 0; r < rounds; r++)
+	{
+	  if (r % 8 == 0)
+	    {
+	      d = orig;
+	    }
+	  mutate (d, rng);
+	  LLVMFuzzerTestOneInput (d.empty () ? 0 : &d [0], d.size ());
+	  inputs++;
+	}
+    }
+  std::cout << inputs << " inputs within budget" << std::endl;
+  return 0;
+}
+#endif
@@ -0,0 +1,122 @@
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "core/ea/container.hpp"
+#include "tools/ids.hpp"
+
+using namespace iff::ea::literals;
+using iff::ea::container_builder_c;
+
+// Packs FORM files into a CAT or LIST and splits one back, copying the
+// FORMs as they are.
+static void usage (const char* prog)
+{
+  std::cerr << "USAGE " << prog << " [-l] [-t type] out_file file..." << std::endl
+	    << "      " << prog << " -x [-o prefix] container" << std::endl
+	    << "  packs the files into a CAT (LIST with -l) of the given type, by" << std::endl
+	    << "  default the type the files share; -x writes every child of the" << std::endl
+	    << "  container to prefix<n>.<type>" << std::endl;
+}
+// ---------------------------------------------------------------
+static int split (const char* path, const std::string& prefix)
+{
+  std::vector <std::string> written;
+  const bool ok = iff::ea::split_container (path, prefix, &written);
+  if (!ok)
+    {
+      std::cerr << path << ": not a CAT or LIST, or cant write " << prefix << "*" << std::endl;
+      return 1;
+    }
+  std::cerr << path << ": " << written.size () << " files" << std::endl;
+  return 0;
+}
+// ---------------------------------------------------------------
+int main (int argc, char* argv [])
+{
+  bool        extract = false;
+  iff::ea::id_c id    = "CAT "_id;
+  iff::ea::id_c tag;
+  std::string prefix;
+  std::vector <const char*> files;
+  for (int i = 1; i < argc; i++)
+    {
+      const std::string a = argv [i];
+      if (a == "-x")
+	{
+	  extract = true;
+	}
+      else if (a == "-l")
+	{
+	  id = "LIST"_id;
+	}
+      else if (a == "-o" && i + 1 < argc)
+	{
+	  prefix = argv [++i];
+	}
+      else if (a == "-t" && i + 1 < argc)
+	{
+	  iff_id_t t;
+	  if (!iff::tools::parse_id (argv [++i], t))
+	    {
+	      usage (argv [0]);
+	      return 1;
+	    }
+	  tag = t;
+	}
+      else if (a.size () > 1 && a [0] == '-')
+	{
+	  usage (argv [0]);
+	  return 1;
+	}
+      else
+	{
+	  files.push_back (argv [i]);
+	}
+    }
+  if (extract)
+    {
+      if (files.size () != 1)
+	{
+	  usage (argv [0]);
+	  return 1;
+	}
+      return split (files [0], prefix.empty () ? std::string (files [0]) + "." : prefix);
+    }
+  if (files.size () < 2)
+    {
+      usage (argv [0]);
+      return 1;
+    }
+
+  container_builder_c out;
+  if (out.open (files [0], id, tag) != container_builder_c::eOK)
+    {
+      std::cerr << "cant create " << files [0] << std::endl;
+      return 1;
+    }
+  for (size_t i = 1; i < files.size (); i++)
+    {
+      switch (out.append (files [i]))
+	{
+	case container_builder_c::eOK:
+	  break;
+	case container_builder_c::eNOT_IFF:
+	  std::cerr << files [i] << ": does not start with a group" << std::endl;
+	  return 1;
+	case container_builder_c::eTOO_LARGE:
+	  std::cerr << files [i] << ": the container would exceed 4G" << std::endl;
+	  return 1;
+	default:
+	  std::cerr << files [i] << ": io error" << std::endl;
+	  return 1;
+	}
+    }
+  if (out.finish () != container_builder_c::eOK)
+    {
+      std::cerr << files [0] << ": io error" << std::endl;
+      return 1;
+    }
+  std::cerr << files [0] << ": " << out.children () << " files, " << out.size () << " bytes" << std::endl;
+  return 0;
+}
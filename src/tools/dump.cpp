@@ -0,0 +1,460 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdio>
+
+#include <fcntl.h>
+#include <signal.h>
+
+#include "core/generic_iff_reader.hpp"
+#include "core/ea/ea_io.hpp"
+#include "tools/out_buffer.hpp"
+
+// Structure dump of IFF files.
+//
+//   text    the indented layout printed by iff_test
+//   json    one compact document per file, groups nest their objects
+//   ndjson  one line per chunk or group, for line based consumers
+//
+// Events go straight from the reader into a buffered writer: no
+// strings are built per event and nothing is flushed per line.
+
+enum format_t
+  {
+    eTEXT,
+    eJSON,
+    eNDJSON
+  };
+
+using iff::tools::out_buffer_c;
+
+// ---------------------------------------------------------------
+static void put_json_string (out_buffer_c& out, const char* s, size_t n)
+{
+  static const char hex [] = "0123456789abcdef";
+  out.put ('"');
+  for (size_t i = 0; i < n; i++)
+    {
+      const unsigned char c = (unsigned char)s [i];
+      if (c == '"' || c == '\\')
+	{
+	  out.put ('\\');
+	  out.put ((char)c);
+	}
+      else if (c < 0x20 || c >= 0x7F)
+	{
+	  const char esc [6] = { '\\', 'u', '0', '0', hex [c >> 4], hex [c & 15] };
+	  out.write (esc, sizeof (esc));
+	}
+      else
+	{
+	  out.put ((char)c);
+	}
+    }
+  out.put ('"');
+}
+// ===============================================================
+class dump_reader_c : public generic_iff_reader_c <iff::ea::io_c>
+{
+public:
+  dump_reader_c (out_buffer_c& out, format_t format)
+    : m_out    (out),
+      m_format (format),
+      m_depth  (0),
+      m_first  (true),
+      m_events (0)
+  {
+  }
+
+  // dumps one file; the output is well formed even if parsing fails
+  status_t dump (const char* path);
+
+  uint64_t events () const
+  {
+    return m_events;
+  }
+private:
+  virtual void _on_chunk_enter (const id_t& id, std::streamsize size, std::streamsize pos);
+  virtual void _on_chunk_exit  (const id_t& id, std::streamsize size, std::streamsize pos);
+  virtual void _on_group_enter (const id_t& id, const id_t& tag, std::streamsize size, std::streamsize pos);
+  virtual void _on_group_exit  (const id_t& id, const id_t& tag, std::streamsize size, std::streamsize pos);
+
+  void _id_raw  (const id_t& id);
+  void _id_json (const id_t& id);
+  void _separator ();
+  void _ndjson_head (const char* kind, const id_t& id);
+  static const char* _error (status_t rc);
+private:
+  out_buffer_c& m_out;
+  format_t      m_format;
+  unsigned      m_depth;
+  bool          m_first;
+  uint64_t      m_events;
+  // path of the current file as a JSON string
+  std::string   m_file;
+};
+// ---------------------------------------------------------------
+// iff_test printed ids through a C string, which ends at a NUL
+void dump_reader_c::_id_raw (const id_t& id)
+{
+  const iff_id_t v = id.value ();
+  for (int shift = 24; shift >= 0; shift -= 8)
+    {
+      const char c = (char)(v >> shift);
+      if (!c)
+	{
+	  break;
+	}
+      m_out.put (c);
+    }
+}
+// ---------------------------------------------------------------
+void dump_reader_c::_id_json (const id_t& id)
+{
+  const iff_id_t v = id.value ();
+  const char s [4] = { (char)(v >> 24), (char)(v >> 16), (char)(v >> 8), (char)v };
+  put_json_string (m_out, s, sizeof (s));
+}
+// ---------------------------------------------------------------
+void dump_reader_c::_separator ()
+{
+  if (!m_first)
+    {
+      m_out.put (',');
+    }
+  m_first = false;
+}
+// ---------------------------------------------------------------
+void dump_reader_c::_ndjson_head (const char* kind, const id_t& id)
+{
+  m_out.write ("{\"file\":", 8);
+  m_out.write (m_file.data (), m_file.size ());
+  m_out.write (",\"depth\":", 9);
+  m_out.put_u64 (m_depth);
+  m_out.write (",\"kind\":\"", 9);
+  m_out.write (kind);
+  m_out.write ("\",\"id\":", 7);
+  _id_json (id);
+}
+// ---------------------------------------------------------------
+const char* dump_reader_c::_error (status_t rc)
+{
+  switch (rc)
+    {
+    case eNOT_IFF:
+      return "not iff";
+    case eTOO_DEEP:
+      return "too deep";
+    case eCORRUPT:
+      return "corrupt";
+    case eNO_MEMORY:
+      return "no memory";
+    default:
+      return "io error";
+    }
+}
+// ---------------------------------------------------------------
+dump_reader_c::status_t dump_reader_c::dump (const char* path)
+{
+  m_depth = 0;
+  m_first = true;
+  m_file.clear ();
+  {
+    // escape the path once, ndjson repeats it on every line
+    std::string s;
+    for (const char* p = path; *p; p++)
+      {
+	const unsigned char c = (unsigned char)*p;
+	if (c == '"' || c == '\\')
+	  {
+	    s += '\\';
+	    s += (char)c;
+	  }
+	else if (c < 0x20)
+	  {
+	    char esc [8];
+	    snprintf (esc, sizeof (esc), "\\u%04x", c);
+	    s += esc;
+	  }
+	else
+	  {
+	    s += (char)c;
+	  }
+      }
+    m_file = "\"" + s + "\"";
+  }
+
+  status_t rc = open (path);
+  if (m_format == eJSON)
+    {
+      m_out.write ("{\"file\":", 8);
+      m_out.write (m_file.data (), m_file.size ());
+      m_out.write (",\"size\":", 8);
+      m_out.put_i64 (rc == eOK ? file_size () : 0);
+      m_out.write (",\"objects\":[", 12);
+    }
+  if (rc == eOK)
+    {
+      rc = read ();
+    }
+  switch (m_format)
+    {
+    case eJSON:
+      // close whatever a failed parse left open
+      for (; m_depth; m_depth--)
+	{
+	  m_out.write ("]}", 2);
+	}
+      m_out.put (']');
+      if (rc != eOK)
+	{
+	  m_out.write (",\"error\":\"", 10);
+	  m_out.write (_error (rc));
+	  m_out.put ('"');
+	}
+      m_out.write ("}\n", 2);
+      break;
+    case eNDJSON:
+      if (rc != eOK)
+	{
+	  m_out.write ("{\"file\":", 8);
+	  m_out.write (m_file.data (), m_file.size ());
+	  m_out.write (",\"error\":\"", 10);
+	  m_out.write (_error (rc));
+	  m_out.write ("\"}\n", 3);
+	}
+      break;
+    default:
+      break;
+    }
+  return rc;
+}
+// ---------------------------------------------------------------
+void dump_reader_c::_on_chunk_enter (const id_t& id, std::streamsize size, std::streamsize pos)
+{
+  m_events++;
+  switch (m_format)
+    {
+    case eTEXT:
+      m_out.put_spaces (m_depth);
+      m_out.write (" CHUNK: ", 8);
+      _id_raw (id);
+      m_out.write (" : ", 3);
+      m_out.put_i64 (size);
+      m_out.write (" (", 2);
+      m_out.put_i64 (pos);
+      m_out.write (", ", 2);
+      break;
+    case eJSON:
+      _separator ();
+      m_out.write ("{\"chunk\":", 9);
+      _id_json (id);
+      m_out.write (",\"offset\":", 10);
+      m_out.put_i64 (pos);
+      m_out.write (",\"size\":", 8);
+      m_out.put_i64 (size);
+      m_out.put ('}');
+      break;
+    case eNDJSON:
+      _ndjson_head ("chunk", id);
+      m_out.write (",\"offset\":", 10);
+      m_out.put_i64 (pos);
+      m_out.write (",\"size\":", 8);
+      m_out.put_i64 (size);
+      m_out.write ("}\n", 2);
+      break;
+    }
+}
+// ---------------------------------------------------------------
+void dump_reader_c::_on_chunk_exit (const id_t&, std::streamsize, std::streamsize pos)
+{
+  m_events++;
+  if (m_format == eTEXT)
+    {
+      m_out.put_i64 (pos);
+      m_out.write (")\n", 2);
+    }
+}
+// ---------------------------------------------------------------
+void dump_reader_c::_on_group_enter (const id_t& id, const id_t& tag,
+				     std::streamsize size, std::streamsize pos)
+{
+  m_events++;
+  switch (m_format)
+    {
+    case eTEXT:
+      m_out.put_spaces (m_depth);
+      m_out.write ("-> GROUP: ", 10);
+      _id_raw (id);
+      m_out.put (',');
+      _id_raw (tag);
+      m_out.write (" (", 2);
+      m_out.put_i64 (pos);
+      m_out.put (',');
+      m_out.put_i64 (size);
+      m_out.write (")\n", 2);
+      break;
+    case eJSON:
+      _separator ();
+      m_out.write ("{\"group\":", 9);
+      _id_json (id);
+      m_out.write (",\"tag\":", 7);
+      _id_json (tag);
+      m_out.write (",\"offset\":", 10);
+      m_out.put_i64 (pos);
+      m_out.write (",\"size\":", 8);
+      m_out.put_i64 (size);
+      m_out.write (",\"objects\":[", 12);
+      m_first = true;
+      break;
+    case eNDJSON:
+      _ndjson_head ("group", id);
+      m_out.write (",\"tag\":", 7);
+      _id_json (tag);
+      m_out.write (",\"offset\":", 10);
+      m_out.put_i64 (pos);
+      m_out.write (",\"size\":", 8);
+      m_out.put_i64 (size);
+      m_out.write ("}\n", 2);
+      break;
+    }
+  m_depth++;
+}
+// ---------------------------------------------------------------
+void dump_reader_c::_on_group_exit (const id_t& id, const id_t& tag,
+				    std::streamsize size, std::streamsize pos)
+{
+  m_events++;
+  m_depth--;
+  switch (m_format)
+    {
+    case eTEXT:
+      m_out.put_spaces (m_depth);
+      m_out.write ("<- GROUP: ", 10);
+      _id_raw (id);
+      m_out.put (',');
+      _id_raw (tag);
+      m_out.write (" (", 2);
+      m_out.put_i64 (pos);
+      m_out.put (',');
+      m_out.put_i64 (size);
+      m_out.write (")\n", 2);
+      break;
+    case eJSON:
+      m_out.write ("]}", 2);
+      m_first = false;
+      break;
+    case eNDJSON:
+      break;
+    }
+}
+// ===============================================================
+static void usage (const char* prog)
+{
+  std::cerr << "USAGE " << prog << " [-f text|json|ndjson] [-o file] [-s] file ..." << std::endl
+	    << "  -s prints the event rate to stderr" << std::endl;
+}
+// ---------------------------------------------------------------
+int main (int argc, char* argv [])
+{
+  format_t    format = eTEXT;
+  const char* output = 0;
+  bool        stats  = false;
+  std::vector <const char*> files;
+
+  for (int i = 1; i < argc; i++)
+    {
+      const std::string a = argv [i];
+      if ((a == "-f" || a == "-o") && i + 1 < argc)
+	{
+	  const std::string v = argv [++i];
+	  if (a == "-o")
+	    {
+	      output = argv [i];
+	    }
+	  else if (v == "text")
+	    {
+	      format = eTEXT;
+	    }
+	  else if (v == "json")
+	    {
+	      format = eJSON;
+	    }
+	  else if (v == "ndjson")
+	    {
+	      format = eNDJSON;
+	    }
+	  else
+	    {
+	      usage (argv [0]);
+	      return 1;
+	    }
+	}
+      else if (a == "-s")
+	{
+	  stats = true;
+	}
+      else if (a.size () > 1 && a [0] == '-')
+	{
+	  usage (argv [0]);
+	  return 1;
+	}
+      else
+	{
+	  files.push_back (argv [i]);
+	}
+    }
+  if (files.empty ())
+    {
+      usage (argv [0]);
+      return 1;
+    }
+
+  // a closed pipe (iff_dump ... | head) fails the write instead of
+  // killing us, out_buffer_c then stops quietly
+  signal (SIGPIPE, SIG_IGN);
+  int fd = 1;
+  if (output)
+    {
+      fd = ::open (output, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+      if (fd < 0)
+	{
+	  std::cerr << "cant create " << output << std::endl;
+	  return 1;
+	}
+    }
+
+  int rc = 0;
+  uint64_t events = 0;
+  const std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now ();
+  {
+    out_buffer_c  out (fd);
+    dump_reader_c reader (out, format);
+    for (size_t i = 0; i < files.size () && out.good (); i++)
+      {
+	if (reader.dump (files [i]) != dump_reader_c::eOK)
+	  {
+	    std::cerr << files [i] << ": cant read" << std::endl;
+	    rc = 1;
+	  }
+      }
+    out.flush ();
+    if (!out.good ())
+      {
+	rc = 1;
+      }
+    events = reader.events ();
+  }
+  const double seconds = std::chrono::duration <double> (std::chrono::steady_clock::now () - t0).count ();
+  if (output)
+    {
+      close (fd);
+    }
+  if (stats)
+    {
+      std::cerr << events << " events in " << seconds << " s, "
+		<< (seconds > 0 ? (uint64_t)(events / seconds) : 0) << " events/s" << std::endl;
+    }
+  return rc;
+}
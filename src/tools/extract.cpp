@@ -0,0 +1,186 @@
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <mutex>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "core/ea/extract.hpp"
+#include "core/ea/container.hpp"
+#include "tools/numbers.hpp"
+#include "tools/ids.hpp"
+
+// Exports chunk payloads of many files, several files at a time:
+//
+//   iff_extract -j 8 -o out BODY,AIFF/SSND *.iff
+//
+// writes out/<file>.<n>.<ID> for the nth selected chunk of every file.
+static void usage (const char* prog)
+{
+  std::cerr << "USAGE " << prog << " [-j threads] [-o dir] [TAG/]ID[,[TAG/]ID...] file..." << std::endl
+	    << "  copies the payloads of the selected chunks to standalone files" << std::endl;
+}
+// ---------------------------------------------------------------
+static std::string base_name (const std::string& path)
+{
+  const std::string::size_type slash = path.rfind ('/');
+  return slash == std::string::npos ? path : path.substr (slash + 1);
+}
+// ===============================================================
+struct job_t
+{
+  std::vector <std::pair <iff_id_t, iff_id_t> > selectors;
+  std::vector <std::string>                     files;
+  std::string                                   out_dir;
+
+  std::atomic <size_t>   next;
+  std::atomic <uint64_t> chunks;
+  std::atomic <uint64_t> bytes;
+  std::atomic <unsigned> failed;
+  std::atomic <int>      method;
+  std::mutex             log;
+
+  job_t ()
+    : next   (0),
+      chunks (0),
+      bytes  (0),
+      failed (0),
+      method (iff::eCOPY_FILE_RANGE)
+  {
+  }
+};
+// ---------------------------------------------------------------
+static void fail (job_t& job, const std::string& what)
+{
+  job.failed++;
+  std::lock_guard <std::mutex> lock (job.log);
+  std::cerr << what << std::endl;
+}
+// ---------------------------------------------------------------
+static void worker (job_t* job)
+{
+  iff::ea::extractor_c extractor;
+  for (size_t i = 0; i < job->selectors.size (); i++)
+    {
+      extractor.select (job->selectors [i].first, job->selectors [i].second);
+    }
+  std::vector <iff::ea::chunk_ref_t> refs;
+  for (size_t f = job->next++; f < job->files.size (); f = job->next++)
+    {
+      const std::string& path = job->files [f];
+      if (extractor.locate (path.c_str (), refs) != iff::ea::extractor_c::reader_t::eOK)
+	{
+	  fail (*job, path + ": not a readable IFF file");
+	  continue;
+	}
+      const int fd = open (path.c_str (), O_RDONLY);
+      if (fd < 0)
+	{
+	  fail (*job, path + ": cant open");
+	  continue;
+	}
+      for (size_t k = 0; k < refs.size (); k++)
+	{
+	  std::ostringstream name;
+	  name << job->out_dir << "/" << base_name (path) << "." << k << "." << iff::ea::id_file_name (iff::ea::id_c (refs [k].id));
+	  iff::copy_method_t m;
+	  if (!iff::ea::extractor_c::extract (fd, refs [k], name.str (), &m))
+	    {
+	      fail (*job, name.str () + ": extraction failed");
+	      continue;
+	    }
+	  // report the slowest method any copy fell back to
+	  int seen = job->method.load ();
+	  while (m > seen && !job->method.compare_exchange_weak (seen, m))
+	    {
+	    }
+	  job->chunks++;
+	  job->bytes += refs [k].size;
+	}
+      close (fd);
+    }
+}
+// ---------------------------------------------------------------
+int main (int argc, char* argv [])
+{
+  job_t    job;
+  uint64_t threads = std::thread::hardware_concurrency ();
+  job.out_dir = ".";
+  for (int i = 1; i < argc; i++)
+    {
+      const std::string a = argv [i];
+      if (a == "-j" && i + 1 < argc)
+	{
+	  if (!iff::tools::parse_number (argv [++i], threads))
+	    {
+	      usage (argv [0]);
+	      return 1;
+	    }
+	}
+      else if (a == "-o" && i + 1 < argc)
+	{
+	  job.out_dir = argv [++i];
+	}
+      else if (a.size () > 1 && a [0] == '-')
+	{
+	  usage (argv [0]);
+	  return 1;
+	}
+      else if (job.selectors.empty ())
+	{
+	  std::istringstream list (a);
+	  std::string s;
+	  while (std::getline (list, s, ','))
+	    {
+	      iff_id_t parent, id;
+	      if (!iff::tools::parse_selector (s, parent, id))
+		{
+		  usage (argv [0]);
+		  return 1;
+		}
+	      job.selectors.push_back (std::make_pair (parent, id));
+	    }
+	}
+      else
+	{
+	  job.files.push_back (a);
+	}
+    }
+  if (job.selectors.empty () || job.files.empty ())
+    {
+      usage (argv [0]);
+      return 1;
+    }
+  if (threads == 0)
+    {
+      threads = 1;
+    }
+  if (threads > job.files.size ())
+    {
+      threads = job.files.size ();
+    }
+
+  std::vector <std::thread> pool;
+  for (uint64_t t = 1; t < threads; t++)
+    {
+      pool.push_back (std::thread (&worker, &job));
+    }
+  worker (&job);
+  for (size_t t = 0; t < pool.size (); t++)
+    {
+      pool [t].join ();
+    }
+
+  std::cerr << job.files.size () << " files, " << job.chunks.load () << " chunks, "
+	    << job.bytes.load () << " bytes";
+  if (job.chunks.load ())
+    {
+      std::cerr << " by " << iff::copy_method_name ((iff::copy_method_t)job.method.load ());
+    }
+  std::cerr << std::endl;
+  return job.failed.load () ? 1 : 0;
+}
@@ -0,0 +1,111 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <cstdlib>
+
+#include "tools/synth.hpp"
+#include "tools/numbers.hpp"
+
+static void usage (const char* prog)
+{
+  std::cerr << "USAGE " << prog << " -s shape [-c count] [-d depth] [-z size] [-r seed] -o file" << std::endl
+	    << "  shapes: tiny, deep, body, cat, anim" << std::endl
+	    << "  count and size accept K, M and G suffixes" << std::endl;
+}
+// ---------------------------------------------------------------
+int main (int argc, char* argv [])
+{
+  const char* shape_name = 0;
+  const char* out        = 0;
+  uint64_t    count = 0, depth = 0, size = 0, seed = 0;
+  bool        has_count = false, has_depth = false, has_size = false, has_seed = false;
+
+  for (int i = 1; i < argc; i++)
+    {
+      const std::string a = argv [i];
+      if (i + 1 >= argc)
+	{
+	  usage (argv [0]);
+	  return 1;
+	}
+      const char* v = argv [++i];
+      bool ok = true;
+      if (a == "-s")
+	{
+	  shape_name = v;
+	}
+      else if (a == "-o")
+	{
+	  out = v;
+	}
+      else if (a == "-c")
+	{
+	  ok = has_count = iff::tools::parse_number (v, count);
+	}
+      else if (a == "-d")
+	{
+	  ok = has_depth = iff::tools::parse_number (v, depth);
+	}
+      else if (a == "-z")
+	{
+	  ok = has_size = iff::tools::parse_number (v, size);
+	}
+      else if (a == "-r")
+	{
+	  ok = has_seed = iff::tools::parse_number (v, seed);
+	}
+      else
+	{
+	  ok = false;
+	}
+      if (!ok)
+	{
+	  usage (argv [0]);
+	  return 1;
+	}
+    }
+
+  iff::synth::shape_t shape;
+  if (!shape_name || !out || !iff::synth::shape_by_name (shape_name, shape))
+    {
+      usage (argv [0]);
+      return 1;
+    }
+
+  iff::synth::params_t p;
+  iff::synth::default_params (shape, p);
+  if (has_count)
+    {
+      p.count = count;
+    }
+  if (has_depth)
+    {
+      p.depth = (unsigned)depth;
+    }
+  if (has_size)
+    {
+      p.size = size;
+    }
+  if (has_seed)
+    {
+      p.seed = seed;
+    }
+
+  std::ofstream ofs (out, std::ios::binary | std::ios::trunc);
+  if (!ofs.good ())
+    {
+      std::cerr << "cant open " << out << std::endl;
+      return 1;
+    }
+  if (!iff::synth::generate (ofs, p))
+    {
+      std::cerr << "cant generate " << out
+		<< " (IFF sizes are limited to 4 GiB)" << std::endl;
+      return 1;
+    }
+  ofs.close ();
+  std::cout << out << ": " << iff::synth::shape_name (shape)
+	    << " count=" << p.count << " depth=" << p.depth
+	    << " size=" << p.size << " seed=" << p.seed << std::endl;
+  return 0;
+}
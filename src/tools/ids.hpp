@@ -0,0 +1,38 @@
+#ifndef __IFF_TOOLS_IDS_HPP__
+#define __IFF_TOOLS_IDS_HPP__
+
+#include <string>
+#include "core/handler_registry.hpp"
+#include "core/ea/id.hpp"
+
+namespace iff
+{
+  namespace tools
+  {
+    // up to four characters, short ids are padded with spaces
+    inline bool parse_id (const std::string& s, iff_id_t& id)
+    {
+      if (s.empty () || s.size () > 4)
+	{
+	  return false;
+	}
+      const std::string padded = s + std::string (4 - s.size (), ' ');
+      id = iff::ea::id_c (padded [0], padded [1], padded [2], padded [3]);
+      return true;
+    }
+
+    // ID or TAG/ID, parent is handler_registry_c::ANY without a TAG
+    inline bool parse_selector (const std::string& s, iff_id_t& parent, iff_id_t& id)
+    {
+      const std::string::size_type slash = s.find ('/');
+      parent = iff::handler_registry_c::ANY;
+      if (slash == std::string::npos)
+	{
+	  return parse_id (s, id);
+	}
+      return parse_id (s.substr (0, slash), parent) && parse_id (s.substr (slash + 1), id);
+    }
+  } // ns tools
+} // ns iff
+
+#endif
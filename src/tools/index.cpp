@@ -0,0 +1,140 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <cstdio>
+
+#include "core/index_builder.hpp"
+#include "core/ea/ea_io.hpp"
+#include "core/ea/id.hpp"
+#include "tools/numbers.hpp"
+
+// Exit codes: 0 done, 1 usage or parse error, 2 the memory cap was hit
+static void usage (const char* prog)
+{
+  std::cerr << "USAGE " << prog << " [-m memory_cap] [-b buffer] file index_file|-" << std::endl
+	    << "      " << prog << " -d index_file" << std::endl
+	    << "  writes the structure of file as a binary index while parsing it," << std::endl
+	    << "  memory stays under memory_cap (K, M and G suffixes) or the run fails" << std::endl;
+}
+// ---------------------------------------------------------------
+static int dump (const char* path)
+{
+  std::ifstream ifs (path, std::ios::in | std::ios::binary);
+  iff::index_reader_c r (ifs);
+  if (!ifs || !r.open ())
+    {
+      std::cerr << path << ": not an index" << std::endl;
+      return 1;
+    }
+  std::cout << "file size " << r.file_size () << ", " << r.count () << " records" << std::endl;
+  iff::index_record_t rec;
+  while (r.next (rec))
+    {
+      const std::string id  = iff::ea::id_c (rec.id).to_string ();
+      const std::string tag = iff::ea::id_c (rec.tag).to_string ();
+      char line [256];
+      snprintf (line, sizeof (line), "%*s%s%s%s size %llu at %llu\n",
+		2 * rec.depth, "", id.c_str (),
+		rec.kind == iff::index_record_t::eGROUP ? " " : "",
+		rec.kind == iff::index_record_t::eGROUP ? tag.c_str () : "",
+		(unsigned long long)rec.size, (unsigned long long)rec.offset);
+      std::cout << line;
+    }
+  return 0;
+}
+// ---------------------------------------------------------------
+int main (int argc, char* argv [])
+{
+  typedef iff::index_builder_c <iff::ea::io_c> builder_t;
+
+  uint64_t    cap    = iff::memory_budget_c::UNLIMITED;
+  uint64_t    buffer = iff::index_writer_c::DEFAULT_BUFFER_SIZE;
+  const char* in     = 0;
+  const char* out    = 0;
+
+  for (int i = 1; i < argc; i++)
+    {
+      const std::string a = argv [i];
+      if (a == "-d" && i + 1 < argc)
+	{
+	  return dump (argv [i + 1]);
+	}
+      if ((a == "-m" || a == "-b") && i + 1 < argc)
+	{
+	  if (!iff::tools::parse_number (argv [++i], a == "-m" ? cap : buffer))
+	    {
+	      usage (argv [0]);
+	      return 1;
+	    }
+	}
+      else if (a.size () > 1 && a [0] == '-')
+	{
+	  usage (argv [0]);
+	  return 1;
+	}
+      else if (!in)
+	{
+	  in = argv [i];
+	}
+      else if (!out)
+	{
+	  out = argv [i];
+	}
+      else
+	{
+	  usage (argv [0]);
+	  return 1;
+	}
+    }
+  if (!in || !out)
+    {
+      usage (argv [0]);
+      return 1;
+    }
+
+  std::ofstream ofs;
+  std::ostream* os = &std::cout;
+  if (std::string (out) != "-")
+    {
+      ofs.open (out, std::ios::out | std::ios::binary | std::ios::trunc);
+      if (!ofs)
+	{
+	  std::cerr << "cant create " << out << std::endl;
+	  return 1;
+	}
+      os = &ofs;
+    }
+
+  iff::memory_budget_c budget ((size_t)cap);
+  iff::index_writer_c  writer (*os, &budget, (size_t)buffer);
+  builder_t            builder (writer, &budget);
+  const builder_t::status_t rc = builder.build (in);
+  if (rc != builder_t::eOK && os == &ofs)
+    {
+      // no partial indexes
+      ofs.close ();
+      remove (out);
+    }
+  switch (rc)
+    {
+    case builder_t::eOK:
+      std::cerr << in << ": " << writer.records () << " records, peak memory "
+		<< budget.peak () << " bytes" << std::endl;
+      return 0;
+    case builder_t::eNO_MEMORY:
+      std::cerr << in << ": memory cap of " << cap << " bytes exceeded" << std::endl;
+      return 2;
+    case builder_t::eNOT_IFF:
+      std::cerr << in << ": not an IFF file" << std::endl;
+      return 1;
+    case builder_t::eTOO_DEEP:
+      std::cerr << in << ": nested too deep" << std::endl;
+      return 1;
+    case builder_t::eCORRUPT:
+      std::cerr << in << ": corrupt" << std::endl;
+      return 1;
+    default:
+      std::cerr << in << ": io error" << std::endl;
+      return 1;
+    }
+}
@@ -0,0 +1,41 @@
+#ifndef __IFF_TOOLS_NUMBERS_HPP__
+#define __IFF_TOOLS_NUMBERS_HPP__
+
+#include <cstdlib>
+#include "core/iff_types.hpp"
+
+namespace iff
+{
+  namespace tools
+  {
+    // decimal, octal or hex with an optional K, M or G suffix
+    inline bool parse_number (const char* s, uint64_t& v)
+    {
+      char* end = 0;
+      v = strtoull (s, &end, 0);
+      if (end == s)
+	{
+	  return false;
+	}
+      switch (*end)
+	{
+	case 0:
+	  return true;
+	case 'k': case 'K':
+	  v <<= 10;
+	  break;
+	case 'm': case 'M':
+	  v <<= 20;
+	  break;
+	case 'g': case 'G':
+	  v <<= 30;
+	  break;
+	default:
+	  return false;
+	}
+      return end [1] == 0;
+    }
+  } // ns tools
+} // ns iff
+
+#endif
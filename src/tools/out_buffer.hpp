@@ -0,0 +1,142 @@
+#ifndef __IFF_TOOLS_OUT_BUFFER_HPP__
+#define __IFF_TOOLS_OUT_BUFFER_HPP__
+
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+
+#include "core/iff_types.hpp"
+
+namespace iff
+{
+  namespace tools
+  {
+    // Buffered output straight to a file descriptor. Nothing is
+    // flushed per line, numbers are formatted without locales or
+    // streams. After a failed write (a closed pipe) every further
+    // write is dropped and good () turns false.
+    class out_buffer_c
+    {
+    public:
+      enum
+	{
+	  SIZE = 64 * 1024
+	};
+
+      explicit out_buffer_c (int fd)
+	: m_fd   (fd),
+	  m_used (0),
+	  m_good (true)
+      {
+      }
+      ~out_buffer_c ()
+      {
+	flush ();
+      }
+
+      void put (char c)
+      {
+	if (m_used == SIZE)
+	  {
+	    flush ();
+	  }
+	m_buffer [m_used++] = c;
+      }
+      void write (const char* s, size_t n)
+      {
+	if (n > SIZE - m_used)
+	  {
+	    flush ();
+	    if (n > SIZE)
+	      {
+		_write (s, n);
+		return;
+	      }
+	  }
+	memcpy (m_buffer + m_used, s, n);
+	m_used += n;
+      }
+      void write (const char* s)
+      {
+	write (s, strlen (s));
+      }
+      void put_u64 (uint64_t v)
+      {
+	char digits [20];
+	size_t n = 0;
+	do
+	  {
+	    digits [n++] = (char)('0' + v % 10);
+	    v /= 10;
+	  }
+	while (v);
+	if (n > SIZE - m_used)
+	  {
+	    flush ();
+	  }
+	while (n)
+	  {
+	    m_buffer [m_used++] = digits [--n];
+	  }
+      }
+      void put_i64 (int64_t v)
+      {
+	if (v < 0)
+	  {
+	    put ('-');
+	    put_u64 (0 - (uint64_t)v);
+	    return;
+	  }
+	put_u64 ((uint64_t)v);
+      }
+      void put_spaces (size_t n)
+      {
+	static const char spaces [] = "                                ";
+	while (n)
+	  {
+	    const size_t k = n < sizeof (spaces) - 1 ? n : sizeof (spaces) - 1;
+	    write (spaces, k);
+	    n -= k;
+	  }
+      }
+      void flush ()
+      {
+	_write (m_buffer, m_used);
+	m_used = 0;
+      }
+      bool good () const
+      {
+	return m_good;
+      }
+    private:
+      out_buffer_c (const out_buffer_c&);
+      out_buffer_c& operator = (const out_buffer_c&);
+
+      void _write (const char* p, size_t n)
+      {
+	while (n && m_good)
+	  {
+	    const ssize_t k = ::write (m_fd, p, n);
+	    if (k < 0 && errno == EINTR)
+	      {
+		continue;
+	      }
+	    if (k <= 0)
+	      {
+		m_good = false;
+		break;
+	      }
+	    p += k;
+	    n -= (size_t)k;
+	  }
+      }
+    private:
+      int    m_fd;
+      size_t m_used;
+      bool   m_good;
+      char   m_buffer [SIZE];
+    };
+  } // ns tools
+} // ns iff
+
+#endif
@@ -0,0 +1,151 @@
+#include <iostream>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "core/dispatch_reader.hpp"
+#include "core/ea/ea_io.hpp"
+#include "core/ea/patch.hpp"
+#include "tools/numbers.hpp"
+#include "tools/ids.hpp"
+
+// Replaces the payload of one chunk in place: iff_patch file ILBM/ANNO -t "text"
+static void usage (const char* prog)
+{
+  std::cerr << "USAGE " << prog << " [-n nth] file [TAG/]ID (-t text | -f payload_file)" << std::endl
+	    << "  replaces the payload of the nth (from 0) chunk ID, inside groups of" << std::endl
+	    << "  type TAG if given; only the rest of the file moves if the size changes" << std::endl;
+}
+// ---------------------------------------------------------------
+namespace
+{
+  class finder_c : public iff::chunk_handler_c
+  {
+  public:
+    explicit finder_c (uint64_t nth)
+      : pos   (-1),
+	m_nth (nth)
+    {
+    }
+    virtual void on_chunk (const iff::chunk_event_t& ev)
+    {
+      if (m_nth-- == 0)
+	{
+	  pos = ev.file_pos;
+	}
+    }
+    std::streamsize pos;
+  private:
+    uint64_t m_nth;
+  };
+}
+// ---------------------------------------------------------------
+int main (int argc, char* argv [])
+{
+  uint64_t    nth  = 0;
+  const char* path = 0;
+  const char* what = 0;
+  const char* text = 0;
+  const char* from = 0;
+  for (int i = 1; i < argc; i++)
+    {
+      const std::string a = argv [i];
+      if (a == "-n" && i + 1 < argc)
+	{
+	  if (!iff::tools::parse_number (argv [++i], nth))
+	    {
+	      usage (argv [0]);
+	      return 1;
+	    }
+	}
+      else if (a == "-t" && i + 1 < argc)
+	{
+	  text = argv [++i];
+	}
+      else if (a == "-f" && i + 1 < argc)
+	{
+	  from = argv [++i];
+	}
+      else if (a.size () > 1 && a [0] == '-')
+	{
+	  usage (argv [0]);
+	  return 1;
+	}
+      else if (!path)
+	{
+	  path = argv [i];
+	}
+      else if (!what)
+	{
+	  what = argv [i];
+	}
+      else
+	{
+	  usage (argv [0]);
+	  return 1;
+	}
+    }
+  iff_id_t parent;
+  iff_id_t id;
+  if (!path || !what || !text == !from || !iff::tools::parse_selector (what, parent, id))
+    {
+      usage (argv [0]);
+      return 1;
+    }
+
+  std::vector <char> payload;
+  if (text)
+    {
+      payload.assign (text, text + std::string (text).size ());
+    }
+  else
+    {
+      std::ifstream ifs (from, std::ios::in | std::ios::binary);
+      if (!ifs)
+	{
+	  std::cerr << "cant open " << from << std::endl;
+	  return 1;
+	}
+      payload.assign (std::istreambuf_iterator <char> (ifs), std::istreambuf_iterator <char> ());
+    }
+
+  finder_c finder (nth);
+  iff::handler_registry_c handlers;
+  handlers.bind (parent, id, &finder);
+  handlers.compile ();
+  iff::dispatch_reader_c <iff::ea::io_c> reader (handlers);
+  if (reader.open (path) != reader.eOK || reader.read () != reader.eOK)
+    {
+      std::cerr << path << ": not a readable IFF file" << std::endl;
+      return 1;
+    }
+  if (finder.pos < 0)
+    {
+      std::cerr << path << ": no chunk " << what << " #" << nth << std::endl;
+      return 1;
+    }
+
+  iff::ea::patcher_c patcher;
+  iff::ea::patcher_c::status_t rc = patcher.open (path);
+  if (rc == iff::ea::patcher_c::eOK)
+    {
+      rc = patcher.replace ((uint64_t)finder.pos, payload.empty () ? 0 : &payload [0], payload.size ());
+    }
+  switch (rc)
+    {
+    case iff::ea::patcher_c::eOK:
+      std::cerr << path << ": " << payload.size () << " bytes at " << finder.pos
+		<< ", moved " << patcher.bytes_moved () << " bytes" << std::endl;
+      return 0;
+    case iff::ea::patcher_c::eTOO_LARGE:
+      std::cerr << path << ": an enclosing group would exceed 4G" << std::endl;
+      return 1;
+    case iff::ea::patcher_c::eCORRUPT:
+      std::cerr << path << ": corrupt" << std::endl;
+      return 1;
+    default:
+      std::cerr << path << ": io error" << std::endl;
+      return 1;
+    }
+}
@@ -0,0 +1,232 @@
+#include <string.h>
+#include <vector>
+
+#include "tools/synth.hpp"
+#include "core/ea/writer.hpp"
+#include "core/fd_io.hpp"
+
+using namespace iff::ea::literals;
+using iff::put_be16;
+using iff::put_be32;
+
+static const std::streamsize BLOCK_SIZE = 64 * 1024;
+
+// xorshift64*: small, fast and identical on every platform
+class rng_c
+{
+public:
+  explicit rng_c (uint64_t seed)
+    : m_state (seed ? seed : 0x9E3779B97F4A7C15ULL)
+  {
+  }
+  uint64_t next ()
+  {
+    m_state ^= m_state >> 12;
+    m_state ^= m_state << 25;
+    m_state ^= m_state >> 27;
+    return m_state * 0x2545F4914F6CDD1DULL;
+  }
+  uint64_t below (uint64_t n)
+  {
+    return n ? next () % n : 0;
+  }
+  void fill (char* buff, size_t size)
+  {
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8)
+      {
+	const uint64_t v = next ();
+	memcpy (buff + i, &v, 8);
+      }
+    if (i < size)
+      {
+	const uint64_t v = next ();
+	memcpy (buff + i, &v, size - i);
+      }
+  }
+private:
+  uint64_t m_state;
+};
+// ---------------------------------------------------------------
+static bool random_chunk (iff::ea::writer_c& w, const iff::ea::id_c& id,
+			  uint64_t size, rng_c& rng, std::vector <char>& buff)
+{
+  if (size <= (uint64_t)buff.size ())
+    {
+      rng.fill (&buff [0], (size_t)size);
+      return w.chunk (id, &buff [0], (std::streamsize)size);
+    }
+  if (!w.begin_chunk (id))
+    {
+      return false;
+    }
+  while (size)
+    {
+      const size_t n = size < (uint64_t)buff.size () ? (size_t)size : buff.size ();
+      rng.fill (&buff [0], n);
+      if (!w.write (&buff [0], n))
+	{
+	  return false;
+	}
+      size -= n;
+    }
+  return w.end ();
+}
+// ---------------------------------------------------------------
+static bool write_bmhd (iff::ea::writer_c& w)
+{
+  unsigned char bmhd [20];
+  memset (bmhd, 0, sizeof (bmhd));
+  put_be16 (bmhd + 0, 320);  // w
+  put_be16 (bmhd + 2, 200);  // h
+  bmhd [8]  = 5;             // planes
+  bmhd [14] = 10;            // x aspect
+  bmhd [15] = 11;            // y aspect
+  put_be16 (bmhd + 16, 320); // page width
+  put_be16 (bmhd + 18, 200); // page height
+  return w.chunk (iff::ea::id_c ('B','M','H','D'), bmhd, sizeof (bmhd));
+}
+// ---------------------------------------------------------------
+static bool write_anhd (iff::ea::writer_c& w)
+{
+  unsigned char anhd [40];
+  memset (anhd, 0, sizeof (anhd));
+  anhd [0] = 5;              // operation: byte vertical delta
+  put_be32 (anhd + 14, 1);   // reltime
+  anhd [18] = 2;             // interleave
+  return w.chunk (iff::ea::id_c ('A','N','H','D'), anhd, sizeof (anhd));
+}
+
+namespace iff
+{
+  namespace synth
+  {
+    constexpr ea::id_c FORM = "FORM"_id;
+    constexpr ea::id_c CAT  = "CAT "_id;
+    // ---------------------------------------------------------------
+    void default_params (shape_t shape, params_t& p)
+    {
+      p.shape = shape;
+      p.seed  = 1;
+      p.depth = 1;
+      p.count = 1;
+      p.size  = 0;
+      switch (shape)
+	{
+	case eTINY:
+	  p.count = 1000000;
+	  p.size  = 4;
+	  break;
+	case eDEEP:
+	  p.depth = 4096;
+	  p.size  = 16;
+	  break;
+	case eBODY:
+	  p.size  = 256 * 1024 * 1024;
+	  break;
+	case eCAT:
+	  p.count = 100000;
+	  p.size  = 64;
+	  break;
+	case eANIM:
+	  p.count = 1000;
+	  p.size  = 64 * 1024;
+	  break;
+	}
+    }
+    // ---------------------------------------------------------------
+    static const char* s_names [] = {"tiny", "deep", "body", "cat", "anim"};
+    // ---------------------------------------------------------------
+    const char* shape_name (shape_t shape)
+    {
+      return s_names [shape];
+    }
+    // ---------------------------------------------------------------
+    bool shape_by_name (const char* name, shape_t& shape)
+    {
+      for (unsigned i = 0; i < sizeof (s_names) / sizeof (s_names [0]); i++)
+	{
+	  if (strcmp (name, s_names [i]) == 0)
+	    {
+	      shape = (shape_t)i;
+	      return true;
+	    }
+	}
+      return false;
+    }
+    // ---------------------------------------------------------------
+    bool generate (std::ostream& os, const params_t& p)
+    {
+      ea::writer_c      w (os);
+      rng_c             rng (p.seed);
+      std::vector <char> buff (BLOCK_SIZE);
+
+      switch (p.shape)
+	{
+	case eTINY:
+	  {
+	    static const char ids [] = "TXT0TXT1TXT2TXT3DATAANNOAUTHNAME";
+	    w.begin_group (FORM, ea::id_c ('T','I','N','Y'));
+	    for (uint64_t i = 0; i < p.count && w.good (); i++)
+	      {
+		const char* c = ids + 4 * rng.below (8);
+		random_chunk (w, ea::id_c (c [0], c [1], c [2], c [3]),
+			      rng.below (p.size + 1), rng, buff);
+	      }
+	    w.end ();
+	  }
+	  break;
+	case eDEEP:
+	  for (unsigned level = 0; level < p.depth && w.good (); level++)
+	    {
+	      unsigned char lvl [4];
+	      put_be32 (lvl, level);
+	      w.begin_group (FORM, ea::id_c ('N','E','S','T'));
+	      w.chunk (ea::id_c ('L','E','V','L'), lvl, sizeof (lvl));
+	    }
+	  random_chunk (w, ea::id_c ('D','A','T','A'), p.size, rng, buff);
+	  while (w.depth () && w.good ())
+	    {
+	      w.end ();
+	    }
+	  break;
+	case eBODY:
+	  w.begin_group (FORM, ea::id_c ('I','L','B','M'));
+	  write_bmhd (w);
+	  random_chunk (w, ea::id_c ('B','O','D','Y'), p.size, rng, buff);
+	  w.end ();
+	  break;
+	case eCAT:
+	  w.begin_group (CAT, ea::id_c ('S','Y','N','T'));
+	  for (uint64_t i = 0; i < p.count && w.good (); i++)
+	    {
+	      w.begin_group (FORM, ea::id_c ('S','Y','N','T'));
+	      random_chunk (w, ea::id_c ('D','A','T','A'), rng.below (p.size + 1), rng, buff);
+	      w.end ();
+	    }
+	  w.end ();
+	  break;
+	case eANIM:
+	  w.begin_group (FORM, ea::id_c ('A','N','I','M'));
+	  for (uint64_t i = 0; i < p.count && w.good (); i++)
+	    {
+	      w.begin_group (FORM, ea::id_c ('I','L','B','M'));
+	      if (i == 0)
+		{
+		  write_bmhd (w);
+		  random_chunk (w, ea::id_c ('B','O','D','Y'), p.size, rng, buff);
+		}
+	      else
+		{
+		  write_anhd (w);
+		  random_chunk (w, ea::id_c ('D','L','T','A'), p.size, rng, buff);
+		}
+	      w.end ();
+	    }
+	  w.end ();
+	  break;
+	}
+      return w.good () && w.depth () == 0 && os.good ();
+    }
+  } // ns synth
+} // ns iff
@@ -0,0 +1,40 @@
+#ifndef __IFF_TOOLS_SYNTH_HPP__
+#define __IFF_TOOLS_SYNTH_HPP__
+
+#include <iostream>
+#include "core/iff_types.hpp"
+
+namespace iff
+{
+  namespace synth
+  {
+    // Shapes of synthetic EA IFF files. All of them are valid IFF
+    // and are fully determined by params_t, seed included.
+    enum shape_t
+      {
+	eTINY,   // FORM TINY holding "count" chunks of 0.."size" bytes
+	eDEEP,   // "depth" nested FORM NEST groups, DATA of "size" bytes inside
+	eBODY,   // FORM ILBM with a BMHD and a single BODY of "size" bytes
+	eCAT,    // CAT  holding "count" FORMs with a DATA of 0.."size" bytes
+	eANIM    // FORM ANIM of "count" frames, every delta "size" bytes
+      };
+
+    struct params_t
+    {
+      shape_t  shape;
+      uint64_t count;
+      unsigned depth;
+      uint64_t size;
+      uint64_t seed;
+    };
+
+    void        default_params (shape_t shape, params_t& p);
+    const char* shape_name     (shape_t shape);
+    bool        shape_by_name  (const char* name, shape_t& shape);
+
+    // the stream must be seekable: group sizes are backpatched
+    bool generate (std::ostream& os, const params_t& p);
+  } // ns synth
+} // ns iff
+
+#endif
@@ -0,0 +1,90 @@
+#include <string.h>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "core/codec/transcode.hpp"
+
+using iff::codec::audio_transcoder_c;
+
+// Converts an AIFF / AIFC to WAV or a WAV to AIFF, whichever the input is.
+static void usage (const char* prog)
+{
+  std::cerr << "USAGE " << prog << " [-s] in_file out_file" << std::endl
+	    << "  converts FORM AIFF/AIFC to RIFF WAVE and back; -s writes 16 bit and" << std::endl
+	    << "  wider WAV samples as AIFC 'sowt', which copies them unswapped" << std::endl;
+}
+// ---------------------------------------------------------------
+int main (int argc, char* argv [])
+{
+  bool sowt = false;
+  const char* in  = 0;
+  const char* out = 0;
+  for (int i = 1; i < argc; i++)
+    {
+      const std::string a = argv [i];
+      if (a == "-s")
+	{
+	  sowt = true;
+	}
+      else if (a.size () > 1 && a [0] == '-')
+	{
+	  usage (argv [0]);
+	  return 1;
+	}
+      else if (!in)
+	{
+	  in = argv [i];
+	}
+      else if (!out)
+	{
+	  out = argv [i];
+	}
+      else
+	{
+	  usage (argv [0]);
+	  return 1;
+	}
+    }
+  if (!in || !out)
+    {
+      usage (argv [0]);
+      return 1;
+    }
+
+  char magic [4] = {0, 0, 0, 0};
+  std::ifstream ifs (in, std::ios::in | std::ios::binary);
+  ifs.read (magic, sizeof (magic));
+  ifs.close ();
+
+  audio_transcoder_c t;
+  t.set_sowt (sowt);
+  const std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now ();
+  audio_transcoder_c::status_t rc;
+  if (memcmp (magic, "RIFF", 4) == 0)
+    {
+      rc = t.wav_to_aiff (in, out);
+    }
+  else
+    {
+      rc = t.aiff_to_wav (in, out);
+    }
+  const double seconds = std::chrono::duration <double> (std::chrono::steady_clock::now () - t0).count ();
+  if (rc != audio_transcoder_c::eOK)
+    {
+      std::cerr << in << ": " << audio_transcoder_c::status_name (rc) << std::endl;
+      return 1;
+    }
+  const iff::codec::audio_format_t& f = t.format ();
+  std::cerr << in << ": " << f.channels << " ch, " << f.sample_bits << " bit"
+	    << (f.floating ? " float" : "") << ", " << f.sample_rate << " Hz, "
+	    << f.frames << " frames, " << t.data_bytes () << " bytes "
+	    << (t.copied () ? "copied by " : "converted by ") << iff::copy_method_name (t.method ());
+  if (seconds > 0)
+    {
+      std::cerr << ", " << t.data_bytes () / (1024.0 * 1024.0) / seconds << " MB/s";
+    }
+  std::cerr << std::endl;
+  return 0;
+}